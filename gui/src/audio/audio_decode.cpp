@@ -325,28 +325,23 @@ static NormalizedAudio decode_wav_file(const std::string& path) {
 // ---------------------------------------------------------------------------
 
 // Decode WSS using armatools::wss, then normalize to 44100/stereo.
+// Samples are decoded straight into int16 frames.
 static NormalizedAudio decode_wss(std::istream& stream) {
-    auto wss = armatools::wss::read(stream);
-    if (wss.pcm.empty() || wss.bits_per_sample != 16) {
+    armatools::wss::Decoder decoder(stream);
+    const auto& info = decoder.info();
+    if (decoder.frames() == 0 || info.channels == 0 || info.bits_per_sample != 16) {
         std::string msg = "WSS: unsupported format or empty PCM (bits=" +
-                          std::to_string(wss.bits_per_sample) + ", pcm_size=" +
-                          std::to_string(wss.pcm.size()) + ")";
+                          std::to_string(info.bits_per_sample) + ", samples=" +
+                          std::to_string(info.samples) + ")";
         LOGE(msg);
         throw std::runtime_error(msg);
     }
 
-    // Convert raw bytes to int16_t samples.
-    size_t num_samples = wss.pcm.size() / 2;
-    std::vector<int16_t> raw(num_samples);
-    for (size_t i = 0; i < num_samples; ++i) {
-        raw[i] = static_cast<int16_t>(
-            static_cast<uint16_t>(wss.pcm[i * 2]) |
-            (static_cast<uint16_t>(wss.pcm[i * 2 + 1]) << 8));
-    }
-
-    size_t src_channels = wss.channels;
-    uint32_t src_rate = wss.sample_rate;
-    size_t src_frames = src_channels > 0 ? num_samples / src_channels : 0;
+    size_t src_channels = info.channels;
+    uint32_t src_rate = info.sample_rate;
+    size_t src_frames = static_cast<size_t>(decoder.frames());
+    std::vector<int16_t> raw(src_frames * src_channels);
+    decoder.decode(raw.data(), src_frames);
 
     // Resample if needed (simple linear interpolation).
     std::vector<int16_t> resampled;
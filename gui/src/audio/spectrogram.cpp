@@ -1,5 +1,7 @@
 #include "spectrogram.h"
 
+#include <armatools/parallel.h>
+
 #include <algorithm>
 #include <cmath>
 #include <cstring>
@@ -8,65 +10,90 @@ static constexpr size_t kFFTSize = 4096;
 static constexpr size_t kHop = 256;
 static constexpr size_t kFreqBins = 1024;
 static constexpr float kMinFreq = 20.0f;
+// Cached columns kept across views (32 MiB of dB values) before the
+// columns outside the current view are dropped.
+static constexpr size_t kMaxCachedCols = 8192;
 
-// In-place radix-2 Cooley-Tukey FFT.
-// real[] and imag[] must have n elements, n must be a power of 2.
-static void fft(float* real, float* imag, size_t n) {
-    // Bit-reversal permutation.
-    for (size_t i = 1, j = 0; i < n; ++i) {
-        size_t bit = n >> 1;
-        for (; j & bit; bit >>= 1) j ^= bit;
-        j ^= bit;
-        if (i < j) {
-            std::swap(real[i], real[j]);
-            std::swap(imag[i], imag[j]);
-        }
-    }
+// A real FFT of kFFTSize samples runs as a complex FFT of half the size
+// over even/odd sample pairs, followed by a split pass.
+static constexpr size_t kHalf = kFFTSize / 2;
+static constexpr size_t kNone = static_cast<size_t>(-1);
 
-    // Butterfly stages.
-    for (size_t len = 2; len <= n; len <<= 1) {
-        float angle = -2.0f * 3.14159265358979323846f / static_cast<float>(len);
-        float wreal = std::cos(angle);
-        float wimag = std::sin(angle);
-        for (size_t i = 0; i < n; i += len) {
-            float cur_r = 1.0f, cur_i = 0.0f;
-            for (size_t j = 0; j < len / 2; ++j) {
-                size_t u = i + j;
-                size_t v = i + j + len / 2;
-                float tr = cur_r * real[v] - cur_i * imag[v];
-                float ti = cur_r * imag[v] + cur_i * real[v];
-                real[v] = real[u] - tr;
-                imag[v] = imag[u] - ti;
-                real[u] += tr;
-                imag[u] += ti;
-                float new_r = cur_r * wreal - cur_i * wimag;
-                float new_i = cur_r * wimag + cur_i * wreal;
-                cur_r = new_r;
-                cur_i = new_i;
-            }
-        }
-    }
-}
+struct SpectrogramEngine::Impl {
+    std::vector<float> mono;
+    size_t total_cols = 0;
 
-SpectrogramData compute_spectrogram(const float* mono, size_t count,
-                                     uint32_t sample_rate) {
-    SpectrogramData data;
-    if (count < kFFTSize) return data;
+    // Tables shared by every column.
+    std::vector<float> window;                  // Hann, kFFTSize
+    std::vector<uint32_t> bitrev;               // kHalf
+    std::vector<float> tw_re, tw_im;            // exp(-2*pi*i*j/kHalf), j < kHalf/2
+    std::vector<float> split_re, split_im;      // exp(-2*pi*i*k/kFFTSize), k <= kHalf
+    std::vector<size_t> bin_edges;              // kFreqBins + 1 FFT bins
 
-    float nyquist = static_cast<float>(sample_rate) / 2.0f;
+    // Cache: slot[col] indexes a kFreqBins run of dB values in db;
+    // cached_cols lists the columns in slot order.
+    std::vector<size_t> slot;
+    std::vector<float> db;
+    std::vector<size_t> cached_cols;
+    size_t cached = 0;
+
+    // Per-thread scratch.
+    struct Scratch {
+        std::vector<float> re = std::vector<float>(kHalf);
+        std::vector<float> im = std::vector<float>(kHalf);
+        std::vector<float> magnitude = std::vector<float>(kHalf + 1);
+    };
+
+    Impl(std::vector<float> samples, uint32_t sample_rate);
+    void fft(Scratch& s) const;
+    void column(size_t col, Scratch& s, float* out) const;
+    void evict_except(const std::vector<size_t>& keep);
+};
 
-    // Precompute Hann window.
-    std::vector<float> window(kFFTSize);
-    for (size_t i = 0; i < kFFTSize; ++i) {
-        window[i] = 0.5f * (1.0f - std::cos(2.0f * 3.14159265358979323846f *
-                                              static_cast<float>(i) /
-                                              static_cast<float>(kFFTSize)));
+SpectrogramEngine::Impl::Impl(std::vector<float> samples, uint32_t sample_rate)
+    : mono(std::move(samples)) {
+    if (mono.size() >= kFFTSize) total_cols = (mono.size() - kFFTSize) / kHop + 1;
+    slot.assign(total_cols, kNone);
+
+    // Tables are evaluated in double so every twiddle is exact to float
+    // precision instead of accumulating rounding across a stage.
+    constexpr double kPi = 3.14159265358979323846;
+    window.resize(kFFTSize);
+    for (size_t i = 0; i < kFFTSize; ++i)
+        window[i] = static_cast<float>(
+            0.5 * (1.0 - std::cos(2.0 * kPi * static_cast<double>(i) / static_cast<double>(kFFTSize))));
+
+    size_t bits = 0;
+    while ((size_t{1} << bits) < kHalf) ++bits;
+    bitrev.resize(kHalf);
+    for (size_t i = 0; i < kHalf; ++i) {
+        size_t r = 0;
+        for (size_t b = 0; b < bits; ++b)
+            if (i & (size_t{1} << b)) r |= size_t{1} << (bits - 1 - b);
+        bitrev[i] = static_cast<uint32_t>(r);
+    }
+
+    tw_re.resize(kHalf / 2);
+    tw_im.resize(kHalf / 2);
+    for (size_t j = 0; j < kHalf / 2; ++j) {
+        double a = -2.0 * kPi * static_cast<double>(j) / static_cast<double>(kHalf);
+        tw_re[j] = static_cast<float>(std::cos(a));
+        tw_im[j] = static_cast<float>(std::sin(a));
     }
 
-    // Precompute log-spaced frequency bin edges → FFT bin indices.
+    split_re.resize(kHalf + 1);
+    split_im.resize(kHalf + 1);
+    for (size_t k = 0; k <= kHalf; ++k) {
+        double a = -2.0 * kPi * static_cast<double>(k) / static_cast<double>(kFFTSize);
+        split_re[k] = static_cast<float>(std::cos(a));
+        split_im[k] = static_cast<float>(std::sin(a));
+    }
+
+    // Log-spaced frequency bin edges → FFT bin indices.
+    float nyquist = static_cast<float>(sample_rate) / 2.0f;
     float log_min = std::log(kMinFreq);
     float log_max = std::log(nyquist);
-    std::vector<size_t> bin_edges(kFreqBins + 1);
+    bin_edges.resize(kFreqBins + 1);
     for (size_t i = 0; i <= kFreqBins; ++i) {
         float freq = std::exp(log_min + static_cast<float>(i) /
                                             static_cast<float>(kFreqBins) *
@@ -74,51 +101,162 @@ SpectrogramData compute_spectrogram(const float* mono, size_t count,
         auto fft_bin = static_cast<size_t>(freq / nyquist * (kFFTSize / 2));
         bin_edges[i] = std::min(fft_bin, kFFTSize / 2);
     }
+}
 
-    size_t cols = (count - kFFTSize) / kHop + 1;
-    data.cols = cols;
-    data.freq_bins = kFreqBins;
-    data.db.resize(cols * kFreqBins);
+// Radix-2 butterflies over bit-reversed input in s.re/s.im.
+void SpectrogramEngine::Impl::fft(Scratch& s) const {
+    float* re = s.re.data();
+    float* im = s.im.data();
+    for (size_t len = 2, step = kHalf / 2; len <= kHalf; len <<= 1, step >>= 1) {
+        size_t half = len / 2;
+        for (size_t i = 0; i < kHalf; i += len) {
+            for (size_t j = 0; j < half; ++j) {
+                float wr = tw_re[j * step];
+                float wi = tw_im[j * step];
+                size_t u = i + j;
+                size_t v = u + half;
+                float tr = wr * re[v] - wi * im[v];
+                float ti = wr * im[v] + wi * re[v];
+                re[v] = re[u] - tr;
+                im[v] = im[u] - ti;
+                re[u] += tr;
+                im[u] += ti;
+            }
+        }
+    }
+}
 
-    std::vector<float> real(kFFTSize);
-    std::vector<float> imag(kFFTSize);
-    std::vector<float> magnitude(kFFTSize / 2 + 1);
+// column writes the kFreqBins dB values of hop column col to out.
+void SpectrogramEngine::Impl::column(size_t col, Scratch& s, float* out) const {
+    const float* x = mono.data() + col * kHop;
 
-    for (size_t col = 0; col < cols; ++col) {
-        size_t offset = col * kHop;
+    // Pack even samples as real and odd samples as imaginary parts,
+    // windowed and already in bit-reversed order.
+    for (size_t n = 0; n < kHalf; ++n) {
+        size_t r = bitrev[n];
+        s.re[r] = x[2 * n] * window[2 * n];
+        s.im[r] = x[2 * n + 1] * window[2 * n + 1];
+    }
+    fft(s);
 
-        // Apply window and fill FFT input.
-        for (size_t i = 0; i < kFFTSize; ++i) {
-            real[i] = mono[offset + i] * window[i];
-            imag[i] = 0.0f;
-        }
+    // Split the packed spectrum Z into the real input's spectrum X:
+    // X[k] = (Z[k] + conj(Z[M-k])) / 2 + W^k * (Z[k] - conj(Z[M-k])) / 2i.
+    for (size_t k = 0; k <= kHalf; ++k) {
+        size_t a = k % kHalf;
+        size_t b = (kHalf - k) % kHalf;
+        float even_r = 0.5f * (s.re[a] + s.re[b]);
+        float even_i = 0.5f * (s.im[a] - s.im[b]);
+        float odd_r = 0.5f * (s.im[a] + s.im[b]);
+        float odd_i = -0.5f * (s.re[a] - s.re[b]);
+        float xr = even_r + split_re[k] * odd_r - split_im[k] * odd_i;
+        float xi = even_i + split_re[k] * odd_i + split_im[k] * odd_r;
+        s.magnitude[k] = std::sqrt(xr * xr + xi * xi);
+    }
 
-        fft(real.data(), imag.data(), kFFTSize);
+    // Map to log-spaced frequency bins.
+    for (size_t b = 0; b < kFreqBins; ++b) {
+        size_t lo = bin_edges[b];
+        size_t hi = bin_edges[b + 1];
+        if (hi <= lo) hi = lo + 1;
+        if (hi > kFFTSize / 2 + 1) hi = kFFTSize / 2 + 1;
 
-        // Compute magnitudes.
-        for (size_t i = 0; i <= kFFTSize / 2; ++i) {
-            magnitude[i] = std::sqrt(real[i] * real[i] + imag[i] * imag[i]);
-        }
+        float sum = 0.0f;
+        for (size_t i = lo; i < hi; ++i) sum += s.magnitude[i];
+        float avg = sum / static_cast<float>(hi - lo);
+
+        float db_val = (avg > 1e-10f) ? 20.0f * std::log10(avg / static_cast<float>(kFFTSize)) : -80.0f;
+        out[b] = std::clamp(db_val, -80.0f, 0.0f);
+    }
+}
 
-        // Map to log-spaced frequency bins.
-        for (size_t b = 0; b < kFreqBins; ++b) {
-            size_t lo = bin_edges[b];
-            size_t hi = bin_edges[b + 1];
-            if (hi <= lo) hi = lo + 1;
-            if (hi > kFFTSize / 2 + 1) hi = kFFTSize / 2 + 1;
+// Drop every cached column not in keep, compacting the survivors to the
+// front of db.
+void SpectrogramEngine::Impl::evict_except(const std::vector<size_t>& keep) {
+    std::vector<size_t> kept;
+    std::vector<float> kept_db;
+    for (size_t col : keep) {
+        if (slot[col] == kNone) continue;
+        kept_db.insert(kept_db.end(), db.begin() + static_cast<std::ptrdiff_t>(slot[col]),
+                       db.begin() + static_cast<std::ptrdiff_t>(slot[col] + kFreqBins));
+        slot[col] = kNone;
+        kept.push_back(col);
+    }
+    for (size_t col : cached_cols) slot[col] = kNone;
+    for (size_t i = 0; i < kept.size(); ++i) slot[kept[i]] = i * kFreqBins;
+    cached_cols = std::move(kept);
+    cached = cached_cols.size();
+    db = std::move(kept_db);
+}
 
-            float sum = 0.0f;
-            for (size_t i = lo; i < hi; ++i) sum += magnitude[i];
-            float avg = sum / static_cast<float>(hi - lo);
+SpectrogramEngine::SpectrogramEngine(std::vector<float> mono, uint32_t sample_rate)
+    : impl_(std::make_unique<Impl>(std::move(mono), sample_rate)) {}
 
-            float db_val = (avg > 1e-10f) ? 20.0f * std::log10(avg / static_cast<float>(kFFTSize)) : -80.0f;
-            data.db[col * kFreqBins + b] = std::clamp(db_val, -80.0f, 0.0f);
-        }
+SpectrogramEngine::~SpectrogramEngine() = default;
+
+size_t SpectrogramEngine::total_columns() const { return impl_->total_cols; }
+
+size_t SpectrogramEngine::sample_count() const { return impl_->mono.size(); }
+
+size_t SpectrogramEngine::cached_columns() const { return impl_->cached; }
+
+SpectrogramData SpectrogramEngine::compute(size_t begin, size_t end, size_t cols,
+                                           unsigned threads) {
+    auto& d = *impl_;
+    SpectrogramData data;
+    if (d.total_cols == 0 || cols == 0) return data;
+
+    // Hop columns whose frames start inside [begin, end).
+    size_t first = std::min(begin / kHop, d.total_cols - 1);
+    size_t last = std::clamp((end + kHop - 1) / kHop, first + 1, d.total_cols);
+    std::vector<size_t> picks(cols);
+    for (size_t c = 0; c < cols; ++c)
+        picks[c] = first + c * (last - first) / cols;
+
+    // Reserve cache slots for the columns not seen before. Once the cache
+    // would outgrow its budget, only the columns of this view are kept.
+    size_t new_cols = 0;
+    for (size_t col : picks)
+        if (d.slot[col] == kNone) ++new_cols;
+    if (new_cols > 0 && d.cached + new_cols > std::max(kMaxCachedCols, cols))
+        d.evict_except(picks);
+    std::vector<size_t> missing;
+    for (size_t col : picks) {
+        if (d.slot[col] != kNone) continue;
+        d.slot[col] = d.cached++ * kFreqBins;
+        d.cached_cols.push_back(col);
+        missing.push_back(col);
+    }
+    d.db.resize(d.cached * kFreqBins);
+
+    if (!missing.empty()) {
+        // A few dozen columns per thread keeps start-up cost negligible.
+        size_t n_threads = std::clamp<size_t>(
+            missing.size() / 32, 1, armatools::binutil::worker_count(static_cast<int>(threads)));
+        size_t per = (missing.size() + n_threads - 1) / n_threads;
+        armatools::binutil::parallel_for(n_threads, n_threads, [&](size_t t) {
+            Impl::Scratch scratch;
+            size_t last_i = std::min((t + 1) * per, missing.size());
+            for (size_t i = t * per; i < last_i; ++i)
+                d.column(missing[i], scratch, d.db.data() + d.slot[missing[i]]);
+        });
     }
 
+    data.cols = cols;
+    data.freq_bins = kFreqBins;
+    data.db.resize(cols * kFreqBins);
+    for (size_t c = 0; c < cols; ++c)
+        std::copy_n(d.db.begin() + static_cast<std::ptrdiff_t>(d.slot[picks[c]]), kFreqBins,
+                    data.db.begin() + static_cast<std::ptrdiff_t>(c * kFreqBins));
     return data;
 }
 
+SpectrogramData compute_spectrogram(const float* mono, size_t count,
+                                     uint32_t sample_rate) {
+    if (count < kFFTSize) return {};
+    SpectrogramEngine engine(std::vector<float>(mono, mono + count), sample_rate);
+    return engine.compute(0, count, engine.total_columns());
+}
+
 // 7-stop gradient: black → dark blue → purple → red → orange → yellow → white
 // mapped from -80 dB to 0 dB.
 static void db_to_color(float db, uint8_t& r, uint8_t& g, uint8_t& b) {
@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 struct SpectrogramData {
@@ -23,5 +24,44 @@ struct SpectrogramImage {
 SpectrogramData compute_spectrogram(const float* mono, size_t count,
                                      uint32_t sample_rate);
 
+// SpectrogramEngine computes spectrogram columns on demand for a view of
+// the audio and keeps the columns it has computed, so redrawing, resizing
+// or zooming only transforms frames it has not seen yet. The cache holds
+// up to 8192 columns (or one view, if larger); past that, columns outside
+// the current view are dropped.
+//
+// Columns sit on the same 256-sample hop grid as compute_spectrogram. A
+// view of n columns over [begin, end) picks the grid column nearest each
+// pixel, so a whole-file overview costs n FFTs however long the file is.
+// Missing columns are computed in parallel with a real-input FFT using
+// precomputed twiddle and bit-reversal tables.
+//
+// Not thread-safe: use one engine from one thread at a time.
+class SpectrogramEngine {
+public:
+    SpectrogramEngine(std::vector<float> mono, uint32_t sample_rate);
+    ~SpectrogramEngine();
+
+    SpectrogramEngine(const SpectrogramEngine&) = delete;
+    SpectrogramEngine& operator=(const SpectrogramEngine&) = delete;
+
+    // Number of hop columns in the whole file.
+    size_t total_columns() const;
+
+    // Samples of mono audio the engine was built from.
+    size_t sample_count() const;
+
+    // Compute cols columns spanning samples [begin, end). threads = 0 uses
+    // all cores.
+    SpectrogramData compute(size_t begin, size_t end, size_t cols, unsigned threads = 0);
+
+    // Columns currently cached.
+    size_t cached_columns() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
 // Render spectrogram data to an RGBA image.
 SpectrogramImage render_spectrogram(const SpectrogramData& data);
@@ -0,0 +1,58 @@
+#include "compressed_texture.h"
+
+#include <epoxy/gl.h>
+
+#include <algorithm>
+
+namespace infra::gl {
+
+namespace {
+
+GLenum s3tc_internal_format(const std::string& format) {
+    if (format == "DXT1") return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+    if (format == "DXT3") return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+    if (format == "DXT5") return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    return 0;
+}
+
+}  // namespace
+
+bool supports_s3tc() {
+    return epoxy_has_gl_extension("GL_EXT_texture_compression_s3tc");
+}
+
+uint32_t upload_dxt_texture_2d(const std::string& format,
+                               const std::vector<armatools::paa::Mip>& mips) {
+    const GLenum internal_format = s3tc_internal_format(format);
+    if (internal_format == 0 || mips.empty()) return 0;
+    if (mips.front().width <= 0 || mips.front().height <= 0) return 0;
+
+    // PAA rows run top to bottom like the RGBA uploads, so blocks go in
+    // unchanged. Levels stop at the first one that does not halve the
+    // previous, since GL needs a consistent chain to sample mipmaps.
+    GLuint tex = 0;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    GLint levels = 0;
+    for (const auto& mip : mips) {
+        if (levels > 0) {
+            const auto& prev = mips[static_cast<size_t>(levels - 1)];
+            if (mip.width != std::max(1, prev.width / 2)
+                || mip.height != std::max(1, prev.height / 2)) break;
+        }
+        glCompressedTexImage2D(GL_TEXTURE_2D, levels, internal_format,
+                               mip.width, mip.height, 0,
+                               static_cast<GLsizei>(mip.data.size()), mip.data.data());
+        ++levels;
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return tex;
+}
+
+}  // namespace infra::gl
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <armatools/paa.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace infra::gl {
+
+// supports_s3tc reports whether the current GL context accepts DXT1/3/5
+// blocks (GL_EXT_texture_compression_s3tc). Needs a current context.
+[[nodiscard]] bool supports_s3tc();
+
+// upload_dxt_texture_2d creates a GL_TEXTURE_2D from a PAA mip chain kept
+// as stored, with repeat wrapping and trilinear filtering over the levels
+// that halve cleanly. Returns 0 for formats S3TC cannot take (DXT2/DXT4,
+// non-DXT) or an empty chain; the caller then decodes to RGBA.
+[[nodiscard]] uint32_t upload_dxt_texture_2d(const std::string& format,
+                                             const std::vector<armatools::paa::Mip>& mips);
+
+}  // namespace infra::gl
@@ -9,6 +9,7 @@
 #include <armatools/armapath.h>
 
 #include <algorithm>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
@@ -173,6 +174,7 @@ ModelViewPanel::ModelViewPanel() : Gtk::Box(Gtk::Orientation::VERTICAL, 0) {
 ModelViewPanel::~ModelViewPanel() {
     realize_connection_.disconnect();
     load_poll_conn_.disconnect();
+    texture_poll_conn_.disconnect();
 }
 
 void ModelViewPanel::set_config(Config* cfg) {
@@ -310,6 +312,8 @@ void ModelViewPanel::apply_lod(const armatools::p3d::LOD& lod,
 
 void ModelViewPanel::clear() {
     loaded_textures_.clear();
+    pending_textures_.clear();
+    texture_poll_conn_.disconnect();
     pending_lod_.reset();
     while (auto* child = lods_box_.get_first_child())
         lods_box_.remove(*child);
@@ -430,46 +434,76 @@ void ModelViewPanel::load_textures_for_lod(const armatools::p3d::LOD& lod,
                                             const std::string& model_path) {
     if (!texture_loader_shared_) return;
 
-    // Load all textures from the LOD
-    auto textures = texture_loader_shared_->load_textures(
-        const_cast<armatools::p3d::LOD&>(lod), model_path);
-    
-    // Apply each texture to the GL view
-    for (const auto& tex_ptr : textures) {
-        if (!tex_ptr) continue;
-        const auto& tex = *tex_ptr;
-        auto normalized = armatools::armapath::to_slash_lower(tex.path);
-        if (!loaded_textures_.count(normalized)) {
+    // Decoding runs on the loader pool; finished textures are applied to
+    // the GL view from on_texture_poll as they arrive.
+    auto futures = texture_loader_shared_->load_textures_async(
+        lod, model_path, TexturesLoaderService::Priority::Visible,
+        gl_view_.supports_compressed_textures());
+    for (auto& f : futures)
+        pending_textures_.push_back(std::move(f));
+
+    // Cached textures are ready already; apply them without waiting a tick.
+    if (on_texture_poll() && !texture_poll_conn_.connected()) {
+        texture_poll_conn_ = Glib::signal_timeout().connect(
+            sigc::mem_fun(*this, &ModelViewPanel::on_texture_poll), 16);
+    }
+}
+
+bool ModelViewPanel::on_texture_poll() {
+    auto it = pending_textures_.begin();
+    while (it != pending_textures_.end()) {
+        if (it->wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            ++it;
+            continue;
+        }
+        auto tex = it->get();
+        it = pending_textures_.erase(it);
+        if (tex) apply_texture(*tex);
+    }
+
+    if (pending_textures_.empty()) {
+        texture_poll_conn_.disconnect();
+        return false;
+    }
+    return true;
+}
+
+void ModelViewPanel::apply_texture(const TexturesLoaderService::TextureData& tex) {
+    auto normalized = armatools::armapath::to_slash_lower(tex.path);
+    if (!loaded_textures_.count(normalized)) {
+        if (!tex.mips.empty()) {
+            gl_view_.set_compressed_texture(tex.path, tex.header.format, tex.mips);
+        } else {
             gl_view_.set_texture(tex.path, tex.image.width, tex.image.height,
                                  tex.image.pixels.data());
-            loaded_textures_.insert(normalized);
-        }
-        if (tex.has_normal_map && tex.normal_map.width > 0 && tex.normal_map.height > 0) {
-            gl_view_.set_normal_map(tex.path, tex.normal_map.width, tex.normal_map.height,
-                                    tex.normal_map.pixels.data());
-        }
-        if (tex.has_specular_map && tex.specular_map.width > 0 && tex.specular_map.height > 0) {
-            gl_view_.set_specular_map(tex.path, tex.specular_map.width, tex.specular_map.height,
-                                      tex.specular_map.pixels.data());
-        }
-        if (tex.has_material) {
-            render_domain::ModelViewWidget::MaterialParams mp;
-            mp.ambient[0] = tex.material.ambient[0];
-            mp.ambient[1] = tex.material.ambient[1];
-            mp.ambient[2] = tex.material.ambient[2];
-            mp.diffuse[0] = tex.material.diffuse[0];
-            mp.diffuse[1] = tex.material.diffuse[1];
-            mp.diffuse[2] = tex.material.diffuse[2];
-            mp.emissive[0] = tex.material.emissive[0];
-            mp.emissive[1] = tex.material.emissive[1];
-            mp.emissive[2] = tex.material.emissive[2];
-            mp.specular[0] = tex.material.specular[0];
-            mp.specular[1] = tex.material.specular[1];
-            mp.specular[2] = tex.material.specular[2];
-            mp.specular_power = tex.material.specular_power;
-            mp.shader_mode = tex.material.shader_mode;
-            gl_view_.set_material_params(tex.path, mp);
         }
+        loaded_textures_.insert(normalized);
+    }
+    if (tex.has_normal_map && tex.normal_map.width > 0 && tex.normal_map.height > 0) {
+        gl_view_.set_normal_map(tex.path, tex.normal_map.width, tex.normal_map.height,
+                                tex.normal_map.pixels.data());
+    }
+    if (tex.has_specular_map && tex.specular_map.width > 0 && tex.specular_map.height > 0) {
+        gl_view_.set_specular_map(tex.path, tex.specular_map.width, tex.specular_map.height,
+                                  tex.specular_map.pixels.data());
+    }
+    if (tex.has_material) {
+        render_domain::ModelViewWidget::MaterialParams mp;
+        mp.ambient[0] = tex.material.ambient[0];
+        mp.ambient[1] = tex.material.ambient[1];
+        mp.ambient[2] = tex.material.ambient[2];
+        mp.diffuse[0] = tex.material.diffuse[0];
+        mp.diffuse[1] = tex.material.diffuse[1];
+        mp.diffuse[2] = tex.material.diffuse[2];
+        mp.emissive[0] = tex.material.emissive[0];
+        mp.emissive[1] = tex.material.emissive[1];
+        mp.emissive[2] = tex.material.emissive[2];
+        mp.specular[0] = tex.material.specular[0];
+        mp.specular[1] = tex.material.specular[1];
+        mp.specular[2] = tex.material.specular[2];
+        mp.specular_power = tex.material.specular_power;
+        mp.shader_mode = tex.material.shader_mode;
+        gl_view_.set_material_params(tex.path, mp);
     }
 }
 
@@ -110,6 +110,9 @@ private:
 
     // Texture cache: tracks which keys have been uploaded to GL
     std::unordered_set<std::string> loaded_textures_;
+    // Async texture loads not yet applied; polled by texture_poll_conn_
+    std::vector<TexturesLoaderService::TextureFuture> pending_textures_;
+    sigc::connection texture_poll_conn_;
 
     // Pending LOD data (for deferred loading when GL is not yet realized)
     struct PendingLod {
@@ -144,6 +147,8 @@ private:
                                const std::string& model_path);
     void load_textures_for_lods(const std::vector<armatools::p3d::LOD>& lods,
                                 const std::string& model_path);
+    bool on_texture_poll();
+    void apply_texture(const TexturesLoaderService::TextureData& tex);
     void render_active_lods(bool reset_camera);
     void setup_bg_color_popover();
     void on_screenshot();
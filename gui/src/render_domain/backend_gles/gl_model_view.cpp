@@ -1,6 +1,7 @@
 #include "gl_model_view.h"
 
 #include "gl_error_log.h"
+#include "infra/gl/compressed_texture.h"
 #include "infra/gl/load_resource_text.h"
 #include "log_panel.h"
 #include "cli_logger.h"
@@ -272,10 +273,12 @@ void GLModelView::on_realize_gl() {
     }
 
     is_desktop_gl_ = epoxy_is_desktop_gl();
+    s3tc_supported_ = infra::gl::supports_s3tc();
     int ver = epoxy_gl_version();
     LOGI("GLModelView: using " +
         std::string(is_desktop_gl_ ? "OpenGL" : "OpenGL ES") +
-        " " + std::to_string(ver / 10) + "." + std::to_string(ver % 10));
+        " " + std::to_string(ver / 10) + "." + std::to_string(ver % 10) +
+        (s3tc_supported_ ? " (S3TC)" : ""));
 
     // Select shader sources based on API
     const std::string vert = infra::gl::load_resource_text(
@@ -772,6 +775,35 @@ void GLModelView::set_texture(const std::string& key, int width, int height,
     queue_render();
 }
 
+void GLModelView::set_compressed_texture(const std::string& key, const std::string& format,
+                                         const std::vector<armatools::paa::Mip>& mips) {
+    if (mips.empty()) return;
+    make_current();
+    if (has_error()) return;
+
+    const GLuint tex = s3tc_supported_ ? infra::gl::upload_dxt_texture_2d(format, mips) : 0;
+    if (tex == 0) {
+        auto img = armatools::paa::decode_mip(format, mips.front());
+        set_texture(key, img.width, img.height, img.pixels.data());
+        return;
+    }
+
+    auto norm_key = armatools::armapath::to_slash_lower(key);
+    auto it = textures_.find(norm_key);
+    if (it != textures_.end()) {
+        glDeleteTextures(1, &it->second);
+        textures_.erase(it);
+    }
+    textures_[norm_key] = tex;
+    texture_has_alpha_[norm_key] = armatools::paa::mip_has_alpha(format, mips.front());
+
+    queue_render();
+}
+
+bool GLModelView::supports_compressed_textures() const {
+    return s3tc_supported_;
+}
+
 void GLModelView::reset_camera() {
     camera_controller_.reset_camera();
     const auto state = camera_controller_.camera_state();
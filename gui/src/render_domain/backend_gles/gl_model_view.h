@@ -4,6 +4,7 @@
 #include "domain/gl_model_camera_types.h"
 #include "render_domain/rd_backend_abi.h"
 
+#include <armatools/paa.h>
 #include <gtkmm.h>
 #include <string>
 #include <vector>
@@ -28,6 +29,12 @@ public:
                         const std::vector<std::string>& material_texture_keys = {});
     void set_texture(const std::string& key, int width, int height,
                      const uint8_t* rgba_data);
+    // Uploads a DXT mip chain as stored when the context has S3TC;
+    // otherwise decodes the first level and falls back to set_texture.
+    void set_compressed_texture(const std::string& key, const std::string& format,
+                                const std::vector<armatools::paa::Mip>& mips);
+    // True once realized on a context with S3TC support.
+    bool supports_compressed_textures() const;
     void set_normal_map(const std::string& key, int width, int height,
                         const uint8_t* rgba_data);
     void set_specular_map(const std::string& key, int width, int height,
@@ -110,6 +117,7 @@ private:
     bool textured_ = true;
     bool has_geometry_ = false;
     bool is_desktop_gl_ = true;
+    bool s3tc_supported_ = false;
 
     // 5a. Grid/axis display
     bool show_grid_ = true;
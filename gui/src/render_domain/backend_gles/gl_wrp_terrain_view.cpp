@@ -1,6 +1,7 @@
 #include "gl_wrp_terrain_view.h"
 
 #include "gl_error_log.h"
+#include "infra/gl/compressed_texture.h"
 #include "infra/gl/load_resource_text.h"
 #include "log_panel.h"
 #include "cli_logger.h"
@@ -821,9 +822,12 @@ GLWrpTerrainView::ObjectLoadResult GLWrpTerrainView::prepare_object_model_asset_
         lod_out.bounding_radius = std::max(lod_out.bounding_radius, 0.1f);
 
         if (texture_loader_) {
-            auto lod_copy = *lod;
-            auto resolved = texture_loader_->load_textures(lod_copy, model_name);
-            for (const auto& tex_ptr : resolved) {
+            // Queued at Background so browsing previews and the model panel
+            // are served first; this worker waits for its own results.
+            auto pending = texture_loader_->load_textures_async(
+                *lod, model_name, TexturesLoaderService::Priority::Background, s3tc_supported_);
+            for (const auto& future : pending) {
+                auto tex_ptr = future.get();
                 if (!tex_ptr) continue;
                 const auto& tex = *tex_ptr;
                 std::string key = armatools::armapath::to_slash_lower(tex.path);
@@ -1500,6 +1504,8 @@ void GLWrpTerrainView::on_realize_gl() {
         return;
     }
 
+    s3tc_supported_ = infra::gl::supports_s3tc();
+
     const std::string point_vert_src = infra::gl::load_resource_text(kPointVertResource);
     const std::string point_frag_src = infra::gl::load_resource_text(kPointFragResource);
     auto pvs = compile_shader(GL_VERTEX_SHADER, point_vert_src.c_str());
@@ -3142,7 +3148,19 @@ void GLWrpTerrainView::drain_ready_object_results() {
     if (has_error()) return;
 
     std::unordered_map<std::string, std::pair<GLuint, bool>> texture_cache;
+    const bool s3tc = s3tc_supported_;
     auto upload_texture = [&](const std::string& key, const std::shared_ptr<const TexturesLoaderService::TextureData>& td) -> std::pair<GLuint, bool> {
+        if (td && !td->mips.empty()) {
+            const auto& fmt = td->header.format;
+            if (s3tc) {
+                if (const GLuint gl_tex = infra::gl::upload_dxt_texture_2d(fmt, td->mips))
+                    return {gl_tex, armatools::paa::mip_has_alpha(fmt, td->mips.front())};
+            }
+            const auto img = armatools::paa::decode_mip(fmt, td->mips.front());
+            const GLuint gl_tex = upload_rgba_texture_2d(img.pixels.data(), img.width, img.height);
+            if (gl_tex == 0) return {0, false};
+            return {gl_tex, image_has_alpha_channel(img)};
+        }
         if (!td || td->image.width <= 0 || td->image.height <= 0 || td->image.pixels.empty()) return {0, false};
         const GLuint gl_tex = upload_rgba_texture_2d(td->image.pixels.data(), td->image.width, td->image.height);
         if (gl_tex == 0) return {0, false};
@@ -5,6 +5,7 @@
 
 #include <gtkmm.h>
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -346,6 +347,8 @@ private:
 
     std::shared_ptr<P3dModelLoaderService> model_loader_;
     std::shared_ptr<TexturesLoaderService> texture_loader_;
+    // Set on realize; object workers read it to keep DXT textures compressed.
+    std::atomic<bool> s3tc_supported_{false};
     std::vector<armatools::wrp::TextureEntry> texture_entries_;
     std::array<GLuint, kTerrainRoleCount> layer_atlas_tex_{};
     std::array<std::vector<uint8_t>, kTerrainRoleCount> layer_atlas_pixels_{};
@@ -126,6 +126,16 @@ void ModelViewWidget::set_texture(const std::string& key,
     if (has_gles()) impl_->gles.set_texture(key, width, height, rgba_data);
 }
 
+void ModelViewWidget::set_compressed_texture(const std::string& key,
+                                             const std::string& format,
+                                             const std::vector<armatools::paa::Mip>& mips) {
+    if (has_gles()) impl_->gles.set_compressed_texture(key, format, mips);
+}
+
+bool ModelViewWidget::supports_compressed_textures() const {
+    return has_gles() && impl_->gles.supports_compressed_textures();
+}
+
 void ModelViewWidget::set_normal_map(const std::string& key,
                                      int width,
                                      int height,
@@ -5,6 +5,7 @@
 
 #include <gtkmm.h>
 #include <armatools/p3d.h>
+#include <armatools/paa.h>
 #include <sigc++/signal.h>
 
 #include <cstdint>
@@ -52,6 +53,9 @@ public:
     void set_scene_blob(const rd_scene_blob_v1& blob,
                         const std::vector<std::string>& material_texture_keys = {});
     void set_texture(const std::string& key, int width, int height, const uint8_t* rgba_data);
+    void set_compressed_texture(const std::string& key, const std::string& format,
+                                const std::vector<armatools::paa::Mip>& mips);
+    bool supports_compressed_textures() const;
     void set_normal_map(const std::string& key, int width, int height, const uint8_t* rgba_data);
     void set_specular_map(const std::string& key, int width, int height, const uint8_t* rgba_data);
     void set_material_params(const std::string& key, const MaterialParams& params);
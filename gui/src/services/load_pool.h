@@ -0,0 +1,211 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace load_pool {
+
+// Priority orders queued loads: Visible jobs are taken before Prefetch,
+// Prefetch before Background; FIFO within a class.
+enum class Priority { Visible = 0, Prefetch = 1, Background = 2 };
+
+// ready returns a future that already holds value.
+template <typename T>
+std::shared_future<T> ready(T value) {
+    std::promise<T> promise;
+    promise.set_value(std::move(value));
+    return promise.get_future().share();
+}
+
+// LruCache holds values until their summed byte cost exceeds the budget,
+// then drops the least recently used. The newest entry is always kept.
+// Not thread-safe.
+template <typename V>
+class LruCache {
+public:
+    explicit LruCache(size_t budget) : budget_(budget) {}
+
+    bool find(const std::string& key, V& out) {
+        auto it = map_.find(key);
+        if (it == map_.end()) return false;
+        order_.splice(order_.begin(), order_, it->second);
+        out = it->second->value;
+        return true;
+    }
+
+    void put(const std::string& key, V value, size_t cost) {
+        auto it = map_.find(key);
+        if (it != map_.end()) {
+            bytes_ -= it->second->cost;
+            it->second->value = std::move(value);
+            it->second->cost = cost;
+            order_.splice(order_.begin(), order_, it->second);
+        } else {
+            order_.push_front(Entry{key, std::move(value), cost});
+            map_.emplace(key, order_.begin());
+        }
+        bytes_ += cost;
+        while (bytes_ > budget_ && order_.size() > 1) {
+            bytes_ -= order_.back().cost;
+            map_.erase(order_.back().key);
+            order_.pop_back();
+        }
+    }
+
+    size_t size() const { return order_.size(); }
+    size_t bytes() const { return bytes_; }
+
+private:
+    struct Entry {
+        std::string key;
+        V value;
+        size_t cost = 0;
+    };
+    std::list<Entry> order_;
+    std::unordered_map<std::string, typename std::list<Entry>::iterator> map_;
+    size_t bytes_ = 0;
+    size_t budget_ = 0;
+};
+
+// Pool runs keyed loads on worker threads, started on the first submit.
+// Requests for a key that is already queued or loading share one future; a
+// higher priority promotes the queued job. A load that throws resolves to
+// T{}, as do jobs still queued when the pool is destroyed.
+template <typename T>
+class Pool {
+public:
+    using Future = std::shared_future<T>;
+
+    explicit Pool(unsigned workers) : worker_count_(workers > 0 ? workers : 1) {}
+
+    ~Pool() {
+        std::vector<std::shared_ptr<Job>> abandoned;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+            for (auto& queue : queues_) {
+                for (auto& job : queue) {
+                    if (job->taken) continue;
+                    job->taken = true;
+                    abandoned.push_back(std::move(job));
+                }
+                queue.clear();
+            }
+        }
+        cv_.notify_all();
+        // Abandoned jobs are off every queue, so no worker can touch them;
+        // resolve them before waiting for running loads.
+        for (auto& job : abandoned) job->promise.set_value(T{});
+        for (auto& worker : workers_) {
+            if (worker.joinable()) worker.join();
+        }
+    }
+
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    Future submit(const std::string& key, Priority priority, std::function<T()> load) {
+        const auto cls = static_cast<size_t>(priority);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_) return ready(T{});
+
+        auto it = in_flight_.find(key);
+        if (it != in_flight_.end()) {
+            auto& job = it->second;
+            if (!job->taken && priority < job->priority) {
+                // The copy left in the lower queue is skipped once taken.
+                job->priority = priority;
+                queues_[cls].push_back(job);
+                cv_.notify_one();
+            }
+            return job->future;
+        }
+
+        if (workers_.empty()) {
+            workers_.reserve(worker_count_);
+            for (unsigned i = 0; i < worker_count_; ++i)
+                workers_.emplace_back([this]() { worker_loop(); });
+        }
+
+        auto job = std::make_shared<Job>();
+        job->key = key;
+        job->load = std::move(load);
+        job->priority = priority;
+        job->future = job->promise.get_future().share();
+        in_flight_.emplace(key, job);
+        queues_[cls].push_back(job);
+        cv_.notify_one();
+        return job->future;
+    }
+
+private:
+    struct Job {
+        std::string key;
+        std::function<T()> load;
+        std::promise<T> promise;
+        Future future;
+        Priority priority = Priority::Background;
+        bool taken = false; // popped by a worker; stale copies in lower queues are skipped
+    };
+
+    void worker_loop() {
+        for (;;) {
+            std::shared_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                for (;;) {
+                    cv_.wait(lock, [this]() {
+                        if (stop_) return true;
+                        for (const auto& queue : queues_)
+                            if (!queue.empty()) return true;
+                        return false;
+                    });
+                    if (stop_) return;
+                    for (auto& queue : queues_) {
+                        if (queue.empty()) continue;
+                        job = std::move(queue.front());
+                        queue.pop_front();
+                        break;
+                    }
+                    if (!job->taken) break;
+                    job.reset();
+                }
+                job->taken = true;
+            }
+
+            T value{};
+            try {
+                value = job->load();
+            } catch (...) {
+                value = T{};
+            }
+            job->promise.set_value(std::move(value));
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = in_flight_.find(job->key);
+            if (it != in_flight_.end() && it->second == job) in_flight_.erase(it);
+        }
+    }
+
+    unsigned worker_count_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::array<std::deque<std::shared_ptr<Job>>, 3> queues_;
+    std::unordered_map<std::string, std::shared_ptr<Job>> in_flight_;
+    std::vector<std::thread> workers_;
+    bool stop_ = false;
+};
+
+} // namespace load_pool
@@ -0,0 +1,49 @@
+#include "texture_data.h"
+
+#include <utility>
+
+namespace texture_data {
+
+using TextureData = TexturesLoaderService::TextureData;
+
+size_t cost(const TextureData* tex) {
+    if (!tex) return cache_entry_overhead;
+    size_t total = cache_entry_overhead + tex->path.size() + tex->image.pixels.size()
+        + tex->normal_map.pixels.size() + tex->specular_map.pixels.size();
+    for (const auto& mip : tex->mips) total += mip.data.size();
+    return total;
+}
+
+size_t layered_cost(const TexturesLoaderService::TerrainLayeredMaterial* mat) {
+    if (!mat) return cache_entry_overhead;
+    size_t total = cache_entry_overhead + mat->satellite.image.pixels.size()
+        + mat->mask.image.pixels.size();
+    for (const auto& s : mat->surfaces) {
+        total += s.macro.image.pixels.size() + s.normal.image.pixels.size()
+            + s.detail.image.pixels.size();
+    }
+    return total;
+}
+
+std::shared_ptr<const TextureData> decode(std::istream& in, const std::string& tex_path,
+                                          bool keep_compressed) {
+    try {
+        if (keep_compressed) {
+            const auto start = in.tellg();
+            const auto fmt = armatools::paa::read_header(in).format;
+            in.seekg(start);
+            if (fmt == "DXT1" || fmt == "DXT3" || fmt == "DXT5") {
+                auto [mips, hdr] = armatools::paa::read_mips(in);
+                if (hdr.width <= 0 || hdr.height <= 0) return nullptr;
+                return std::make_shared<const TextureData>(
+                    TextureData{tex_path, hdr, {}, false, false, {}, false, {}, false, {}, std::move(mips)});
+            }
+        }
+        auto [img, hdr] = armatools::paa::decode(in);
+        if (img.width > 0 && img.height > 0)
+            return std::make_shared<const TextureData>(TextureData{tex_path, hdr, img, false, false, {}, false, {}, false, {}, {}});
+    } catch (...) {}
+    return nullptr;
+}
+
+} // namespace texture_data
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "textures_loader.h"
+
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <string>
+
+namespace texture_data {
+
+// Cache costs are the decoded pixel bytes plus a small fixed overhead, so
+// failed lookups still count toward the budget.
+inline constexpr size_t cache_entry_overhead = 256;
+
+// Bytes a texture is charged in the texture cache: RGBA pixels when
+// expanded, the stored mip bytes when kept compressed.
+size_t cost(const TexturesLoaderService::TextureData* tex);
+
+// Bytes a layered terrain material is charged in the layered cache.
+size_t layered_cost(const TexturesLoaderService::TerrainLayeredMaterial* mat);
+
+// Reads a PAA/PAC stream. With keep_compressed, DXT1/3/5 textures keep
+// their stored mip chain in mips and leave image empty; other formats are
+// always expanded to RGBA. Returns nullptr if the stream does not decode.
+std::shared_ptr<const TexturesLoaderService::TextureData> decode(std::istream& in,
+                                                                 const std::string& tex_path,
+                                                                 bool keep_compressed);
+
+} // namespace texture_data
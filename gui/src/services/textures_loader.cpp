@@ -3,17 +3,20 @@
 #include <armatools/armapath.h>
 #include <armatools/config.h>
 #include <armatools/rvmat.h>
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <limits>
 #include <regex>
 #include <sstream>
+#include <thread>
 
 #include "pbo_util.h"
 #include "config.h"
 #include "cli_logger.h"
 #include "log_panel.h"
 #include "procedural_texture.h"
+#include "texture_data.h"
 
 namespace {
 
@@ -24,6 +27,12 @@ std::string normalize_asset_path(std::string p) {
     return p;
 }
 
+// Textures kept compressed are cached apart from their RGBA form.
+std::string texture_cache_key(std::string normalized, bool keep_compressed) {
+    if (keep_compressed) normalized += "|dxt";
+    return normalized;
+}
+
 std::string join_cache_key(const std::vector<std::string>& values) {
     std::string key;
     key.reserve(values.size() * 32);
@@ -35,22 +44,128 @@ std::string join_cache_key(const std::vector<std::string>& values) {
     return key;
 }
 
+using TextureData = TexturesLoaderService::TextureData;
+
+std::shared_ptr<const TextureData> procedural_texture_data(const std::string& tex_path) {
+    auto img = procedural_texture::generate(tex_path);
+    if (!img) return nullptr;
+    armatools::paa::Header hdr;
+    hdr.width = img->width;
+    hdr.height = img->height;
+    return std::make_shared<const TextureData>(TextureData{tex_path, hdr, *img, false, false, {}, false, {}, false, {}, {}});
+}
+
+TexturesLoaderService::TextureFuture ready_future(std::shared_ptr<const TextureData> tex) {
+    return load_pool::ready(std::move(tex));
+}
 
+// Loader workers: one per core but one, within [2, 6].
+unsigned loader_worker_count() {
+    const unsigned hc = std::thread::hardware_concurrency();
+    return std::clamp(hc > 1 ? hc - 1 : 2u, 2u, 6u);
+}
 
 } // namespace
 
 TexturesLoaderService::TexturesLoaderService(const std::string& db_path_in,
                                      Config* cfg_in,
                                      const std::shared_ptr<armatools::pboindex::DB>& db_in,
-                                     const std::shared_ptr<armatools::pboindex::Index>& index_in) {
+                                     const std::shared_ptr<armatools::pboindex::Index>& index_in)
+    : jobs_(loader_worker_count()) {
     db_path = db_path_in;
     cfg = cfg_in;
     db = db_in;
     index = index_in;
 }
 
+TexturesLoaderService::~TexturesLoaderService() = default;
+
+bool TexturesLoaderService::cache_find(const std::string& key,
+                                       std::shared_ptr<const TextureData>& out) {
+    std::lock_guard<std::mutex> lock(texture_cache_mutex_);
+    return texture_cache_.find(key, out);
+}
+
+std::shared_ptr<const TexturesLoaderService::TextureData>
+TexturesLoaderService::cache_store(const std::string& key, std::shared_ptr<const TextureData> tex) {
+    const size_t cost = key.size() + texture_data::cost(tex.get());
+    std::lock_guard<std::mutex> lock(texture_cache_mutex_);
+    texture_cache_.put(key, tex, cost);
+    return tex;
+}
+
+TexturesLoaderService::TextureFuture
+TexturesLoaderService::submit(const std::string& key, Priority priority,
+                              std::function<std::shared_ptr<const TextureData>()> load) {
+    {
+        std::shared_ptr<const TextureData> cached;
+        if (cache_find(key, cached)) return ready_future(std::move(cached));
+    }
+
+    return jobs_.submit(key, priority, [key, load = std::move(load)]() -> std::shared_ptr<const TextureData> {
+        try {
+            return load();
+        } catch (const std::exception& e) {
+            LOGW("LodTextures: async load failed for '" + key + "': " + e.what());
+        } catch (...) {
+            LOGW("LodTextures: async load failed for '" + key + "'");
+        }
+        return nullptr;
+    });
+}
+
+TexturesLoaderService::TextureFuture
+TexturesLoaderService::load_texture_async(const std::string& texture_path, Priority priority,
+                                          bool keep_compressed) {
+    if (texture_path.empty()) return ready_future(nullptr);
+    if (armatools::armapath::is_procedural_texture(texture_path))
+        return ready_future(procedural_texture_data(texture_path));
+    auto normalized = normalize_asset_path(texture_path);
+    if (normalized.empty()) return ready_future(nullptr);
+    return submit(texture_cache_key(std::move(normalized), keep_compressed), priority,
+                  [this, texture_path, keep_compressed]() {
+        return load_single_texture(texture_path, "", keep_compressed);
+    });
+}
+
+std::vector<TexturesLoaderService::TextureFuture>
+TexturesLoaderService::load_textures_async(const armatools::p3d::LOD& lod,
+                                           const std::string& model_path,
+                                           Priority priority,
+                                           bool keep_compressed) {
+    std::vector<TextureFuture> result;
+    std::unordered_set<std::string> seen;
+    result.reserve(lod.textures.size() + lod.materials.size());
+
+    for (const auto& tex_path : lod.textures) {
+        if (tex_path.empty()) continue;
+        if (armatools::armapath::is_procedural_texture(tex_path)) {
+            if (seen.insert(tex_path).second)
+                result.push_back(ready_future(procedural_texture_data(tex_path)));
+            continue;
+        }
+        auto normalized = normalize_asset_path(tex_path);
+        if (normalized.empty() || !seen.insert(normalized).second) continue;
+        result.push_back(submit(texture_cache_key(std::move(normalized), keep_compressed), priority,
+                                [this, tex_path, model_path, keep_compressed]() {
+            return load_single_texture(tex_path, model_path, keep_compressed);
+        }));
+    }
+
+    for (const auto& mat_path : lod.materials) {
+        auto key = normalize_asset_path(mat_path);
+        if (key.empty() || !seen.insert(key).second) continue;
+        result.push_back(submit(key, priority, [this, mat_path, model_path]() {
+            return load_single_material(mat_path, model_path);
+        }));
+    }
+
+    return result;
+}
+
 std::vector<std::shared_ptr<const TexturesLoaderService::TextureData>> 
-TexturesLoaderService::load_textures(armatools::p3d::LOD& lod, const std::string& model_path) {
+TexturesLoaderService::load_textures(armatools::p3d::LOD& lod, const std::string& model_path,
+                                     bool keep_compressed) {
     std::vector<std::shared_ptr<const TextureData>> result;
     LOGD(            "LodTextures: load_textures model=" + model_path
             + " lod_textures=" + std::to_string(lod.textures.size())
@@ -68,15 +183,10 @@ TexturesLoaderService::load_textures(armatools::p3d::LOD& lod, const std::string
     for (const auto& tex_path : lod.textures) {
         if (tex_path.empty()) continue;
         if (armatools::armapath::is_procedural_texture(tex_path)) {
-            if (auto img = procedural_texture::generate(tex_path)) {
-                armatools::paa::Header hdr;
-                hdr.width = img->width;
-                hdr.height = img->height;
-                add_if_loaded(std::make_shared<const TextureData>(TextureData{tex_path, hdr, *img, false, false, {}, false, {}, false, {}}));
-            }
+            add_if_loaded(procedural_texture_data(tex_path));
             continue;
         }
-        add_if_loaded(load_single_texture(tex_path, model_path));
+        add_if_loaded(load_single_texture(tex_path, model_path, keep_compressed));
     }
 
     for (const auto& mat_path : lod.materials) {
@@ -92,56 +202,29 @@ TexturesLoaderService::load_textures(armatools::p3d::LOD& lod, const std::string
 
 std::shared_ptr<const TexturesLoaderService::TextureData> 
 TexturesLoaderService::load_single_texture(const std::string& tex_path, 
-                                            const std::string& model_path) 
+                                            const std::string& model_path,
+                                            bool keep_compressed)
                                             {
     auto normalized = armatools::armapath::to_slash_lower(tex_path);
     while (!normalized.empty() && (normalized.front() == '/' || normalized.front() == '\\'))
         normalized.erase(normalized.begin());
+    const auto key = texture_cache_key(normalized, keep_compressed);
 
     {
-        std::lock_guard<std::mutex> lock(texture_cache_mutex_);
-        auto it = texture_cache_.find(normalized);
-        if (it != texture_cache_.end()) {
-            it->second.last_used = texture_cache_tick_++;
-            if (it->second.has_value) return it->second.value;
-            return nullptr;
-        }
+        std::shared_ptr<const TextureData> cached;
+        if (cache_find(key, cached)) return cached;
     }
 
     auto cache_result = [&](std::shared_ptr<const TextureData> tex) {
-        std::lock_guard<std::mutex> lock(texture_cache_mutex_);
-        TextureCacheItem item;
-        item.has_value = (tex != nullptr);
-        item.value = tex;
-        item.last_used = texture_cache_tick_++;
-        texture_cache_[normalized] = std::move(item);
-
-        while (texture_cache_.size() > texture_cache_capacity_) {
-            auto victim = texture_cache_.end();
-            uint64_t oldest = std::numeric_limits<uint64_t>::max();
-            for (auto it = texture_cache_.begin(); it != texture_cache_.end(); ++it) {
-                if (it->second.last_used < oldest) {
-                    oldest = it->second.last_used;
-                    victim = it;
-                }
-            }
-            if (victim == texture_cache_.end()) break;
-            texture_cache_.erase(victim);
-        }
-        return tex;
+        return cache_store(key, std::move(tex));
     };
 
     auto try_decode_data = [&](const std::vector<uint8_t>& data)
         -> std::shared_ptr<const TextureData> {
         if (data.empty()) return nullptr;
-        try {
-            std::string str(data.begin(), data.end());
-            std::istringstream stream(str);
-            auto [img, hdr] = armatools::paa::decode(stream);
-            if (img.width > 0 && img.height > 0)
-                return std::make_shared<const TextureData>(TextureData{tex_path, hdr, img, false, false, {}, false, {}, false, {}});
-        } catch (...) {}
-        return nullptr;
+        std::string str(data.begin(), data.end());
+        std::istringstream stream(str);
+        return texture_data::decode(stream, tex_path, keep_compressed);
     };
 
     auto try_decode_file = [&](const std::filesystem::path& path)
@@ -150,12 +233,7 @@ TexturesLoaderService::load_single_texture(const std::string& tex_path,
         if (!std::filesystem::exists(path, ec)) return nullptr;
         std::ifstream f(path, std::ios::binary);
         if (!f.is_open()) return nullptr;
-        try {
-            auto [img, hdr] = armatools::paa::decode(f);
-            if (img.width > 0 && img.height > 0)
-                return std::make_shared<const TextureData>(TextureData{tex_path, hdr, img, false, false, {}, false, {}, false, {}});
-        } catch (...) {}
-        return nullptr;
+        return texture_data::decode(f, tex_path, keep_compressed);
     };
 
     // 1) Resolve via index first
@@ -211,36 +289,12 @@ TexturesLoaderService::load_single_material(const std::string& material_path,
     if (mat_norm.empty()) return nullptr;
 
     {
-        std::lock_guard<std::mutex> lock(texture_cache_mutex_);
-        auto it = texture_cache_.find(mat_norm);
-        if (it != texture_cache_.end()) {
-            it->second.last_used = texture_cache_tick_++;
-            if (it->second.has_value) return it->second.value;
-            return nullptr;
-        }
+        std::shared_ptr<const TextureData> cached;
+        if (cache_find(mat_norm, cached)) return cached;
     }
 
     auto cache_result = [&](std::shared_ptr<const TextureData> tex) {
-        std::lock_guard<std::mutex> lock(texture_cache_mutex_);
-        TextureCacheItem item;
-        item.has_value = (tex != nullptr);
-        item.value = tex;
-        item.last_used = texture_cache_tick_++;
-        texture_cache_[mat_norm] = std::move(item);
-
-        while (texture_cache_.size() > texture_cache_capacity_) {
-            auto victim = texture_cache_.end();
-            uint64_t oldest = std::numeric_limits<uint64_t>::max();
-            for (auto it = texture_cache_.begin(); it != texture_cache_.end(); ++it) {
-                if (it->second.last_used < oldest) {
-                    oldest = it->second.last_used;
-                    victim = it;
-                }
-            }
-            if (victim == texture_cache_.end()) break;
-            texture_cache_.erase(victim);
-        }
-        return tex;
+        return cache_store(mat_norm, std::move(tex));
     };
 
     LOGD(            "LodTextures: material begin raw='" + material_path
@@ -355,7 +409,7 @@ TexturesLoaderService::load_single_material(const std::string& material_path,
             std::istringstream stream(str);
             auto [img, hdr] = armatools::paa::decode(stream);
             if (img.width > 0 && img.height > 0)
-                return std::make_shared<TextureData>(TextureData{key, hdr, img, false, false, {}, false, {}, false, {}});
+                return std::make_shared<TextureData>(TextureData{key, hdr, img, false, false, {}, false, {}, false, {}, {}});
         } catch (...) {}
         return nullptr;
     };
@@ -596,9 +650,9 @@ TexturesLoaderService::load_single_material(const std::string& material_path,
 }
 
 std::shared_ptr<const TexturesLoaderService::TextureData>
-TexturesLoaderService::load_texture(const std::string& texture_path) {
+TexturesLoaderService::load_texture(const std::string& texture_path, bool keep_compressed) {
     if (texture_path.empty()) return nullptr;
-    return load_single_texture(texture_path, "");
+    return load_single_texture(texture_path, "", keep_compressed);
 }
 
 std::shared_ptr<const TexturesLoaderService::TerrainLayeredMaterial>
@@ -618,11 +672,8 @@ TexturesLoaderService::load_terrain_layered_material(const std::vector<std::stri
 
     {
         std::lock_guard<std::mutex> lock(terrain_layered_cache_mutex_);
-        auto it = terrain_layered_cache_.find(cache_key);
-        if (it != terrain_layered_cache_.end()) {
-            it->second.last_used = terrain_layered_cache_tick_++;
-            return it->second.value;
-        }
+        std::shared_ptr<const TerrainLayeredMaterial> cached;
+        if (terrain_layered_cache_.find(cache_key, cached)) return cached;
     }
 
     auto resolve_relative = [](const std::string& base, const std::string& rel) {
@@ -803,23 +854,8 @@ TexturesLoaderService::load_terrain_layered_material(const std::vector<std::stri
 
     {
         std::lock_guard<std::mutex> lock(terrain_layered_cache_mutex_);
-        TerrainLayeredCacheItem item;
-        item.value = resolved;
-        item.last_used = terrain_layered_cache_tick_++;
-        terrain_layered_cache_[cache_key] = std::move(item);
-
-        while (terrain_layered_cache_.size() > terrain_layered_cache_capacity_) {
-            auto victim = terrain_layered_cache_.end();
-            uint64_t oldest = std::numeric_limits<uint64_t>::max();
-            for (auto it = terrain_layered_cache_.begin(); it != terrain_layered_cache_.end(); ++it) {
-                if (it->second.last_used < oldest) {
-                    oldest = it->second.last_used;
-                    victim = it;
-                }
-            }
-            if (victim == terrain_layered_cache_.end()) break;
-            terrain_layered_cache_.erase(victim);
-        }
+        terrain_layered_cache_.put(cache_key, resolved,
+                                   cache_key.size() + texture_data::layered_cost(resolved.get()));
     }
 
     return resolved;
@@ -832,13 +868,8 @@ TexturesLoaderService::load_terrain_texture_entry(const std::string& entry_path)
     if (normalized.empty()) return nullptr;
 
     {
-        std::lock_guard<std::mutex> lock(texture_cache_mutex_);
-        auto it = texture_cache_.find(normalized);
-        if (it != texture_cache_.end()) {
-            it->second.last_used = texture_cache_tick_++;
-            if (it->second.has_value) return it->second.value;
-            return nullptr;
-        }
+        std::shared_ptr<const TextureData> cached;
+        if (cache_find(normalized, cached)) return cached;
     }
 
     const auto ext = std::filesystem::path(normalized).extension().string();
@@ -856,27 +887,5 @@ TexturesLoaderService::load_terrain_texture_entry(const std::string& entry_path)
         }
     }
 
-    {
-        std::lock_guard<std::mutex> lock(texture_cache_mutex_);
-        TextureCacheItem item;
-        item.has_value = (resolved != nullptr);
-        item.value = resolved;
-        item.last_used = texture_cache_tick_++;
-        texture_cache_[normalized] = std::move(item);
-
-        while (texture_cache_.size() > texture_cache_capacity_) {
-            auto victim = texture_cache_.end();
-            uint64_t oldest = std::numeric_limits<uint64_t>::max();
-            for (auto it = texture_cache_.begin(); it != texture_cache_.end(); ++it) {
-                if (it->second.last_used < oldest) {
-                    oldest = it->second.last_used;
-                    victim = it;
-                }
-            }
-            if (victim == texture_cache_.end()) break;
-            texture_cache_.erase(victim);
-        }
-    }
-
-    return resolved;
+    return cache_store(normalized, std::move(resolved));
 }
@@ -5,6 +5,9 @@
 #include <armatools/paa.h>
 #include <armatools/rvmat.h>
 
+#include "load_pool.h"
+
+#include <array>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
@@ -63,46 +66,85 @@ public:
         armatools::paa::Image normal_map;
         bool has_specular_map = false;
         armatools::paa::Image specular_map;
+        // DXT mip chain as stored, set instead of image when the texture
+        // was requested with keep_compressed.
+        std::vector<armatools::paa::Mip> mips;
     };
 
-    std::vector<std::shared_ptr<const TextureData>> load_textures(armatools::p3d::LOD& lod, const std::string& model_path);
-    std::shared_ptr<const TextureData> load_texture(const std::string& texture_path);
+    using Priority = load_pool::Priority;
+    using TextureFuture = load_pool::Pool<std::shared_ptr<const TextureData>>::Future;
+
+    // Synchronous loads decode on the calling thread; use them from worker
+    // threads only.
+    //
+    // With keep_compressed, DXT1/DXT3/DXT5 PAAs keep their mip chain in
+    // TextureData::mips instead of being expanded to RGBA; callers ask for
+    // it when their GL context reports S3TC. The two forms are cached
+    // separately. Other formats and material stage textures are always
+    // expanded, so consumers must still accept both forms. Terrain entries
+    // are always expanded.
+    std::vector<std::shared_ptr<const TextureData>> load_textures(armatools::p3d::LOD& lod, const std::string& model_path,
+                                                                  bool keep_compressed = false);
+    std::shared_ptr<const TextureData> load_texture(const std::string& texture_path, bool keep_compressed = false);
     std::shared_ptr<const TextureData> load_terrain_texture_entry(const std::string& entry_path);
     std::shared_ptr<const TerrainLayeredMaterial> load_terrain_layered_material(
         const std::vector<std::string>& entry_paths);
 
+    // load_texture_async queues a texture decode on the loader pool and
+    // returns at once. Requests for a path that is already queued or
+    // decoding share one future; a higher priority promotes the queued job.
+    // Cached textures come back as ready futures. The result is nullptr
+    // when the texture cannot be resolved. Visible is for what is on screen,
+    // Prefetch for what the user is likely to open next (asset browser
+    // neighbours), Background for bulk loads such as terrain objects.
+    TextureFuture load_texture_async(const std::string& texture_path,
+                                     Priority priority = Priority::Visible,
+                                     bool keep_compressed = false);
+
+    // load_textures_async queues every texture and material of lod and
+    // returns one future per distinct entry, in LOD order. Poll them with
+    // wait_for(0) from the UI thread.
+    std::vector<TextureFuture> load_textures_async(const armatools::p3d::LOD& lod,
+                                                   const std::string& model_path,
+                                                   Priority priority = Priority::Visible,
+                                                   bool keep_compressed = false);
+
     TexturesLoaderService(const std::string& db_path_in,
                     Config* cfg_in,
                     const std::shared_ptr<armatools::pboindex::DB>& db_in,
                     const std::shared_ptr<armatools::pboindex::Index>& index_in);
+    ~TexturesLoaderService();
 
-private:
-    struct TextureCacheItem {
-        bool has_value = false;
-        std::shared_ptr<const TextureData> value;
-        uint64_t last_used = 0;
-    };
+    TexturesLoaderService(const TexturesLoaderService&) = delete;
+    TexturesLoaderService& operator=(const TexturesLoaderService&) = delete;
 
+private:
     std::string db_path;
     Config* cfg = nullptr;
     std::shared_ptr<armatools::pboindex::DB> db;
     std::shared_ptr<armatools::pboindex::Index> index;
+
+    // Decoded textures by normalized path; failures are cached too, at a
+    // nominal cost, so unresolved paths are not searched again.
     std::mutex texture_cache_mutex_;
-    std::unordered_map<std::string, TextureCacheItem> texture_cache_;
-    uint64_t texture_cache_tick_ = 1;
-    size_t texture_cache_capacity_ = 1024;
-    struct TerrainLayeredCacheItem {
-        std::shared_ptr<const TerrainLayeredMaterial> value;
-        uint64_t last_used = 0;
-    };
+    load_pool::LruCache<std::shared_ptr<const TextureData>> texture_cache_{size_t(768) << 20};
 
     std::mutex terrain_layered_cache_mutex_;
-    std::unordered_map<std::string, TerrainLayeredCacheItem> terrain_layered_cache_;
-    uint64_t terrain_layered_cache_tick_ = 1;
-    size_t terrain_layered_cache_capacity_ = 1024;
+    load_pool::LruCache<std::shared_ptr<const TerrainLayeredMaterial>> terrain_layered_cache_{size_t(256) << 20};
+
+    bool cache_find(const std::string& key, std::shared_ptr<const TextureData>& out);
+    std::shared_ptr<const TextureData> cache_store(const std::string& key,
+                                                   std::shared_ptr<const TextureData> tex);
+    TextureFuture submit(const std::string& key, Priority priority,
+                         std::function<std::shared_ptr<const TextureData>()> load);
 
     std::shared_ptr<const TextureData> load_single_texture(const std::string& tex_path,
-                                                   const std::string& model_path);
+                                                   const std::string& model_path,
+                                                   bool keep_compressed = false);
     std::shared_ptr<const TextureData> load_single_material(const std::string& material_path,
                                                     const std::string& model_path);
+
+    // Async loader pool; declared last so its workers stop before the
+    // caches they fill are destroyed.
+    load_pool::Pool<std::shared_ptr<const TextureData>> jobs_;
 };
@@ -6,8 +6,6 @@
 #include "cli_logger.h"
 #include "pbo_util.h"
 #include "cli_logger.h"
-#include "procedural_texture.h"
-#include "cli_logger.h"
 
 #include <armatools/config.h>
 #include "cli_logger.h"
@@ -17,8 +15,6 @@
 #include "cli_logger.h"
 #include <armatools/p3d.h>
 #include "cli_logger.h"
-#include <armatools/paa.h>
-#include "cli_logger.h"
 #include <armatools/rvmat.h>
 #include "cli_logger.h"
 #include <armatools/wss.h>
@@ -456,6 +452,7 @@ TabAssetBrowser::~TabAssetBrowser() {
     if (pbo_index_service_) pbo_index_service_->unsubscribe(this);
     if (scroll_value_conn_.connected()) scroll_value_conn_.disconnect();
     audio_stop_all();
+    cancel_preview_loads();
     ++nav_generation_; // cancel any pending navigate
     if (nav_thread_.joinable()) {
         nav_thread_.request_stop();
@@ -475,6 +472,7 @@ void TabAssetBrowser::set_model_loader_service(
 
 void TabAssetBrowser::set_texture_loader_service(
     const std::shared_ptr<TexturesLoaderService>& service) {
+    texture_loader_ = service;
     model_panel_.set_texture_loader_service(service);
 }
 
@@ -1078,6 +1076,7 @@ void TabAssetBrowser::show_file_info(const armatools::pboindex::FindResult& file
     rvmat_paned_.set_visible(false);
     rvmat_text_parsed_cache_.clear();
     rvmat_text_source_cache_.clear();
+    cancel_preview_loads();
     model_panel_.set_visible(false);
     audio_panel_.set_visible(false);
     audio_stop_all();
@@ -1110,6 +1109,16 @@ static std::vector<uint8_t> extract_from_pbo_file(
     return extract_from_pbo(file.pbo_path, file.file_path);
 }
 
+static bool is_texture_file(const std::string& file_path) {
+    auto ext = fs::path(file_path).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".paa" || ext == ".pac";
+}
+
+static bool texture_ready(const TexturesLoaderService::TextureFuture& future) {
+    return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
 void TabAssetBrowser::preview_p3d(const armatools::pboindex::FindResult& file) {
     model_panel_.load_p3d(file.prefix + "/" + file.file_path);
     model_panel_.set_visible(true);
@@ -1117,40 +1126,110 @@ void TabAssetBrowser::preview_p3d(const armatools::pboindex::FindResult& file) {
 }
 
 void TabAssetBrowser::preview_paa(const armatools::pboindex::FindResult& file) {
-    try {
-        auto data = extract_from_pbo_file(file);
-        if (data.empty()) {
-            info_view_.get_buffer()->set_text("Could not extract file from PBO.");
-            return;
-        }
+    if (!texture_loader_) {
+        info_view_.get_buffer()->set_text("Texture loader not available.");
+        return;
+    }
+    // Decoded on the loader pool; on_preview_poll shows it when ready.
+    info_view_.get_buffer()->set_text("Loading texture...");
+    pending_paa_ = PendingPaa{file, texture_loader_->load_texture_async(
+                                        file.prefix + "/" + file.file_path)};
+    start_preview_poll();
+    prefetch_neighbour_textures();
+}
 
-        std::string str(data.begin(), data.end());
-        std::istringstream stream(str);
-        auto [img, hdr] = armatools::paa::decode(stream);
+void TabAssetBrowser::prefetch_neighbour_textures() {
+    auto* row = dir_list_.get_selected_row();
+    if (!row || !texture_loader_) return;
+    // Arrow-key browsing usually moves one row at a time.
+    const int idx = row->get_index();
+    for (int n : {idx + 1, idx - 1, idx + 2}) {
+        armatools::pboindex::FindResult file;
+        if (!get_file_at_row(n, file) || !is_texture_file(file.file_path)) continue;
+        texture_loader_->load_texture_async(file.prefix + "/" + file.file_path,
+                                            TexturesLoaderService::Priority::Prefetch);
+    }
+}
 
-        std::ostringstream info;
-        info << file.file_path
-             << " | " << file.data_size << " bytes"
-             << " | " << hdr.format
-             << " | " << hdr.width << "x" << hdr.height;
-        file_info_label_.set_text(info.str());
-        info_scroll_.set_visible(false);
+void TabAssetBrowser::start_preview_poll() {
+    if (on_preview_poll() && !preview_poll_conn_.connected()) {
+        preview_poll_conn_ = Glib::signal_timeout().connect(
+            sigc::mem_fun(*this, &TabAssetBrowser::on_preview_poll), 16);
+    }
+}
 
-        // Show image preview
-        auto pixbuf = Gdk::Pixbuf::create_from_data(
-            img.pixels.data(),
-            Gdk::Colorspace::RGB,
-            true, 8,
-            img.width, img.height,
-            img.width * 4);
-        auto copy = pixbuf->copy();
-        auto texture = Gdk::Texture::create_for_pixbuf(copy);
-        preview_picture_.set_paintable(texture);
-        preview_scroll_.set_visible(true);
-        preview_scroll_.set_size_request(-1, 380);
-    } catch (const std::exception& e) {
-        info_view_.get_buffer()->set_text(std::string("PAA error: ") + e.what());
+bool TabAssetBrowser::on_preview_poll() {
+    if (pending_paa_ && texture_ready(pending_paa_->future)) {
+        auto tex = pending_paa_->future.get();
+        auto file = std::move(pending_paa_->file);
+        pending_paa_.reset();
+        if (!tex || tex->image.width <= 0 || tex->image.height <= 0) {
+            info_view_.get_buffer()->set_text("Could not load texture from PBO.");
+        } else {
+            std::ostringstream info;
+            info << file.file_path
+                 << " | " << file.data_size << " bytes"
+                 << " | " << tex->header.format
+                 << " | " << tex->header.width << "x" << tex->header.height;
+            file_info_label_.set_text(info.str());
+            info_scroll_.set_visible(false);
+
+            // Show image preview; the copy owns its pixels, so the cached
+            // texture may be evicted.
+            const auto& img = tex->image;
+            auto pixbuf = Gdk::Pixbuf::create_from_data(
+                img.pixels.data(),
+                Gdk::Colorspace::RGB,
+                true, 8,
+                img.width, img.height,
+                img.width * 4);
+            auto copy = pixbuf->copy();
+            auto texture = Gdk::Texture::create_for_pixbuf(copy);
+            preview_picture_.set_paintable(texture);
+            preview_scroll_.set_visible(true);
+            preview_scroll_.set_size_request(-1, 380);
+        }
     }
+
+    bool rvmat_changed = false;
+    bool rvmat_pending = false;
+    for (auto& st : rvmat_stage_loads_) {
+        if (st.candidates.empty()) continue;
+        // Candidates are tried in order, so a later one is only used once
+        // every earlier one has come back empty.
+        while (!st.candidates.empty() && texture_ready(st.candidates.front())) {
+            auto tex = st.candidates.front().get();
+            st.candidates.erase(st.candidates.begin());
+            if (tex && tex->image.width > 0 && tex->image.height > 0) {
+                (rvmat_preview_.*st.apply)(tex->image.width, tex->image.height,
+                                           tex->image.pixels.data());
+                st.loaded = true;
+                st.candidates.clear();
+            }
+        }
+        if (st.candidates.empty()) rvmat_changed = true;
+        else rvmat_pending = true;
+    }
+    if (rvmat_changed) {
+        rvmat_text_parsed_cache_ = rvmat_report();
+        if (rvmat_text_parsed_.get_active())
+            rvmat_info_view_.get_buffer()->set_text(rvmat_text_parsed_cache_);
+    }
+
+    if (!pending_paa_ && !rvmat_pending) {
+        preview_poll_conn_.disconnect();
+        return false;
+    }
+    return true;
+}
+
+void TabAssetBrowser::cancel_preview_loads() {
+    // Dropped futures still finish on the pool and land in its cache.
+    preview_poll_conn_.disconnect();
+    pending_paa_.reset();
+    rvmat_stage_loads_.clear();
+    rvmat_report_head_.clear();
+    rvmat_uv_warnings_.clear();
 }
 
 void TabAssetBrowser::preview_audio(const armatools::pboindex::FindResult& file) {
@@ -1345,34 +1424,29 @@ void TabAssetBrowser::preview_rvmat(const armatools::pboindex::FindResult& file)
         rvmat_preview_.set_specular_uv_source(uv_source(stage_spec));
         rvmat_preview_.set_ao_uv_source(uv_source(stage_ao));
 
-        bool diff_loaded = false;
-        bool nrm_loaded = false;
-        bool spec_loaded = false;
-        bool ao_loaded = false;
-        if (stage_diff && !stage_diff->texture_path.empty()) {
-            if (auto tex = load_preview_texture_asset(file, stage_diff->texture_path)) {
-                rvmat_preview_.set_diffuse_texture(tex->width, tex->height, tex->pixels.data());
-                diff_loaded = true;
-            }
-        }
-        if (stage_nrm && !stage_nrm->texture_path.empty()) {
-            if (auto tex = load_preview_texture_asset(file, stage_nrm->texture_path)) {
-                rvmat_preview_.set_normal_texture(tex->width, tex->height, tex->pixels.data());
-                nrm_loaded = true;
-            }
-        }
-        if (stage_spec && !stage_spec->texture_path.empty()) {
-            if (auto tex = load_preview_texture_asset(file, stage_spec->texture_path)) {
-                rvmat_preview_.set_specular_texture(tex->width, tex->height, tex->pixels.data());
-                spec_loaded = true;
-            }
-        }
-        if (stage_ao && !stage_ao->texture_path.empty()) {
-            if (auto tex = load_preview_texture_asset(file, stage_ao->texture_path)) {
-                rvmat_preview_.set_ao_texture(tex->width, tex->height, tex->pixels.data());
-                ao_loaded = true;
+        // Stage textures decode on the loader pool; on_preview_poll applies
+        // them and refreshes the resolved-stage report.
+        using Widget = render_domain::RvmatPreviewWidget;
+        auto add_stage_load = [&](const char* name, const armatools::rvmat::TextureStage* st,
+                                  void (Widget::*apply)(int, int, const uint8_t*)) {
+            RvmatStageLoad load;
+            load.name = name;
+            load.apply = apply;
+            if (st) {
+                load.present = true;
+                load.stage_number = st->stage_number;
+                load.texture_path = st->texture_path;
+                if (texture_loader_ && !st->texture_path.empty()) {
+                    for (const auto& key : preview_texture_keys(file, st->texture_path))
+                        load.candidates.push_back(texture_loader_->load_texture_async(key));
+                }
             }
-        }
+            rvmat_stage_loads_.push_back(std::move(load));
+        };
+        add_stage_load("Diffuse", stage_diff, &Widget::set_diffuse_texture);
+        add_stage_load("Normal", stage_nrm, &Widget::set_normal_texture);
+        add_stage_load("SMDI", stage_spec, &Widget::set_specular_texture);
+        add_stage_load("AO/AS", stage_ao, &Widget::set_ao_texture);
 
         auto fmt_rgba = [](const std::array<float, 4>& c) {
             std::ostringstream s;
@@ -1394,20 +1468,10 @@ void TabAssetBrowser::preview_rvmat(const armatools::pboindex::FindResult& file)
             return l == "tex" || l == "tex1";
         };
 
-        std::vector<std::string> warnings;
-        if (!stage_diff) warnings.emplace_back("Diffuse stage not resolved.");
-        if (stage_diff && !diff_loaded)
-            warnings.emplace_back("Diffuse missing: " + stage_diff->texture_path);
-        if (stage_nrm && !nrm_loaded)
-            warnings.emplace_back("Normal missing: " + stage_nrm->texture_path);
-        if (stage_spec && !spec_loaded)
-            warnings.emplace_back("SMDI missing: " + stage_spec->texture_path);
-        if (stage_ao && !ao_loaded)
-            warnings.emplace_back("AO/AS missing: " + stage_ao->texture_path);
         for (const auto* st : {stage_diff, stage_nrm, stage_spec, stage_ao}) {
             if (st && !uv_source_supported(st->uv_source)) {
-                warnings.emplace_back("uvSource unsupported: " + st->uv_source
-                                      + " (using tex)");
+                rvmat_uv_warnings_.emplace_back("uvSource unsupported: " + st->uv_source
+                                                + " (using tex)");
             }
         }
 
@@ -1441,30 +1505,8 @@ void TabAssetBrowser::preview_rvmat(const armatools::pboindex::FindResult& file)
             }
         }
 
-        out << "Resolved stages:\n";
-        auto print_stage = [&](const char* name, const armatools::rvmat::TextureStage* st,
-                               bool loaded) {
-            out << "  " << name << ": ";
-            if (!st) {
-                out << "-\n";
-                return;
-            }
-            out << "Stage" << st->stage_number << " "
-                << (st->texture_path.empty() ? "-" : st->texture_path);
-            if (!loaded && !st->texture_path.empty()) out << " (missing)";
-            out << "\n";
-        };
-        print_stage("Diffuse", stage_diff, diff_loaded);
-        print_stage("Normal", stage_nrm, nrm_loaded);
-        print_stage("SMDI", stage_spec, spec_loaded);
-        print_stage("AO/AS", stage_ao, ao_loaded);
-
-        if (!warnings.empty()) {
-            out << "Warnings:\n";
-            for (const auto& w : warnings) out << "  " << w << "\n";
-        }
-
-        rvmat_text_parsed_cache_ = out.str();
+        rvmat_report_head_ = out.str();
+        rvmat_text_parsed_cache_ = rvmat_report();
         if (is_rap) {
             std::ostringstream derap;
             armatools::config::write_text(derap, cfg);
@@ -1479,11 +1521,43 @@ void TabAssetBrowser::preview_rvmat(const armatools::pboindex::FindResult& file)
         rvmat_info_view_.get_buffer()->set_text(rvmat_text_parsed_cache_);
         info_scroll_.set_visible(false);
         rvmat_paned_.set_visible(true);
+        start_preview_poll();
     } catch (const std::exception& e) {
         info_view_.get_buffer()->set_text(std::string("RVMAT error: ") + e.what());
     }
 }
 
+std::string TabAssetBrowser::rvmat_report() const {
+    std::ostringstream out;
+    out << rvmat_report_head_ << "Resolved stages:\n";
+    std::vector<std::string> warnings;
+    for (const auto& st : rvmat_stage_loads_) {
+        out << "  " << st.name << ": ";
+        if (!st.present) {
+            out << "-\n";
+            continue;
+        }
+        out << "Stage" << st.stage_number << " "
+            << (st.texture_path.empty() ? "-" : st.texture_path);
+        if (!st.candidates.empty()) {
+            out << " (loading)";
+        } else if (!st.loaded) {
+            if (!st.texture_path.empty()) out << " (missing)";
+            warnings.push_back(std::string(st.name) + " missing: " + st.texture_path);
+        }
+        out << "\n";
+    }
+    if (!rvmat_stage_loads_.empty() && !rvmat_stage_loads_.front().present)
+        warnings.insert(warnings.begin(), "Diffuse stage not resolved.");
+    warnings.insert(warnings.end(), rvmat_uv_warnings_.begin(), rvmat_uv_warnings_.end());
+
+    if (!warnings.empty()) {
+        out << "Warnings:\n";
+        for (const auto& w : warnings) out << "  " << w << "\n";
+    }
+    return out.str();
+}
+
 void TabAssetBrowser::preview_jpg(const armatools::pboindex::FindResult& file) {
     try {
         auto data = extract_from_pbo_file(file);
@@ -1544,12 +1618,13 @@ void TabAssetBrowser::preview_text(const armatools::pboindex::FindResult& file)
 // Helper: get the currently selected file from the list
 // ---------------------------------------------------------------------------
 bool TabAssetBrowser::get_selected_file(armatools::pboindex::FindResult& out) {
-    if (!db_) return false;
-
     auto* row = dir_list_.get_selected_row();
     if (!row) return false;
+    return get_file_at_row(row->get_index(), out);
+}
 
-    int idx = row->get_index();
+bool TabAssetBrowser::get_file_at_row(int idx, armatools::pboindex::FindResult& out) {
+    if (!db_) return false;
 
     auto bc = std::string(breadcrumb_label_.get_text());
     if (bc.starts_with("Search results:")) {
@@ -1567,56 +1642,19 @@ bool TabAssetBrowser::get_selected_file(armatools::pboindex::FindResult& out) {
     }
 }
 
-std::optional<TabAssetBrowser::DecodedTexture> TabAssetBrowser::load_preview_texture_asset(
+// preview_texture_keys lists the asset paths an RVMAT stage texture may
+// resolve to, in lookup order: paths outside the game roots are relative to
+// the material, and extensionless ones may be .paa or .pac.
+std::vector<std::string> TabAssetBrowser::preview_texture_keys(
     const armatools::pboindex::FindResult& context_file,
-    const std::string& texture_path) {
-    if (armatools::armapath::is_procedural_texture(texture_path)) {
-        if (auto img = procedural_texture::generate(texture_path)) {
-            return DecodedTexture{img->width, img->height, img->pixels};
-        }
-        return std::nullopt;
-    }
+    const std::string& texture_path) const {
+    if (armatools::armapath::is_procedural_texture(texture_path)) return {texture_path};
     auto normalize = [](std::string p) {
         p = armatools::armapath::to_slash_lower(p);
         while (!p.empty() && (p.front() == '/' || p.front() == '\\'))
             p.erase(p.begin());
         return p;
     };
-    auto decode = [](const std::vector<uint8_t>& bytes) -> std::optional<DecodedTexture> {
-        if (bytes.empty()) return std::nullopt;
-        try {
-            std::string str(bytes.begin(), bytes.end());
-            std::istringstream stream(str);
-            auto [img, _hdr] = armatools::paa::decode(stream);
-            if (img.width <= 0 || img.height <= 0) return std::nullopt;
-            return DecodedTexture{img.width, img.height, img.pixels};
-        } catch (...) {
-            return std::nullopt;
-        }
-    };
-
-    auto try_extract = [&](const std::string& key) -> std::optional<DecodedTexture> {
-        if (key.empty()) return std::nullopt;
-        if (index_) {
-            armatools::pboindex::ResolveResult rr;
-            if (index_->resolve(key, rr)) {
-                if (auto out = decode(extract_from_pbo(rr.pbo_path, rr.entry_name)))
-                    return out;
-            }
-        }
-        if (db_) {
-            auto filename = fs::path(key).filename().string();
-            auto results = db_->find_files("*" + filename);
-            for (const auto& r : results) {
-                auto full = armatools::armapath::to_slash_lower(r.prefix + "/" + r.file_path);
-                if (full == key || full.ends_with("/" + key)) {
-                    if (auto out = decode(extract_from_pbo(r.pbo_path, r.file_path)))
-                        return out;
-                }
-            }
-        }
-        return std::nullopt;
-    };
 
     auto rel = normalize(texture_path);
     auto base = normalize(context_file.prefix + "/" + context_file.file_path);
@@ -1631,10 +1669,7 @@ std::optional<TabAssetBrowser::DecodedTexture> TabAssetBrowser::load_preview_tex
         keys.push_back(candidate + ".paa");
         keys.push_back(candidate + ".pac");
     }
-    for (const auto& k : keys) {
-        if (auto out = try_extract(k)) return out;
-    }
-    return std::nullopt;
+    return keys;
 }
 
 // ---------------------------------------------------------------------------
@@ -1734,6 +1769,7 @@ void TabAssetBrowser::audio_load_from_memory(const uint8_t* data, size_t size,
 
     audio_waveform_envelope_.clear();
     audio_spectrogram_surface_.reset();
+    audio_spectrogram_engine_.reset();
     audio_waveform_area_.queue_draw();
     audio_spectrogram_area_.queue_draw();
 
@@ -1748,9 +1784,7 @@ void TabAssetBrowser::audio_load_from_memory(const uint8_t* data, size_t size,
         std::transform(lower_ext.begin(), lower_ext.end(), lower_ext.begin(), ::tolower);
 
         if (lower_ext == ".ogg") {
-            std::string str(reinterpret_cast<const char*>(data), size);
-            std::istringstream stream(str);
-            auto hdr = armatools::ogg::read_header(stream);
+            auto hdr = armatools::ogg::read_header(std::span<const uint8_t>(data, size));
             info << "Format: OGG Vorbis\n"
                  << "Channels: " << hdr.channels << "\n"
                  << "Sample rate: " << hdr.sample_rate << " Hz\n";
@@ -1759,7 +1793,7 @@ void TabAssetBrowser::audio_load_from_memory(const uint8_t* data, size_t size,
         } else if (lower_ext == ".wss" || lower_ext == ".wav") {
             std::string str(reinterpret_cast<const char*>(data), size);
             std::istringstream stream(str);
-            auto audio = armatools::wss::read(stream);
+            auto audio = armatools::wss::Decoder(stream).info();
             info << "Format: " << audio.format << "\n"
                  << "Channels: " << audio.channels << "\n"
                  << "Sample rate: " << audio.sample_rate << " Hz\n"
@@ -1782,6 +1816,9 @@ void TabAssetBrowser::audio_load_from_memory(const uint8_t* data, size_t size,
         audio_waveform_area_.queue_draw();
 
         // Compute spectrogram in background
+        audio_spectrogram_engine_ =
+            std::make_shared<SpectrogramEngine>(audio_mono_, audio_decoded_.sample_rate);
+        audio_spectrogram_width_ = -1;
         audio_compute_spectrogram_async();
 
         // Enable controls
@@ -1821,17 +1858,27 @@ void TabAssetBrowser::audio_compute_waveform() {
 }
 
 void TabAssetBrowser::audio_compute_spectrogram_async() {
-    if (audio_spectrogram_computing_.load()) return;
+    if (!audio_spectrogram_engine_ || audio_spectrogram_computing_.load()) return;
+    if (audio_spectrogram_thread_.joinable()) audio_spectrogram_thread_.join();
     audio_spectrogram_computing_.store(true);
 
-    auto mono_copy = audio_mono_;
-    auto sample_rate = audio_decoded_.sample_rate;
+    // One column per pixel; the engine reuses columns across resizes.
+    int width = audio_spectrogram_area_.get_width();
+    audio_spectrogram_width_ = width;
+    size_t cols = std::min(static_cast<size_t>(width > 0 ? width : kWaveformCols),
+                           audio_spectrogram_engine_->total_columns());
 
-    audio_spectrogram_thread_ = std::thread([this, mono = std::move(mono_copy), sample_rate]() {
-        auto spec_data = compute_spectrogram(mono.data(), mono.size(), sample_rate);
+    audio_spectrogram_thread_ = std::thread([this, engine = audio_spectrogram_engine_, cols]() {
+        auto spec_data = engine->compute(0, engine->sample_count(), cols);
         auto img = render_spectrogram(spec_data);
 
-        Glib::signal_idle().connect_once([this, img = std::move(img)]() {
+        Glib::signal_idle().connect_once([this, engine, img = std::move(img)]() {
+            if (engine != audio_spectrogram_engine_) {
+                // A different asset was loaded meanwhile; start over for it.
+                audio_spectrogram_computing_.store(false);
+                audio_compute_spectrogram_async();
+                return;
+            }
             if (img.width > 0 && img.height > 0) {
                 auto surface = Cairo::ImageSurface::create(
                     Cairo::Surface::Format::ARGB32, img.width, img.height);
@@ -1935,6 +1982,8 @@ void TabAssetBrowser::audio_draw_spectrogram(const Cairo::RefPtr<Cairo::Context>
         cr->paint();
         cr->restore();
     }
+    if (audio_spectrogram_engine_ && width != audio_spectrogram_width_)
+        audio_compute_spectrogram_async();
 
     // Playback cursor
     if (audio_engine_.has_audio()) {
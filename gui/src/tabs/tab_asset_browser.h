@@ -7,6 +7,7 @@
 #include "pbo_index_service.h"
 #include "render_domain/rvmat_preview_widget.h"
 #include "spectrogram.h"
+#include "textures_loader.h"
 
 #include <armatools/pboindex.h>
 
@@ -75,6 +76,8 @@ private:
     Cairo::RefPtr<Cairo::ImageSurface> audio_spectrogram_surface_;
     std::atomic<bool> audio_spectrogram_computing_{false};
     std::thread audio_spectrogram_thread_;
+    std::shared_ptr<SpectrogramEngine> audio_spectrogram_engine_; // caches columns of the loaded audio
+    int audio_spectrogram_width_ = -1; // area width the surface was computed for
 
     // Left panel
     Gtk::Box left_box_{Gtk::Orientation::VERTICAL, 4};
@@ -125,6 +128,31 @@ private:
     render_domain::RvmatPreviewWidget rvmat_preview_;
     ModelViewPanel model_panel_;
 
+    // --- Async texture previews ---
+    // PAA and RVMAT stage textures decode on the texture loader pool and are
+    // applied by on_preview_poll; show_file_info drops loads for the previous
+    // selection.
+    std::shared_ptr<TexturesLoaderService> texture_loader_;
+    sigc::connection preview_poll_conn_;
+    struct PendingPaa {
+        armatools::pboindex::FindResult file;
+        TexturesLoaderService::TextureFuture future;
+    };
+    std::optional<PendingPaa> pending_paa_;
+    struct RvmatStageLoad {
+        const char* name = "";
+        bool present = false;
+        int stage_number = 0;
+        std::string texture_path;
+        void (render_domain::RvmatPreviewWidget::*apply)(int, int, const uint8_t*) = nullptr;
+        // Candidate keys in lookup order; the first that resolves is used.
+        std::vector<TexturesLoaderService::TextureFuture> candidates;
+        bool loaded = false;
+    };
+    std::vector<RvmatStageLoad> rvmat_stage_loads_;
+    std::string rvmat_report_head_;
+    std::vector<std::string> rvmat_uv_warnings_;
+
     // --- Audio panel (embedded player) ---
     Gtk::Box audio_panel_{Gtk::Orientation::VERTICAL, 4};
     Gtk::ScrolledWindow audio_info_scroll_;
@@ -178,14 +206,14 @@ private:
     void preview_jpg(const armatools::pboindex::FindResult& file);
     void preview_text(const armatools::pboindex::FindResult& file);
 
-    struct DecodedTexture {
-        int width = 0;
-        int height = 0;
-        std::vector<uint8_t> pixels;
-    };
-    std::optional<DecodedTexture> load_preview_texture_asset(
+    std::vector<std::string> preview_texture_keys(
         const armatools::pboindex::FindResult& context_file,
-        const std::string& texture_path);
+        const std::string& texture_path) const;
+    void prefetch_neighbour_textures();
+    void start_preview_poll();
+    bool on_preview_poll();
+    void cancel_preview_loads();
+    std::string rvmat_report() const;
 
     // Audio player methods
     void audio_load_from_memory(const uint8_t* data, size_t size,
@@ -206,6 +234,7 @@ private:
 
     // Helper to get the currently selected file (if any)
     bool get_selected_file(armatools::pboindex::FindResult& out);
+    bool get_file_at_row(int idx, armatools::pboindex::FindResult& out);
 
     static std::string icon_for_extension(const std::string& ext);
     static std::string audio_format_time(double seconds);
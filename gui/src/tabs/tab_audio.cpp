@@ -241,6 +241,7 @@ void TabAudio::load_audio(const std::string& path) {
     // Clear state
     waveform_envelope_.clear();
     spectrogram_surface_.reset();
+    spectrogram_engine_.reset();
     save_wav_button_.set_visible(false);
     current_file_path_.clear();
     waveform_area_.queue_draw();
@@ -277,6 +278,7 @@ void TabAudio::load_audio_from_memory(const uint8_t* data, size_t size,
 
     waveform_envelope_.clear();
     spectrogram_surface_.reset();
+    spectrogram_engine_.reset();
     save_wav_button_.set_visible(false);
     current_file_path_.clear();
     waveform_area_.queue_draw();
@@ -320,6 +322,8 @@ void TabAudio::on_loaded(const std::string& info_text) {
     waveform_area_.queue_draw();
 
     // Compute spectrogram in background
+    spectrogram_engine_ = std::make_shared<SpectrogramEngine>(mono_data_, decoded_audio_.sample_rate);
+    spectrogram_width_ = -1;
     compute_spectrogram_async();
 
     // Enable buttons
@@ -356,18 +360,28 @@ void TabAudio::compute_waveform_envelope() {
 }
 
 void TabAudio::compute_spectrogram_async() {
-    if (spectrogram_computing_.load()) return;
+    if (!spectrogram_engine_ || spectrogram_computing_.load()) return;
+    if (spectrogram_thread_.joinable()) spectrogram_thread_.join();
     spectrogram_computing_.store(true);
 
-    // Copy data for thread safety.
-    auto mono_copy = mono_data_;
-    auto sample_rate = decoded_audio_.sample_rate;
+    // One column per pixel of the area. The engine keeps the columns it
+    // has computed, so a resize only transforms the new ones.
+    int width = spectrogram_area_.get_width();
+    spectrogram_width_ = width;
+    size_t cols = std::min(static_cast<size_t>(width > 0 ? width : kWaveformCols),
+                           spectrogram_engine_->total_columns());
 
-    spectrogram_thread_ = std::thread([this, mono = std::move(mono_copy), sample_rate]() {
-        auto data = compute_spectrogram(mono.data(), mono.size(), sample_rate);
+    spectrogram_thread_ = std::thread([this, engine = spectrogram_engine_, cols]() {
+        auto data = engine->compute(0, engine->sample_count(), cols);
         auto img = render_spectrogram(data);
 
-        Glib::signal_idle().connect_once([this, img = std::move(img)]() {
+        Glib::signal_idle().connect_once([this, engine, img = std::move(img)]() {
+            if (engine != spectrogram_engine_) {
+                // Another file was loaded meanwhile; start over for it.
+                spectrogram_computing_.store(false);
+                compute_spectrogram_async();
+                return;
+            }
             if (img.width > 0 && img.height > 0) {
                 // Cairo expects ARGB32 premultiplied. We have RGBA.
                 // Convert RGBA → ARGB32 (Cairo native format).
@@ -474,6 +488,7 @@ void TabAudio::draw_spectrogram(const Cairo::RefPtr<Cairo::Context>& cr,
         cr->paint();
         cr->restore();
     }
+    if (spectrogram_engine_ && width != spectrogram_width_) compute_spectrogram_async();
 
     // Playback cursor
     if (engine_.has_audio()) {
@@ -716,9 +731,7 @@ std::string TabAudio::build_ogg_info(const std::string& path) {
 std::string TabAudio::build_ogg_info_memory(const uint8_t* data, size_t size) {
     std::ostringstream info;
     try {
-        std::string str(reinterpret_cast<const char*>(data), size);
-        std::istringstream stream(str);
-        auto hdr = armatools::ogg::read_header(stream);
+        auto hdr = armatools::ogg::read_header(std::span<const uint8_t>(data, size));
 
         info << "Format: OGG Vorbis\n";
         info << "Sample rate: " << hdr.sample_rate << " Hz\n";
@@ -757,7 +770,7 @@ std::string TabAudio::build_wss_info(const std::string& path) {
     try {
         std::ifstream f(path, std::ios::binary);
         if (!f.is_open()) return "Format: WSS/WAV";
-        auto audio = armatools::wss::read(f);
+        auto audio = armatools::wss::Decoder(f).info();
 
         info << "Format: " << audio.format << " " << audio.bits_per_sample << "-bit\n";
         info << "Sample rate: " << audio.sample_rate << " Hz\n";
@@ -777,7 +790,7 @@ std::string TabAudio::build_wss_info_memory(const uint8_t* data, size_t size) {
     try {
         std::string str(reinterpret_cast<const char*>(data), size);
         std::istringstream stream(str);
-        auto audio = armatools::wss::read(stream);
+        auto audio = armatools::wss::Decoder(stream).info();
 
         info << "Format: " << audio.format << " " << audio.bits_per_sample << "-bit\n";
         info << "Sample rate: " << audio.sample_rate << " Hz\n";
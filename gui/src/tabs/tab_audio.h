@@ -41,6 +41,8 @@ private:
     // --- Spectrogram ---
     Cairo::RefPtr<Cairo::ImageSurface> spectrogram_surface_;
     std::atomic<bool> spectrogram_computing_{false};
+    std::shared_ptr<SpectrogramEngine> spectrogram_engine_; // caches columns of the loaded audio
+    int spectrogram_width_ = -1; // area width the surface was computed for
 
     // --- Path row ---
     Gtk::Box path_box_{Gtk::Orientation::HORIZONTAL, 4};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace armatools::binutil {
+
+// MappedFile holds the bytes of a file: a read-only mapping of it, or a
+// buffer the caller read some other way and adopted.
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { reset(); }
+
+    // map maps path read-only in place of the current contents. It returns
+    // false and leaves the object empty if the file is missing, empty or
+    // cannot be mapped; callers fall back to reading it.
+    bool map(const std::filesystem::path& path);
+
+    // adopt takes bytes in place of the current contents.
+    void adopt(std::vector<uint8_t> bytes);
+
+    // reset unmaps the file or frees the adopted bytes.
+    void reset();
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+private:
+    std::vector<uint8_t> owned_;
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    void* view_ = nullptr; // mapped view, if any
+};
+
+} // namespace armatools::binutil
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace armatools::binutil {
+
+// worker_count maps a thread count option to a number of workers: values
+// of 0 or less mean one per hardware thread.
+inline size_t worker_count(int requested) {
+    if (requested > 0) return static_cast<size_t>(requested);
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// parallel_for calls fn(i) for every i < count on up to threads workers,
+// including the calling thread, and returns once all calls are done. The
+// first exception thrown by fn stops the remaining indexes from being
+// handed out and is rethrown on the calling thread.
+template <class Fn>
+void parallel_for(size_t count, size_t threads, const Fn& fn) {
+    threads = std::min(threads, count);
+    if (threads <= 1) {
+        for (size_t i = 0; i < count; i++) fn(i);
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    std::mutex mu;
+    std::exception_ptr error;
+    auto work = [&] {
+        try {
+            for (size_t i = next++; i < count; i = next++) fn(i);
+        } catch (...) {
+            std::lock_guard lock(mu);
+            if (!error) error = std::current_exception();
+            next = count;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    try {
+        for (size_t t = 1; t < threads; t++) pool.emplace_back(work);
+    } catch (const std::system_error&) {
+        // Out of threads: the ones already started and the caller finish.
+    }
+    work();
+    for (auto& t : pool) t.join();
+    if (error) std::rethrow_exception(error);
+}
+
+// ordered_for calls produce(i, slot) for every i < count on up to threads
+// workers and consume(i, slot) on the calling thread in index order. At
+// most 2*threads slots are alive; each is reused for a later index once it
+// has been consumed, so produce must overwrite what it needs. The first
+// exception from either side stops the workers and is rethrown.
+template <class T, class Produce, class Consume>
+void ordered_for(size_t count, size_t threads, const Produce& produce, const Consume& consume) {
+    threads = std::min(threads, count);
+    if (threads <= 1) {
+        T slot{};
+        for (size_t i = 0; i < count; i++) {
+            produce(i, slot);
+            consume(i, slot);
+        }
+        return;
+    }
+
+    struct Slot {
+        T data{};
+        bool done = false;
+    };
+    const size_t window = threads * 2;
+    std::vector<Slot> slots(window);
+    std::mutex mu;
+    std::condition_variable cv;
+    size_t next = 0;
+    size_t consumed = 0;
+    bool failed = false;
+    std::exception_ptr error;
+
+    auto fail = [&](std::exception_ptr e) {
+        {
+            std::lock_guard lock(mu);
+            if (!error) error = std::move(e);
+            failed = true;
+        }
+        cv.notify_all();
+    };
+
+    auto work = [&] {
+        for (;;) {
+            size_t i;
+            {
+                std::unique_lock lock(mu);
+                cv.wait(lock, [&] { return failed || next >= count || next < consumed + window; });
+                if (failed || next >= count) return;
+                i = next++;
+            }
+            Slot& slot = slots[i % window];
+            try {
+                produce(i, slot.data);
+            } catch (...) {
+                fail(std::current_exception());
+                return;
+            }
+            {
+                std::lock_guard lock(mu);
+                slot.done = true;
+            }
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    try {
+        for (size_t t = 0; t < threads; t++) workers.emplace_back(work);
+    } catch (const std::system_error&) {
+        // Out of threads: carry on with the ones already started.
+        if (workers.empty()) throw;
+    }
+    try {
+        while (consumed < count) {
+            Slot& slot = slots[consumed % window];
+            {
+                std::unique_lock lock(mu);
+                cv.wait(lock, [&] { return failed || slot.done; });
+                if (failed) break;
+            }
+            consume(consumed, slot.data);
+            {
+                std::lock_guard lock(mu);
+                slot.done = false;
+                consumed++;
+            }
+            cv.notify_all();
+        }
+    } catch (...) {
+        fail(std::current_exception());
+    }
+    for (auto& t : workers) t.join();
+    if (error) std::rethrow_exception(error);
+}
+
+} // namespace armatools::binutil
@@ -1,3 +0,0 @@
-// binutil is header-heavy; this file ensures the library has at least one
-// translation unit so CMake can produce a valid static library.
-#include "armatools/binutil.h"
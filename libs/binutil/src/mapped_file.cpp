@@ -0,0 +1,73 @@
+#include "armatools/mapped_file.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <utility>
+
+namespace armatools::binutil {
+
+bool MappedFile::map(const std::filesystem::path& path) {
+    reset();
+#if defined(_WIN32)
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fsize{};
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &fsize) && fsize.QuadPart > 0)
+        mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    // The view keeps the mapping and the file open once both handles close.
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (mapping) CloseHandle(mapping);
+    CloseHandle(file);
+    if (!view) return false;
+    size_ = static_cast<size_t>(fsize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void* view = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) return false;
+    size_ = static_cast<size_t>(st.st_size);
+#endif
+    view_ = view;
+    data_ = static_cast<const uint8_t*>(view);
+    return true;
+}
+
+void MappedFile::adopt(std::vector<uint8_t> bytes) {
+    reset();
+    owned_ = std::move(bytes);
+    data_ = owned_.data();
+    size_ = owned_.size();
+}
+
+void MappedFile::reset() {
+    if (view_) {
+#if defined(_WIN32)
+        UnmapViewOfFile(view_);
+#else
+        ::munmap(view_, size_);
+#endif
+    }
+    view_ = nullptr;
+    owned_ = std::vector<uint8_t>();
+    data_ = nullptr;
+    size_ = 0;
+}
+
+} // namespace armatools::binutil
@@ -1,10 +1,18 @@
 #include "armatools/binutil.h"
+#include "armatools/mapped_file.h"
+#include "armatools/parallel.h"
 
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <cmath>
 #include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 using namespace armatools::binutil;
 
@@ -99,3 +107,92 @@ TEST(Binutil, WriteU32) {
     std::memcpy(&v, data.data(), 4);
     EXPECT_EQ(v, 0xDEADBEEF);
 }
+
+TEST(MappedFile, MapsAndAdopts) {
+    auto dir = std::filesystem::temp_directory_path() / "armatools_mapped_file_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / "data.bin", std::ios::binary) << "mapped bytes";
+    std::ofstream(dir / "empty.bin", std::ios::binary).close();
+
+    MappedFile f;
+    EXPECT_TRUE(f.empty());
+    ASSERT_TRUE(f.map(dir / "data.bin"));
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(f.data()), f.size()), "mapped bytes");
+
+    f.adopt({1, 2, 3});
+    ASSERT_EQ(f.size(), 3u);
+    EXPECT_EQ(f.data()[2], 3);
+
+    // A failed map leaves the object empty; empty files are not mapped.
+    EXPECT_FALSE(f.map(dir / "missing.bin"));
+    EXPECT_TRUE(f.empty());
+    EXPECT_EQ(f.data(), nullptr);
+    EXPECT_FALSE(f.map(dir / "empty.bin"));
+
+    ASSERT_TRUE(f.map(dir / "data.bin"));
+    f.reset();
+    EXPECT_TRUE(f.empty());
+    std::filesystem::remove_all(dir);
+}
+
+TEST(Parallel, ForVisitsEveryIndexOnce) {
+    for (size_t threads : {0u, 1u, 3u, 16u}) {
+        std::vector<std::atomic<int>> hits(1000);
+        parallel_for(hits.size(), threads, [&](size_t i) { hits[i]++; });
+        for (size_t i = 0; i < hits.size(); i++) ASSERT_EQ(hits[i].load(), 1) << threads << " " << i;
+    }
+    parallel_for(0, 4, [](size_t) { FAIL(); });
+}
+
+TEST(Parallel, ForRethrowsOnCaller) {
+    std::atomic<size_t> calls{0};
+    EXPECT_THROW(parallel_for(100000, 4,
+                              [&](size_t i) {
+                                  calls++;
+                                  if (i == 10) throw std::runtime_error("worker");
+                              }),
+                 std::runtime_error);
+    // Indexes stop being handed out after the failure.
+    EXPECT_LT(calls.load(), 100000u);
+    EXPECT_THROW(parallel_for(5, 1, [](size_t) { throw std::runtime_error("caller"); }), std::runtime_error);
+}
+
+TEST(Parallel, OrderedConsumesInIndexOrder) {
+    for (size_t threads : {1u, 2u, 8u}) {
+        std::vector<size_t> seen;
+        ordered_for<std::string>(
+            500, threads, [](size_t i, std::string& s) { s = std::to_string(i * 3); },
+            [&](size_t i, std::string& s) {
+                EXPECT_EQ(s, std::to_string(i * 3));
+                seen.push_back(i);
+            });
+        ASSERT_EQ(seen.size(), 500u);
+        for (size_t i = 0; i < seen.size(); i++) EXPECT_EQ(seen[i], i);
+    }
+}
+
+TEST(Parallel, OrderedRethrowsFromEitherSide) {
+    auto noop = [](size_t, int&) {};
+    EXPECT_THROW(ordered_for<int>(
+                     1000, 4,
+                     [](size_t i, int&) {
+                         if (i == 100) throw std::runtime_error("produce");
+                     },
+                     noop),
+                 std::runtime_error);
+    size_t consumed = 0;
+    EXPECT_THROW(ordered_for<int>(1000, 4, noop,
+                                  [&](size_t i, int&) {
+                                      consumed++;
+                                      if (i == 5) throw std::runtime_error("consume");
+                                  }),
+                 std::runtime_error);
+    EXPECT_EQ(consumed, 6u);
+}
+
+TEST(Parallel, WorkerCount) {
+    EXPECT_EQ(worker_count(3), 3u);
+    EXPECT_GE(worker_count(0), 1u);
+    EXPECT_EQ(worker_count(-1), worker_count(0));
+}
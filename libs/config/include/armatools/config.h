@@ -1,10 +1,16 @@
 #pragma once
 
 #include <cstdint>
+#include <filesystem>
+#include <functional>
 #include <istream>
 #include <memory>
+#include <optional>
 #include <ostream>
+#include <span>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -62,10 +68,155 @@ struct Config {
 // read parses a rapified config from a seekable stream.
 Config read(std::istream& r);
 
-// parse_text parses a plaintext (derap'd) config.cpp/hpp file.
+// IncludedText is a file returned by an #include resolver. name is used in
+// error messages and passed back as the 'from' of nested includes.
+struct IncludedText {
+    std::string name;
+    std::string text;
+};
+
+// TextOptions controls the preprocessor of the text parser.
+struct TextOptions {
+    // include resolves #include "target" seen in file 'from' (the path given
+    // to parse_text_file, or empty for parse_text). Returning nullopt is an
+    // error. Without a resolver #include lines are skipped.
+    std::function<std::optional<IncludedText>(const std::string& target, const std::string& from)> include;
+    // defines are predefined object-like macros (name, body).
+    std::vector<std::pair<std::string, std::string>> defines;
+};
+
+// parse_text parses a plaintext (derap'd) config.cpp/hpp/rvmat source in a
+// single pass, running #define/#ifdef/#include as it goes. Errors throw
+// std::runtime_error with the file and line.
+Config parse_text(std::string_view src, const TextOptions& opts = {});
 Config parse_text(std::istream& r);
 
+// parse_text_file parses a text config from disk. Unless opts supplies a
+// resolver, includes are read relative to the including file.
+Config parse_text_file(const std::filesystem::path& path, const TextOptions& opts = {});
+
 // write_text writes the config as human-readable text.
 void write_text(std::ostream& w, const Config& cfg);
 
+// format_value returns a non-class entry in config syntax: "text" (quoted
+// and escaped), 3, 1.5 or {1, "a", {2}}. Class entries give "".
+std::string format_value(const Entry& e);
+
+// --- Lazy rapified view ---
+//
+// ConfigView reads a rapified config in place, without building a Config
+// tree. Class bodies are decoded only when visited (the format stores the
+// offset of every body), names and strings are views into the buffer, and
+// each class builds a case-insensitive hash index of its entries on the
+// first lookup. Decoded classes are cached and shared between threads.
+
+namespace detail {
+struct ViewState;
+struct ViewClass;
+} // namespace detail
+
+enum class EntryKind : uint8_t { Class, String, Float, Int, Array, External, Delete };
+
+// ArrayView is an undecoded array; elements() decodes one nesting level.
+class ArrayView {
+public:
+    ArrayView() = default;
+
+    uint32_t size() const { return count_; }
+    bool expansion() const { return expansion_; }
+
+    struct Element;
+    std::vector<Element> elements() const;
+
+    // to_entry decodes the array and all nested arrays.
+    ArrayEntry to_entry() const;
+
+private:
+    friend struct detail::ViewState;
+    ArrayView(const uint8_t* begin, const uint8_t* end, size_t pos, bool expansion);
+
+    const uint8_t* begin_ = nullptr;
+    const uint8_t* end_ = nullptr;
+    size_t pos_ = 0; // first element, after the count
+    uint32_t count_ = 0;
+    bool expansion_ = false;
+};
+
+struct ArrayView::Element {
+    enum class Type : uint8_t { String, Float, Int, Array } type = Type::Int;
+    std::string_view string;
+    float float_value = 0;
+    int32_t int_value = 0;
+    ArrayView array;
+};
+
+struct EntryView {
+    EntryKind kind = EntryKind::Int;
+    std::string_view name;
+    std::string_view string; // String
+    float float_value = 0;   // Float
+    int32_t int_value = 0;   // Int
+    ArrayView array;         // Array (array.expansion() for +=)
+    uint32_t body = 0;       // Class: offset of the class body
+};
+
+// ClassView is a handle to a class body; it stays valid as long as the
+// ConfigView it came from.
+class ClassView {
+public:
+    ClassView() = default;
+
+    explicit operator bool() const { return cls_ != nullptr; }
+
+    std::string_view parent() const;
+    std::span<const EntryView> entries() const;
+
+    // find returns the entry with the given name (case-insensitive), or nullptr.
+    const EntryView* find(std::string_view name) const;
+
+    // find_class returns a child class with a body; external and deleted
+    // classes yield an empty view.
+    ClassView find_class(std::string_view name) const;
+
+    std::optional<std::string_view> find_string(std::string_view name) const;
+    std::optional<int32_t> find_int(std::string_view name) const;
+    // find_float also accepts int entries.
+    std::optional<float> find_float(std::string_view name) const;
+    std::optional<ArrayView> find_array(std::string_view name) const;
+
+    // materialize decodes this class and all its descendants.
+    ConfigClass materialize() const;
+
+private:
+    friend class ConfigView;
+    friend struct detail::ViewState;
+    ClassView(detail::ViewState* state, detail::ViewClass* cls) : state_(state), cls_(cls) {}
+
+    detail::ViewState* state_ = nullptr;
+    detail::ViewClass* cls_ = nullptr;
+};
+
+class ConfigView {
+public:
+    // open memory-maps a rapified config file (falling back to reading it).
+    static ConfigView open(const std::filesystem::path& path);
+
+    // ConfigView takes ownership of an in-memory rapified config.
+    explicit ConfigView(std::vector<uint8_t> bytes);
+    ~ConfigView();
+    ConfigView(ConfigView&& other) noexcept;
+    ConfigView& operator=(ConfigView&& other) noexcept;
+
+    ClassView root() const;
+
+    // find_class resolves a '/'-separated class path from the root, e.g.
+    // "CfgVehicles/Car". Returns an empty view if any step is missing.
+    ClassView find_class(std::string_view path) const;
+
+private:
+    ConfigView() = default;
+
+    std::unique_ptr<detail::ViewState> state_;
+};
+
 } // namespace armatools::config
@@ -1,10 +1,19 @@
 #include "armatools/config.h"
 #include "armatools/binutil.h"
+#include "armatools/mapped_file.h"
 
+#include <algorithm>
 #include <charconv>
+#include <climits>
+#include <cstring>
+#include <deque>
 #include <format>
+#include <fstream>
+#include <iterator>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
+#include <unordered_map>
 
 namespace armatools::config {
 
@@ -184,6 +193,352 @@ Config read(std::istream& r) {
     return Config{std::move(root)};
 }
 
+// --- Lazy rapified view ---
+
+namespace {
+
+// Cursor decodes little-endian values from a byte range, throwing instead
+// of reading past the end.
+struct Cursor {
+    const uint8_t* begin;
+    const uint8_t* end;
+    size_t pos;
+
+    size_t size() const { return static_cast<size_t>(end - begin); }
+
+    void need(size_t n) const {
+        if (pos > size() || n > size() - pos)
+            throw std::runtime_error(std::format("config: truncated data at offset {}", pos));
+    }
+
+    uint8_t u8() {
+        need(1);
+        return begin[pos++];
+    }
+
+    template <typename T> T fixed() {
+        need(sizeof(T));
+        T v;
+        std::memcpy(&v, begin + pos, sizeof(T));
+        pos += sizeof(T);
+        return v;
+    }
+
+    uint32_t compressed_int() {
+        uint32_t result = 0;
+        for (int shift = 0;; shift += 7) {
+            uint8_t b = u8();
+            if (shift > 28) throw std::runtime_error(std::format("config: bad compressed int at offset {}", pos));
+            result |= static_cast<uint32_t>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) return result;
+        }
+    }
+
+    std::string_view asciiz() {
+        need(0);
+        auto* start = begin + pos;
+        auto* nul = static_cast<const uint8_t*>(std::memchr(start, 0, static_cast<size_t>(end - start)));
+        if (!nul) throw std::runtime_error(std::format("config: unterminated string at offset {}", pos));
+        pos += static_cast<size_t>(nul - start) + 1;
+        return {reinterpret_cast<const char*>(start), static_cast<size_t>(nul - start)};
+    }
+
+    void skip_array() {
+        uint32_t count = compressed_int();
+        for (uint32_t i = 0; i < count; i++) {
+            switch (uint8_t type = u8()) {
+                case 0: asciiz(); break;
+                case 1:
+                case 2: need(4); pos += 4; break;
+                case 3: skip_array(); break;
+                default: throw std::runtime_error(std::format("config: unknown array element type {}", type));
+            }
+        }
+    }
+};
+
+char ascii_lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+struct CaseInsensitiveHash {
+    size_t operator()(std::string_view s) const {
+        uint64_t h = 14695981039346656037ull; // FNV-1a
+        for (char c : s) {
+            h ^= static_cast<uint8_t>(ascii_lower(c));
+            h *= 1099511628211ull;
+        }
+        return static_cast<size_t>(h);
+    }
+};
+
+struct CaseInsensitiveEqual {
+    bool operator()(std::string_view a, std::string_view b) const {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); i++) {
+            if (ascii_lower(a[i]) != ascii_lower(b[i])) return false;
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+namespace detail {
+
+struct ViewClass {
+    std::string_view parent;
+    std::vector<EntryView> entries;
+    // Built on the first lookup; later duplicates of a name win, like the
+    // engine's config merge.
+    std::once_flag index_once;
+    std::unordered_map<std::string_view, uint32_t, CaseInsensitiveHash, CaseInsensitiveEqual> index;
+};
+
+struct ViewState {
+    binutil::MappedFile file;
+
+    std::mutex mu;
+    std::unordered_map<uint32_t, std::unique_ptr<ViewClass>> classes; // by body offset
+
+    void check_header() const {
+        if (file.size() < 16 || std::memcmp(file.data(), "\0raP", 4) != 0)
+            throw std::runtime_error("config: not a rapified config");
+    }
+
+    ClassView view(ViewClass* cls) { return ClassView(this, cls); }
+
+    // load decodes the class body at offset once; later calls return the
+    // cached entry list.
+    ViewClass* load(uint32_t offset) {
+        std::lock_guard lock(mu);
+        auto& slot = classes[offset];
+        if (slot) return slot.get();
+
+        auto cls = std::make_unique<ViewClass>();
+        Cursor c{file.data(), file.data() + file.size(), offset};
+        cls->parent = c.asciiz();
+        uint32_t num_entries = c.compressed_int();
+        cls->entries.reserve(std::min<size_t>(num_entries, file.size() - c.pos));
+        for (uint32_t i = 0; i < num_entries; i++) {
+            EntryView e;
+            uint8_t entry_type = c.u8();
+            switch (entry_type) {
+                case 0:
+                    e.kind = EntryKind::Class;
+                    e.name = c.asciiz();
+                    e.body = c.fixed<uint32_t>();
+                    break;
+                case 1: {
+                    uint8_t subtype = c.u8();
+                    e.name = c.asciiz();
+                    switch (subtype) {
+                        case 0: e.kind = EntryKind::String; e.string = c.asciiz(); break;
+                        case 1: e.kind = EntryKind::Float; e.float_value = c.fixed<float>(); break;
+                        case 2: e.kind = EntryKind::Int; e.int_value = c.fixed<int32_t>(); break;
+                        default: throw std::runtime_error(std::format("config: unknown variable subtype {}", subtype));
+                    }
+                    break;
+                }
+                case 2:
+                case 5: {
+                    if (entry_type == 5) {
+                        c.need(4);
+                        c.pos += 4;
+                    }
+                    e.kind = EntryKind::Array;
+                    e.name = c.asciiz();
+                    e.array = array_at(c, entry_type == 5);
+                    break;
+                }
+                case 3:
+                    e.kind = EntryKind::External;
+                    e.name = c.asciiz();
+                    break;
+                case 4:
+                    e.kind = EntryKind::Delete;
+                    e.name = c.asciiz();
+                    break;
+                default:
+                    throw std::runtime_error(std::format("config: unknown entry type {}", entry_type));
+            }
+            cls->entries.push_back(e);
+        }
+        slot = std::move(cls);
+        return slot.get();
+    }
+
+    // array_at returns a view of the array at the cursor and skips past it.
+    static ArrayView array_at(Cursor& c, bool expansion) {
+        size_t start = c.pos;
+        ArrayView a(c.begin, c.end, start, expansion);
+        c.skip_array();
+        return a;
+    }
+};
+
+} // namespace detail
+
+ArrayView::ArrayView(const uint8_t* begin, const uint8_t* end, size_t pos, bool expansion)
+    : begin_(begin), end_(end), expansion_(expansion) {
+    Cursor c{begin, end, pos};
+    count_ = c.compressed_int();
+    pos_ = c.pos;
+}
+
+std::vector<ArrayView::Element> ArrayView::elements() const {
+    std::vector<Element> out;
+    if (!begin_) return out;
+    out.reserve(count_);
+    Cursor c{begin_, end_, pos_};
+    for (uint32_t i = 0; i < count_; i++) {
+        Element e;
+        switch (uint8_t type = c.u8()) {
+            case 0: e.type = Element::Type::String; e.string = c.asciiz(); break;
+            case 1: e.type = Element::Type::Float; e.float_value = c.fixed<float>(); break;
+            case 2: e.type = Element::Type::Int; e.int_value = c.fixed<int32_t>(); break;
+            case 3: e.type = Element::Type::Array; e.array = detail::ViewState::array_at(c, false); break;
+            default: throw std::runtime_error(std::format("config: unknown array element type {}", type));
+        }
+        out.push_back(e);
+    }
+    return out;
+}
+
+ArrayEntry ArrayView::to_entry() const {
+    ArrayEntry arr;
+    arr.expansion = expansion_;
+    for (const auto& e : elements()) {
+        switch (e.type) {
+            case Element::Type::String: arr.elements.push_back(StringElement{std::string(e.string)}); break;
+            case Element::Type::Float: arr.elements.push_back(FloatElement{e.float_value}); break;
+            case Element::Type::Int: arr.elements.push_back(IntElement{e.int_value}); break;
+            case Element::Type::Array: {
+                auto nested = e.array.to_entry();
+                arr.elements.push_back(NestedArrayEntry{false, std::move(nested.elements)});
+                break;
+            }
+        }
+    }
+    return arr;
+}
+
+std::string_view ClassView::parent() const {
+    return cls_ ? cls_->parent : std::string_view{};
+}
+
+std::span<const EntryView> ClassView::entries() const {
+    if (!cls_) return {};
+    return cls_->entries;
+}
+
+const EntryView* ClassView::find(std::string_view name) const {
+    if (!cls_) return nullptr;
+    std::call_once(cls_->index_once, [this] {
+        cls_->index.reserve(cls_->entries.size());
+        for (uint32_t i = 0; i < cls_->entries.size(); i++) cls_->index[cls_->entries[i].name] = i;
+    });
+    auto it = cls_->index.find(name);
+    return it == cls_->index.end() ? nullptr : &cls_->entries[it->second];
+}
+
+ClassView ClassView::find_class(std::string_view name) const {
+    const EntryView* e = find(name);
+    if (!e || e->kind != EntryKind::Class) return {};
+    return state_->view(state_->load(e->body));
+}
+
+std::optional<std::string_view> ClassView::find_string(std::string_view name) const {
+    const EntryView* e = find(name);
+    if (!e || e->kind != EntryKind::String) return std::nullopt;
+    return e->string;
+}
+
+std::optional<int32_t> ClassView::find_int(std::string_view name) const {
+    const EntryView* e = find(name);
+    if (!e || e->kind != EntryKind::Int) return std::nullopt;
+    return e->int_value;
+}
+
+std::optional<float> ClassView::find_float(std::string_view name) const {
+    const EntryView* e = find(name);
+    if (!e) return std::nullopt;
+    if (e->kind == EntryKind::Float) return e->float_value;
+    if (e->kind == EntryKind::Int) return static_cast<float>(e->int_value);
+    return std::nullopt;
+}
+
+std::optional<ArrayView> ClassView::find_array(std::string_view name) const {
+    const EntryView* e = find(name);
+    if (!e || e->kind != EntryKind::Array) return std::nullopt;
+    return e->array;
+}
+
+ConfigClass ClassView::materialize() const {
+    ConfigClass out;
+    if (!cls_) return out;
+    out.parent = std::string(cls_->parent);
+    out.entries.reserve(cls_->entries.size());
+    for (const auto& e : cls_->entries) {
+        std::string name(e.name);
+        switch (e.kind) {
+            case EntryKind::Class: {
+                auto child = state_->view(state_->load(e.body)).materialize();
+                out.entries.push_back({std::move(name), ClassEntryOwned{std::make_unique<ConfigClass>(std::move(child))}});
+                break;
+            }
+            case EntryKind::String: out.entries.push_back({std::move(name), StringEntry{std::string(e.string)}}); break;
+            case EntryKind::Float: out.entries.push_back({std::move(name), FloatEntry{e.float_value}}); break;
+            case EntryKind::Int: out.entries.push_back({std::move(name), IntEntry{e.int_value}}); break;
+            case EntryKind::Array: out.entries.push_back({std::move(name), e.array.to_entry()}); break;
+            case EntryKind::External:
+            case EntryKind::Delete: {
+                auto c = std::make_unique<ConfigClass>();
+                c->external = e.kind == EntryKind::External;
+                c->deletion = e.kind == EntryKind::Delete;
+                out.entries.push_back({std::move(name), ClassEntryOwned{std::move(c)}});
+                break;
+            }
+        }
+    }
+    return out;
+}
+
+ConfigView ConfigView::open(const std::filesystem::path& path) {
+    ConfigView v;
+    v.state_ = std::make_unique<detail::ViewState>();
+    if (!v.state_->file.map(path)) {
+        std::ifstream f(path, std::ios::binary);
+        if (!f) throw std::runtime_error(std::format("config: cannot open {}", path.string()));
+        v.state_->file.adopt(std::vector<uint8_t>(std::istreambuf_iterator<char>(f), {}));
+    }
+    v.state_->check_header();
+    return v;
+}
+
+ConfigView::ConfigView(std::vector<uint8_t> bytes) : state_(std::make_unique<detail::ViewState>()) {
+    state_->file.adopt(std::move(bytes));
+    state_->check_header();
+}
+
+ConfigView::~ConfigView() = default;
+ConfigView::ConfigView(ConfigView&& other) noexcept = default;
+ConfigView& ConfigView::operator=(ConfigView&& other) noexcept = default;
+
+ClassView ConfigView::root() const {
+    return state_->view(state_->load(16));
+}
+
+ClassView ConfigView::find_class(std::string_view path) const {
+    ClassView cls = root();
+    while (cls && !path.empty()) {
+        size_t slash = path.find('/');
+        cls = cls.find_class(path.substr(0, slash));
+        path = slash == std::string_view::npos ? std::string_view{} : path.substr(slash + 1);
+    }
+    return cls;
+}
+
 // --- Text writer ---
 
 static std::string escape_string(const std::string& s) {
@@ -269,22 +624,737 @@ void write_text(std::ostream& w, const Config& cfg) {
     write_class(w, cfg.root, 0);
 }
 
-// --- Text parser (stub — full implementation follows Go parse.go) ---
+std::string format_value(const Entry& e) {
+    std::ostringstream w;
+    std::visit([&](const auto& v) {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, StringEntry>) {
+            w << "\"" << escape_string(v.value) << "\"";
+        } else if constexpr (std::is_same_v<T, FloatEntry>) {
+            w << format_float(v.value);
+        } else if constexpr (std::is_same_v<T, IntEntry>) {
+            w << v.value;
+        } else if constexpr (std::is_same_v<T, ArrayEntry>) {
+            write_array_elements(w, v.elements);
+        }
+    }, e);
+    return std::move(w).str();
+}
+
+// --- Text parser ---
+
+namespace {
+
+struct Macro {
+    std::vector<std::string_view> params;
+    std::string_view body;
+    bool function_like = false;
+};
+
+// TextParser is a single-pass recursive descent parser. Tokens are views
+// into the source (or into expanded macro text); the preprocessor runs
+// inside the lexer, which reads from a stack of frames: the file, included
+// files and macro expansions.
+class TextParser {
+public:
+    TextParser(std::string_view src, std::string name, const TextOptions& opts) : opts_(opts) {
+        if (src.starts_with("\xef\xbb\xbf")) src.remove_prefix(3);
+        for (const auto& [macro, value] : opts.defines) {
+            Macro m;
+            m.body = store(value);
+            macros_[store(macro)] = m;
+        }
+        frames_.push_back({src, 0, store(std::move(name)), {}, true, true});
+    }
+
+    Config parse() {
+        Config cfg;
+        parse_body(cfg.root, true);
+        return cfg;
+    }
+
+private:
+    enum class Tok : uint8_t { End, Name, Number, String, Punct };
+
+    struct Token {
+        Tok type = Tok::End;
+        std::string_view text;
+        bool space_before = false;
+
+        bool is(char c) const { return type == Tok::Punct && text.size() == 1 && text[0] == c; }
+    };
+
+    struct Frame {
+        std::string_view text;
+        size_t pos = 0;
+        std::string_view file;  // file frames: name for messages and includes
+        std::string_view macro; // macro frames: the macro being expanded
+        bool is_file = false;
+        bool line_start = true;
+    };
+
+    const TextOptions& opts_;
+    std::vector<Frame> frames_;
+    std::unordered_map<std::string_view, Macro> macros_;
+    std::deque<std::string> arena_; // owns expanded text; element addresses are stable
+    std::optional<Token> peeked_;
+    int cond_depth_ = 0;
+
+    std::string_view store(std::string s) {
+        arena_.push_back(std::move(s));
+        return arena_.back();
+    }
+
+    [[noreturn]] void fail(const std::string& msg) const {
+        for (auto it = frames_.rbegin(); it != frames_.rend(); ++it) {
+            if (!it->is_file) continue;
+            auto upto = it->text.substr(0, std::min(it->pos, it->text.size()));
+            auto line = std::count(upto.begin(), upto.end(), '\n') + 1;
+            if (it->file.empty()) throw std::runtime_error(std::format("config: line {}: {}", line, msg));
+            throw std::runtime_error(std::format("config: {}:{}: {}", it->file, line, msg));
+        }
+        throw std::runtime_error("config: " + msg);
+    }
+
+    static bool is_name_start(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    }
+    static bool is_name_char(char c) { return is_name_start(c) || (c >= '0' && c <= '9'); }
+    static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+    static bool is_space(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v'; }
+
+    // --- Preprocessor ---
+
+    // directive_line returns the rest of a directive line with continuations
+    // joined and comments removed, and moves past it.
+    std::string directive_line(Frame& f) {
+        std::string out;
+        const char* p = f.text.data() + f.pos;
+        const char* e = f.text.data() + f.text.size();
+        while (p < e && *p != '\n') {
+            if (*p == '\\' && p + 1 < e && (p[1] == '\n' || (p[1] == '\r' && p + 2 < e && p[2] == '\n'))) {
+                p += p[1] == '\n' ? 2 : 3;
+                out += ' ';
+            } else if (*p == '/' && p + 1 < e && p[1] == '/') {
+                while (p < e && *p != '\n') ++p;
+            } else if (*p == '/' && p + 1 < e && p[1] == '*') {
+                const char* end = p + 2;
+                while (end + 1 < e && !(end[0] == '*' && end[1] == '/')) ++end;
+                p = end + 1 < e ? end + 2 : e;
+                out += ' ';
+            } else if (*p == '"' || *p == '\'') {
+                char q = *p;
+                out += *p++;
+                while (p < e && *p != q && *p != '\n') out += *p++;
+                if (p < e && *p == q) out += *p++;
+            } else {
+                out += *p++;
+            }
+        }
+        f.pos = static_cast<size_t>(p - f.text.data());
+        while (!out.empty() && is_space(out.back())) out.pop_back();
+        return out;
+    }
+
+    static std::string_view trim(std::string_view s) {
+        while (!s.empty() && is_space(s.front())) s.remove_prefix(1);
+        while (!s.empty() && is_space(s.back())) s.remove_suffix(1);
+        return s;
+    }
+
+    static std::string_view take_name(std::string_view& s) {
+        s = trim(s);
+        size_t n = 0;
+        while (n < s.size() && is_name_char(s[n])) ++n;
+        auto name = s.substr(0, n);
+        s.remove_prefix(n);
+        return name;
+    }
+
+    // eval_if handles the "#if" forms configs use: integer literals, macro
+    // names and defined(NAME), optionally negated with '!'.
+    bool eval_if(std::string_view expr) {
+        expr = trim(expr);
+        bool negate = false;
+        while (expr.starts_with('!')) {
+            negate = !negate;
+            expr = trim(expr.substr(1));
+        }
+        bool value = false;
+        if (expr.starts_with("defined")) {
+            expr.remove_prefix(7);
+            expr = trim(expr);
+            bool paren = expr.starts_with('(');
+            if (paren) expr.remove_prefix(1);
+            value = macros_.contains(take_name(expr));
+        } else if (!expr.empty() && is_digit(expr[0])) {
+            long v = 0;
+            std::from_chars(expr.data(), expr.data() + expr.size(), v);
+            value = v != 0;
+        } else if (auto it = macros_.find(take_name(expr)); it != macros_.end()) {
+            auto body = trim(it->second.body);
+            long v = 0;
+            std::from_chars(body.data(), body.data() + body.size(), v);
+            value = v != 0;
+        }
+        return value != negate;
+    }
+
+    // skip_conditional skips lines until the #else or #endif matching an
+    // untaken branch. Returns true if it stopped at #else.
+    bool skip_conditional(Frame& f, bool stop_at_else) {
+        int depth = 0;
+        while (f.pos < f.text.size()) {
+            size_t eol = f.text.find('\n', f.pos);
+            std::string_view line = f.text.substr(f.pos, eol == std::string_view::npos ? std::string_view::npos : eol - f.pos);
+            f.pos = eol == std::string_view::npos ? f.text.size() : eol + 1;
+            line = trim(line);
+            if (!line.starts_with('#')) continue;
+            line.remove_prefix(1);
+            auto word = take_name(line);
+            if (word == "if" || word == "ifdef" || word == "ifndef") {
+                ++depth;
+            } else if (word == "endif") {
+                if (depth-- == 0) return false;
+            } else if (word == "else" && depth == 0 && stop_at_else) {
+                return true;
+            }
+        }
+        fail("unterminated #if");
+    }
+
+    void define(std::string_view line) {
+        auto name = take_name(line);
+        if (name.empty()) fail("#define without a name");
+        Macro m;
+        // A '(' right after the name makes a function-like macro.
+        if (line.starts_with('(')) {
+            m.function_like = true;
+            size_t close = line.find(')');
+            if (close == std::string_view::npos) fail(std::format("unterminated parameter list in #define {}", name));
+            auto params = line.substr(1, close - 1);
+            line.remove_prefix(close + 1);
+            while (!trim(params).empty()) {
+                m.params.push_back(take_name(params));
+                params = trim(params);
+                if (params.starts_with(',')) params.remove_prefix(1);
+                else if (!params.empty()) fail(std::format("bad parameter list in #define {}", name));
+            }
+        }
+        m.body = trim(line);
+        macros_[name] = m;
+    }
+
+    void include(std::string_view line, const Frame& from) {
+        line = trim(line);
+        if (line.size() < 2 || !((line.front() == '"' && line.back() == '"') || (line.front() == '<' && line.back() == '>')))
+            fail("malformed #include");
+        if (!opts_.include) return;
+        std::string target(line.substr(1, line.size() - 2));
+        if (frames_.size() > 64) fail(std::format("#include nesting too deep at \"{}\"", target));
+        auto file = opts_.include(target, std::string(from.file));
+        if (!file) fail(std::format("cannot resolve #include \"{}\"", target));
+        Frame inc;
+        inc.file = store(std::move(file->name));
+        inc.text = store(std::move(file->text));
+        inc.is_file = true;
+        frames_.push_back(inc);
+    }
+
+    // directive handles the line starting at the '#' under f.pos.
+    void directive() {
+        Frame& f = frames_.back();
+        ++f.pos;
+        std::string_view line = store(directive_line(f));
+        auto word = take_name(line);
+        if (word == "define") {
+            define(line);
+        } else if (word == "undef") {
+            macros_.erase(take_name(line));
+        } else if (word == "include") {
+            include(line, f); // may push a frame; f is not used afterwards
+        } else if (word == "ifdef" || word == "ifndef" || word == "if") {
+            bool taken = word == "if" ? eval_if(line) : (macros_.contains(take_name(line)) == (word == "ifdef"));
+            if (taken || skip_conditional(f, true)) ++cond_depth_;
+        } else if (word == "else") {
+            if (cond_depth_ == 0) fail("#else without #if");
+            skip_conditional(f, false);
+            --cond_depth_;
+        } else if (word == "endif") {
+            if (cond_depth_ == 0) fail("#endif without #if");
+            --cond_depth_;
+        } else if (word.empty() || word == "pragma" || word == "line") {
+            // ignored
+        } else {
+            fail(std::format("unknown directive #{}", word));
+        }
+    }
+
+    bool expanding(std::string_view name) const {
+        for (const auto& f : frames_) {
+            if (f.macro == name) return true;
+        }
+        return false;
+    }
+
+    // expand pushes the expansion of macro name if its arguments (for a
+    // function-like macro) follow in the current frame. Returns false if
+    // the name is used without arguments.
+    bool expand(std::string_view name, const Macro& m) {
+        Frame& f = frames_.back();
+        if (!m.function_like) {
+            frames_.push_back({m.body, 0, {}, name, false, false});
+            return true;
+        }
+        size_t p = f.pos;
+        while (p < f.text.size() && (is_space(f.text[p]) || f.text[p] == '\n')) ++p;
+        if (p >= f.text.size() || f.text[p] != '(') return false;
+
+        std::vector<std::string_view> args;
+        int depth = 0;
+        size_t arg_start = ++p;
+        for (;; ++p) {
+            if (p >= f.text.size()) fail(std::format("unterminated arguments to {}", name));
+            char c = f.text[p];
+            if (c == '"' || c == '\'') {
+                size_t close = f.text.find(c, p + 1);
+                if (close == std::string_view::npos) fail("unterminated string");
+                p = close;
+            } else if (c == '(') {
+                ++depth;
+            } else if (c == ')' && depth > 0) {
+                --depth;
+            } else if ((c == ',' || c == ')') && depth == 0) {
+                args.push_back(trim(f.text.substr(arg_start, p - arg_start)));
+                arg_start = p + 1;
+                if (c == ')') break;
+            }
+        }
+        f.pos = p + 1;
+        if (args.size() == 1 && args[0].empty() && m.params.empty()) args.clear();
+        if (args.size() != m.params.size())
+            fail(std::format("{} expects {} arguments, got {}", name, m.params.size(), args.size()));
+
+        auto arg_for = [&](std::string_view param) -> const std::string_view* {
+            for (size_t i = 0; i < m.params.size(); ++i) {
+                if (m.params[i] == param) return &args[i];
+            }
+            return nullptr;
+        };
+
+        std::string out;
+        out.reserve(m.body.size() + 16);
+        const std::string_view body = m.body;
+        for (size_t i = 0; i < body.size();) {
+            char c = body[i];
+            if (c == '#' && i + 1 < body.size() && body[i + 1] == '#') {
+                while (!out.empty() && is_space(out.back())) out.pop_back();
+                i += 2;
+                while (i < body.size() && is_space(body[i])) ++i;
+            } else if (c == '#') {
+                size_t j = i + 1;
+                while (j < body.size() && is_space(body[j])) ++j;
+                size_t k = j;
+                while (k < body.size() && is_name_char(body[k])) ++k;
+                if (auto* arg = arg_for(body.substr(j, k - j))) {
+                    out += '"';
+                    out += *arg;
+                    out += '"';
+                    i = k;
+                } else {
+                    out += c;
+                    ++i;
+                }
+            } else if (c == '"' || c == '\'') {
+                size_t close = body.find(c, i + 1);
+                size_t end = close == std::string_view::npos ? body.size() : close + 1;
+                out += body.substr(i, end - i);
+                i = end;
+            } else if (is_name_start(c)) {
+                size_t k = i;
+                while (k < body.size() && is_name_char(body[k])) ++k;
+                auto word = body.substr(i, k - i);
+                if (auto* arg = arg_for(word)) out += *arg;
+                else out += word;
+                i = k;
+            } else {
+                out += c;
+                ++i;
+            }
+        }
+        frames_.push_back({store(std::move(out)), 0, {}, name, false, false});
+        return true;
+    }
+
+    // --- Lexer ---
+
+    Token lex() {
+        bool space = false;
+        for (;;) {
+            if (frames_.empty()) return {Tok::End, {}, space};
+            Frame& f = frames_.back();
+            const char* begin = f.text.data();
+            const char* p = begin + f.pos;
+            const char* e = begin + f.text.size();
+
+            bool directive_found = false;
+            while (p < e) {
+                char c = *p;
+                if (c == '\n') {
+                    f.line_start = true;
+                    space = true;
+                    ++p;
+                } else if (is_space(c)) {
+                    space = true;
+                    ++p;
+                } else if (c == '/' && p + 1 < e && p[1] == '/') {
+                    p = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(e - p)));
+                    if (!p) p = e;
+                    space = true;
+                } else if (c == '/' && p + 1 < e && p[1] == '*') {
+                    std::string_view rest(p + 2, static_cast<size_t>(e - p - 2));
+                    size_t close = rest.find("*/");
+                    if (close == std::string_view::npos) {
+                        f.pos = static_cast<size_t>(p - begin);
+                        fail("unterminated comment");
+                    }
+                    p += close + 4;
+                    space = true;
+                } else if (c == '#' && f.is_file && f.line_start) {
+                    directive_found = true;
+                    break;
+                } else if (c == '\\' && p + 1 < e && (p[1] == '\n' || p[1] == '\r')) {
+                    ++p; // line continuation outside a directive
+                } else {
+                    break;
+                }
+            }
+            f.pos = static_cast<size_t>(p - begin);
+            if (directive_found) {
+                directive();
+                space = true;
+                continue;
+            }
+            if (p == e) {
+                frames_.pop_back();
+                space = true;
+                continue;
+            }
+            f.line_start = false;
+
+            char c = *p;
+            const char* start = p;
+            if (is_name_start(c)) {
+                while (p < e && is_name_char(*p)) ++p;
+                f.pos = static_cast<size_t>(p - begin);
+                std::string_view word(start, static_cast<size_t>(p - start));
+                if (!macros_.empty()) {
+                    auto it = macros_.find(word);
+                    if (it != macros_.end() && !expanding(word) && expand(word, it->second)) continue;
+                }
+                return {Tok::Name, word, space};
+            }
+            if (is_digit(c) || (c == '.' && p + 1 < e && is_digit(p[1]))) {
+                bool hex = c == '0' && p + 1 < e && (p[1] == 'x' || p[1] == 'X');
+                while (p < e) {
+                    char d = *p;
+                    if (is_name_char(d) || d == '.') {
+                        ++p;
+                    } else if ((d == '-' || d == '+') && !hex && (p[-1] == 'e' || p[-1] == 'E')) {
+                        ++p;
+                    } else {
+                        break;
+                    }
+                }
+                f.pos = static_cast<size_t>(p - begin);
+                return {Tok::Number, {start, static_cast<size_t>(p - start)}, space};
+            }
+            if (c == '"' || c == '\'') {
+                // Quotes are escaped by doubling them.
+                std::string unescaped;
+                bool escaped = false;
+                ++p;
+                const char* seg = p;
+                for (;;) {
+                    const char* q = static_cast<const char*>(std::memchr(p, c, static_cast<size_t>(e - p)));
+                    if (!q) {
+                        f.pos = static_cast<size_t>(start - begin);
+                        fail("unterminated string");
+                    }
+                    if (q + 1 < e && q[1] == c) {
+                        unescaped.append(seg, static_cast<size_t>(q - seg) + 1);
+                        escaped = true;
+                        p = seg = q + 2;
+                        continue;
+                    }
+                    f.pos = static_cast<size_t>(q + 1 - begin);
+                    if (!escaped) return {Tok::String, {seg, static_cast<size_t>(q - seg)}, space};
+                    unescaped.append(seg, static_cast<size_t>(q - seg));
+                    return {Tok::String, store(std::move(unescaped)), space};
+                }
+            }
+            f.pos = static_cast<size_t>(p + 1 - begin);
+            return {Tok::Punct, {start, 1}, space};
+        }
+    }
+
+    Token next() {
+        if (peeked_) {
+            Token t = *peeked_;
+            peeked_.reset();
+            return t;
+        }
+        return lex();
+    }
+
+    const Token& peek() {
+        if (!peeked_) peeked_ = lex();
+        return *peeked_;
+    }
+
+    std::string describe(const Token& t) const {
+        switch (t.type) {
+            case Tok::End: return "end of file";
+            case Tok::String: return std::format("string \"{}\"", t.text);
+            default: return std::format("'{}'", t.text);
+        }
+    }
+
+    void expect(char c) {
+        Token t = next();
+        if (!t.is(c)) fail(std::format("expected '{}', got {}", c, describe(t)));
+    }
+
+    std::string_view expect_name(const char* what) {
+        Token t = next();
+        if (t.type != Tok::Name && t.type != Tok::Number) fail(std::format("expected {}, got {}", what, describe(t)));
+        return t.text;
+    }
+
+    // --- Parser ---
+
+    struct Scalar {
+        enum class Kind : uint8_t { String, Int, Float } kind = Kind::String;
+        std::string text;
+        int32_t int_value = 0;
+        float float_value = 0;
+    };
+
+    static bool parse_number(std::string_view s, bool negative, Scalar& out) {
+        if (s.empty()) return false;
+        const char* b = s.data();
+        const char* e = b + s.size();
+        if (s.size() > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+            uint32_t v = 0;
+            auto [ptr, ec] = std::from_chars(b + 2, e, v, 16);
+            if (ec != std::errc{} || ptr != e) return false;
+            out.kind = Scalar::Kind::Int;
+            out.int_value = negative ? -static_cast<int32_t>(v) : static_cast<int32_t>(v);
+            return true;
+        }
+        int64_t iv = 0;
+        auto [iptr, iec] = std::from_chars(b, e, iv);
+        if (iec == std::errc{} && iptr == e) {
+            if (negative) iv = -iv;
+            if (iv >= INT32_MIN && iv <= INT32_MAX) {
+                out.kind = Scalar::Kind::Int;
+                out.int_value = static_cast<int32_t>(iv);
+                return true;
+            }
+        }
+        float fv = 0;
+        auto [fptr, fec] = std::from_chars(b, e, fv);
+        if (fec != std::errc{} || fptr != e) return false;
+        out.kind = Scalar::Kind::Float;
+        out.float_value = negative ? -fv : fv;
+        return true;
+    }
+
+    // scalar reads a value up to one of the stop characters (not consumed).
+    // A lone string or number keeps its type; anything else (expressions,
+    // unquoted words) becomes the string of its tokens, like the engine's
+    // treatment of unquoted values.
+    Scalar scalar(const char* stops) {
+        Scalar out;
+        std::vector<Token> toks;
+        int depth = 0;
+        for (;;) {
+            const Token& t = peek();
+            if (t.type == Tok::End) break;
+            if (t.type == Tok::Punct && depth == 0 && std::strchr(stops, t.text[0])) break;
+            if (t.is('(') || t.is('[')) ++depth;
+            if ((t.is(')') || t.is(']')) && depth > 0) --depth;
+            toks.push_back(next());
+        }
+        if (toks.size() == 1 && toks[0].type == Tok::String) {
+            out.text = std::string(toks[0].text);
+            return out;
+        }
+        if (toks.size() == 1 && toks[0].type == Tok::Number && parse_number(toks[0].text, false, out)) return out;
+        if (toks.size() == 2 && (toks[0].is('-') || toks[0].is('+')) && toks[1].type == Tok::Number &&
+            parse_number(toks[1].text, toks[0].is('-'), out))
+            return out;
+        for (size_t i = 0; i < toks.size(); ++i) {
+            if (i > 0 && toks[i].space_before) out.text += ' ';
+            if (toks[i].type == Tok::String) {
+                out.text += '"';
+                out.text += toks[i].text;
+                out.text += '"';
+            } else {
+                out.text += toks[i].text;
+            }
+        }
+        return out;
+    }
+
+    std::vector<ArrayElement> array_elements() {
+        std::vector<ArrayElement> elements;
+        for (;;) {
+            if (peek().is('}')) {
+                next();
+                return elements;
+            }
+            if (peek().is('{')) {
+                next();
+                elements.push_back(NestedArrayEntry{false, array_elements()});
+            } else {
+                if (peek().type == Tok::End) fail("unterminated array");
+                Scalar s = scalar(",}");
+                switch (s.kind) {
+                    case Scalar::Kind::String: elements.push_back(StringElement{std::move(s.text)}); break;
+                    case Scalar::Kind::Int: elements.push_back(IntElement{s.int_value}); break;
+                    case Scalar::Kind::Float: elements.push_back(FloatElement{s.float_value}); break;
+                }
+            }
+            Token sep = next();
+            if (sep.is('}')) return elements;
+            if (!sep.is(',')) fail(std::format("expected ',' or '}}' in array, got {}", describe(sep)));
+        }
+    }
+
+    // end_statement consumes the ';' after an entry. A missing ';' before
+    // '}' is tolerated, as the engine does.
+    void end_statement() {
+        if (peek().is(';')) {
+            next();
+        } else if (!peek().is('}')) {
+            fail(std::format("expected ';', got {}", describe(peek())));
+        }
+    }
+
+    void parse_body(ConfigClass& cls, bool root) {
+        for (;;) {
+            Token t = next();
+            if (t.type == Tok::End) {
+                if (!root) fail("unexpected end of file inside class");
+                if (cond_depth_ != 0) fail("unterminated #if");
+                return;
+            }
+            if (t.is('}')) {
+                if (root) fail("unexpected '}'");
+                if (peek().is(';')) next();
+                return;
+            }
+            if (t.is(';')) continue;
+            if (t.type != Tok::Name && t.type != Tok::Number) fail(std::format("unexpected {}", describe(t)));
+
+            if (t.text == "class") {
+                std::string name(expect_name("class name"));
+                auto child = std::make_unique<ConfigClass>();
+                Token n = next();
+                if (n.is(':')) {
+                    child->parent = std::string(expect_name("parent class name"));
+                    n = next();
+                }
+                if (n.is('{')) {
+                    parse_body(*child, false);
+                } else if (n.is(';')) {
+                    child->external = child->parent.empty();
+                } else {
+                    fail(std::format("expected '{{' or ';' after class {}, got {}", name, describe(n)));
+                }
+                cls.entries.push_back({std::move(name), ClassEntryOwned{std::move(child)}});
+            } else if (t.text == "delete") {
+                std::string name(expect_name("class name"));
+                auto child = std::make_unique<ConfigClass>();
+                child->deletion = true;
+                cls.entries.push_back({std::move(name), ClassEntryOwned{std::move(child)}});
+                end_statement();
+            } else if (t.text == "enum") {
+                expect('{');
+                for (int depth = 1; depth > 0;) {
+                    Token s = next();
+                    if (s.type == Tok::End) fail("unterminated enum");
+                    if (s.is('{')) ++depth;
+                    if (s.is('}')) --depth;
+                }
+                end_statement();
+            } else {
+                std::string name(t.text);
+                Token n = next();
+                if (n.is('[')) {
+                    expect(']');
+                    ArrayEntry arr;
+                    Token op = next();
+                    if (op.is('+')) {
+                        expect('=');
+                        arr.expansion = true;
+                    } else if (!op.is('=')) {
+                        fail(std::format("expected '=' or '+=' after {}[], got {}", name, describe(op)));
+                    }
+                    expect('{');
+                    arr.elements = array_elements();
+                    cls.entries.push_back({std::move(name), std::move(arr)});
+                } else if (n.is('=')) {
+                    Scalar s = scalar(";}");
+                    switch (s.kind) {
+                        case Scalar::Kind::String: cls.entries.push_back({std::move(name), StringEntry{std::move(s.text)}}); break;
+                        case Scalar::Kind::Int: cls.entries.push_back({std::move(name), IntEntry{s.int_value}}); break;
+                        case Scalar::Kind::Float: cls.entries.push_back({std::move(name), FloatEntry{s.float_value}}); break;
+                    }
+                } else {
+                    fail(std::format("expected '=' after {}, got {}", name, describe(n)));
+                }
+                end_statement();
+            }
+        }
+    }
+};
+
+} // namespace
+
+Config parse_text(std::string_view src, const TextOptions& opts) {
+    return TextParser(src, {}, opts).parse();
+}
 
 Config parse_text(std::istream& r) {
-    std::ostringstream buf;
-    buf << r.rdbuf();
-    std::string src = buf.str();
-
-    // Strip UTF-8 BOM
-    if (src.starts_with("\xef\xbb\xbf")) src = src.substr(3);
-
-    // The full text parser is complex (~550 lines in Go). For now, provide a
-    // minimal implementation that handles the most common patterns.
-    // A complete port would replicate the recursive descent parser from parse.go.
-    // TODO: Full text parser implementation
-    (void)src;
-    return Config{};
+    std::string src(std::istreambuf_iterator<char>(r), {});
+    return parse_text(src);
+}
+
+Config parse_text_file(const std::filesystem::path& path, const TextOptions& opts) {
+    auto read_file = [](const std::filesystem::path& p) -> std::optional<std::string> {
+        std::ifstream f(p, std::ios::binary);
+        if (!f) return std::nullopt;
+        return std::string(std::istreambuf_iterator<char>(f), {});
+    };
+    auto src = read_file(path);
+    if (!src) throw std::runtime_error(std::format("config: cannot open {}", path.string()));
+
+    TextOptions file_opts = opts;
+    if (!file_opts.include) {
+        // Resolve relative to the including file; game paths use backslashes.
+        file_opts.include = [&](const std::string& target, const std::string& from) -> std::optional<IncludedText> {
+            std::string rel = target;
+            std::replace(rel.begin(), rel.end(), '\\', '/');
+            auto base = std::filesystem::path(from).parent_path();
+            auto resolved = base / std::filesystem::path(rel).relative_path();
+            auto text = read_file(resolved);
+            if (!text) return std::nullopt;
+            return IncludedText{resolved.string(), std::move(*text)};
+        };
+    }
+    return TextParser(*src, path.string(), file_opts).parse();
 }
 
 } // namespace armatools::config
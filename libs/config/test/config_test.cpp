@@ -0,0 +1,386 @@
+#include "armatools/config.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace armatools::config;
+
+namespace {
+
+// --- Minimal rapifier for building test inputs ---
+
+void put_u8(std::vector<uint8_t>& out, uint8_t v) { out.push_back(v); }
+
+void put_u32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; i++) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+template <typename T> void put_raw(std::vector<uint8_t>& out, T v) {
+    uint8_t buf[sizeof(T)];
+    std::memcpy(buf, &v, sizeof(T));
+    out.insert(out.end(), buf, buf + sizeof(T));
+}
+
+void put_str(std::vector<uint8_t>& out, const std::string& s) {
+    out.insert(out.end(), s.begin(), s.end());
+    out.push_back(0);
+}
+
+void put_cint(std::vector<uint8_t>& out, uint32_t v) {
+    do {
+        uint8_t b = v & 0x7F;
+        v >>= 7;
+        if (v) b |= 0x80;
+        out.push_back(b);
+    } while (v);
+}
+
+void put_elements(std::vector<uint8_t>& out, const std::vector<ArrayElement>& elements) {
+    put_cint(out, static_cast<uint32_t>(elements.size()));
+    for (const auto& el : elements) {
+        if (auto* s = std::get_if<StringElement>(&el)) { put_u8(out, 0); put_str(out, s->value); }
+        else if (auto* f = std::get_if<FloatElement>(&el)) { put_u8(out, 1); put_raw(out, f->value); }
+        else if (auto* i = std::get_if<IntElement>(&el)) { put_u8(out, 2); put_raw(out, i->value); }
+        else if (auto* n = std::get_if<NestedArrayEntry>(&el)) { put_u8(out, 3); put_elements(out, n->elements); }
+    }
+}
+
+// Writes the body of cls at the end of out, then the bodies of its child
+// classes, patching their offsets (the layout the game tools produce).
+void put_class(std::vector<uint8_t>& out, const ConfigClass& cls) {
+    std::vector<std::pair<size_t, const ConfigClass*>> children;
+    put_str(out, cls.parent);
+    put_cint(out, static_cast<uint32_t>(cls.entries.size()));
+    for (const auto& ne : cls.entries) {
+        if (auto* c = std::get_if<ClassEntryOwned>(&ne.entry)) {
+            if (c->cls->external) { put_u8(out, 3); put_str(out, ne.name); }
+            else if (c->cls->deletion) { put_u8(out, 4); put_str(out, ne.name); }
+            else {
+                put_u8(out, 0);
+                put_str(out, ne.name);
+                children.emplace_back(out.size(), c->cls.get());
+                put_u32(out, 0);
+            }
+        } else if (auto* s = std::get_if<StringEntry>(&ne.entry)) {
+            put_u8(out, 1); put_u8(out, 0); put_str(out, ne.name); put_str(out, s->value);
+        } else if (auto* f = std::get_if<FloatEntry>(&ne.entry)) {
+            put_u8(out, 1); put_u8(out, 1); put_str(out, ne.name); put_raw(out, f->value);
+        } else if (auto* i = std::get_if<IntEntry>(&ne.entry)) {
+            put_u8(out, 1); put_u8(out, 2); put_str(out, ne.name); put_raw(out, i->value);
+        } else if (auto* a = std::get_if<ArrayEntry>(&ne.entry)) {
+            if (a->expansion) { put_u8(out, 5); put_u32(out, 1); }
+            else put_u8(out, 2);
+            put_str(out, ne.name);
+            put_elements(out, a->elements);
+        }
+    }
+    for (auto [at, child] : children) {
+        auto offset = static_cast<uint32_t>(out.size());
+        std::memcpy(out.data() + at, &offset, 4);
+        put_class(out, *child);
+    }
+}
+
+std::vector<uint8_t> rapify(const ConfigClass& root) {
+    std::vector<uint8_t> out = {0, 'r', 'a', 'P'};
+    put_u32(out, 0);
+    put_u32(out, 8);
+    put_u32(out, 0); // enum offset, patched below
+    put_class(out, root);
+    auto enum_offset = static_cast<uint32_t>(out.size());
+    std::memcpy(out.data() + 12, &enum_offset, 4);
+    put_u32(out, 0);
+    return out;
+}
+
+std::unique_ptr<ConfigClass> make_class(std::string parent = {}) {
+    auto c = std::make_unique<ConfigClass>();
+    c->parent = std::move(parent);
+    return c;
+}
+
+ConfigClass sample_root() {
+    ConfigClass root;
+    auto vehicles = make_class();
+    vehicles->entries.push_back({"Car", ClassEntryOwned{make_class()}});
+    vehicles->entries.push_back({"Land", ClassEntryOwned{[] { auto c = make_class(); c->external = true; return c; }()}});
+    auto offroad = make_class("Car");
+    offroad->entries.push_back({"displayName", StringEntry{"Offroad \"HMG\""}});
+    offroad->entries.push_back({"model", StringEntry{"\\a3\\soft_f\\offroad_01\\offroad_01_unarmed_f"}});
+    offroad->entries.push_back({"maxSpeed", IntEntry{130}});
+    offroad->entries.push_back({"armor", FloatEntry{40.5f}});
+    ArrayEntry hidden;
+    hidden.elements.push_back(StringElement{"camo"});
+    hidden.elements.push_back(NestedArrayEntry{false, {IntElement{1}, FloatElement{0.5f}}});
+    offroad->entries.push_back({"hiddenSelections", std::move(hidden)});
+    ArrayEntry extra;
+    extra.expansion = true;
+    extra.elements.push_back(IntElement{7});
+    offroad->entries.push_back({"extra", std::move(extra)});
+    offroad->entries.push_back({"Turrets", ClassEntryOwned{make_class()}});
+    vehicles->entries.push_back({"C_Offroad_01_F", ClassEntryOwned{std::move(offroad)}});
+    vehicles->entries.push_back({"Old", ClassEntryOwned{[] { auto c = make_class(); c->deletion = true; return c; }()}});
+    root.entries.push_back({"CfgPatches", ClassEntryOwned{make_class()}});
+    root.entries.push_back({"CfgVehicles", ClassEntryOwned{std::move(vehicles)}});
+    root.entries.push_back({"version", IntEntry{3}});
+    return root;
+}
+
+std::string to_text(const Config& cfg) {
+    std::ostringstream out;
+    write_text(out, cfg);
+    return out.str();
+}
+
+} // namespace
+
+TEST(ConfigView, LooksUpClassesAndValues) {
+    ConfigView view(rapify(sample_root()));
+    auto offroad = view.find_class("CfgVehicles/C_Offroad_01_F");
+    ASSERT_TRUE(offroad);
+    EXPECT_EQ(offroad.parent(), "Car");
+    EXPECT_EQ(offroad.find_string("displayName"), "Offroad \"HMG\"");
+    EXPECT_EQ(offroad.find_string("DISPLAYNAME"), "Offroad \"HMG\"");
+    EXPECT_EQ(offroad.find_int("maxSpeed"), 130);
+    EXPECT_EQ(offroad.find_float("armor"), 40.5f);
+    EXPECT_EQ(offroad.find_float("maxSpeed"), 130.0f);
+    EXPECT_FALSE(offroad.find_int("armor"));
+    EXPECT_FALSE(offroad.find_string("missing"));
+
+    auto hidden = offroad.find_array("hiddenSelections");
+    ASSERT_TRUE(hidden);
+    EXPECT_FALSE(hidden->expansion());
+    auto elements = hidden->elements();
+    ASSERT_EQ(elements.size(), 2u);
+    EXPECT_EQ(elements[0].string, "camo");
+    ASSERT_EQ(elements[1].type, ArrayView::Element::Type::Array);
+    auto nested = elements[1].array.elements();
+    ASSERT_EQ(nested.size(), 2u);
+    EXPECT_EQ(nested[0].int_value, 1);
+    EXPECT_EQ(nested[1].float_value, 0.5f);
+    EXPECT_TRUE(offroad.find_array("extra")->expansion());
+
+    EXPECT_TRUE(view.find_class("cfgvehicles/car"));
+    EXPECT_FALSE(view.find_class("CfgVehicles/Land")); // external
+    EXPECT_FALSE(view.find_class("CfgVehicles/Old"));  // delete
+    EXPECT_FALSE(view.find_class("CfgVehicles/Nope"));
+    EXPECT_FALSE(view.find_class("CfgVehicles/C_Offroad_01_F/maxSpeed")); // not a class
+}
+
+TEST(ConfigView, EntriesKeepFileOrderAndKinds) {
+    ConfigView view(rapify(sample_root()));
+    auto vehicles = view.root().find_class("CfgVehicles");
+    auto entries = vehicles.entries();
+    ASSERT_EQ(entries.size(), 4u);
+    EXPECT_EQ(entries[0].name, "Car");
+    EXPECT_EQ(entries[0].kind, EntryKind::Class);
+    EXPECT_EQ(entries[1].kind, EntryKind::External);
+    EXPECT_EQ(entries[3].kind, EntryKind::Delete);
+    // Visiting the same class twice returns the cached body.
+    EXPECT_EQ(view.find_class("CfgVehicles").entries().data(), entries.data());
+}
+
+TEST(ConfigView, MaterializeMatchesRead) {
+    auto bytes = rapify(sample_root());
+    std::istringstream in(std::string(bytes.begin(), bytes.end()));
+    Config eager = read(in);
+
+    ConfigView view(bytes);
+    Config lazy;
+    lazy.root = view.root().materialize();
+    EXPECT_EQ(to_text(lazy), to_text(eager));
+    EXPECT_NE(to_text(lazy).find("C_Offroad_01_F: Car"), std::string::npos);
+}
+
+TEST(ConfigView, OpenMapsFile) {
+    auto path = std::filesystem::temp_directory_path() / "armatools_config_view_test.bin";
+    auto bytes = rapify(sample_root());
+    {
+        std::ofstream f(path, std::ios::binary);
+        f.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+    {
+        auto view = ConfigView::open(path);
+        ConfigView moved = std::move(view);
+        EXPECT_EQ(moved.find_class("CfgVehicles/C_Offroad_01_F").find_int("maxSpeed"), 130);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(ConfigView, RejectsBadInput) {
+    EXPECT_THROW(ConfigView(std::vector<uint8_t>{'n', 'o', 'p', 'e'}), std::runtime_error);
+
+    auto bytes = rapify(sample_root());
+    bytes.resize(40); // cut inside the root body
+    ConfigView view(bytes);
+    EXPECT_THROW(view.root(), std::runtime_error);
+}
+
+// --- Text parser ---
+
+namespace {
+
+const ConfigClass& child(const ConfigClass& cls, std::string_view name) {
+    for (const auto& ne : cls.entries) {
+        if (ne.name != name) continue;
+        if (auto* c = std::get_if<ClassEntryOwned>(&ne.entry)) return *c->cls;
+    }
+    throw std::runtime_error("no class " + std::string(name));
+}
+
+const Entry& entry(const ConfigClass& cls, std::string_view name) {
+    for (const auto& ne : cls.entries) {
+        if (ne.name == name) return ne.entry;
+    }
+    throw std::runtime_error("no entry " + std::string(name));
+}
+
+} // namespace
+
+TEST(ParseText, ClassesAndValues) {
+    auto cfg = parse_text(R"(
+        // line comment
+        class CfgPatches { class Test { units[] = {}; requiredVersion = 0.1; }; };
+        class Land;
+        class Car: Land { /* block
+            comment */ };
+        class CfgVehicles {
+            delete Old;
+            class Offroad: Car {
+                displayName = "Offroad ""HMG""";
+                model = "\a3\soft_f\offroad";
+                maxSpeed = 130;
+                offset = -2;
+                mask = 0x10;
+                armor = 40.5;
+                scale = 1e3;
+                weight = 2 * 3;
+                side = TEast;
+                hiddenSelections[] = {"camo", {1, -0.5}, 3,};
+                extra[] += {7};
+            };
+        };
+        enum { destructNo, destructBuilding = 1 };
+    )");
+    const auto& vehicles = child(cfg.root, "CfgVehicles");
+    EXPECT_TRUE(child(vehicles, "Old").deletion);
+    EXPECT_TRUE(child(cfg.root, "Land").external);
+    EXPECT_EQ(child(cfg.root, "Car").parent, "Land");
+
+    const auto& offroad = child(vehicles, "Offroad");
+    EXPECT_EQ(offroad.parent, "Car");
+    EXPECT_EQ(std::get<StringEntry>(entry(offroad, "displayName")).value, "Offroad \"HMG\"");
+    EXPECT_EQ(std::get<StringEntry>(entry(offroad, "model")).value, "\\a3\\soft_f\\offroad");
+    EXPECT_EQ(std::get<IntEntry>(entry(offroad, "maxSpeed")).value, 130);
+    EXPECT_EQ(std::get<IntEntry>(entry(offroad, "offset")).value, -2);
+    EXPECT_EQ(std::get<IntEntry>(entry(offroad, "mask")).value, 16);
+    EXPECT_EQ(std::get<FloatEntry>(entry(offroad, "armor")).value, 40.5f);
+    EXPECT_EQ(std::get<FloatEntry>(entry(offroad, "scale")).value, 1000.0f);
+    EXPECT_EQ(std::get<StringEntry>(entry(offroad, "weight")).value, "2 * 3");
+    EXPECT_EQ(std::get<StringEntry>(entry(offroad, "side")).value, "TEast");
+
+    const auto& hidden = std::get<ArrayEntry>(entry(offroad, "hiddenSelections"));
+    EXPECT_FALSE(hidden.expansion);
+    ASSERT_EQ(hidden.elements.size(), 3u);
+    EXPECT_EQ(std::get<StringElement>(hidden.elements[0]).value, "camo");
+    const auto& nested = std::get<NestedArrayEntry>(hidden.elements[1]);
+    EXPECT_EQ(std::get<IntElement>(nested.elements[0]).value, 1);
+    EXPECT_EQ(std::get<FloatElement>(nested.elements[1]).value, -0.5f);
+    EXPECT_TRUE(std::get<ArrayEntry>(entry(offroad, "extra")).expansion);
+    EXPECT_TRUE(std::get<ArrayEntry>(entry(child(child(cfg.root, "CfgPatches"), "Test"), "units")).elements.empty());
+}
+
+TEST(ParseText, Preprocessor) {
+    TextOptions opts;
+    opts.defines = {{"PREDEFINED", "1"}};
+    auto cfg = parse_text(R"(
+#define SPEED 120
+#define QUOTE(x) #x
+#define CLASS(name) class Cfg##name
+#define LONG_MACRO(a, b) \
+    a = b
+#ifdef SPEED
+speed = SPEED;
+#else
+speed = 0;
+#endif
+#ifndef SPEED
+broken = 1;
+#endif
+#if PREDEFINED
+#if 0
+nested = 1;
+#endif
+predefined = 1;
+#endif
+#undef SPEED
+#ifdef SPEED
+undef = 0;
+#endif
+CLASS(Weapons) { name = QUOTE(rifle); };
+LONG_MACRO(joined, 5);
+)", opts);
+    EXPECT_EQ(std::get<IntEntry>(entry(cfg.root, "speed")).value, 120);
+    EXPECT_EQ(std::get<IntEntry>(entry(cfg.root, "predefined")).value, 1);
+    EXPECT_EQ(std::get<IntEntry>(entry(cfg.root, "joined")).value, 5);
+    EXPECT_EQ(std::get<StringEntry>(entry(child(cfg.root, "CfgWeapons"), "name")).value, "rifle");
+    for (const char* name : {"broken", "nested", "undef"}) {
+        EXPECT_THROW(entry(cfg.root, name), std::runtime_error) << name;
+    }
+}
+
+TEST(ParseText, Includes) {
+    TextOptions opts;
+    std::vector<std::string> seen;
+    opts.include = [&](const std::string& target, const std::string& from) -> std::optional<IncludedText> {
+        seen.push_back(from + ">" + target);
+        if (target == "macros.hpp") return IncludedText{"macros.hpp", "#define VALUE 42\n#include \"inner.hpp\"\n"};
+        if (target == "inner.hpp") return IncludedText{"inner.hpp", "inner = 1;\n"};
+        return std::nullopt;
+    };
+    auto cfg = parse_text("#include \"macros.hpp\"\nvalue = VALUE;\n", opts);
+    EXPECT_EQ(std::get<IntEntry>(entry(cfg.root, "value")).value, 42);
+    EXPECT_EQ(std::get<IntEntry>(entry(cfg.root, "inner")).value, 1);
+    EXPECT_EQ(seen, (std::vector<std::string>{">macros.hpp", "macros.hpp>inner.hpp"}));
+
+    EXPECT_THROW(parse_text("#include \"missing.hpp\"\n", opts), std::runtime_error);
+    // Without a resolver includes are skipped.
+    EXPECT_NO_THROW(parse_text("#include \"missing.hpp\"\nx = 1;\n"));
+}
+
+TEST(ParseText, IncludesFromDisk) {
+    auto dir = std::filesystem::temp_directory_path() / "armatools_parse_text_test";
+    std::filesystem::create_directories(dir / "sub");
+    std::ofstream(dir / "config.cpp") << "#include \"sub\\defs.hpp\"\nclass CfgTest { v = DEF; };\n";
+    std::ofstream(dir / "sub" / "defs.hpp") << "#define DEF 3\n";
+    auto cfg = parse_text_file(dir / "config.cpp");
+    EXPECT_EQ(std::get<IntEntry>(entry(child(cfg.root, "CfgTest"), "v")).value, 3);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ParseText, ReportsLine) {
+    try {
+        parse_text("class A {\n  x = 1;\n  y 2;\n};\n");
+        FAIL() << "expected an error";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find("line 3"), std::string::npos) << e.what();
+    }
+    EXPECT_THROW(parse_text("class A { x = 1;"), std::runtime_error);
+    EXPECT_THROW(parse_text("x = \"open;"), std::runtime_error);
+    EXPECT_THROW(parse_text("#ifdef A\nx = 1;\n"), std::runtime_error);
+    EXPECT_THROW(parse_text("}"), std::runtime_error);
+}
+
+TEST(ParseText, RoundTripsWriteText) {
+    Config cfg;
+    cfg.root = sample_root();
+    std::string text = to_text(cfg);
+    EXPECT_EQ(to_text(parse_text(text)), text);
+
+    std::istringstream in("\xef\xbb\xbfvalue = 1;\n");
+    EXPECT_EQ(std::get<IntEntry>(entry(parse_text(in).root, "value")).value, 1);
+}
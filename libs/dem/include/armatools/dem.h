@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+namespace armatools::dem {
+
+// Grid is a read-only view of a row-major elevation grid in meters. Row 0
+// is the southern edge, as in WRP files; the writers flip it where a
+// format stores the northern row first.
+struct Grid {
+    const float* data = nullptr;
+    int width = 0;
+    int height = 0;
+    double cell_size = 1;
+    double origin_x = 0; // world X of column 0
+    double origin_y = 0; // world Y of row 0
+};
+
+struct TextOptions {
+    int decimals = 4;         // fixed decimals for elevations; -1 = shortest round-trip
+    int threads = 0;          // formatting threads; 0 = all cores
+    int rows_per_chunk = 0;   // rows formatted per task; 0 = about 1 MiB of text
+};
+
+// write_asc writes an ESRI ASCII grid, northern row first.
+//
+// Rows are formatted with std::to_chars into per-chunk buffers on worker
+// threads and written in order with one write per chunk; only a few chunks
+// per thread are held at once.
+void write_asc(std::ostream& w, const Grid& g, const TextOptions& opts = {});
+
+// write_xyz writes one "X Y Z" line per cell, southern row first. X and Y
+// have two decimals; Z uses opts.decimals.
+void write_xyz(std::ostream& w, const Grid& g, const TextOptions& opts = {});
+
+// write_raw writes little-endian float32 samples, northern row first, with
+// no header.
+void write_raw(std::ostream& w, const Grid& g);
+
+enum class SampleType { Float32, UInt16 };
+enum class Compression { None, Deflate, LZW };
+
+struct TiffOptions {
+    SampleType sample = SampleType::Float32;
+    double min_value = 0;             // UInt16: elevation stored as 0
+    double max_value = 1;             // UInt16: elevation stored as 65535
+    Compression compression = Compression::None;
+    int level = 6;                    // deflate level, 1-9
+    bool predictor = true;            // compressed only: horizontal (UInt16) or floating-point (Float32) predictor
+    int rows_per_strip = 0;           // 0 = 16 when compressed, about 1 MiB per strip otherwise
+    int threads = 0;                  // compression threads; 0 = all cores
+};
+
+// parse_compression maps "none", "deflate" or "lzw" to a Compression.
+// Throws std::invalid_argument for other names.
+Compression parse_compression(const std::string& name);
+
+// write_geotiff writes a single-band GeoTIFF, northern row first, with
+// ModelPixelScale/ModelTiepoint placing the grid at its origin. Strips are
+// compressed in parallel and written in order; the IFD follows the pixel
+// data, so w must be seekable. Throws std::runtime_error if the file would
+// exceed the 4 GiB classic TIFF limit.
+void write_geotiff(std::ostream& w, const Grid& g, const TiffOptions& opts = {});
+
+} // namespace armatools::dem
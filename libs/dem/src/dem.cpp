@@ -0,0 +1,463 @@
+#include "armatools/dem.h"
+#include "armatools/parallel.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace armatools::dem {
+
+namespace {
+
+constexpr size_t default_chunk_bytes = 1024 * 1024;
+
+// ordered_chunks calls produce(i, buf) for every i < count on worker
+// threads and consume(buf) on the calling thread in index order. Buffers
+// are reused and cleared before each produce call.
+template <class Produce, class Consume>
+void ordered_chunks(size_t count, int threads, const Produce& produce, const Consume& consume) {
+    binutil::ordered_for<std::vector<char>>(
+        count, binutil::worker_count(threads),
+        [&](size_t i, std::vector<char>& buf) {
+            buf.clear();
+            produce(i, buf);
+        },
+        [&](size_t, std::vector<char>& buf) { consume(buf); });
+}
+
+void write_buf(std::ostream& w, const std::vector<char>& buf) {
+    w.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+    if (!w) throw std::runtime_error("dem: write failed");
+}
+
+void check_grid(const Grid& g) {
+    if (!g.data || g.width <= 0 || g.height <= 0) throw std::invalid_argument("dem: empty grid");
+}
+
+const float* row_ptr(const Grid& g, int row) {
+    return g.data + static_cast<size_t>(row) * static_cast<size_t>(g.width);
+}
+
+// Number formatting. Fixed precision formats the exact binary value, so
+// the output matches std::format("{:.Nf}") for the same type.
+
+template <class T>
+void append_fixed(std::vector<char>& out, T v, int decimals) {
+    char tmp[128];
+    auto r = decimals < 0 ? std::to_chars(tmp, tmp + sizeof(tmp), v)
+                          : std::to_chars(tmp, tmp + sizeof(tmp), v, std::chars_format::fixed, decimals);
+    out.insert(out.end(), tmp, r.ptr);
+}
+
+void append_int(std::vector<char>& out, int v) {
+    char tmp[16];
+    auto r = std::to_chars(tmp, tmp + sizeof(tmp), v);
+    out.insert(out.end(), tmp, r.ptr);
+}
+
+int clamp_decimals(int decimals) { return decimals < 0 ? -1 : std::min(decimals, 17); }
+
+size_t text_chunk_rows(const TextOptions& opts, const Grid& g, size_t bytes_per_value) {
+    if (opts.rows_per_chunk > 0) return static_cast<size_t>(opts.rows_per_chunk);
+    size_t row_bytes = static_cast<size_t>(g.width) * bytes_per_value;
+    return std::max<size_t>(1, default_chunk_bytes / row_bytes);
+}
+
+void append_line(std::vector<char>& out, std::string_view s) { out.insert(out.end(), s.begin(), s.end()); }
+
+// TIFF writing.
+
+constexpr uint16_t tag_image_width = 256;
+constexpr uint16_t tag_image_length = 257;
+constexpr uint16_t tag_bits_per_sample = 258;
+constexpr uint16_t tag_compression = 259;
+constexpr uint16_t tag_photometric = 262;
+constexpr uint16_t tag_strip_offsets = 273;
+constexpr uint16_t tag_samples_per_pixel = 277;
+constexpr uint16_t tag_rows_per_strip = 278;
+constexpr uint16_t tag_strip_byte_counts = 279;
+constexpr uint16_t tag_predictor = 317;
+constexpr uint16_t tag_sample_format = 339;
+constexpr uint16_t tag_model_pixel_scale = 33550;
+constexpr uint16_t tag_model_tiepoint = 33922;
+constexpr uint16_t tag_geo_key_directory = 34735;
+
+constexpr uint16_t dt_short = 3;
+constexpr uint16_t dt_long = 4;
+constexpr uint16_t dt_double = 12;
+
+template <class T>
+void put_le(std::vector<char>& out, T v) {
+    char b[sizeof(T)];
+    std::memcpy(b, &v, sizeof(T));
+    out.insert(out.end(), b, b + sizeof(T));
+}
+
+void put_le_f64(std::vector<char>& out, double v) { put_le(out, std::bit_cast<uint64_t>(v)); }
+
+void put_tag(std::vector<char>& out, uint16_t tag, uint16_t dtype, uint32_t count, uint32_t value) {
+    put_le(out, tag);
+    put_le(out, dtype);
+    put_le(out, count);
+    if (dtype == dt_short && count == 1) {
+        put_le(out, static_cast<uint16_t>(value));
+        put_le(out, uint16_t{0});
+    } else {
+        put_le(out, value);
+    }
+}
+
+// lzw_encode appends data as a TIFF LZW stream: MSB-first codes of 9 to 12
+// bits, widened one code early as readers expect, with a Clear code when
+// the table fills.
+void lzw_encode(const uint8_t* data, size_t size, std::vector<char>& out) {
+    constexpr uint32_t clear_code = 256;
+    constexpr uint32_t eoi_code = 257;
+    constexpr uint32_t first_code = 258;
+    constexpr uint32_t max_code = 4094;
+    constexpr size_t table_size = 1 << 13; // open addressing, > 4096 entries
+
+    std::vector<uint32_t> keys(table_size);
+    std::vector<uint16_t> codes(table_size);
+    uint32_t next_code = first_code;
+    int width = 9;
+    uint32_t bit_buf = 0;
+    int bit_count = 0;
+
+    auto emit = [&](uint32_t code) {
+        bit_buf = (bit_buf << width) | code;
+        bit_count += width;
+        while (bit_count >= 8) {
+            bit_count -= 8;
+            out.push_back(static_cast<char>(bit_buf >> bit_count));
+        }
+    };
+    auto reset = [&] {
+        std::fill(keys.begin(), keys.end(), 0u);
+        next_code = first_code;
+        width = 9;
+    };
+
+    emit(clear_code);
+    if (size > 0) {
+        reset();
+        uint32_t prefix = data[0];
+        for (size_t i = 1; i < size; i++) {
+            uint32_t key = ((prefix << 8) | data[i]) + 1; // 0 marks an empty slot
+            size_t h = (key * 2654435761u) >> 19;
+            while (keys[h] != 0 && keys[h] != key) h = (h + 1) & (table_size - 1);
+            if (keys[h] == key) {
+                prefix = codes[h];
+                continue;
+            }
+            emit(prefix);
+            keys[h] = key;
+            codes[h] = static_cast<uint16_t>(next_code++);
+            if (next_code == max_code) {
+                emit(clear_code);
+                reset();
+            } else if (next_code > (1u << width) - 1) {
+                width++;
+            }
+            prefix = data[i];
+        }
+        emit(prefix);
+        // The decoder adds one more entry for the last code and widens
+        // one code early; follow it so that EOI is read at the right width.
+        if (++next_code == max_code) {
+            emit(clear_code);
+            width = 9;
+        } else if (next_code > (1u << width) - 1) {
+            width++;
+        }
+    }
+    emit(eoi_code);
+    if (bit_count > 0) out.push_back(static_cast<char>(bit_buf << (8 - bit_count)));
+}
+
+void deflate_encode(const uint8_t* data, size_t size, int level, std::vector<char>& out) {
+    uLongf len = compressBound(static_cast<uLong>(size));
+    out.resize(len);
+    int rc = compress2(reinterpret_cast<Bytef*>(out.data()), &len, data, static_cast<uLong>(size),
+                       std::clamp(level, 1, 9));
+    if (rc != Z_OK) throw std::runtime_error("dem: deflate failed");
+    out.resize(len);
+}
+
+struct StripEncoder {
+    const Grid& g;
+    const TiffOptions& opts;
+    size_t rows_per_strip;
+    size_t sample_bytes;
+    bool predictor;
+
+    // encode fills out with strip i: rows north first, converted to the
+    // sample type, run through the predictor and compressed.
+    void encode(size_t i, std::vector<char>& out) const {
+        size_t height = static_cast<size_t>(g.height);
+        size_t width = static_cast<size_t>(g.width);
+        size_t first = i * rows_per_strip;
+        size_t rows = std::min(rows_per_strip, height - first);
+        size_t row_bytes = width * sample_bytes;
+
+        std::vector<uint8_t> raw(rows * row_bytes);
+        std::vector<uint8_t> tmp(predictor ? row_bytes : 0);
+        double range = opts.max_value - opts.min_value;
+        if (range <= 0) range = 1;
+
+        for (size_t r = 0; r < rows; r++) {
+            const float* src = row_ptr(g, static_cast<int>(height - 1 - (first + r)));
+            uint8_t* dst = raw.data() + r * row_bytes;
+            if (opts.sample == SampleType::Float32) {
+                if (!predictor) {
+                    std::memcpy(dst, src, row_bytes);
+                    continue;
+                }
+                // Floating-point predictor: bytes of each sample split into
+                // planes, most significant first, then differenced.
+                std::memcpy(tmp.data(), src, row_bytes);
+                for (size_t x = 0; x < width; x++) {
+                    for (size_t b = 0; b < 4; b++) dst[(3 - b) * width + x] = tmp[x * 4 + b];
+                }
+                for (size_t k = row_bytes - 1; k > 0; k--) dst[k] = static_cast<uint8_t>(dst[k] - dst[k - 1]);
+            } else {
+                uint16_t prev = 0;
+                for (size_t x = 0; x < width; x++) {
+                    double norm = (static_cast<double>(src[x]) - opts.min_value) / range;
+                    norm = std::clamp(norm, 0.0, 1.0);
+                    auto v = static_cast<uint16_t>(norm * 65535);
+                    uint16_t s = predictor ? static_cast<uint16_t>(v - prev) : v;
+                    prev = v;
+                    std::memcpy(dst + x * 2, &s, 2);
+                }
+            }
+        }
+
+        switch (opts.compression) {
+        case Compression::None:
+            out.assign(raw.begin(), raw.end());
+            break;
+        case Compression::Deflate:
+            deflate_encode(raw.data(), raw.size(), opts.level, out);
+            break;
+        case Compression::LZW:
+            lzw_encode(raw.data(), raw.size(), out);
+            break;
+        }
+    }
+};
+
+} // namespace
+
+void write_asc(std::ostream& w, const Grid& g, const TextOptions& opts) {
+    check_grid(g);
+    int decimals = clamp_decimals(opts.decimals);
+
+    std::vector<char> header;
+    auto line = [&](std::string_view key, double v) {
+        append_line(header, key);
+        append_fixed(header, v, 6);
+        header.push_back('\n');
+    };
+    append_line(header, "ncols         ");
+    append_int(header, g.width);
+    append_line(header, "\nnrows         ");
+    append_int(header, g.height);
+    header.push_back('\n');
+    line("xllcorner     ", g.origin_x);
+    line("yllcorner     ", g.origin_y);
+    line("cellsize      ", g.cell_size);
+    append_line(header, "NODATA_value  -9999\n");
+    write_buf(w, header);
+
+    size_t height = static_cast<size_t>(g.height);
+    size_t width = static_cast<size_t>(g.width);
+    size_t chunk_rows = text_chunk_rows(opts, g, decimals < 0 ? 12 : static_cast<size_t>(decimals) + 6);
+    size_t chunks = (height + chunk_rows - 1) / chunk_rows;
+
+    ordered_chunks(chunks, opts.threads,
+        [&](size_t i, std::vector<char>& buf) {
+            size_t first = i * chunk_rows;
+            size_t last = std::min(height, first + chunk_rows);
+            buf.reserve((last - first) * width * (decimals < 0 ? 12 : static_cast<size_t>(decimals) + 6));
+            for (size_t r = first; r < last; r++) {
+                // ESRI ASCII Grid is top-to-bottom; row 0 is south.
+                const float* row = row_ptr(g, static_cast<int>(height - 1 - r));
+                for (size_t col = 0; col < width; col++) {
+                    if (col > 0) buf.push_back(' ');
+                    append_fixed(buf, row[col], decimals);
+                }
+                buf.push_back('\n');
+            }
+        },
+        [&](const std::vector<char>& buf) { write_buf(w, buf); });
+}
+
+void write_xyz(std::ostream& w, const Grid& g, const TextOptions& opts) {
+    check_grid(g);
+    int decimals = clamp_decimals(opts.decimals);
+
+    size_t height = static_cast<size_t>(g.height);
+    size_t width = static_cast<size_t>(g.width);
+    size_t value_bytes = 24 + (decimals < 0 ? 12 : static_cast<size_t>(decimals) + 6);
+    size_t chunk_rows = text_chunk_rows(opts, g, value_bytes);
+    size_t chunks = (height + chunk_rows - 1) / chunk_rows;
+
+    ordered_chunks(chunks, opts.threads,
+        [&](size_t i, std::vector<char>& buf) {
+            size_t first = i * chunk_rows;
+            size_t last = std::min(height, first + chunk_rows);
+            buf.reserve((last - first) * width * value_bytes);
+            for (size_t r = first; r < last; r++) {
+                double y = g.origin_y + static_cast<double>(r) * g.cell_size;
+                const float* row = row_ptr(g, static_cast<int>(r));
+                for (size_t col = 0; col < width; col++) {
+                    double x = g.origin_x + static_cast<double>(col) * g.cell_size;
+                    append_fixed(buf, x, 2);
+                    buf.push_back(' ');
+                    append_fixed(buf, y, 2);
+                    buf.push_back(' ');
+                    append_fixed(buf, row[col], decimals);
+                    buf.push_back('\n');
+                }
+            }
+        },
+        [&](const std::vector<char>& buf) { write_buf(w, buf); });
+}
+
+void write_raw(std::ostream& w, const Grid& g) {
+    check_grid(g);
+    auto row_bytes = static_cast<std::streamsize>(static_cast<size_t>(g.width) * sizeof(float));
+    for (int row = g.height - 1; row >= 0; row--) {
+        w.write(reinterpret_cast<const char*>(row_ptr(g, row)), row_bytes);
+    }
+    if (!w) throw std::runtime_error("dem: write failed");
+}
+
+Compression parse_compression(const std::string& name) {
+    if (name == "none") return Compression::None;
+    if (name == "deflate") return Compression::Deflate;
+    if (name == "lzw") return Compression::LZW;
+    throw std::invalid_argument("dem: unknown compression " + name);
+}
+
+void write_geotiff(std::ostream& w, const Grid& g, const TiffOptions& opts) {
+    check_grid(g);
+    bool compressed = opts.compression != Compression::None;
+    bool predictor = compressed && opts.predictor;
+    size_t sample_bytes = opts.sample == SampleType::Float32 ? 4 : 2;
+    size_t height = static_cast<size_t>(g.height);
+    size_t row_bytes = static_cast<size_t>(g.width) * sample_bytes;
+
+    size_t rows_per_strip = opts.rows_per_strip > 0 ? static_cast<size_t>(opts.rows_per_strip)
+                          : compressed              ? 16
+                                                    : std::max<size_t>(1, default_chunk_bytes / row_bytes);
+    rows_per_strip = std::min(rows_per_strip, height);
+    size_t strips = (height + rows_per_strip - 1) / rows_per_strip;
+
+    auto start = w.tellp();
+    if (start < 0) throw std::runtime_error("dem: GeoTIFF output must be seekable");
+
+    // Header; the IFD offset is patched once the strips are written.
+    std::vector<char> head;
+    append_line(head, "II");
+    put_le(head, uint16_t{42});
+    put_le(head, uint32_t{0});
+    write_buf(w, head);
+
+    constexpr uint64_t max_offset = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> counts;
+    offsets.reserve(strips);
+    counts.reserve(strips);
+    uint64_t pos = head.size();
+
+    StripEncoder enc{g, opts, rows_per_strip, sample_bytes, predictor};
+    ordered_chunks(strips, opts.threads,
+        [&](size_t i, std::vector<char>& buf) { enc.encode(i, buf); },
+        [&](const std::vector<char>& buf) {
+            if (pos + buf.size() > max_offset) throw std::runtime_error("dem: GeoTIFF exceeds 4 GiB");
+            offsets.push_back(static_cast<uint32_t>(pos));
+            counts.push_back(static_cast<uint32_t>(buf.size()));
+            write_buf(w, buf);
+            pos += buf.size();
+        });
+
+    // IFD, word-aligned, followed by the values that do not fit in a tag.
+    std::vector<char> ifd;
+    if (pos % 2) {
+        ifd.push_back(0);
+        pos++;
+    }
+    uint32_t ifd_offset = static_cast<uint32_t>(pos);
+    uint16_t num_tags = predictor ? 14 : 13;
+    uint64_t extra = pos + 2 + uint64_t{num_tags} * 12 + 4;
+    uint64_t pixel_scale_off = extra;
+    uint64_t tiepoint_off = pixel_scale_off + 24;
+    uint64_t geo_key_off = tiepoint_off + 48;
+    uint64_t strip_offsets_off = geo_key_off + 24;
+    uint64_t strip_counts_off = strip_offsets_off + 4 * strips;
+    uint64_t end = strip_counts_off + 4 * strips;
+    if (end > max_offset) throw std::runtime_error("dem: GeoTIFF exceeds 4 GiB");
+
+    auto n = static_cast<uint32_t>(strips);
+    put_le(ifd, num_tags);
+    put_tag(ifd, tag_image_width, dt_long, 1, static_cast<uint32_t>(g.width));
+    put_tag(ifd, tag_image_length, dt_long, 1, static_cast<uint32_t>(g.height));
+    put_tag(ifd, tag_bits_per_sample, dt_short, 1, static_cast<uint32_t>(sample_bytes * 8));
+    uint32_t compression_code = opts.compression == Compression::Deflate ? 8
+                              : opts.compression == Compression::LZW     ? 5
+                                                                         : 1;
+    put_tag(ifd, tag_compression, dt_short, 1, compression_code);
+    put_tag(ifd, tag_photometric, dt_short, 1, 1);
+    put_tag(ifd, tag_strip_offsets, dt_long, n, n == 1 ? offsets[0] : static_cast<uint32_t>(strip_offsets_off));
+    put_tag(ifd, tag_samples_per_pixel, dt_short, 1, 1);
+    put_tag(ifd, tag_rows_per_strip, dt_long, 1, static_cast<uint32_t>(rows_per_strip));
+    put_tag(ifd, tag_strip_byte_counts, dt_long, n, n == 1 ? counts[0] : static_cast<uint32_t>(strip_counts_off));
+    if (predictor) put_tag(ifd, tag_predictor, dt_short, 1, opts.sample == SampleType::Float32 ? 3 : 2);
+    put_tag(ifd, tag_sample_format, dt_short, 1, opts.sample == SampleType::Float32 ? 3 : 1);
+    put_tag(ifd, tag_model_pixel_scale, dt_double, 3, static_cast<uint32_t>(pixel_scale_off));
+    put_tag(ifd, tag_model_tiepoint, dt_double, 6, static_cast<uint32_t>(tiepoint_off));
+    put_tag(ifd, tag_geo_key_directory, dt_short, 12, static_cast<uint32_t>(geo_key_off));
+    put_le(ifd, uint32_t{0}); // no next IFD
+
+    // ModelPixelScale
+    put_le_f64(ifd, g.cell_size);
+    put_le_f64(ifd, g.cell_size);
+    put_le_f64(ifd, 0.0);
+
+    // ModelTiepoint: raster (0,0) is the northern row.
+    put_le_f64(ifd, 0.0);
+    put_le_f64(ifd, 0.0);
+    put_le_f64(ifd, 0.0);
+    put_le_f64(ifd, g.origin_x);
+    put_le_f64(ifd, g.origin_y + static_cast<double>(g.height - 1) * g.cell_size);
+    put_le_f64(ifd, 0.0);
+
+    // GeoKeyDirectory: projected model, pixel is area.
+    for (int v : {1, 1, 0, 2, 1024, 0, 1, 1, 1025, 0, 1, 1}) put_le(ifd, static_cast<uint16_t>(v));
+
+    if (n > 1) {
+        for (uint32_t v : offsets) put_le(ifd, v);
+        for (uint32_t v : counts) put_le(ifd, v);
+    }
+    write_buf(w, ifd);
+
+    std::vector<char> patch;
+    put_le(patch, ifd_offset);
+    auto after = w.tellp();
+    w.seekp(start + std::streamoff{4});
+    write_buf(w, patch);
+    w.seekp(after);
+    if (!w) throw std::runtime_error("dem: write failed");
+}
+
+} // namespace armatools::dem
@@ -0,0 +1,356 @@
+#include "armatools/dem.h"
+
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include <cstring>
+#include <format>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace armatools::dem;
+
+namespace {
+
+struct TestGrid {
+    std::vector<float> data;
+    Grid grid;
+};
+
+TestGrid make_grid(int width, int height) {
+    TestGrid t;
+    t.data.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            t.data[static_cast<size_t>(y * width + x)] =
+                static_cast<float>(x * 1.37 - y * 2.113 + (x * y % 7) * 0.031 - 5.0);
+        }
+    }
+    t.grid = {t.data.data(), width, height, 2.5, 200000, 100};
+    return t;
+}
+
+std::string reference_asc(const Grid& g) {
+    std::string s;
+    s += std::format("ncols         {}\n", g.width);
+    s += std::format("nrows         {}\n", g.height);
+    s += std::format("xllcorner     {:.6f}\n", g.origin_x);
+    s += std::format("yllcorner     {:.6f}\n", g.origin_y);
+    s += std::format("cellsize      {:.6f}\n", g.cell_size);
+    s += "NODATA_value  -9999\n";
+    for (int row = g.height - 1; row >= 0; row--) {
+        for (int col = 0; col < g.width; col++) {
+            if (col > 0) s += ' ';
+            s += std::format("{:.4f}", g.data[row * g.width + col]);
+        }
+        s += '\n';
+    }
+    return s;
+}
+
+uint16_t get_u16(const std::string& f, size_t off) {
+    uint16_t v;
+    std::memcpy(&v, f.data() + off, 2);
+    return v;
+}
+
+uint32_t get_u32(const std::string& f, size_t off) {
+    uint32_t v;
+    std::memcpy(&v, f.data() + off, 4);
+    return v;
+}
+
+// lzw_decode reads a TIFF LZW stream and throws unless it ends with an EOI
+// read at the current code width. last_table_size receives the table size
+// when EOI was read.
+std::vector<uint8_t> lzw_decode(const uint8_t* p, size_t size, size_t* last_table_size = nullptr) {
+    std::vector<std::vector<uint8_t>> table;
+    auto reset = [&] {
+        table.assign(258, {});
+        for (int i = 0; i < 256; i++) table[static_cast<size_t>(i)] = {static_cast<uint8_t>(i)};
+    };
+    reset();
+    std::vector<uint8_t> out;
+    size_t bit = 0;
+    int width = 9;
+    int old = -1;
+    while (bit + static_cast<size_t>(width) <= size * 8) {
+        uint32_t code = 0;
+        for (int i = 0; i < width; i++, bit++) {
+            code = (code << 1) | ((p[bit / 8] >> (7 - bit % 8)) & 1u);
+        }
+        if (code == 257) {
+            if (last_table_size) *last_table_size = table.size();
+            return out;
+        }
+        if (code == 256) {
+            reset();
+            width = 9;
+            old = -1;
+            continue;
+        }
+        std::vector<uint8_t> entry;
+        if (code < table.size()) {
+            entry = table[code];
+            if (old >= 0) {
+                auto add = table[static_cast<size_t>(old)];
+                add.push_back(entry[0]);
+                table.push_back(add);
+            }
+        } else {
+            if (old < 0 || code != table.size()) throw std::runtime_error("bad LZW code");
+            entry = table[static_cast<size_t>(old)];
+            entry.push_back(entry[0]);
+            table.push_back(entry);
+        }
+        out.insert(out.end(), entry.begin(), entry.end());
+        old = static_cast<int>(code);
+        if (table.size() + 1 >= (size_t{1} << width) && width < 12) width++;
+    }
+    throw std::runtime_error("missing LZW EOI");
+}
+
+struct Tiff {
+    std::map<uint16_t, std::vector<uint32_t>> tags;
+    std::vector<uint8_t> pixels; // decompressed, predictor undone, north row first
+};
+
+// Minimal reference reader for the files write_geotiff produces.
+Tiff read_tiff(const std::string& f) {
+    Tiff t;
+    EXPECT_EQ(f.substr(0, 4), std::string("II*\0", 4));
+    size_t ifd = get_u32(f, 4);
+    uint16_t n = get_u16(f, ifd);
+    uint16_t prev_tag = 0;
+    for (size_t i = 0; i < n; i++) {
+        size_t e = ifd + 2 + i * 12;
+        uint16_t tag = get_u16(f, e);
+        EXPECT_GT(tag, prev_tag);
+        prev_tag = tag;
+        uint16_t type = get_u16(f, e + 2);
+        uint32_t count = get_u32(f, e + 4);
+        auto& v = t.tags[tag];
+        if (type == 3 && count == 1) {
+            v.push_back(get_u16(f, e + 8));
+        } else if (type == 4 && count == 1) {
+            v.push_back(get_u32(f, e + 8));
+        } else if (type == 4) {
+            uint32_t off = get_u32(f, e + 8);
+            for (uint32_t k = 0; k < count; k++) v.push_back(get_u32(f, off + k * 4));
+        } else {
+            v.push_back(get_u32(f, e + 8));
+        }
+    }
+    EXPECT_EQ(get_u32(f, ifd + 2 + n * 12u), 0u);
+
+    uint32_t width = t.tags[256][0];
+    uint32_t height = t.tags[257][0];
+    uint32_t bps = t.tags[258][0] / 8;
+    uint32_t compression = t.tags[259][0];
+    uint32_t rows_per_strip = t.tags[278][0];
+    uint32_t predictor = t.tags.count(317) ? t.tags[317][0] : 1;
+    auto& offsets = t.tags[273];
+    auto& counts = t.tags[279];
+    EXPECT_EQ(offsets.size(), (height + rows_per_strip - 1) / rows_per_strip);
+    size_t row_bytes = size_t{width} * bps;
+
+    for (size_t s = 0; s < offsets.size(); s++) {
+        auto src = reinterpret_cast<const uint8_t*>(f.data() + offsets[s]);
+        size_t rows = std::min<size_t>(rows_per_strip, height - s * rows_per_strip);
+        std::vector<uint8_t> strip;
+        if (compression == 1) {
+            strip.assign(src, src + counts[s]);
+        } else if (compression == 8) {
+            strip.resize(rows * row_bytes);
+            uLongf len = static_cast<uLongf>(strip.size());
+            EXPECT_EQ(uncompress(strip.data(), &len, src, counts[s]), Z_OK);
+            strip.resize(len);
+        } else if (compression == 5) {
+            strip = lzw_decode(src, counts[s]);
+        } else {
+            ADD_FAILURE() << "compression " << compression;
+        }
+        EXPECT_EQ(strip.size(), rows * row_bytes);
+
+        for (size_t r = 0; r < rows; r++) {
+            uint8_t* row = strip.data() + r * row_bytes;
+            if (predictor == 2) {
+                for (size_t x = 1; x < width; x++) {
+                    uint16_t a, b;
+                    std::memcpy(&a, row + (x - 1) * 2, 2);
+                    std::memcpy(&b, row + x * 2, 2);
+                    b = static_cast<uint16_t>(a + b);
+                    std::memcpy(row + x * 2, &b, 2);
+                }
+            } else if (predictor == 3) {
+                for (size_t k = 1; k < row_bytes; k++) row[k] = static_cast<uint8_t>(row[k] + row[k - 1]);
+                std::vector<uint8_t> tmp(row, row + row_bytes);
+                for (size_t x = 0; x < width; x++) {
+                    for (size_t b = 0; b < 4; b++) row[x * 4 + b] = tmp[(3 - b) * width + x];
+                }
+            }
+        }
+        t.pixels.insert(t.pixels.end(), strip.begin(), strip.end());
+    }
+    return t;
+}
+
+} // namespace
+
+TEST(Text, AscMatchesFormat) {
+    auto t = make_grid(37, 23);
+    std::string want = reference_asc(t.grid);
+    for (int threads : {1, 3}) {
+        for (int chunk : {0, 1, 4}) {
+            std::ostringstream out;
+            write_asc(out, t.grid, {.decimals = 4, .threads = threads, .rows_per_chunk = chunk});
+            EXPECT_EQ(out.str(), want) << threads << " threads, " << chunk << " rows per chunk";
+        }
+    }
+}
+
+TEST(Text, XyzMatchesFormat) {
+    auto t = make_grid(11, 9);
+    std::string want;
+    for (int row = 0; row < 9; row++) {
+        double y = 100 + row * 2.5;
+        for (int col = 0; col < 11; col++) {
+            double x = 200000 + col * 2.5;
+            want += std::format("{:.2f} {:.2f} {:.2f}\n", x, y, t.data[static_cast<size_t>(row * 11 + col)]);
+        }
+    }
+    std::ostringstream out;
+    write_xyz(out, t.grid, {.decimals = 2, .threads = 4, .rows_per_chunk = 2});
+    EXPECT_EQ(out.str(), want);
+}
+
+TEST(Text, ShortestRoundTrips) {
+    auto t = make_grid(5, 4);
+    std::ostringstream out;
+    write_asc(out, t.grid, {.decimals = -1, .threads = 2, .rows_per_chunk = 1});
+    std::istringstream in(out.str());
+    std::string line;
+    for (int i = 0; i < 6; i++) std::getline(in, line);
+    for (int row = 3; row >= 0; row--) {
+        for (int col = 0; col < 5; col++) {
+            std::string tok;
+            in >> tok;
+            EXPECT_EQ(std::stof(tok), t.data[static_cast<size_t>(row * 5 + col)]);
+        }
+    }
+}
+
+TEST(Raw, NorthRowFirst) {
+    auto t = make_grid(6, 3);
+    std::ostringstream out;
+    write_raw(out, t.grid);
+    std::string s = out.str();
+    ASSERT_EQ(s.size(), 6u * 3u * 4u);
+    float first;
+    std::memcpy(&first, s.data(), 4);
+    EXPECT_EQ(first, t.data[12]);
+}
+
+TEST(GeoTiff, RoundTrips) {
+    auto t = make_grid(53, 41);
+    for (auto sample : {SampleType::Float32, SampleType::UInt16}) {
+        for (auto comp : {Compression::None, Compression::Deflate, Compression::LZW}) {
+            for (bool predictor : {false, true}) {
+                TiffOptions opts{.sample = sample, .min_value = -100, .max_value = 100,
+                                 .compression = comp, .predictor = predictor,
+                                 .rows_per_strip = 6, .threads = 3};
+                std::stringstream out;
+                write_geotiff(out, t.grid, opts);
+                auto tiff = read_tiff(out.str());
+                SCOPED_TRACE(std::format("sample {} compression {} predictor {}",
+                                         static_cast<int>(sample), static_cast<int>(comp), predictor));
+                EXPECT_EQ(tiff.tags[256][0], 53u);
+                EXPECT_EQ(tiff.tags[257][0], 41u);
+                EXPECT_EQ(tiff.tags.count(317), predictor && comp != Compression::None ? 1u : 0u);
+
+                size_t bps = sample == SampleType::Float32 ? 4 : 2;
+                ASSERT_EQ(tiff.pixels.size(), t.data.size() * bps);
+                for (int row = 0; row < 41; row++) {
+                    for (int col = 0; col < 53; col++) {
+                        float v = t.data[static_cast<size_t>((40 - row) * 53 + col)];
+                        const uint8_t* p = tiff.pixels.data() + static_cast<size_t>(row * 53 + col) * bps;
+                        if (sample == SampleType::Float32) {
+                            float got;
+                            std::memcpy(&got, p, 4);
+                            ASSERT_EQ(got, v);
+                        } else {
+                            uint16_t got;
+                            std::memcpy(&got, p, 2);
+                            ASSERT_EQ(got, static_cast<uint16_t>((v + 100.0) / 200.0 * 65535));
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(GeoTiff, LzwResetsLongStrips) {
+    // Noisy uint16 data in one strip overflows the 4096-entry code table.
+    std::vector<float> data(512 * 64);
+    uint32_t seed = 1;
+    for (auto& v : data) {
+        seed = seed * 1103515245u + 12345u;
+        v = static_cast<float>(seed >> 16);
+    }
+    Grid g{data.data(), 512, 64, 1, 0, 0};
+    std::stringstream out;
+    write_geotiff(out, g, {.sample = SampleType::Float32, .compression = Compression::LZW,
+                           .predictor = false, .rows_per_strip = 64});
+    auto tiff = read_tiff(out.str());
+    ASSERT_EQ(tiff.pixels.size(), data.size() * 4);
+    float got;
+    std::memcpy(&got, tiff.pixels.data(), 4);
+    EXPECT_EQ(got, data[63 * 512]);
+    std::memcpy(&got, tiff.pixels.data() + tiff.pixels.size() - 4, 4);
+    EXPECT_EQ(got, data[511]);
+}
+
+TEST(GeoTiff, LzwEoiAtEveryWidth) {
+    // The decoder widens as its table reaches 511, 1023 and 2047 entries,
+    // which can happen on the last code; EOI must follow at the new width.
+    std::set<size_t> boundaries;
+    uint32_t seed = 7;
+    for (int i = 0; i < 4500; i++) {
+        // Each width gets five random rows, so the final table sizes
+        // are spread finely enough to land on every boundary.
+        int w = 100 + i / 5;
+        std::vector<float> data(static_cast<size_t>(w));
+        for (auto& v : data) {
+            seed = seed * 1103515245u + 12345u;
+            v = static_cast<float>(seed >> 16);
+        }
+        Grid g{data.data(), w, 1, 1, 0, 0};
+        std::stringstream out;
+        write_geotiff(out, g, {.sample = SampleType::UInt16, .min_value = 0, .max_value = 65535,
+                               .compression = Compression::LZW, .predictor = false});
+        auto f = out.str();
+        auto tiff = read_tiff(f);
+        ASSERT_EQ(tiff.pixels.size(), data.size() * 2);
+        size_t last = 0;
+        lzw_decode(reinterpret_cast<const uint8_t*>(f.data()) + tiff.tags[273][0], tiff.tags[279][0], &last);
+        for (size_t x = 0; x < data.size(); x++) {
+            uint16_t v;
+            std::memcpy(&v, tiff.pixels.data() + x * 2, 2);
+            ASSERT_EQ(v, static_cast<uint16_t>(data[x])) << "width " << w;
+        }
+        if (last == 511 || last == 1023 || last == 2047) boundaries.insert(last);
+    }
+    EXPECT_EQ(boundaries, (std::set<size_t>{511, 1023, 2047}));
+}
+
+TEST(GeoTiff, ParseCompression) {
+    EXPECT_EQ(parse_compression("deflate"), Compression::Deflate);
+    EXPECT_EQ(parse_compression("lzw"), Compression::LZW);
+    EXPECT_EQ(parse_compression("none"), Compression::None);
+    EXPECT_THROW(parse_compression("jpeg"), std::invalid_argument);
+}
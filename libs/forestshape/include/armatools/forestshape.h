@@ -27,4 +27,8 @@ struct Polygon {
 // ExtractFromObjects extracts forest polygons from OFP forest block objects.
 std::vector<Polygon> extract_from_objects(const std::vector<wrp::ObjectRecord>& objects);
 
+// extract_from_objects variant reusing a model table built from the same objects.
+std::vector<Polygon> extract_from_objects(const std::vector<wrp::ObjectRecord>& objects,
+                                          const wrp::ModelTable& models);
+
 } // namespace armatools::forestshape
@@ -1,11 +1,13 @@
 #include <armatools/forestshape.h>
+#include <armatools/parallel.h>
 
 #include <algorithm>
 #include <cmath>
-#include <map>
-#include <queue>
-#include <unordered_map>
-#include <unordered_set>
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <span>
+#include <stdexcept>
 
 namespace armatools::forestshape {
 
@@ -15,47 +17,28 @@ namespace armatools::forestshape {
 
 struct ForestBlock {
     int obj_idx = 0;
-    std::string model;
+    uint32_t model_id = 0;
     std::array<double, 2> pos{};
-    ForestType type;
+    bool conifer = false;
     bool is_square = false;
     int yaw = 0; // normalized: 0, 90, 180, 270
 };
 
-struct CellKey {
-    int col = 0, row = 0;
-    bool operator==(const CellKey& o) const { return col == o.col && row == o.row; }
-};
-
-struct CellKeyHash {
-    size_t operator()(const CellKey& k) const {
-        return std::hash<int64_t>{}(static_cast<int64_t>(k.col) * 100003 + k.row);
-    }
-};
-
-struct CellInfo {
-    bool is_square = false;
-    int tri_yaw = 0;
-};
-
 static constexpr double grid_cell_size = 50.0;
 static constexpr double grid_half = 25.0;
 
-enum Dir { dir_n = 0, dir_e = 1, dir_s = 2, dir_w = 3 };
+// Grids with at least this many forest cells are traced on several threads.
+static constexpr size_t parallel_cells = 16384;
+
+// Cover bits mark the sides of a cell its block reaches: all four for a
+// square, the two legs for a triangle.
+static constexpr uint8_t cover_n = 1, cover_e = 2, cover_s = 4, cover_w = 8;
+static constexpr uint8_t cover_all = cover_n | cover_e | cover_s | cover_w;
 
 // ---------------------------------------------------------------------------
 // Helpers
 // ---------------------------------------------------------------------------
 
-static std::string base_name(const std::string& model_name) {
-    std::string s = model_name;
-    for (auto& c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
-    auto pos = s.find_last_of("\\/");
-    if (pos != std::string::npos) s = s.substr(pos + 1);
-    if (s.size() > 4 && s.substr(s.size() - 4) == ".p3d") s.resize(s.size() - 4);
-    return s;
-}
-
 static int normalize_yaw(double yaw) {
     double deg = std::fmod(yaw, 360.0);
     if (deg < 0) deg += 360;
@@ -63,41 +46,62 @@ static int normalize_yaw(double yaw) {
     return q * 90;
 }
 
-static bool covers_direction(const CellInfo& ci, Dir dir) {
-    if (ci.is_square) return true;
-    switch (ci.tri_yaw) {
-    case 0:   return dir == dir_n || dir == dir_w;
-    case 90:  return dir == dir_n || dir == dir_e;
-    case 180: return dir == dir_s || dir == dir_e;
-    case 270: return dir == dir_s || dir == dir_w;
+static uint8_t triangle_cover(int yaw) {
+    switch (yaw) {
+    case 0:   return cover_n | cover_w;
+    case 90:  return cover_n | cover_e;
+    case 180: return cover_s | cover_e;
+    default:  return cover_s | cover_w; // 270
     }
-    return false;
 }
 
 // ---------------------------------------------------------------------------
 // Forest block classification
 // ---------------------------------------------------------------------------
 
-static std::vector<ForestBlock> classify_forest(const std::vector<wrp::ObjectRecord>& objects) {
+// ForestModel is the classification of one distinct model, shared by all of
+// its placements.
+struct ForestModel {
+    bool is_forest = false;
+    bool is_square = false;
+    bool conifer = false;
+};
+
+static ForestModel classify_model(const std::string& base) {
+    ForestModel m;
+    if (!base.starts_with("les")) return m;
+    if (base.find("mlaz") != std::string::npos) return m;
+    if (base.find("singlestrom") != std::string::npos) return m;
+
+    m.is_forest = true;
+    m.is_square = (base.find("trojuhelnik") == std::string::npos);
+    m.conifer = base.find("jehl") != std::string::npos;
+    return m;
+}
+
+static std::vector<ForestBlock> classify_forest(const std::vector<wrp::ObjectRecord>& objects,
+                                                const wrp::ModelTable& models) {
+    std::vector<ForestModel> classes;
+    classes.reserve(models.size());
+    for (const auto& e : models.entries()) classes.push_back(classify_model(e.base_name));
+
     std::vector<ForestBlock> blocks;
 
     for (size_t i = 0; i < objects.size(); i++) {
         auto& obj = objects[i];
-        std::string base = base_name(obj.model_name);
-
-        if (base.substr(0, 3) != "les") continue;
-        if (base.find("mlaz") != std::string::npos) continue;
-        if (base.find("singlestrom") != std::string::npos) continue;
+        uint32_t id = models.id(i);
+        const auto& fm = classes[id];
+        if (!fm.is_forest) continue;
 
         ForestBlock fb;
         fb.obj_idx = static_cast<int>(i);
-        fb.model = obj.model_name;
+        fb.model_id = id;
         fb.pos = {obj.position[0], obj.position[2]};
-        fb.is_square = (base.find("trojuhelnik") == std::string::npos);
+        fb.is_square = fm.is_square;
         fb.yaw = normalize_yaw(obj.rotation.yaw);
-        fb.type = (base.find("jehl") != std::string::npos) ? forest_conifer : forest_mixed;
+        fb.conifer = fm.conifer;
 
-        blocks.push_back(std::move(fb));
+        blocks.push_back(fb);
     }
     return blocks;
 }
@@ -106,21 +110,29 @@ static std::vector<ForestBlock> classify_forest(const std::vector<wrp::ObjectRec
 // Forest grid
 // ---------------------------------------------------------------------------
 
+// ForestGrid is a dense grid of cell cover masks over the bounding box of
+// one region of a forest type's blocks (see split_regions). Row 0 is the southernmost row; 0 marks an
+// empty cell.
 struct ForestGrid {
-    std::unordered_map<CellKey, CellInfo, CellKeyHash> cells;
+    std::vector<uint8_t> cells;
+    int width = 0, height = 0;
+    int col0 = 0, row0 = 0; // grid column and row of cells[0]
     double phase_x = 0, phase_z = 0;
 
-    CellKey snap(const std::array<double, 2>& pos) const {
-        return {
-            static_cast<int>(std::round((pos[0] - phase_x) / grid_cell_size)),
-            static_cast<int>(std::round((pos[1] - phase_z) / grid_cell_size))
-        };
+    int snap_col(double x) const { return static_cast<int>(std::round((x - phase_x) / grid_cell_size)); }
+    int snap_row(double z) const { return static_cast<int>(std::round((z - phase_z) / grid_cell_size)); }
+
+    // at returns the cover of local cell (c, r); cells outside the grid are
+    // empty.
+    uint8_t at(int c, int r) const {
+        if (c < 0 || r < 0 || c >= width || r >= height) return 0;
+        return cells[static_cast<size_t>(r) * static_cast<size_t>(width) + static_cast<size_t>(c)];
     }
 
     std::array<double, 2> vertex_world(int vx, int vy) const {
         return {
-            phase_x + static_cast<double>(vx) * grid_cell_size - grid_half,
-            phase_z + static_cast<double>(vy) * grid_cell_size - grid_half
+            phase_x + static_cast<double>(col0 + vx) * grid_cell_size - grid_half,
+            phase_z + static_cast<double>(row0 + vy) * grid_cell_size - grid_half
         };
     }
 };
@@ -131,7 +143,7 @@ static double pos_mod(double x, double m) {
     return r;
 }
 
-static void detect_phase(const std::vector<ForestBlock>& blocks, double& px, double& pz) {
+static void detect_phase(std::span<const ForestBlock> blocks, double& px, double& pz) {
     for (auto& b : blocks) {
         if (!b.is_square) {
             px = pos_mod(b.pos[0], grid_cell_size);
@@ -145,39 +157,159 @@ static void detect_phase(const std::vector<ForestBlock>& blocks, double& px, dou
     pz = pos_mod(sz, grid_cell_size);
 }
 
-static ForestGrid build_forest_grid(const std::vector<ForestBlock>& blocks) {
-    ForestGrid g;
-    if (blocks.empty()) return g;
-
-    detect_phase(blocks, g.phase_x, g.phase_z);
-
-    for (auto& b : blocks) {
-        CellKey ck = g.snap(b.pos);
-        auto it = g.cells.find(ck);
-        if (it != g.cells.end() && it->second.is_square) continue;
-        if (b.is_square) {
-            g.cells[ck] = {true, 0};
-        } else {
-            g.cells[ck] = {false, b.yaw};
+// CellKey is the grid column and row a block snaps to.
+using CellKey = std::array<int, 2>;
+
+// split_regions groups blocks into regions that no forest area can span:
+// where a whole row or column between blocks is empty, the blocks on either
+// side go to different regions. Each region gets its own grid, so a stray
+// block far from the rest does not stretch one grid over the gap.
+static std::vector<std::vector<uint32_t>> split_regions(const std::vector<CellKey>& keys) {
+    std::vector<std::vector<uint32_t>> regions;
+    std::vector<std::vector<uint32_t>> pending(1);
+    pending[0].resize(keys.size());
+    for (uint32_t i = 0; i < keys.size(); i++) pending[0][i] = i;
+
+    while (!pending.empty()) {
+        auto group = std::move(pending.back());
+        pending.pop_back();
+        bool split = false;
+        for (size_t axis : {size_t{1}, size_t{0}}) {
+            std::stable_sort(group.begin(), group.end(),
+                             [&](uint32_t a, uint32_t b) { return keys[a][axis] < keys[b][axis]; });
+            size_t begin = 0;
+            for (size_t i = 1; i < group.size(); i++) {
+                if (int64_t{keys[group[i]][axis]} - keys[group[i - 1]][axis] < 2) continue;
+                pending.emplace_back(group.begin() + static_cast<std::ptrdiff_t>(begin),
+                                     group.begin() + static_cast<std::ptrdiff_t>(i));
+                begin = i;
+            }
+            if (begin == 0) continue;
+            pending.emplace_back(group.begin() + static_cast<std::ptrdiff_t>(begin), group.end());
+            split = true;
+            break;
         }
+        if (split) continue;
+        // Keep object order: the last block in a cell wins.
+        std::sort(group.begin(), group.end());
+        regions.push_back(std::move(group));
+    }
+    return regions;
+}
+
+// build_forest_grid rasterizes one region; proto carries the grid phase.
+static ForestGrid build_forest_grid(std::span<const ForestBlock> blocks, const std::vector<CellKey>& keys,
+                                    const std::vector<uint32_t>& region, const ForestGrid& proto) {
+    ForestGrid g;
+    g.phase_x = proto.phase_x;
+    g.phase_z = proto.phase_z;
+
+    int col_max = std::numeric_limits<int>::min(), row_max = std::numeric_limits<int>::min();
+    g.col0 = std::numeric_limits<int>::max();
+    g.row0 = std::numeric_limits<int>::max();
+    for (uint32_t i : region) {
+        g.col0 = std::min(g.col0, keys[i][0]);
+        g.row0 = std::min(g.row0, keys[i][1]);
+        col_max = std::max(col_max, keys[i][0]);
+        row_max = std::max(row_max, keys[i][1]);
+    }
+    // Without an empty row or column to split on, a region spans at most
+    // one cell per block in each direction.
+    int64_t w = int64_t{col_max} - g.col0 + 1, h = int64_t{row_max} - g.row0 + 1;
+    if (w * h > std::numeric_limits<int32_t>::max())
+        throw std::runtime_error(std::format("forestshape: forest grid too large ({}x{} cells)", w, h));
+    g.width = static_cast<int>(w);
+    g.height = static_cast<int>(h);
+    g.cells.assign(static_cast<size_t>(w * h), 0);
+
+    // A square wins over triangles; otherwise the last block in a cell wins.
+    for (uint32_t i : region) {
+        auto& cell = g.cells[static_cast<size_t>(keys[i][1] - g.row0) * static_cast<size_t>(g.width) +
+                             static_cast<size_t>(keys[i][0] - g.col0)];
+        if (cell == cover_all) continue;
+        cell = blocks[i].is_square ? cover_all : triangle_cover(blocks[i].yaw);
     }
     return g;
 }
 
 // ---------------------------------------------------------------------------
-// Boundary tracing
+// Component labeling
 // ---------------------------------------------------------------------------
 
-struct Vtx {
-    int x = 0, y = 0;
-    bool operator==(const Vtx& o) const { return x == o.x && y == o.y; }
+// Components lists the cells of each connected forest area, in row-major
+// order of their first cell. Cells of a component are in row-major order.
+struct Components {
+    std::vector<int32_t> cells;   // grid cell indices, grouped by component
+    std::vector<size_t> offsets;  // component i is cells[offsets[i], offsets[i + 1])
+
+    size_t count() const { return offsets.size() - 1; }
+    size_t size(size_t comp) const { return offsets[comp + 1] - offsets[comp]; }
 };
 
-struct VtxHash {
-    size_t operator()(const Vtx& v) const {
-        return std::hash<int64_t>{}(static_cast<int64_t>(v.x) * 100003 + v.y);
+static int32_t find_root(std::vector<int32_t>& parent, int32_t i) {
+    while (parent[static_cast<size_t>(i)] != i) {
+        auto& p = parent[static_cast<size_t>(i)];
+        p = parent[static_cast<size_t>(p)];
+        i = p;
+    }
+    return i;
+}
+
+// unite joins two sets, keeping the lower cell index as the root so that
+// every root is the first cell of its component in row-major order.
+static void unite(std::vector<int32_t>& parent, int32_t a, int32_t b) {
+    a = find_root(parent, a);
+    b = find_root(parent, b);
+    if (a == b) return;
+    if (a < b) parent[static_cast<size_t>(b)] = a;
+    else parent[static_cast<size_t>(a)] = b;
+}
+
+// label_components joins cells whose shared side is covered from both
+// sides, with one union-find pass over the grid.
+static Components label_components(const ForestGrid& g) {
+    const size_t n = g.cells.size();
+    const auto w = static_cast<size_t>(g.width);
+    std::vector<int32_t> parent(n, -1);
+    for (size_t i = 0; i < n; i++) {
+        uint8_t cell = g.cells[i];
+        if (cell == 0) continue;
+        auto id = static_cast<int32_t>(i);
+        parent[i] = id;
+        if (i % w > 0 && (cell & cover_w) && (g.cells[i - 1] & cover_e))
+            unite(parent, id, id - 1);
+        if (i >= w && (cell & cover_s) && (g.cells[i - w] & cover_n))
+            unite(parent, id, static_cast<int32_t>(i - w));
+    }
+
+    // Roots come first in row-major order, so one pass numbers components
+    // and resolves every cell.
+    std::vector<int32_t> label(n, -1);
+    std::vector<size_t> counts;
+    for (size_t i = 0; i < n; i++) {
+        if (parent[i] < 0) continue;
+        auto root = static_cast<size_t>(find_root(parent, static_cast<int32_t>(i)));
+        if (root == i) {
+            label[i] = static_cast<int32_t>(counts.size());
+            counts.push_back(0);
+        }
+        label[i] = label[root];
+        counts[static_cast<size_t>(label[i])]++;
     }
-};
+
+    Components comps;
+    comps.offsets.assign(counts.size() + 1, 0);
+    for (size_t c = 0; c < counts.size(); c++) comps.offsets[c + 1] = comps.offsets[c] + counts[c];
+    comps.cells.resize(comps.offsets.back());
+    std::vector<size_t> fill(comps.offsets.begin(), comps.offsets.end() - 1);
+    for (size_t i = 0; i < n; i++)
+        if (label[i] >= 0) comps.cells[fill[static_cast<size_t>(label[i])]++] = static_cast<int32_t>(i);
+    return comps;
+}
+
+// ---------------------------------------------------------------------------
+// Boundary tracing
+// ---------------------------------------------------------------------------
 
 static double shoelace(const std::vector<std::array<double, 2>>& ring) {
     if (ring.size() < 3) return 0;
@@ -188,171 +320,187 @@ static double shoelace(const std::vector<std::array<double, 2>>& ring) {
     return area / 2;
 }
 
-static std::vector<Polygon> trace_polygons(ForestGrid& g) {
-    if (g.cells.empty()) return {};
-
-    // Flood fill to find connected components
-    std::unordered_set<CellKey, CellKeyHash> visited;
-    std::vector<std::vector<CellKey>> components;
-
-    struct NeighborCheck {
-        int dc, dr;
-        Dir dir_from, dir_to;
-    };
-    static const NeighborCheck neighbors[] = {
-        {-1, 0, dir_w, dir_e},
-        {+1, 0, dir_e, dir_w},
-        {0, -1, dir_s, dir_n},
-        {0, +1, dir_n, dir_s},
+// trace_component chains the boundary edges of one component into rings.
+// It only reads the grid, so components can be traced concurrently.
+static Polygon trace_component(const ForestGrid& g, const int32_t* cells, size_t count) {
+    // Vertices are numbered row-major over the (width + 1) x (height + 1)
+    // corner lattice.
+    const auto stride = static_cast<uint64_t>(g.width) + 1;
+    auto vtx = [&](int vx, int vy) { return static_cast<uint64_t>(vy) * stride + static_cast<uint64_t>(vx); };
+
+    struct Edge { uint64_t from, to; };
+    std::vector<Edge> edges;
+    edges.reserve(count * 4);
+    auto add_edge = [&](uint64_t from, uint64_t to) { edges.push_back({from, to}); };
+
+    // A side is on the boundary unless the neighbour covers it; such a
+    // neighbour is always part of the same component.
+    auto is_boundary = [&](int c, int r, uint8_t dir) -> bool {
+        switch (dir) {
+        case cover_s: return !(g.at(c, r - 1) & cover_n);
+        case cover_e: return !(g.at(c + 1, r) & cover_w);
+        case cover_n: return !(g.at(c, r + 1) & cover_s);
+        default:      return !(g.at(c - 1, r) & cover_e);
+        }
     };
 
-    for (auto& [ck, ci] : g.cells) {
-        if (visited.count(ck)) continue;
-        visited.insert(ck);
-
-        std::vector<CellKey> comp;
-        std::queue<CellKey> queue;
-        queue.push(ck);
-
-        while (!queue.empty()) {
-            CellKey cur = queue.front();
-            queue.pop();
-            comp.push_back(cur);
-            auto& cur_ci = g.cells[cur];
-
-            for (auto& nb : neighbors) {
-                CellKey nk{cur.col + nb.dc, cur.row + nb.dr};
-                if (visited.count(nk)) continue;
-                auto nit = g.cells.find(nk);
-                if (nit == g.cells.end()) continue;
-                if (covers_direction(cur_ci, nb.dir_from) &&
-                    covers_direction(nit->second, nb.dir_to)) {
-                    visited.insert(nk);
-                    queue.push(nk);
-                }
+    double area = 0;
+    for (size_t k = 0; k < count; k++) {
+        int c = cells[k] % g.width, r = cells[k] / g.width;
+        uint8_t cell = g.at(c, r);
+
+        if (cell == cover_all) {
+            if (is_boundary(c, r, cover_s)) add_edge(vtx(c, r), vtx(c+1, r));
+            if (is_boundary(c, r, cover_e)) add_edge(vtx(c+1, r), vtx(c+1, r+1));
+            if (is_boundary(c, r, cover_n)) add_edge(vtx(c+1, r+1), vtx(c, r+1));
+            if (is_boundary(c, r, cover_w)) add_edge(vtx(c, r+1), vtx(c, r));
+            area += grid_cell_size * grid_cell_size;
+        } else {
+            switch (cell) {
+            case cover_n | cover_w: // NW
+                if (is_boundary(c, r, cover_n)) add_edge(vtx(c+1, r+1), vtx(c, r+1));
+                if (is_boundary(c, r, cover_w)) add_edge(vtx(c, r+1), vtx(c, r));
+                add_edge(vtx(c, r), vtx(c+1, r+1));
+                break;
+            case cover_n | cover_e: // NE
+                if (is_boundary(c, r, cover_n)) add_edge(vtx(c+1, r+1), vtx(c, r+1));
+                if (is_boundary(c, r, cover_e)) add_edge(vtx(c+1, r), vtx(c+1, r+1));
+                add_edge(vtx(c, r+1), vtx(c+1, r));
+                break;
+            case cover_s | cover_e: // SE
+                if (is_boundary(c, r, cover_e)) add_edge(vtx(c+1, r), vtx(c+1, r+1));
+                if (is_boundary(c, r, cover_s)) add_edge(vtx(c, r), vtx(c+1, r));
+                add_edge(vtx(c+1, r+1), vtx(c, r));
+                break;
+            case cover_s | cover_w: // SW
+                if (is_boundary(c, r, cover_s)) add_edge(vtx(c, r), vtx(c+1, r));
+                if (is_boundary(c, r, cover_w)) add_edge(vtx(c, r+1), vtx(c, r));
+                add_edge(vtx(c+1, r), vtx(c, r+1));
+                break;
             }
+            area += grid_cell_size * grid_cell_size / 2;
         }
-        components.push_back(std::move(comp));
     }
 
-    // Sort by size (largest first)
-    std::sort(components.begin(), components.end(),
-              [](auto& a, auto& b) { return a.size() > b.size(); });
-
-    std::vector<Polygon> polygons;
-
-    for (auto& comp : components) {
-        std::unordered_map<CellKey, CellInfo, CellKeyHash> comp_set;
-        for (auto& ck : comp) comp_set[ck] = g.cells[ck];
-
-        auto is_boundary = [&](int c, int r, Dir dir) -> bool {
-            CellKey nk;
-            Dir facing;
-            switch (dir) {
-            case dir_s: nk = {c, r - 1}; facing = dir_n; break;
-            case dir_e: nk = {c + 1, r}; facing = dir_w; break;
-            case dir_n: nk = {c, r + 1}; facing = dir_s; break;
-            case dir_w: nk = {c - 1, r}; facing = dir_e; break;
-            }
-            auto it = comp_set.find(nk);
-            if (it == comp_set.end()) return true;
-            return !covers_direction(it->second, facing);
-        };
-
-        // Collect directed boundary edges
-        std::unordered_map<Vtx, std::vector<Vtx>, VtxHash> edge_map;
-        auto add_edge = [&](Vtx from, Vtx to) {
-            edge_map[from].push_back(to);
-        };
+    // Group outgoing edges by start vertex; within a vertex they are taken
+    // last-added first.
+    std::stable_sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) { return a.from < b.from; });
+    std::vector<uint64_t> starts;
+    std::vector<size_t> first, left;
+    for (size_t i = 0; i < edges.size(); i++) {
+        if (i == 0 || edges[i].from != edges[i - 1].from) {
+            starts.push_back(edges[i].from);
+            first.push_back(i);
+            left.push_back(0);
+        }
+        left.back()++;
+    }
+    auto group_of = [&](uint64_t v) -> size_t {
+        auto it = std::lower_bound(starts.begin(), starts.end(), v);
+        return it != starts.end() && *it == v ? static_cast<size_t>(it - starts.begin()) : starts.size();
+    };
+    auto world = [&](uint64_t v) {
+        return g.vertex_world(static_cast<int>(v % stride), static_cast<int>(v / stride));
+    };
 
-        double area = 0;
-
-        for (auto& ck : comp) {
-            int c = ck.col, r = ck.row;
-            auto& ci = comp_set[ck];
-
-            if (ci.is_square) {
-                if (is_boundary(c, r, dir_s)) add_edge({c, r}, {c+1, r});
-                if (is_boundary(c, r, dir_e)) add_edge({c+1, r}, {c+1, r+1});
-                if (is_boundary(c, r, dir_n)) add_edge({c+1, r+1}, {c, r+1});
-                if (is_boundary(c, r, dir_w)) add_edge({c, r+1}, {c, r});
-                area += grid_cell_size * grid_cell_size;
-            } else {
-                switch (ci.tri_yaw) {
-                case 0: // NW
-                    if (is_boundary(c, r, dir_n)) add_edge({c+1, r+1}, {c, r+1});
-                    if (is_boundary(c, r, dir_w)) add_edge({c, r+1}, {c, r});
-                    add_edge({c, r}, {c+1, r+1});
-                    break;
-                case 90: // NE
-                    if (is_boundary(c, r, dir_n)) add_edge({c+1, r+1}, {c, r+1});
-                    if (is_boundary(c, r, dir_e)) add_edge({c+1, r}, {c+1, r+1});
-                    add_edge({c, r+1}, {c+1, r});
+    // Chain edges into closed rings
+    size_t max_edges = 4 * count + 4;
+    std::vector<std::vector<std::array<double, 2>>> rings;
+    for (size_t s = 0; s < starts.size(); s++) {
+        while (left[s] > 0) {
+            std::vector<std::array<double, 2>> ring;
+            uint64_t start = starts[s], cur = start;
+            for (size_t iter = 0; iter < max_edges; iter++) {
+                ring.push_back(world(cur));
+                size_t gi = group_of(cur);
+                if (gi == starts.size() || left[gi] == 0) {
+                    ring.push_back(world(start));
                     break;
-                case 180: // SE
-                    if (is_boundary(c, r, dir_e)) add_edge({c+1, r}, {c+1, r+1});
-                    if (is_boundary(c, r, dir_s)) add_edge({c, r}, {c+1, r});
-                    add_edge({c+1, r+1}, {c, r});
-                    break;
-                case 270: // SW
-                    if (is_boundary(c, r, dir_s)) add_edge({c, r}, {c+1, r});
-                    if (is_boundary(c, r, dir_w)) add_edge({c, r+1}, {c, r});
-                    add_edge({c+1, r}, {c, r+1});
+                }
+                uint64_t nxt = edges[first[gi] + --left[gi]].to;
+                if (nxt == start) {
+                    ring.push_back(world(start));
                     break;
                 }
-                area += grid_cell_size * grid_cell_size / 2;
+                cur = nxt;
             }
+            if (ring.size() >= 4) rings.push_back(std::move(ring));
         }
+    }
 
-        // Chain edges into closed rings
-        int max_edges = 4 * static_cast<int>(comp.size()) + 4;
-        std::vector<std::vector<std::array<double, 2>>> rings;
-
-        for (auto& [start, _] : edge_map) {
-            while (!edge_map[start].empty()) {
-                std::vector<std::array<double, 2>> ring;
-                Vtx cur = start;
-                for (int iter = 0; iter < max_edges; iter++) {
-                    ring.push_back(g.vertex_world(cur.x, cur.y));
-                    auto& edges = edge_map[cur];
-                    if (edges.empty()) {
-                        ring.push_back(g.vertex_world(start.x, start.y));
-                        break;
-                    }
-                    Vtx nxt = edges.back();
-                    edges.pop_back();
-                    if (nxt == start) {
-                        ring.push_back(g.vertex_world(start.x, start.y));
-                        break;
-                    }
-                    cur = nxt;
-                }
-                if (ring.size() >= 4) rings.push_back(std::move(ring));
-            }
+    Polygon poly;
+    poly.cell_count = static_cast<int>(count);
+    poly.area = area;
+
+    if (rings.size() == 1) {
+        poly.exterior = std::move(rings[0]);
+    } else if (rings.size() > 1) {
+        double max_area = 0;
+        size_t max_idx = 0;
+        for (size_t i = 0; i < rings.size(); i++) {
+            double a = std::abs(shoelace(rings[i]));
+            if (a > max_area) { max_area = a; max_idx = i; }
         }
-
-        Polygon poly;
-        poly.cell_count = static_cast<int>(comp.size());
-        poly.area = area;
-
-        if (rings.size() == 1) {
-            poly.exterior = std::move(rings[0]);
-        } else if (rings.size() > 1) {
-            double max_area = 0;
-            size_t max_idx = 0;
-            for (size_t i = 0; i < rings.size(); i++) {
-                double a = std::abs(shoelace(rings[i]));
-                if (a > max_area) { max_area = a; max_idx = i; }
-            }
-            poly.exterior = std::move(rings[max_idx]);
-            for (size_t i = 0; i < rings.size(); i++) {
-                if (i != max_idx) poly.holes.push_back(std::move(rings[i]));
-            }
+        poly.exterior = std::move(rings[max_idx]);
+        for (size_t i = 0; i < rings.size(); i++) {
+            if (i != max_idx) poly.holes.push_back(std::move(rings[i]));
         }
+    }
+    return poly;
+}
+
+// trace_polygons traces every forest area of one forest type, largest
+// first. Large forests are traced on several threads, each taking the next
+// untraced component.
+static std::vector<Polygon> trace_polygons(std::span<const ForestBlock> blocks) {
+    if (blocks.empty()) return {};
 
-        polygons.push_back(std::move(poly));
+    ForestGrid proto;
+    detect_phase(blocks, proto.phase_x, proto.phase_z);
+    std::vector<CellKey> keys(blocks.size());
+    for (size_t i = 0; i < blocks.size(); i++)
+        keys[i] = {proto.snap_col(blocks[i].pos[0]), proto.snap_row(blocks[i].pos[1])};
+
+    auto regions = split_regions(keys);
+    std::vector<ForestGrid> grids;
+    std::vector<Components> comps;
+    grids.reserve(regions.size());
+    comps.reserve(regions.size());
+    size_t total_cells = 0;
+    for (const auto& region : regions) {
+        grids.push_back(build_forest_grid(blocks, keys, region, proto));
+        comps.push_back(label_components(grids.back()));
+        total_cells += comps.back().cells.size();
     }
 
+    // Order components as one grid over all regions would: by size, then
+    // by their first cell in row-major order.
+    struct Job {
+        size_t grid, comp, size;
+        int row, col;
+    };
+    std::vector<Job> jobs;
+    for (size_t gi = 0; gi < grids.size(); gi++) {
+        const auto& g = grids[gi];
+        for (size_t c = 0; c < comps[gi].count(); c++) {
+            int32_t first = comps[gi].cells[comps[gi].offsets[c]];
+            jobs.push_back({gi, c, comps[gi].size(c), g.row0 + first / g.width, g.col0 + first % g.width});
+        }
+    }
+    std::sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) {
+        if (a.size != b.size) return a.size > b.size;
+        return a.row != b.row ? a.row < b.row : a.col < b.col;
+    });
+
+    std::vector<Polygon> polygons(jobs.size());
+    auto trace = [&](size_t k) {
+        const auto& job = jobs[k];
+        const auto& cc = comps[job.grid];
+        polygons[k] = trace_component(grids[job.grid], cc.cells.data() + cc.offsets[job.comp], job.size);
+    };
+
+    size_t n_threads = total_cells >= parallel_cells ? binutil::worker_count(0) : 1;
+    binutil::parallel_for(jobs.size(), n_threads, trace);
     return polygons;
 }
 
@@ -361,21 +509,27 @@ static std::vector<Polygon> trace_polygons(ForestGrid& g) {
 // ---------------------------------------------------------------------------
 
 std::vector<Polygon> extract_from_objects(const std::vector<wrp::ObjectRecord>& objects) {
-    auto blocks = classify_forest(objects);
+    return extract_from_objects(objects, wrp::ModelTable::build(objects));
+}
+
+std::vector<Polygon> extract_from_objects(const std::vector<wrp::ObjectRecord>& objects,
+                                          const wrp::ModelTable& models) {
+    auto blocks = classify_forest(objects, models);
     if (blocks.empty()) return {};
 
-    // Group by forest type
-    std::unordered_map<ForestType, std::vector<ForestBlock>> by_type;
-    for (auto& b : blocks) by_type[b.type].push_back(std::move(b));
+    // Group by forest type, keeping object order within each
+    auto conifer = std::stable_partition(blocks.begin(), blocks.end(),
+                                         [](const ForestBlock& b) { return !b.conifer; });
+    std::span<const ForestBlock> all(blocks);
+    auto split = static_cast<size_t>(conifer - blocks.begin());
 
     std::vector<Polygon> polygons;
-    for (auto& ft : {forest_mixed, forest_conifer}) {
-        auto it = by_type.find(ft);
-        if (it == by_type.end()) continue;
+    for (auto [ft, group] : {std::pair{&forest_mixed, all.first(split)},
+                             std::pair{&forest_conifer, all.subspan(split)}}) {
+        if (group.empty()) continue;
 
-        auto grid = build_forest_grid(it->second);
-        auto polys = trace_polygons(grid);
-        for (auto& p : polys) p.type = ft;
+        auto polys = trace_polygons(group);
+        for (auto& p : polys) p.type = *ft;
         polygons.insert(polygons.end(),
                         std::make_move_iterator(polys.begin()),
                         std::make_move_iterator(polys.end()));
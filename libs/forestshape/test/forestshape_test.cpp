@@ -0,0 +1,122 @@
+#include "armatools/forestshape.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace armatools::forestshape;
+using armatools::wrp::ObjectRecord;
+
+namespace {
+
+constexpr double cell_area = 50.0 * 50.0;
+
+ObjectRecord block(const std::string& model, int col, int row, double yaw = 0) {
+    ObjectRecord o;
+    o.model_name = model;
+    o.position = {col * 50.0, 0, row * 50.0};
+    o.rotation.yaw = yaw;
+    return o;
+}
+
+ObjectRecord square(int col, int row) { return block("les_ctverec_pruhozi.p3d", col, row); }
+
+} // namespace
+
+TEST(ForestShape, RingWithHole) {
+    std::vector<ObjectRecord> objs;
+    for (int r = 0; r < 3; r++)
+        for (int c = 0; c < 3; c++)
+            if (c != 1 || r != 1) objs.push_back(square(c, r));
+
+    auto polys = extract_from_objects(objs);
+    ASSERT_EQ(polys.size(), 1u);
+    EXPECT_EQ(polys[0].id, 1);
+    EXPECT_EQ(polys[0].type, forest_mixed);
+    EXPECT_EQ(polys[0].cell_count, 8);
+    EXPECT_EQ(polys[0].area, 8 * cell_area);
+    EXPECT_EQ(polys[0].exterior.size(), 13u); // 12 unit edges, closed
+    ASSERT_EQ(polys[0].holes.size(), 1u);
+    EXPECT_EQ(polys[0].holes[0].size(), 5u);
+}
+
+TEST(ForestShape, CornerContactDoesNotConnect) {
+    auto polys = extract_from_objects({square(0, 0), square(1, 1)});
+    ASSERT_EQ(polys.size(), 2u);
+    EXPECT_EQ(polys[0].id, 1);
+    EXPECT_EQ(polys[1].id, 2);
+    EXPECT_EQ(polys[0].cell_count, 1);
+}
+
+TEST(ForestShape, TriangleConnectsOnItsLegs) {
+    // A yaw 0 triangle covers the north and west sides of its cell.
+    const std::string tri = "les_trojuhelnik_pruhozi.p3d";
+    auto west = extract_from_objects({block(tri, 1, 0), square(0, 0)});
+    ASSERT_EQ(west.size(), 1u);
+    EXPECT_EQ(west[0].area, 1.5 * cell_area);
+
+    auto east = extract_from_objects({block(tri, 1, 0), square(2, 0)});
+    EXPECT_EQ(east.size(), 2u);
+}
+
+TEST(ForestShape, TypesAreSeparate) {
+    auto polys = extract_from_objects({square(0, 0), block("les_ctverec_jehl.p3d", 1, 0)});
+    ASSERT_EQ(polys.size(), 2u);
+    EXPECT_NE(polys[0].type, polys[1].type);
+}
+
+TEST(ForestShape, ManyComponents) {
+    // Enough cells to trace on several threads: 65 strips of 260 squares.
+    std::vector<ObjectRecord> objs;
+    for (int r = 0; r < 130; r += 2)
+        for (int c = 0; c < 260; c++) objs.push_back(square(c, r));
+
+    auto polys = extract_from_objects(objs);
+    ASSERT_EQ(polys.size(), 65u);
+    for (size_t i = 0; i < polys.size(); i++) {
+        EXPECT_EQ(polys[i].id, static_cast<int>(i) + 1);
+        EXPECT_EQ(polys[i].cell_count, 260);
+        EXPECT_EQ(polys[i].exterior.size(), 2u * 261 + 1);
+        EXPECT_TRUE(polys[i].holes.empty());
+    }
+}
+
+TEST(ForestShape, StrayBlockFarAway) {
+    // One grid over the bounding box would take 10^14 cells.
+    std::vector<ObjectRecord> objs = {square(0, 0), square(1, 0), square(0, 1)};
+    objs.push_back(square(10000000, 10000000));
+    objs.push_back(square(-10000000, 3));
+    objs.push_back(square(2, 10000000));
+
+    auto polys = extract_from_objects(objs);
+    ASSERT_EQ(polys.size(), 4u);
+    EXPECT_EQ(polys[0].cell_count, 3);
+    EXPECT_DOUBLE_EQ(polys[0].area, 3 * cell_area);
+    for (size_t i = 1; i < polys.size(); i++) {
+        EXPECT_EQ(polys[i].cell_count, 1);
+        EXPECT_EQ(polys[i].exterior.size(), 5u);
+    }
+}
+
+TEST(ForestShape, RegionsMatchOneGrid) {
+    // Areas separated by empty rows and columns trace the same as when
+    // they touch the same grid: an L, a triangle pair and a ring.
+    std::vector<ObjectRecord> objs;
+    for (int c = 0; c < 4; c++) objs.push_back(square(c, 0));
+    objs.push_back(square(0, 1));
+    objs.push_back(block("les_trojuhelnik_pruhozi.p3d", 6, 0, 0));
+    objs.push_back(block("les_trojuhelnik_pruhozi.p3d", 5, 0, 180));
+    for (int r = 3; r < 6; r++)
+        for (int c = 0; c < 3; c++)
+            if (r != 4 || c != 1) objs.push_back(square(c, r));
+
+    auto polys = extract_from_objects(objs);
+    ASSERT_EQ(polys.size(), 3u);
+    EXPECT_EQ(polys[0].cell_count, 8);
+    EXPECT_EQ(polys[0].holes.size(), 1u);
+    EXPECT_EQ(polys[1].cell_count, 5);
+    EXPECT_EQ(polys[1].exterior.size(), 13u);
+    EXPECT_EQ(polys[2].cell_count, 2);
+    EXPECT_DOUBLE_EQ(polys[2].area, cell_area);
+}
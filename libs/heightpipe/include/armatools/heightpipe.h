@@ -22,6 +22,12 @@ struct Heightmap {
 
 enum class EdgeMode { Clamp, Wrap, Mirror };
 enum class ResampleMethod { Bicubic, Lanczos3 };
+
+// SampleAlign selects how output samples map onto the input grid. Center
+// treats samples as pixel areas: output x reads input (x + 0.5) / scale - 0.5.
+// Origin treats them as grid vertices: output x reads input x / scale, so
+// the terrain keeps its origin and cell size divides by the scale.
+enum class SampleAlign { Center, Origin };
 enum class CorrectionMode {
     None,
     Unsharp,
@@ -62,6 +68,10 @@ struct UpscaleCorrectionParams {
     float noise_slope_weight = 0.7f;
     float noise_curv_weight = 0.3f;
     float noise_bias = 0.05f;
+
+    // Alignment the upsampled input was resampled with; the source residual
+    // is resampled the same way so that the detail stays registered.
+    SampleAlign align = SampleAlign::Center;
 };
 
 struct ErosionParams {
@@ -88,6 +98,15 @@ struct ErosionParams {
     float thermal_factor = 0.2f;
 };
 
+// ResampleOptions configures resample. Rows are processed in bands on
+// worker threads; the output does not depend on the thread count.
+struct ResampleOptions {
+    ResampleMethod method = ResampleMethod::Bicubic;
+    EdgeMode edge_mode = EdgeMode::Clamp;
+    SampleAlign align = SampleAlign::Center;
+    int threads = 0; // 0 = all cores
+};
+
 struct PipelineOptions {
     int scale = 2;
     ResampleMethod resample = ResampleMethod::Bicubic;
@@ -95,6 +114,7 @@ struct PipelineOptions {
     UpscaleCorrectionParams correction;
     ErosionParams erosion;
     uint32_t seed = 1;
+    int threads = 0; // resampling and correction; erosion stays sequential
     bool dump_slope = false;
     bool dump_curvature = false;
     bool dump_flow = false;
@@ -108,13 +128,16 @@ struct PipelineOutputs {
 };
 
 Heightmap resample(const Heightmap& in, int scale, ResampleMethod method, EdgeMode edge_mode);
+Heightmap resample(const Heightmap& in, int scale, const ResampleOptions& opts);
 Heightmap apply_upscale_corrections(
     const Heightmap& upsampled,
     const Heightmap& source,
     int scale,
     const UpscaleCorrectionParams& params,
-    uint32_t seed);
-Heightmap erode_multiscale(const Heightmap& input, int scale, const ErosionParams& params, uint32_t seed, Heightmap* flow_out = nullptr);
+    uint32_t seed,
+    int threads = 0);
+Heightmap erode_multiscale(const Heightmap& input, int scale, const ErosionParams& params, uint32_t seed,
+                           Heightmap* flow_out = nullptr, int threads = 0);
 PipelineOutputs run_pipeline(const Heightmap& in, const PipelineOptions& opt);
 
 UpscaleCorrectionParams correction_preset_for_scale(int scale, CorrectionPreset preset);
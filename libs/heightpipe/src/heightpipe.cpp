@@ -1,4 +1,5 @@
 #include "armatools/heightpipe.h"
+#include "armatools/parallel.h"
 
 #include <algorithm>
 #include <array>
@@ -31,6 +32,26 @@ struct Rng32 {
     }
 };
 
+// parallel_rows runs fn(y0, y1) over bands of [0, rows) on up to threads
+// workers (0 = all cores), including the calling thread. Each band writes
+// only its own output rows, so results do not depend on the thread count.
+template <class Fn>
+void parallel_rows(int rows, int threads, const Fn& fn) {
+    if (rows <= 0) return;
+    const size_t n = std::min(binutil::worker_count(threads), static_cast<size_t>(rows));
+    if (n <= 1) {
+        fn(0, rows);
+        return;
+    }
+
+    const int band = std::max(1, rows / static_cast<int>(n * 4));
+    const auto bands = static_cast<size_t>((rows + band - 1) / band);
+    binutil::parallel_for(bands, n, [&](size_t b) {
+        const int y0 = static_cast<int>(b) * band;
+        fn(y0, std::min(rows, y0 + band));
+    });
+}
+
 [[nodiscard]] int posmod(int v, int m) {
     const int r = v % m;
     return r < 0 ? r + m : r;
@@ -84,55 +105,81 @@ struct Rng32 {
     return sinc(x) * sinc(x / static_cast<float>(a));
 }
 
-[[nodiscard]] float bicubic_sample(const Heightmap& h, float x, float y, EdgeMode mode) {
-    const int ix = static_cast<int>(std::floor(x));
-    const int iy = static_cast<int>(std::floor(y));
-    float sum = 0.0f;
-    float wsum = 0.0f;
-    for (int j = -1; j <= 2; ++j) {
-        const float wy = cubic_weight(y - static_cast<float>(iy + j));
-        for (int i = -1; i <= 2; ++i) {
-            const float wx = cubic_weight(x - static_cast<float>(ix + i));
-            const float w = wx * wy;
-            sum += w * sample_nearest(h, ix + i, iy + j, mode);
-            wsum += w;
-        }
-    }
-    return wsum != 0.0f ? sum / wsum : sample_nearest(h, ix, iy, mode);
-}
+// Taps holds a separable resampling kernel along one axis: for every output
+// coordinate, size edge-resolved input indices and their normalized weights.
+struct Taps {
+    int size = 0;
+    std::vector<int> index;
+    std::vector<float> weight;
+};
 
-[[nodiscard]] float lanczos3_sample(const Heightmap& h, float x, float y, EdgeMode mode) {
-    constexpr int a = 3;
-    const int ix = static_cast<int>(std::floor(x));
-    const int iy = static_cast<int>(std::floor(y));
-    float sum = 0.0f;
-    float wsum = 0.0f;
-    for (int j = -a + 1; j <= a; ++j) {
-        const float wy = lanczos_weight(y - static_cast<float>(iy + j), a);
-        for (int i = -a + 1; i <= a; ++i) {
-            const float wx = lanczos_weight(x - static_cast<float>(ix + i), a);
-            const float w = wx * wy;
-            sum += w * sample_nearest(h, ix + i, iy + j, mode);
-            wsum += w;
+[[nodiscard]] Taps make_taps(int in_n, int out_n, ResampleMethod method, EdgeMode mode, SampleAlign align) {
+    const int a = method == ResampleMethod::Lanczos3 ? 3 : 2;
+    Taps t;
+    t.size = 2 * a;
+    t.index.resize(static_cast<size_t>(out_n * t.size));
+    t.weight.resize(t.index.size());
+    const float s = static_cast<float>(in_n) / static_cast<float>(out_n);
+    for (int o = 0; o < out_n; ++o) {
+        const float src = align == SampleAlign::Center
+            ? (static_cast<float>(o) + 0.5f) * s - 0.5f
+            : static_cast<float>(o) * s;
+        const int i0 = static_cast<int>(std::floor(src));
+        int* idx = t.index.data() + o * t.size;
+        float* w = t.weight.data() + o * t.size;
+        float wsum = 0.0f;
+        for (int k = 0; k < t.size; ++k) {
+            const int i = i0 - a + 1 + k;
+            const float d = src - static_cast<float>(i);
+            idx[k] = edge_index(i, in_n, mode);
+            w[k] = method == ResampleMethod::Lanczos3 ? lanczos_weight(d, a) : cubic_weight(d);
+            wsum += w[k];
+        }
+        for (int k = 0; k < t.size; ++k) {
+            // A kernel that sums to zero falls back to the nearest sample.
+            w[k] = wsum != 0.0f ? w[k] / wsum : (k == a - 1 ? 1.0f : 0.0f);
         }
     }
-    return wsum != 0.0f ? sum / wsum : sample_nearest(h, ix, iy, mode);
+    return t;
 }
 
-[[nodiscard]] Heightmap resample_to(const Heightmap& in, int out_w, int out_h, ResampleMethod method, EdgeMode edge_mode) {
+// resample_to filters rows into an intermediate of out_w columns, then
+// filters columns; both passes run in row bands on worker threads.
+[[nodiscard]] Heightmap resample_to(const Heightmap& in, int out_w, int out_h, ResampleMethod method,
+                                    EdgeMode edge_mode, SampleAlign align = SampleAlign::Center,
+                                    int threads = 0) {
     if (in.empty()) return {};
+    const Taps tx = make_taps(in.width, out_w, method, edge_mode, align);
+    const Taps ty = make_taps(in.height, out_h, method, edge_mode, align);
+
+    Heightmap tmp(out_w, in.height, 0.0f);
+    parallel_rows(in.height, threads, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            const float* src = in.data.data() + static_cast<size_t>(y) * static_cast<size_t>(in.width);
+            float* dst = tmp.data.data() + static_cast<size_t>(y) * static_cast<size_t>(out_w);
+            for (int x = 0; x < out_w; ++x) {
+                const int* idx = tx.index.data() + x * tx.size;
+                const float* w = tx.weight.data() + x * tx.size;
+                float sum = 0.0f;
+                for (int k = 0; k < tx.size; ++k) sum += w[k] * src[idx[k]];
+                dst[x] = sum;
+            }
+        }
+    });
+
     Heightmap out(out_w, out_h, 0.0f);
-    const float sx = static_cast<float>(in.width) / static_cast<float>(out_w);
-    const float sy = static_cast<float>(in.height) / static_cast<float>(out_h);
-    for (int y = 0; y < out_h; ++y) {
-        const float src_y = (static_cast<float>(y) + 0.5f) * sy - 0.5f;
-        for (int x = 0; x < out_w; ++x) {
-            const float src_x = (static_cast<float>(x) + 0.5f) * sx - 0.5f;
-            out.at(x, y) = (method == ResampleMethod::Lanczos3)
-                ? lanczos3_sample(in, src_x, src_y, edge_mode)
-                : bicubic_sample(in, src_x, src_y, edge_mode);
+    parallel_rows(out_h, threads, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            float* dst = out.data.data() + static_cast<size_t>(y) * static_cast<size_t>(out_w);
+            for (int k = 0; k < ty.size; ++k) {
+                const float w = ty.weight[static_cast<size_t>(y * ty.size + k)];
+                if (w == 0.0f) continue;
+                const float* src = tmp.data.data() +
+                    static_cast<size_t>(ty.index[static_cast<size_t>(y * ty.size + k)]) * static_cast<size_t>(out_w);
+                for (int x = 0; x < out_w; ++x) dst[x] += w * src[x];
+            }
         }
-    }
+    });
     return out;
 }
 
@@ -150,60 +197,69 @@ struct Rng32 {
     return k;
 }
 
-[[nodiscard]] Heightmap convolve_separable(const Heightmap& in, const std::vector<float>& kernel, EdgeMode edge_mode) {
+[[nodiscard]] Heightmap convolve_separable(const Heightmap& in, const std::vector<float>& kernel, EdgeMode edge_mode,
+                                           int threads) {
     const int radius = static_cast<int>(kernel.size() / 2);
     Heightmap tmp(in.width, in.height, 0.0f);
     Heightmap out(in.width, in.height, 0.0f);
-    for (int y = 0; y < in.height; ++y) {
-        for (int x = 0; x < in.width; ++x) {
-            float s = 0.0f;
-            for (int i = -radius; i <= radius; ++i) {
-                s += kernel[static_cast<size_t>(i + radius)] * sample_nearest(in, x + i, y, edge_mode);
+    parallel_rows(in.height, threads, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            for (int x = 0; x < in.width; ++x) {
+                float s = 0.0f;
+                for (int i = -radius; i <= radius; ++i) {
+                    s += kernel[static_cast<size_t>(i + radius)] * sample_nearest(in, x + i, y, edge_mode);
+                }
+                tmp.at(x, y) = s;
             }
-            tmp.at(x, y) = s;
         }
-    }
-    for (int y = 0; y < in.height; ++y) {
-        for (int x = 0; x < in.width; ++x) {
-            float s = 0.0f;
-            for (int i = -radius; i <= radius; ++i) {
-                s += kernel[static_cast<size_t>(i + radius)] * sample_nearest(tmp, x, y + i, edge_mode);
+    });
+    parallel_rows(in.height, threads, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            for (int x = 0; x < in.width; ++x) {
+                float s = 0.0f;
+                for (int i = -radius; i <= radius; ++i) {
+                    s += kernel[static_cast<size_t>(i + radius)] * sample_nearest(tmp, x, y + i, edge_mode);
+                }
+                out.at(x, y) = s;
             }
-            out.at(x, y) = s;
         }
-    }
+    });
     return out;
 }
 
-[[nodiscard]] Heightmap gaussian_blur(const Heightmap& in, float sigma, EdgeMode edge_mode) {
-    return convolve_separable(in, gaussian_kernel(sigma), edge_mode);
+[[nodiscard]] Heightmap gaussian_blur(const Heightmap& in, float sigma, EdgeMode edge_mode, int threads) {
+    return convolve_separable(in, gaussian_kernel(sigma), edge_mode, threads);
 }
 
-[[nodiscard]] Heightmap slope_map(const Heightmap& in, EdgeMode mode) {
+[[nodiscard]] Heightmap slope_map(const Heightmap& in, EdgeMode mode, int threads = 0) {
     Heightmap out(in.width, in.height, 0.0f);
-    for (int y = 0; y < in.height; ++y) {
-        for (int x = 0; x < in.width; ++x) {
-            const float dx = 0.5f * (sample_nearest(in, x + 1, y, mode) - sample_nearest(in, x - 1, y, mode));
-            const float dy = 0.5f * (sample_nearest(in, x, y + 1, mode) - sample_nearest(in, x, y - 1, mode));
-            out.at(x, y) = std::sqrt(dx * dx + dy * dy);
+    parallel_rows(in.height, threads, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            for (int x = 0; x < in.width; ++x) {
+                const float dx = 0.5f * (sample_nearest(in, x + 1, y, mode) - sample_nearest(in, x - 1, y, mode));
+                const float dy = 0.5f * (sample_nearest(in, x, y + 1, mode) - sample_nearest(in, x, y - 1, mode));
+                out.at(x, y) = std::sqrt(dx * dx + dy * dy);
+            }
         }
-    }
+    });
     return out;
 }
 
-[[nodiscard]] Heightmap curvature_map(const Heightmap& in, EdgeMode mode) {
+[[nodiscard]] Heightmap curvature_map(const Heightmap& in, EdgeMode mode, int threads = 0) {
     Heightmap out(in.width, in.height, 0.0f);
-    for (int y = 0; y < in.height; ++y) {
-        for (int x = 0; x < in.width; ++x) {
-            const float c = sample_nearest(in, x, y, mode);
-            out.at(x, y) =
-                sample_nearest(in, x - 1, y, mode) +
-                sample_nearest(in, x + 1, y, mode) +
-                sample_nearest(in, x, y - 1, mode) +
-                sample_nearest(in, x, y + 1, mode) -
-                4.0f * c;
+    parallel_rows(in.height, threads, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            for (int x = 0; x < in.width; ++x) {
+                const float c = sample_nearest(in, x, y, mode);
+                out.at(x, y) =
+                    sample_nearest(in, x - 1, y, mode) +
+                    sample_nearest(in, x + 1, y, mode) +
+                    sample_nearest(in, x, y - 1, mode) +
+                    sample_nearest(in, x, y + 1, mode) -
+                    4.0f * c;
+            }
         }
-    }
+    });
     return out;
 }
 
@@ -316,29 +372,45 @@ void add_brush(Heightmap& h, float x, float y, float amount, float radius, EdgeM
     }
 }
 
-[[nodiscard]] Heightmap guided_like_filter(const Heightmap& in, float radius, float sigma, EdgeMode mode) {
+[[nodiscard]] Heightmap guided_like_filter(const Heightmap& in, float radius, float sigma, EdgeMode mode, int threads) {
     const int ir = std::max(1, static_cast<int>(std::ceil(radius)));
+    const int dim = 2 * ir + 1;
     Heightmap out(in.width, in.height, 0.0f);
     const float sig2 = std::max(1e-4f, sigma * sigma);
 
-    for (int y = 0; y < in.height; ++y) {
-        for (int x = 0; x < in.width; ++x) {
-            const float center = in.at(x, y);
-            float wsum = 0.0f;
-            float sum = 0.0f;
-            for (int j = -ir; j <= ir; ++j) {
-                for (int i = -ir; i <= ir; ++i) {
-                    const float v = sample_nearest(in, x + i, y + j, mode);
-                    const float ds2 = static_cast<float>(i * i + j * j);
-                    const float dr = v - center;
-                    const float w = std::exp(-ds2 / (2.0f * radius * radius + 1e-4f) - (dr * dr) / (2.0f * sig2));
-                    wsum += w;
-                    sum += w * v;
+    // The spatial term depends only on the offset; only the range term
+    // needs an exp per tap.
+    std::vector<float> spatial(static_cast<size_t>(dim * dim));
+    for (int j = -ir; j <= ir; ++j) {
+        for (int i = -ir; i <= ir; ++i) {
+            const float ds2 = static_cast<float>(i * i + j * j);
+            spatial[static_cast<size_t>((j + ir) * dim + (i + ir))] = std::exp(-ds2 / (2.0f * radius * radius + 1e-4f));
+        }
+    }
+
+    const float inv_range = 1.0f / (2.0f * sig2);
+    parallel_rows(in.height, threads, [&in, &out, &spatial, ir, dim, inv_range, mode](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            for (int x = 0; x < in.width; ++x) {
+                const float center = in.at(x, y);
+                const bool interior = x >= ir && y >= ir && x + ir < in.width && y + ir < in.height;
+                float wsum = 0.0f;
+                float sum = 0.0f;
+                for (int j = -ir; j <= ir; ++j) {
+                    const float* ws = spatial.data() + (j + ir) * dim + ir;
+                    const float* row = interior ? &in.at(x, y + j) : nullptr;
+                    for (int i = -ir; i <= ir; ++i) {
+                        const float v = interior ? row[i] : sample_nearest(in, x + i, y + j, mode);
+                        const float dr = v - center;
+                        const float w = ws[i] * std::exp(-(dr * dr) * inv_range);
+                        wsum += w;
+                        sum += w * v;
+                    }
                 }
+                out.at(x, y) = wsum > 0.0f ? sum / wsum : center;
             }
-            out.at(x, y) = wsum > 0.0f ? sum / wsum : center;
         }
-    }
+    });
     return out;
 }
 
@@ -449,7 +521,8 @@ void thermal_erosion(Heightmap& h, int iterations, float talus, float factor) {
 
 } // namespace
 
-Heightmap::Heightmap(int w, int h, float value) : width(w), height(h), data(static_cast<size_t>(w * h), value) {}
+Heightmap::Heightmap(int w, int h, float value)
+    : width(w), height(h), data(static_cast<size_t>(w) * static_cast<size_t>(h), value) {}
 
 bool Heightmap::empty() const {
     return width <= 0 || height <= 0 || data.empty();
@@ -545,9 +618,13 @@ ErosionParams erosion_preset_for_scale(int scale) {
 }
 
 Heightmap resample(const Heightmap& in, int scale, ResampleMethod method, EdgeMode edge_mode) {
+    return resample(in, scale, ResampleOptions{.method = method, .edge_mode = edge_mode});
+}
+
+Heightmap resample(const Heightmap& in, int scale, const ResampleOptions& opts) {
     if (scale <= 1) return in;
     if (in.empty()) return {};
-    return resample_to(in, in.width * scale, in.height * scale, method, edge_mode);
+    return resample_to(in, in.width * scale, in.height * scale, opts.method, opts.edge_mode, opts.align, opts.threads);
 }
 
 Heightmap apply_upscale_corrections(
@@ -555,7 +632,8 @@ Heightmap apply_upscale_corrections(
     const Heightmap& source,
     int scale,
     const UpscaleCorrectionParams& params,
-    uint32_t seed) {
+    uint32_t seed,
+    int threads) {
     if (upsampled.empty()) return {};
     if (params.mode == CorrectionMode::None) return upsampled;
 
@@ -570,7 +648,7 @@ Heightmap apply_upscale_corrections(
         (params.residual_gain_max - params.residual_gain_min) * (static_cast<float>(levels) / 4.0f);
 
     if (params.enable_unsharp || params.mode == CorrectionMode::Unsharp || params.mode == CorrectionMode::Hybrid) {
-        const Heightmap blur = gaussian_blur(out, unsharp_sigma, EdgeMode::Clamp);
+        const Heightmap blur = gaussian_blur(out, unsharp_sigma, EdgeMode::Clamp, threads);
         for (size_t i = 0; i < out.data.size(); ++i) {
             out.data[i] = out.data[i] + unsharp_amount * (out.data[i] - blur.data[i]);
         }
@@ -578,7 +656,7 @@ Heightmap apply_upscale_corrections(
 
     if (params.enable_guided_sharp || params.mode == CorrectionMode::GuidedSharp || params.mode == CorrectionMode::Hybrid) {
         const float guided_radius = params.guided_radius_base * static_cast<float>(levels + 1);
-        const Heightmap base = guided_like_filter(out, guided_radius, params.guided_sigma * range, EdgeMode::Clamp);
+        const Heightmap base = guided_like_filter(out, guided_radius, params.guided_sigma * range, EdgeMode::Clamp, threads);
         for (size_t i = 0; i < out.data.size(); ++i) {
             const float detail = out.data[i] - base.data[i];
             out.data[i] = base.data[i] + params.guided_sharpen * detail;
@@ -591,8 +669,8 @@ Heightmap apply_upscale_corrections(
     bool have_curv = false;
 
     if (params.enable_curvature || params.mode == CorrectionMode::CurvatureGain || params.mode == CorrectionMode::Hybrid) {
-        curvature = curvature_map(out, EdgeMode::Clamp);
-        slope = slope_map(out, EdgeMode::Clamp);
+        curvature = curvature_map(out, EdgeMode::Clamp, threads);
+        slope = slope_map(out, EdgeMode::Clamp, threads);
         have_slope = true;
         have_curv = true;
         const float k = params.curvature_gain_base * static_cast<float>(levels) * range;
@@ -605,37 +683,40 @@ Heightmap apply_upscale_corrections(
 
     if ((params.enable_residual || params.mode == CorrectionMode::Residual || params.mode == CorrectionMode::Hybrid) && !source.empty()) {
         const float sigma_src = std::max(0.75f, 0.4f * static_cast<float>(scale));
-        const Heightmap low = gaussian_blur(source, sigma_src, EdgeMode::Clamp);
+        const Heightmap low = gaussian_blur(source, sigma_src, EdgeMode::Clamp, threads);
         Heightmap resid(source.width, source.height, 0.0f);
         for (size_t i = 0; i < resid.data.size(); ++i) resid.data[i] = source.data[i] - low.data[i];
-        const Heightmap up = resample_to(resid, out.width, out.height, ResampleMethod::Bicubic, EdgeMode::Clamp);
+        const Heightmap up = resample_to(resid, out.width, out.height, ResampleMethod::Bicubic, EdgeMode::Clamp,
+                                         params.align, threads);
         for (size_t i = 0; i < out.data.size(); ++i) out.data[i] += resid_gain * up.data[i];
     }
 
     if (params.enable_noise && scale >= 4) {
         if (!have_slope) {
-            slope = slope_map(out, EdgeMode::Clamp);
+            slope = slope_map(out, EdgeMode::Clamp, threads);
             have_slope = true;
         }
         if (!have_curv) {
-            curvature = curvature_map(out, EdgeMode::Clamp);
+            curvature = curvature_map(out, EdgeMode::Clamp, threads);
             have_curv = true;
         }
         const float noise_amp = range * (params.noise_base_amp * static_cast<float>(levels));
         const int octaves = std::max(1, levels);
-        for (int y = 0; y < out.height; ++y) {
-            for (int x = 0; x < out.width; ++x) {
-                const size_t idx = static_cast<size_t>(y * out.width + x);
-                const float sn = slope.data[idx] / (range + 1e-6f);
-                const float cn = std::fabs(curvature.data[idx]) / (range + 1e-6f);
-                const float m = std::clamp(
-                    params.noise_slope_weight * sn + params.noise_curv_weight * cn + params.noise_bias,
-                    0.0f,
-                    1.0f);
-                const float n = fbm_noise(static_cast<float>(x) * 0.02f, static_cast<float>(y) * 0.02f, octaves, seed);
-                out.at(x, y) += noise_amp * n * m;
+        parallel_rows(out.height, threads, [&](int y0, int y1) {
+            for (int y = y0; y < y1; ++y) {
+                for (int x = 0; x < out.width; ++x) {
+                    const size_t idx = static_cast<size_t>(y * out.width + x);
+                    const float sn = slope.data[idx] / (range + 1e-6f);
+                    const float cn = std::fabs(curvature.data[idx]) / (range + 1e-6f);
+                    const float m = std::clamp(
+                        params.noise_slope_weight * sn + params.noise_curv_weight * cn + params.noise_bias,
+                        0.0f,
+                        1.0f);
+                    const float n = fbm_noise(static_cast<float>(x) * 0.02f, static_cast<float>(y) * 0.02f, octaves, seed);
+                    out.at(x, y) += noise_amp * n * m;
+                }
             }
-        }
+        });
     }
 
     const float src_mean = std::accumulate(upsampled.data.begin(), upsampled.data.end(), 0.0f) / static_cast<float>(upsampled.data.size());
@@ -650,7 +731,8 @@ Heightmap apply_upscale_corrections(
     return out;
 }
 
-Heightmap erode_multiscale(const Heightmap& input, int scale, const ErosionParams& params, uint32_t seed, Heightmap* flow_out) {
+Heightmap erode_multiscale(const Heightmap& input, int scale, const ErosionParams& params, uint32_t seed,
+                           Heightmap* flow_out, int threads) {
     if (input.empty()) return {};
     Heightmap out = input;
     Heightmap flow(input.width, input.height, 0.0f);
@@ -659,14 +741,16 @@ Heightmap erode_multiscale(const Heightmap& input, int scale, const ErosionParam
         const int factor = std::clamp(scale / 2, 2, 8);
         const int mw = std::max(2, input.width / factor);
         const int mh = std::max(2, input.height / factor);
-        Heightmap macro = resample_to(out, mw, mh, ResampleMethod::Bicubic, EdgeMode::Clamp);
+        Heightmap macro = resample_to(out, mw, mh, ResampleMethod::Bicubic, EdgeMode::Clamp,
+                                      SampleAlign::Center, threads);
 
         ErosionParams mp = params;
         mp.radius_base = std::max(1.0f, params.radius_base * std::pow(static_cast<float>(factor), 0.75f));
         mp.max_steps = std::max(10, params.max_steps * factor / 2);
         hydraulic_erosion(macro, nullptr, std::max(1000, params.macro_droplets), mp, seed ^ 0xA511E9B3u);
 
-        const Heightmap macro_up = resample_to(macro, out.width, out.height, ResampleMethod::Bicubic, EdgeMode::Clamp);
+        const Heightmap macro_up = resample_to(macro, out.width, out.height, ResampleMethod::Bicubic,
+                                                   EdgeMode::Clamp, SampleAlign::Center, threads);
         const float blend = std::clamp(0.35f + 0.08f * static_cast<float>(scale_levels(scale)), 0.4f, 0.7f);
         for (size_t i = 0; i < out.data.size(); ++i) {
             out.data[i] = out.data[i] + blend * (macro_up.data[i] - out.data[i]);
@@ -699,20 +783,21 @@ PipelineOutputs run_pipeline(const Heightmap& in, const PipelineOptions& opt) {
     }
 
     PipelineOutputs out;
-    const Heightmap up = resample(in, opt.scale, opt.resample, opt.edge_mode);
+    const Heightmap up = resample(in, opt.scale,
+                                  ResampleOptions{.method = opt.resample, .edge_mode = opt.edge_mode, .threads = opt.threads});
 
     UpscaleCorrectionParams cp = opt.correction;
     if (cp.mode == CorrectionMode::Preset) {
         cp = correction_preset_for_scale(opt.scale, cp.preset);
     }
 
-    const Heightmap corrected = apply_upscale_corrections(up, in, opt.scale, cp, opt.seed);
+    const Heightmap corrected = apply_upscale_corrections(up, in, opt.scale, cp, opt.seed, opt.threads);
 
     Heightmap flow;
-    out.out = erode_multiscale(corrected, opt.scale, opt.erosion, opt.seed, opt.dump_flow ? &flow : nullptr);
+    out.out = erode_multiscale(corrected, opt.scale, opt.erosion, opt.seed, opt.dump_flow ? &flow : nullptr, opt.threads);
 
-    if (opt.dump_slope) out.slope = slope_map(out.out, opt.edge_mode);
-    if (opt.dump_curvature) out.curvature = curvature_map(out.out, opt.edge_mode);
+    if (opt.dump_slope) out.slope = slope_map(out.out, opt.edge_mode, opt.threads);
+    if (opt.dump_curvature) out.curvature = curvature_map(out.out, opt.edge_mode, opt.threads);
     if (opt.dump_flow) out.flow = std::move(flow);
 
     for (float v : out.out.data) {
@@ -94,3 +94,46 @@ TEST(Heightpipe, MacroShapeRoughlyPreserved) {
 
     EXPECT_LT(rmse(src, reduced), 15.0f);
 }
+
+TEST(Heightpipe, ResampleIndependentOfThreads) {
+    const hp::Heightmap src = make_ramp(37, 29);
+    for (auto method : {hp::ResampleMethod::Bicubic, hp::ResampleMethod::Lanczos3}) {
+        const hp::Heightmap a = hp::resample(src, 4, {.method = method, .threads = 1});
+        const hp::Heightmap b = hp::resample(src, 4, {.method = method, .threads = 3});
+        ASSERT_EQ(a.data.size(), b.data.size());
+        for (size_t i = 0; i < a.data.size(); ++i) {
+            ASSERT_EQ(a.data[i], b.data[i]);
+        }
+    }
+}
+
+TEST(Heightpipe, OriginAlignKeepsGridVertices) {
+    hp::Heightmap src(9, 7, 0.0f);
+    for (size_t i = 0; i < src.data.size(); ++i) src.data[i] = static_cast<float>((i * 37) % 11);
+
+    const hp::Heightmap up = hp::resample(src, 8, {.align = hp::SampleAlign::Origin, .threads = 2});
+    ASSERT_EQ(up.width, 72);
+    ASSERT_EQ(up.height, 56);
+    for (int y = 0; y < src.height; ++y) {
+        for (int x = 0; x < src.width; ++x) {
+            EXPECT_FLOAT_EQ(up.at(x * 8, y * 8), src.at(x, y));
+        }
+    }
+}
+
+TEST(Heightpipe, ResidualDetailFollowsOriginAlign) {
+    hp::Heightmap src(16, 16, 0.0f);
+    src.at(8, 8) = 10.0f;
+
+    for (auto preset : {hp::CorrectionPreset::RetainDetail, hp::CorrectionPreset::Terrain16x}) {
+        const int scale = preset == hp::CorrectionPreset::Terrain16x ? 16 : 4;
+        const hp::Heightmap up = hp::resample(src, scale, {.align = hp::SampleAlign::Origin, .threads = 1});
+        hp::UpscaleCorrectionParams cp = hp::correction_preset_for_scale(scale, preset);
+        cp.align = hp::SampleAlign::Origin;
+        const hp::Heightmap out = hp::apply_upscale_corrections(up, src, scale, cp, 1, 2);
+
+        const auto peak = std::max_element(out.data.begin(), out.data.end()) - out.data.begin();
+        EXPECT_EQ(static_cast<int>(peak % out.width), 8 * scale);
+        EXPECT_EQ(static_cast<int>(peak / out.width), 8 * scale);
+    }
+}
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <istream>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -23,9 +24,18 @@ struct Header {
 };
 
 // read_header parses OGG pages to extract Vorbis identification, comment,
-// and setup headers.
+// and setup headers. Pages are read one at a time and reading stops after
+// the setup header, so only the header pages are consumed from r.
 Header read_header(std::istream& r);
 
+// read_header reads at most max_bytes from r, for an Ogg stream stored
+// inside a larger file such as an uncompressed PBO entry.
+Header read_header(std::istream& r, uint64_t max_bytes);
+
+// read_header parses the headers of an Ogg stream held in memory without
+// copying packets that fit in one page.
+Header read_header(std::span<const uint8_t> data);
+
 // is_pre_one_encoder returns true if the encoder string matches known
 // pre-1.0 Vorbis encoder patterns.
 bool is_pre_one_encoder(const std::string& encoder);
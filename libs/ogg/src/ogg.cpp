@@ -1,10 +1,12 @@
 #include "armatools/ogg.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstring>
 #include <limits>
 #include <stdexcept>
+#include <vector>
 
 namespace armatools::ogg {
 
@@ -42,8 +44,9 @@ static int ilog(uint32_t v) {
 static int64_t int_pow(int base, int exp) {
     int64_t result = 1;
     for (int i = 0; i < exp; i++) {
+        if (base != 0 && result > std::numeric_limits<int64_t>::max() / base)
+            return std::numeric_limits<int64_t>::max();
         result *= base;
-        if (result < 0) return std::numeric_limits<int64_t>::max();
     }
     return result;
 }
@@ -57,57 +60,93 @@ static int lookup1_values(int entries, int dims) {
 }
 
 // --- OGG page parsing ---
-
-struct OggPage {
-    std::vector<uint8_t> segment_table;
-    std::vector<uint8_t> body;
-    bool continued = false;
+//
+// Pages are read one at a time and only the packet being assembled is kept.
+// A packet that fits in one page is parsed where it lies in the page body;
+// only packets continued across pages are copied.
+
+struct PageView {
+    const uint8_t* segments = nullptr;
+    size_t n_segments = 0;
+    const uint8_t* body = nullptr;
+    size_t body_size = 0;
 };
 
-static OggPage read_ogg_page(std::istream& r) {
-    uint8_t hdr[27];
-    if (!r.read(reinterpret_cast<char*>(hdr), 27))
-        throw std::runtime_error("ogg: reading page header");
-    if (std::memcmp(hdr, "OggS", 4) != 0)
-        throw std::runtime_error("ogg: invalid capture pattern");
+constexpr size_t page_header_size = 27;
 
-    OggPage page;
-    page.continued = (hdr[5] & 0x01) != 0;
-    int n_segments = hdr[26];
+static size_t body_size_of(const uint8_t* segments, size_t n) {
+    size_t size = 0;
+    for (size_t i = 0; i < n; i++) size += segments[i];
+    return size;
+}
 
-    page.segment_table.resize(static_cast<size_t>(n_segments));
-    if (!r.read(reinterpret_cast<char*>(page.segment_table.data()), n_segments))
-        throw std::runtime_error("ogg: reading segment table");
+// StreamPages reads pages into a heap buffer sized to the largest page seen,
+// consuming at most limit bytes. Header pages are small, so probing does
+// not reserve a full 64 KiB page body on the caller's stack.
+class StreamPages {
+public:
+    StreamPages(std::istream& r, uint64_t limit) : r_(r), remaining_(limit) {}
+
+    PageView next() {
+        uint8_t hdr[page_header_size];
+        read(hdr, page_header_size, "ogg: reading page header");
+        if (std::memcmp(hdr, "OggS", 4) != 0)
+            throw std::runtime_error("ogg: invalid capture pattern");
+
+        PageView page;
+        page.n_segments = hdr[26];
+        read(segments_.data(), page.n_segments, "ogg: reading segment table");
+        page.segments = segments_.data();
+        page.body_size = body_size_of(segments_.data(), page.n_segments);
+        if (body_.size() < page.body_size) body_.resize(page.body_size);
+        read(body_.data(), page.body_size, "ogg: reading page body");
+        page.body = body_.data();
+        return page;
+    }
 
-    size_t body_size = 0;
-    for (auto s : page.segment_table) body_size += s;
+private:
+    std::istream& r_;
+    uint64_t remaining_;
+    std::array<uint8_t, 255> segments_{};
+    std::vector<uint8_t> body_;
+
+    void read(uint8_t* dst, size_t n, const char* what) {
+        if (n == 0) return;
+        if (n > remaining_ || !r_.read(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(n)))
+            throw std::runtime_error(what);
+        remaining_ -= n;
+    }
+};
 
-    page.body.resize(body_size);
-    if (body_size > 0 && !r.read(reinterpret_cast<char*>(page.body.data()),
-                                  static_cast<std::streamsize>(body_size)))
-        throw std::runtime_error("ogg: reading page body");
+// SpanPages walks pages in memory without copying them.
+class SpanPages {
+public:
+    explicit SpanPages(std::span<const uint8_t> data) : data_(data) {}
+
+    PageView next() {
+        const uint8_t* hdr = take(page_header_size, "ogg: reading page header");
+        if (std::memcmp(hdr, "OggS", 4) != 0)
+            throw std::runtime_error("ogg: invalid capture pattern");
+
+        PageView page;
+        page.n_segments = hdr[26];
+        page.segments = take(page.n_segments, "ogg: reading segment table");
+        page.body_size = body_size_of(page.segments, page.n_segments);
+        page.body = take(page.body_size, "ogg: reading page body");
+        return page;
+    }
 
-    return page;
-}
+private:
+    std::span<const uint8_t> data_;
+    size_t pos_ = 0;
 
-static std::vector<std::vector<uint8_t>> extract_packets(const OggPage& page) {
-    std::vector<std::vector<uint8_t>> packets;
-    std::vector<uint8_t> current;
-    size_t offset = 0;
-
-    for (auto seg : page.segment_table) {
-        size_t size = seg;
-        current.insert(current.end(), page.body.begin() + static_cast<ptrdiff_t>(offset),
-                       page.body.begin() + static_cast<ptrdiff_t>(offset + size));
-        offset += size;
-        if (size < 255) {
-            packets.push_back(std::move(current));
-            current.clear();
-        }
+    const uint8_t* take(size_t n, const char* what) {
+        if (n > data_.size() - pos_) throw std::runtime_error(what);
+        const uint8_t* p = data_.data() + pos_;
+        pos_ += n;
+        return p;
     }
-    if (!current.empty()) packets.push_back(std::move(current));
-    return packets;
-}
+};
 
 static void parse_comment_header(const uint8_t* data, size_t len, Header& h) {
     if (len < 4) return;
@@ -250,33 +289,70 @@ static void parse_setup_header(const uint8_t* data, size_t len, Header& h) {
     }
 }
 
-Header read_header(std::istream& r) {
-    std::vector<std::vector<uint8_t>> packets;
-    while (packets.size() < 3) {
-        auto page = read_ogg_page(r);
-        auto pkts = extract_packets(page);
-        for (auto& p : pkts) packets.push_back(std::move(p));
+static void parse_packet(int index, const uint8_t* data, size_t len, Header& h) {
+    switch (index) {
+    case 0:
+        if (len < 30 || data[0] != 1 || std::memcmp(data + 1, "vorbis", 6) != 0)
+            throw std::runtime_error("ogg: not a Vorbis identification header");
+        h.channels = data[11];
+        h.sample_rate = static_cast<int>(data[12]) | (static_cast<int>(data[13]) << 8) |
+                        (static_cast<int>(data[14]) << 16) | (static_cast<int>(data[15]) << 24);
+        break;
+    case 1:
+        if (len < 7 || data[0] != 3 || std::memcmp(data + 1, "vorbis", 6) != 0)
+            throw std::runtime_error("ogg: not a Vorbis comment header");
+        parse_comment_header(data + 7, len - 7, h);
+        break;
+    default:
+        if (len >= 7 && data[0] == 5 && std::memcmp(data + 1, "vorbis", 6) == 0)
+            parse_setup_header(data + 7, len - 7, h);
+        break;
     }
+}
 
-    if (packets[0].size() < 30 || packets[0][0] != 1 ||
-        std::memcmp(packets[0].data() + 1, "vorbis", 6) != 0)
-        throw std::runtime_error("ogg: not a Vorbis identification header");
-
+// probe_header assembles the first three packets and stops reading pages
+// after the setup header.
+template <class Pages>
+static Header probe_header(Pages& pages) {
     Header h;
-    h.channels = packets[0][11];
-    h.sample_rate = static_cast<int>(packets[0][12]) | (static_cast<int>(packets[0][13]) << 8) |
-                    (static_cast<int>(packets[0][14]) << 16) | (static_cast<int>(packets[0][15]) << 24);
+    std::vector<uint8_t> partial; // packet continued from a previous page
+    int packet = 0;
+    for (;;) {
+        PageView page = pages.next();
+        size_t start = 0;
+        size_t end = 0;
+        for (size_t i = 0; i < page.n_segments; i++) {
+            end += page.segments[i];
+            if (page.segments[i] == 255) continue;
+
+            const uint8_t* data = page.body + start;
+            size_t len = end - start;
+            if (!partial.empty()) {
+                partial.insert(partial.end(), data, data + len);
+                data = partial.data();
+                len = partial.size();
+            }
+            parse_packet(packet, data, len, h);
+            partial.clear();
+            start = end;
+            if (++packet == 3) return h;
+        }
+        partial.insert(partial.end(), page.body + start, page.body + end);
+    }
+}
 
-    if (packets[1].size() < 7 || packets[1][0] != 3 ||
-        std::memcmp(packets[1].data() + 1, "vorbis", 6) != 0)
-        throw std::runtime_error("ogg: not a Vorbis comment header");
-    parse_comment_header(packets[1].data() + 7, packets[1].size() - 7, h);
+Header read_header(std::istream& r) {
+    return read_header(r, std::numeric_limits<uint64_t>::max());
+}
 
-    if (packets[2].size() >= 7 && packets[2][0] == 5 &&
-        std::memcmp(packets[2].data() + 1, "vorbis", 6) == 0)
-        parse_setup_header(packets[2].data() + 7, packets[2].size() - 7, h);
+Header read_header(std::istream& r, uint64_t max_bytes) {
+    StreamPages pages(r, max_bytes);
+    return probe_header(pages);
+}
 
-    return h;
+Header read_header(std::span<const uint8_t> data) {
+    SpanPages pages(data);
+    return probe_header(pages);
 }
 
 bool is_pre_one_encoder(const std::string& encoder) {
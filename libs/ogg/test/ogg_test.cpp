@@ -0,0 +1,209 @@
+#include "armatools/ogg.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace armatools::ogg;
+
+namespace {
+
+// Vorbis bit packing, LSB first.
+class BitWriter {
+public:
+    void put(uint32_t value, int bits) {
+        for (int i = 0; i < bits; i++) {
+            if (pos_ % 8 == 0) data.push_back(0);
+            if (value & (1u << i)) data.back() |= static_cast<uint8_t>(1u << (pos_ % 8));
+            pos_++;
+        }
+    }
+    std::vector<uint8_t> data;
+
+private:
+    size_t pos_ = 0;
+};
+
+std::vector<uint8_t> packet_prefix(uint8_t type) {
+    return {type, 'v', 'o', 'r', 'b', 'i', 's'};
+}
+
+void put_u32(std::vector<uint8_t>& p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+std::vector<uint8_t> identification_packet() {
+    auto p = packet_prefix(1);
+    put_u32(p, 0);              // version
+    p.push_back(2);             // channels
+    put_u32(p, 44100);          // sample rate
+    for (int i = 0; i < 3; i++) put_u32(p, 0); // bitrates
+    p.push_back(0xB8);          // block sizes
+    p.push_back(1);             // framing
+    return p;
+}
+
+std::vector<uint8_t> comment_packet() {
+    auto p = packet_prefix(3);
+    std::string vendor = "Xiph.Org libVorbis I 20020717";
+    std::string comment = "TITLE=test";
+    put_u32(p, static_cast<uint32_t>(vendor.size()));
+    p.insert(p.end(), vendor.begin(), vendor.end());
+    put_u32(p, 1);
+    put_u32(p, static_cast<uint32_t>(comment.size()));
+    p.insert(p.end(), comment.begin(), comment.end());
+    p.push_back(1);
+    return p;
+}
+
+// setup_packet describes two codebooks and one floor 1, padded to
+// padding bytes so that it can be made to span pages.
+std::vector<uint8_t> setup_packet(size_t padding) {
+    BitWriter bw;
+    bw.put(1, 8);                       // codebook count - 1
+    // Codebook 0: 10 entries of 2 dimensions, lookup type 1.
+    bw.put(0x564342, 24);
+    bw.put(2, 16);
+    bw.put(10, 24);
+    bw.put(0, 1);                       // unordered
+    bw.put(0, 1);                       // not sparse
+    for (int i = 0; i < 10; i++) bw.put(3, 5);
+    bw.put(1, 4);
+    bw.put(0, 32);                      // minimum value
+    bw.put(0, 32);                      // delta value
+    bw.put(3, 4);                       // value bits - 1
+    bw.put(0, 1);                       // sequence flag
+    for (int i = 0; i < 3; i++) bw.put(1, 4); // lookup1_values(10, 2) = 3
+    // Codebook 1: 4 entries of 1 dimension, no lookup.
+    bw.put(0x564342, 24);
+    bw.put(1, 16);
+    bw.put(4, 24);
+    bw.put(0, 1);
+    bw.put(0, 1);
+    for (int i = 0; i < 4; i++) bw.put(1, 5);
+    bw.put(0, 4);
+    bw.put(0, 6);                       // time domain count - 1
+    bw.put(0, 16);
+    bw.put(0, 6);                       // floor count - 1
+    bw.put(1, 16);                      // floor type 1
+    bw.put(0, 5);                       // no partitions
+    bw.put(1, 2);                       // multiplier - 1
+    bw.put(7, 4);                       // range bits
+
+    auto p = packet_prefix(5);
+    p.insert(p.end(), bw.data.begin(), bw.data.end());
+    if (p.size() < padding) p.resize(padding, 0);
+    return p;
+}
+
+// build_stream laces packets into pages of at most max_segments segments.
+std::string build_stream(const std::vector<std::vector<uint8_t>>& packets, size_t max_segments) {
+    std::vector<uint8_t> lacing;
+    std::vector<uint8_t> body;
+    for (const auto& p : packets) {
+        size_t n = p.size();
+        while (n >= 255) { lacing.push_back(255); n -= 255; }
+        lacing.push_back(static_cast<uint8_t>(n));
+        body.insert(body.end(), p.begin(), p.end());
+    }
+
+    std::string out;
+    size_t seg = 0;
+    size_t offset = 0;
+    bool continued = false;
+    uint32_t sequence = 0;
+    while (seg < lacing.size()) {
+        size_t n = std::min(max_segments, lacing.size() - seg);
+        size_t size = 0;
+        for (size_t i = 0; i < n; i++) size += lacing[seg + i];
+
+        std::vector<uint8_t> hdr(27, 0);
+        std::memcpy(hdr.data(), "OggS", 4);
+        hdr[5] = continued ? 1 : 0;
+        hdr[18] = static_cast<uint8_t>(sequence++);
+        hdr[26] = static_cast<uint8_t>(n);
+        out.append(hdr.begin(), hdr.end());
+        out.append(lacing.begin() + static_cast<std::ptrdiff_t>(seg),
+                   lacing.begin() + static_cast<std::ptrdiff_t>(seg + n));
+        out.append(body.begin() + static_cast<std::ptrdiff_t>(offset),
+                   body.begin() + static_cast<std::ptrdiff_t>(offset + size));
+
+        continued = lacing[seg + n - 1] == 255;
+        seg += n;
+        offset += size;
+    }
+    return out;
+}
+
+std::span<const uint8_t> as_bytes(const std::string& s) {
+    return {reinterpret_cast<const uint8_t*>(s.data()), s.size()};
+}
+
+void expect_test_header(const Header& h) {
+    EXPECT_EQ(h.channels, 2);
+    EXPECT_EQ(h.sample_rate, 44100);
+    EXPECT_EQ(h.encoder, "Xiph.Org libVorbis I 20020717");
+    ASSERT_EQ(h.comments.size(), 1u);
+    EXPECT_EQ(h.comments[0], "TITLE=test");
+    ASSERT_EQ(h.codebooks.size(), 2u);
+    EXPECT_EQ(h.codebooks[0].entries, 10);
+    EXPECT_EQ(h.codebooks[0].dimensions, 2);
+    EXPECT_EQ(h.codebooks[0].lookup_type, 1);
+    EXPECT_EQ(h.codebooks[1].entries, 4);
+    EXPECT_EQ(h.codebooks[1].lookup_type, 0);
+    EXPECT_EQ(h.floor_type, 1);
+}
+
+} // namespace
+
+TEST(OggTest, ReadsHeadersFromStreamAndSpan) {
+    auto data = build_stream({identification_packet(), comment_packet(), setup_packet(0)}, 255);
+
+    std::istringstream stream(data);
+    expect_test_header(read_header(stream));
+    expect_test_header(read_header(as_bytes(data)));
+}
+
+TEST(OggTest, JoinsPacketsContinuedAcrossPages) {
+    // Two segments per page: the 3000-byte setup header spans six pages.
+    auto data = build_stream({identification_packet(), comment_packet(), setup_packet(3000)}, 2);
+
+    std::istringstream stream(data);
+    expect_test_header(read_header(stream));
+    expect_test_header(read_header(as_bytes(data)));
+}
+
+TEST(OggTest, StopsAfterSetupHeader) {
+    // Encoders flush the header pages before the first audio page.
+    auto headers = build_stream({identification_packet(), comment_packet(), setup_packet(600)}, 255);
+    auto data = headers + build_stream({std::vector<uint8_t>(100000, 0x55)}, 255);
+
+    std::istringstream stream(data);
+    expect_test_header(read_header(stream));
+    EXPECT_EQ(static_cast<size_t>(stream.tellg()), headers.size());
+}
+
+TEST(OggTest, BoundedReadRejectsTruncatedHeaders) {
+    auto data = build_stream({identification_packet(), comment_packet(), setup_packet(3000)}, 4);
+
+    std::istringstream ok(data);
+    expect_test_header(read_header(ok, data.size()));
+
+    std::istringstream short_read(data);
+    EXPECT_THROW(read_header(short_read, data.size() - 1), std::runtime_error);
+    EXPECT_THROW(read_header(as_bytes(data).first(data.size() - 1)), std::runtime_error);
+}
+
+TEST(OggTest, RejectsNonVorbisStreams) {
+    auto id = identification_packet();
+    id[1] = 'X';
+    auto data = build_stream({id, comment_packet(), setup_packet(0)}, 255);
+    EXPECT_THROW(read_header(as_bytes(data)), std::runtime_error);
+
+    std::string garbage(64, 'x');
+    EXPECT_THROW(read_header(as_bytes(garbage)), std::runtime_error);
+}
@@ -30,12 +30,35 @@ struct Image {
     }
 };
 
+// Mip is one mipmap level in its stored pixel format, after LZO/LZSS
+// expansion: 4x4 blocks for DXT formats (padded to the full block count),
+// packed texels otherwise. Rows run top to bottom, as in Image.
+struct Mip {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> data;
+};
+
 // read_header parses a PAA/PAC file header and returns format and dimensions.
 Header read_header(std::istream& r);
 
 // decode reads a PAA/PAC file and decodes the first mipmap to an RGBA image.
 std::pair<Image, Header> decode(std::istream& r);
 
+// read_mips reads the mipmap chain of a PAA/PAC file, largest first,
+// without converting it to RGBA, so DXT levels can go to the GPU as they
+// are. max_levels > 0 stops after that many levels; a truncated chain ends
+// at the last complete level. Palette-indexed OFP textures have no usable
+// raw levels and throw std::runtime_error; use decode for them.
+std::pair<std::vector<Mip>, Header> read_mips(std::istream& r, int max_levels = 0);
+
+// decode_mip expands a level returned by read_mips to RGBA.
+Image decode_mip(const std::string& format, const Mip& mip);
+
+// mip_has_alpha reports whether any texel of the level is not fully
+// opaque. DXT levels are checked block by block without decoding colors.
+bool mip_has_alpha(const std::string& format, const Mip& mip);
+
 // encode writes a minimal PAA file with one mipmap.
 // format: "auto", "dxt1", "dxt3", "dxt5"
 Header encode(std::ostream& w, const Image& img, const std::string& format = "auto");
@@ -293,6 +293,23 @@ static bool is_dxt_format(const std::string& fmt) {
            fmt == "DXT4" || fmt == "DXT5";
 }
 
+// unpack_mip_data expands the stored bytes of one non-indexed mipmap:
+// LZO for DXT when bit 15 of the width was set, signed-checksum LZSS for
+// the ARGB formats whenever the data is shorter than the texel size.
+static std::vector<uint8_t> unpack_mip_data(const std::string& fmt, int w, int h,
+                                            bool lzo_compressed, std::vector<uint8_t> data) {
+    int expected = expected_pixel_size(fmt, w, h);
+    if (is_dxt_format(fmt)) {
+        if (lzo_compressed) return lzo_decompress(data, expected);
+        return data;
+    }
+    if (static_cast<int>(data.size()) < expected) {
+        return lzss::decompress_signed(data.data(), data.size(),
+                                       static_cast<size_t>(expected));
+    }
+    return data;
+}
+
 // --- RLE decompression for OFP CWC/Demo palette-indexed textures ---
 
 static std::vector<uint8_t> rle_decompress(const uint8_t* src, size_t src_len,
@@ -595,24 +612,8 @@ std::pair<Image, Header> decode(std::istream& r) {
             pixels = rle_decompress(data.data(), data.size(),
                                      static_cast<size_t>(expected));
         }
-    } else if (is_dxt_format(fmt)) {
-        // DXT: LZO compression when bit 15 of width is set
-        if (lzo_compressed) {
-            int expected = expected_pixel_size(fmt, w, h);
-            pixels = lzo_decompress(data, expected);
-        } else {
-            pixels = std::move(data);
-        }
     } else {
-        // Non-DXT (ARGB4444, ARGB1555, AI88, ARGB8888):
-        // Always LZSS-compressed with signed checksum, no 1024-byte threshold
-        int expected = expected_pixel_size(fmt, w, h);
-        if (static_cast<int>(data.size()) < expected) {
-            pixels = lzss::decompress_signed(data.data(), data.size(),
-                                              static_cast<size_t>(expected));
-        } else {
-            pixels = std::move(data);
-        }
+        pixels = unpack_mip_data(fmt, w, h, lzo_compressed, std::move(data));
     }
 
     Image img;
@@ -629,6 +630,95 @@ std::pair<Image, Header> decode(std::istream& r) {
     return {std::move(img), hdr};
 }
 
+std::pair<std::vector<Mip>, Header> read_mips(std::istream& r, int max_levels) {
+    uint16_t type_tag = binutil::read_u16(r);
+    std::string fmt = format_name(type_tag);
+    if (fmt.empty())
+        throw std::runtime_error("paa: palette-indexed texture has no raw mipmaps");
+    skip_taggs(r);
+
+    uint16_t n_palette = binutil::read_u16(r);
+    if (n_palette > 0) r.seekg(static_cast<std::streamoff>(n_palette) * 3, std::ios::cur);
+
+    std::vector<Mip> mips;
+    while (max_levels <= 0 || mips.size() < static_cast<size_t>(max_levels)) {
+        // The chain ends with a zero-sized level header. Errors past the
+        // first level leave the levels read so far.
+        uint16_t width_raw = 0, height_raw = 0;
+        uint8_t u24[3];
+        if (!r.read(reinterpret_cast<char*>(&width_raw), 2)
+            || !r.read(reinterpret_cast<char*>(&height_raw), 2)
+            || width_raw == 0 || height_raw == 0
+            || !r.read(reinterpret_cast<char*>(u24), 3)) {
+            if (mips.empty()) throw std::runtime_error("paa: missing first mipmap");
+            break;
+        }
+        size_t data_size = static_cast<size_t>(u24[0]) | (static_cast<size_t>(u24[1]) << 8) |
+                           (static_cast<size_t>(u24[2]) << 16);
+
+        Mip mip;
+        mip.width = width_raw & 0x7FFF;
+        mip.height = height_raw;
+        try {
+            auto data = binutil::read_bytes(r, data_size);
+            mip.data = unpack_mip_data(fmt, mip.width, mip.height,
+                                       (width_raw & 0x8000) != 0, std::move(data));
+        } catch (const std::exception&) {
+            if (mips.empty()) throw;
+            break;
+        }
+        if (is_dxt_format(fmt))
+            mip.data.resize(static_cast<size_t>(expected_pixel_size(fmt, mip.width, mip.height)), 0);
+        mips.push_back(std::move(mip));
+    }
+
+    if (mips.empty()) throw std::runtime_error("paa: missing first mipmap");
+    Header hdr{fmt, mips.front().width, mips.front().height};
+    return {std::move(mips), hdr};
+}
+
+Image decode_mip(const std::string& format, const Mip& mip) {
+    Image img;
+    img.width = mip.width;
+    img.height = mip.height;
+    img.pixels.resize(static_cast<size_t>(mip.width) * static_cast<size_t>(mip.height) * 4, 0);
+    decode_pixels(format, mip.data.data(), mip.data.size(), img);
+    return img;
+}
+
+bool mip_has_alpha(const std::string& format, const Mip& mip) {
+    const uint8_t* data = mip.data.data();
+    const size_t n = mip.data.size();
+    if (format == "DXT1") {
+        // Punch-through alpha: index 3 in a block with c0 <= c1.
+        for (size_t off = 0; off + 8 <= n; off += 8) {
+            if (get_u16(data + off) > get_u16(data + off + 2)) continue;
+            uint32_t indices = get_u32(data + off + 4);
+            for (int i = 0; i < 16; i++)
+                if (((indices >> (i * 2)) & 3) == 3) return true;
+        }
+        return false;
+    }
+    if (format == "DXT2" || format == "DXT3") {
+        for (size_t off = 0; off + 16 <= n; off += 16)
+            for (auto a : decode_dxt3_alpha(data + off))
+                if (a < 255) return true;
+        return false;
+    }
+    if (format == "DXT4" || format == "DXT5") {
+        // No endpoint shortcut: with a0 <= a1 index 6 is alpha 0 even when
+        // both endpoints are 255.
+        for (size_t off = 0; off + 16 <= n; off += 16)
+            for (auto a : decode_dxt5_alpha(data + off))
+                if (a < 255) return true;
+        return false;
+    }
+    auto img = decode_mip(format, mip);
+    for (size_t i = 3; i < img.pixels.size(); i += 4)
+        if (img.pixels[i] < 255) return true;
+    return false;
+}
+
 // --- DXT Encoding ---
 
 struct NRGBA { uint8_t r, g, b, a; };
@@ -0,0 +1,114 @@
+#include "armatools/paa.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using armatools::paa::Image;
+using armatools::paa::Mip;
+
+namespace {
+
+Image make_image(int w, int h, uint8_t alpha) {
+    Image img;
+    img.width = w;
+    img.height = h;
+    img.pixels.resize(static_cast<size_t>(w) * static_cast<size_t>(h) * 4);
+    for (int y = 0; y < h; y++)
+        for (int x = 0; x < w; x++)
+            img.set(x, y, static_cast<uint8_t>(x * 16), static_cast<uint8_t>(y * 16), 128, alpha);
+    return img;
+}
+
+// make_chain writes a PAA with one level per image by splicing the single
+// level that encode writes for each of them.
+std::string make_chain(const std::vector<Image>& levels, const std::string& format) {
+    std::string out;
+    for (size_t i = 0; i < levels.size(); i++) {
+        std::ostringstream level;
+        armatools::paa::encode(level, levels[i], format);
+        auto bytes = level.str();
+        out += i == 0 ? bytes : bytes.substr(4); // drop type tag and palette count
+    }
+    out.append(4, '\0');
+    return out;
+}
+
+} // namespace
+
+TEST(PaaTest, ReadMipsKeepsBlocks) {
+    auto data = make_chain({make_image(16, 16, 255), make_image(8, 8, 255), make_image(4, 4, 255)}, "dxt1");
+    std::istringstream in(data);
+    auto [mips, hdr] = armatools::paa::read_mips(in);
+
+    EXPECT_EQ(hdr.format, "DXT1");
+    EXPECT_EQ(hdr.width, 16);
+    EXPECT_EQ(hdr.height, 16);
+    ASSERT_EQ(mips.size(), 3u);
+    EXPECT_EQ(mips[0].data.size(), 128u);
+    EXPECT_EQ(mips[1].width, 8);
+    EXPECT_EQ(mips[1].data.size(), 32u);
+    EXPECT_EQ(mips[2].data.size(), 8u);
+
+    std::istringstream in2(data);
+    auto [img, hdr2] = armatools::paa::decode(in2);
+    EXPECT_EQ(armatools::paa::decode_mip(hdr.format, mips[0]).pixels, img.pixels);
+}
+
+TEST(PaaTest, ReadMipsLimitsAndTruncation) {
+    auto data = make_chain({make_image(16, 16, 255), make_image(8, 8, 255), make_image(4, 4, 255)}, "dxt5");
+
+    std::istringstream limited(data);
+    EXPECT_EQ(armatools::paa::read_mips(limited, 1).first.size(), 1u);
+
+    // Cut into the last level's data: the two complete levels remain.
+    std::istringstream truncated(data.substr(0, data.size() - 4 - 8));
+    auto [mips, hdr] = armatools::paa::read_mips(truncated);
+    EXPECT_EQ(hdr.format, "DXT5");
+    ASSERT_EQ(mips.size(), 2u);
+    EXPECT_EQ(mips[1].data.size(), 64u);
+
+    std::istringstream empty(data.substr(0, 4));
+    EXPECT_THROW(armatools::paa::read_mips(empty), std::runtime_error);
+}
+
+TEST(PaaTest, ReadMipsRejectsPaletteIndexed) {
+    std::string data(16, '\0');
+    std::istringstream in(data);
+    EXPECT_THROW(armatools::paa::read_mips(in), std::runtime_error);
+}
+
+TEST(PaaTest, MipHasAlpha) {
+    auto check = [](const Image& img, const std::string& format) {
+        std::ostringstream out;
+        armatools::paa::encode(out, img, format);
+        std::istringstream in(out.str());
+        auto [mips, hdr] = armatools::paa::read_mips(in);
+        return armatools::paa::mip_has_alpha(hdr.format, mips[0]);
+    };
+
+    EXPECT_FALSE(check(make_image(8, 8, 255), "dxt1"));
+    EXPECT_FALSE(check(make_image(8, 8, 255), "dxt5"));
+    EXPECT_TRUE(check(make_image(8, 8, 128), "dxt5"));
+    EXPECT_TRUE(check(make_image(8, 8, 128), "dxt3"));
+
+    auto cutout = make_image(8, 8, 255);
+    cutout.set(3, 3, 0, 0, 0, 0);
+    EXPECT_TRUE(check(cutout, "dxt1"));
+
+    // Six-value mode (a0 <= a1): index 6 is alpha 0 even with both
+    // endpoints at 255.
+    Mip six_value{4, 4, std::vector<uint8_t>(16, 0)};
+    six_value.data[0] = 255;
+    six_value.data[1] = 255;
+    six_value.data[2] = 6;
+    six_value.data[8] = 0xff;
+    six_value.data[9] = 0xff;
+    six_value.data[10] = 0xff;
+    six_value.data[11] = 0xff;
+    EXPECT_TRUE(armatools::paa::mip_has_alpha("DXT5", six_value));
+    six_value.data[2] = 0;
+    EXPECT_FALSE(armatools::paa::mip_has_alpha("DXT5", six_value));
+}
@@ -31,4 +31,8 @@ PBO read(std::istream& r);
 // extract_file extracts a single PBO entry's data to the given writer.
 void extract_file(std::istream& r, const Entry& entry, std::ostream& w);
 
+// is_compressed returns true if the entry is LZSS-compressed. Otherwise its
+// data_size bytes are stored as-is at data_offset and can be read in place.
+bool is_compressed(const Entry& entry);
+
 } // namespace armatools::pbo
@@ -89,8 +89,7 @@ void extract_file(std::istream& r, const Entry& entry, std::ostream& w) {
                         entry.filename, entry.data_offset));
 
     // OFP-era PBOs can have LZSS-compressed entries (packing_method != 0).
-    if (entry.packing_method != 0 && entry.original_size > 0 &&
-        entry.data_size != entry.original_size) {
+    if (is_compressed(entry)) {
         // Read compressed data, then decompress via LZSS
         std::vector<uint8_t> compressed(entry.data_size);
         if (!r.read(reinterpret_cast<char*>(compressed.data()),
@@ -122,4 +121,9 @@ void extract_file(std::istream& r, const Entry& entry, std::ostream& w) {
     }
 }
 
+bool is_compressed(const Entry& entry) {
+    return entry.packing_method != 0 && entry.original_size > 0 &&
+           entry.data_size != entry.original_size;
+}
+
 } // namespace armatools::pbo
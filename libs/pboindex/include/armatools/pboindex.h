@@ -3,7 +3,10 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace armatools::pboindex {
@@ -104,6 +107,8 @@ struct DBStats {
     int p3d_model_count = 0;
     int texture_count = 0;
     int audio_file_count = 0;
+    int config_file_count = 0;  // 0 unless built with index_configs
+    int config_class_count = 0;
 };
 
 // ModelBBox holds bounding box data for a P3D model.
@@ -120,7 +125,7 @@ struct ModelBBox {
 
 // BuildProgress reports the current state of a build/update operation.
 struct BuildProgress {
-    std::string phase;     // "discovery", "pbo", "p3d", "paa", "ogg", "audio", "commit"
+    std::string phase;     // "discovery", "pbo", "p3d", "paa", "ogg", "audio", "config", "commit"
     int pbo_index = 0;
     int pbo_total = 0;
     std::string pbo_path;
@@ -134,6 +139,10 @@ using BuildProgressFunc = std::function<void(const BuildProgress&)>;
 // BuildOptions controls what metadata is eagerly indexed during build/update.
 struct BuildOptions {
     bool on_demand_metadata = false;
+    // index_configs stores every config.bin/config.cpp and rebuilds the
+    // merged class tables queried by DB::find_config_class. Once a database
+    // has them, update_db keeps them current regardless of this flag.
+    bool index_configs = false;
 };
 
 // BuildResult holds counts from a build/update operation.
@@ -143,6 +152,8 @@ struct BuildResult {
     int p3d_count = 0;
     int paa_count = 0;
     int audio_count = 0;
+    int config_count = 0;       // config files stored
+    int config_class_count = 0; // classes in the merged config
 };
 
 // UpdateResult holds counts from an update operation.
@@ -154,9 +165,74 @@ struct UpdateResult {
     int p3d_count = 0;
     int paa_count = 0;
     int audio_count = 0;
+    int config_count = 0;
+    int config_class_count = 0; // classes in the merged config, if rebuilt
+};
+
+// ConfigValue is one property of a merged config class.
+struct ConfigValue {
+    std::string name;
+    std::string type;  // "string", "int", "float" or "array"
+    std::string value; // strings unquoted; numbers and arrays in config syntax
+    bool inherited = false;
+};
+
+// ConfigClassInfo describes a class of the merged game config: every
+// indexed addon applied in CfgPatches requiredAddons order, with its
+// properties flattened through the inheritance chain.
+struct ConfigClassInfo {
+    std::string path;     // "CfgVehicles/Car", original case
+    std::string base;     // path of the resolved parent class, or the declared name if unresolved
+    std::string pbo_path; // PBO of the last addon that defined the class body
+    std::vector<ConfigValue> values; // own and inherited, base properties first
+};
+
+// ModelSnapshot is a compact read-only table of P3D model metadata: the
+// normalized virtual path, original-case name and bounding boxes of every
+// model, sorted by path. It is memory-mapped from a sidecar file next to the
+// database ("<db>.models"), which build_db/update_db rewrite, so opening it
+// parses and allocates nothing. Lookups are binary searches.
+class ModelSnapshot {
+public:
+    ModelSnapshot();
+    ~ModelSnapshot();
+    ModelSnapshot(ModelSnapshot&& other) noexcept;
+    ModelSnapshot& operator=(ModelSnapshot&& other) noexcept;
+
+    // Size returns the number of models.
+    size_t size() const;
+
+    // FindBBox returns the bounding boxes of a model by its lowercase
+    // forward-slash virtual path ("a3/structures_f/data/ammostore2.p3d"),
+    // or nullptr if the model is not indexed.
+    const ModelBBox* find_bbox(std::string_view path) const;
+
+    // FindName returns the original-case basename (without extension) of a
+    // model by its virtual path, or an empty view.
+    std::string_view find_name(std::string_view path) const;
+
+    // FindNameByBase returns the original-case basename of the first model
+    // (in path order) whose lowercase basename is base, or an empty view.
+    std::string_view find_name_by_base(std::string_view base) const;
+
+    // Entry accessors in path order, for i < size().
+    std::string_view path_at(size_t i) const;
+    std::string_view name_at(size_t i) const;
+    const ModelBBox& bbox_at(size_t i) const;
+
+    // SidecarPath returns the snapshot file name for a database path.
+    static std::string sidecar_path(const std::string& db_path);
+
+private:
+    friend class DB;
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
 };
 
 // DB wraps a SQLite database of PBO file metadata.
+// Query methods may be called concurrently from several threads: each call
+// borrows a read-only connection from an internal pool, and prepared
+// statements stay cached per connection.
 class DB {
 public:
     ~DB();
@@ -220,6 +296,28 @@ public:
     // Example: "a3/structures_f/data/ammostore2.p3d" -> "AmmoStore2"
     std::unordered_map<std::string, std::string> query_model_paths() const;
 
+    // ModelSnapshot opens the model metadata snapshot of this database. The
+    // sidecar file is regenerated when it is missing or out of date; if it
+    // cannot be written, the snapshot is kept in memory.
+    ModelSnapshot model_snapshot() const;
+
+    // FindConfigClass returns a class of the merged config by its path
+    // ("CfgVehicles/Car", case-insensitive), or nullopt if there is none.
+    // Throws if the database was built without index_configs.
+    std::optional<ConfigClassInfo> find_config_class(const std::string& path) const;
+
+    // ListConfigClasses returns the paths of the classes declared directly
+    // inside path ("" for the top level), in definition order.
+    std::vector<std::string> list_config_classes(const std::string& path) const;
+
+    // FindConfigClasses returns the paths of classes whose flattened
+    // property name equals value, case-insensitively, e.g. every class with
+    // model = "\a3\soft_f\offroad_01\offroad_01_unarmed_f". Inherited
+    // values match too.
+    std::vector<std::string> find_config_classes(const std::string& name,
+                                                 const std::string& value,
+                                                 size_t limit = 0) const;
+
     // QuerySources returns the distinct source values from the pbos table.
     std::vector<std::string> query_sources() const;
 
@@ -1,5 +1,7 @@
 #include "armatools/pboindex.h"
 #include "armatools/armapath.h"
+#include "armatools/config.h"
+#include "armatools/mapped_file.h"
 #include "armatools/ogg.h"
 #include "armatools/p3d.h"
 #include "armatools/paa.h"
@@ -14,9 +16,14 @@
 #include <filesystem>
 #include <format>
 #include <fstream>
+#include <limits>
+#include <mutex>
+#include <optional>
 #include <sstream>
 #include <stdexcept>
+#include <type_traits>
 #include <unordered_set>
+#include <variant>
 
 namespace fs = std::filesystem;
 
@@ -137,6 +144,43 @@ CREATE INDEX idx_pbos_source ON pbos(source);
 
 static constexpr const char* schema_version = "10";
 
+// Optional config tables, created by BuildOptions::index_configs.
+// pbo_configs keeps each addon's config file ('bin' rapified, 'text'
+// preprocessed) so the merged tables can be rebuilt without rescanning
+// PBOs; config_classes/config_values hold the merged, flattened result.
+static constexpr const char* config_schema_sql = R"SQL(
+CREATE TABLE IF NOT EXISTS pbo_configs (
+    pbo_id INTEGER NOT NULL,
+    path TEXT NOT NULL,
+    format TEXT NOT NULL,
+    data BLOB NOT NULL
+);
+CREATE INDEX IF NOT EXISTS idx_pbo_configs_pbo_id ON pbo_configs(pbo_id);
+CREATE TABLE IF NOT EXISTS config_classes (
+    id INTEGER PRIMARY KEY,
+    outer_id INTEGER,
+    path TEXT NOT NULL COLLATE NOCASE,
+    name TEXT NOT NULL,
+    base TEXT NOT NULL,
+    pbo_id INTEGER
+);
+CREATE UNIQUE INDEX IF NOT EXISTS idx_config_classes_path ON config_classes(path);
+CREATE INDEX IF NOT EXISTS idx_config_classes_outer_id ON config_classes(outer_id);
+CREATE TABLE IF NOT EXISTS config_values (
+    class_id INTEGER NOT NULL,
+    name TEXT NOT NULL COLLATE NOCASE,
+    type TEXT NOT NULL,
+    value TEXT NOT NULL COLLATE NOCASE,
+    inherited INTEGER NOT NULL
+);
+)SQL";
+
+// config_values indexes, dropped while the table is refilled.
+static constexpr const char* config_value_indexes_sql = R"SQL(
+CREATE INDEX IF NOT EXISTS idx_config_values_class_id ON config_values(class_id);
+CREATE INDEX IF NOT EXISTS idx_config_values_name_value ON config_values(name, value);
+)SQL";
+
 // ---------------------------------------------------------------------------
 // SQLite helpers
 // ---------------------------------------------------------------------------
@@ -169,6 +213,9 @@ public:
     void bind_int64(int idx, int64_t v) { sqlite3_bind_int64(stmt_, idx, v); }
     void bind_double(int idx, double v) { sqlite3_bind_double(stmt_, idx, v); }
     void bind_null(int idx) { sqlite3_bind_null(stmt_, idx); }
+    void bind_blob(int idx, const void* data, size_t size) {
+        sqlite3_bind_blob64(stmt_, idx, data, static_cast<sqlite3_uint64>(size), SQLITE_TRANSIENT);
+    }
 
     int step() { return sqlite3_step(stmt_); }
 
@@ -183,6 +230,9 @@ private:
     sqlite3_stmt* stmt_ = nullptr;
 };
 
+static void store_model_snapshot(sqlite3* db, const std::string& db_path);
+static void bump_model_generation(sqlite3* db);
+
 static void exec_sql(sqlite3* db, const char* sql) {
     char* err = nullptr;
     if (sqlite3_exec(db, sql, nullptr, nullptr, &err) != SQLITE_OK) {
@@ -492,12 +542,95 @@ std::vector<PBORef> discover_pbos(const std::string& arma3_dir,
 // DB::Impl
 // ---------------------------------------------------------------------------
 
-struct DB::Impl {
+// Connection is one read-only handle plus its prepared statements, cached by
+// SQL text so repeated queries skip sqlite3_prepare_v2.
+struct Connection {
     sqlite3* db = nullptr;
+    std::unordered_map<std::string, SqliteStmt> stmts;
+    std::vector<SqliteStmt*> in_use;
 
-    ~Impl() {
+    explicit Connection(sqlite3* handle) : db(handle) {}
+    ~Connection() {
+        stmts.clear(); // finalize before closing the handle
         if (db) sqlite3_close(db);
     }
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    // prepare returns the cached statement for sql, reset and unbound.
+    SqliteStmt& prepare(const std::string& sql) {
+        auto it = stmts.find(sql);
+        if (it == stmts.end())
+            it = stmts.emplace(sql, SqliteStmt(db, sql.c_str())).first;
+        else
+            it->second.reset();
+        in_use.push_back(&it->second);
+        return it->second;
+    }
+
+    // Reset the statements handed out since the last call, so an idle
+    // connection does not keep a read transaction open.
+    void reset_statements() {
+        for (auto* s : in_use) s->reset();
+        in_use.clear();
+    }
+};
+
+// SchemaFlags records optional schema features, detected once by DB::open.
+struct SchemaFlags {
+    bool has_dirs = false;           // dirs table (paged directory listing)
+    bool has_source = false;         // pbos.source column
+    bool has_vis_bbox = false;       // p3d_models.vis_* columns
+    bool has_model_textures = false; // model_textures table
+    bool has_configs = false;        // pbo_configs/config_classes/config_values
+};
+
+// Idle connections kept open; busier callers get a temporary extra one.
+static constexpr size_t max_idle_connections = 8;
+
+struct DB::Impl {
+    std::string path;
+    SchemaFlags schema;
+
+    std::mutex mu;
+    std::vector<std::unique_ptr<Connection>> idle;
+
+    // Lease borrows a pooled connection for the duration of one query.
+    class Lease {
+    public:
+        explicit Lease(Impl& impl) : impl_(impl), conn_(impl.acquire()) {}
+        ~Lease() { impl_.release(std::move(conn_)); }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        SqliteStmt& stmt(const std::string& sql) { return conn_->prepare(sql); }
+        sqlite3* handle() const { return conn_->db; }
+
+    private:
+        Impl& impl_;
+        std::unique_ptr<Connection> conn_;
+    };
+
+    Lease lease() { return Lease(*this); }
+
+    std::unique_ptr<Connection> acquire() {
+        {
+            std::lock_guard lock(mu);
+            if (!idle.empty()) {
+                auto conn = std::move(idle.back());
+                idle.pop_back();
+                return conn;
+            }
+        }
+        return std::make_unique<Connection>(
+            open_db_handle(path, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX));
+    }
+
+    void release(std::unique_ptr<Connection> conn) {
+        conn->reset_statements();
+        std::lock_guard lock(mu);
+        if (idle.size() < max_idle_connections) idle.push_back(std::move(conn));
+    }
 };
 
 DB::DB() : impl_(std::make_unique<Impl>()) {}
@@ -709,12 +842,19 @@ static void index_ogg(SqliteStmt& stmt, int64_t pbo_id,
                       std::ifstream& f,
                       const pbo::Entry& entry) {
     try {
-        std::ostringstream buf;
-        pbo::extract_file(f, entry, buf);
-        std::string data = buf.str();
-        std::istringstream is(data);
-
-        auto hdr = ogg::read_header(is);
+        // Only the Vorbis header pages are read; stored entries are probed
+        // in place instead of being extracted.
+        f.clear();
+        ogg::Header hdr;
+        if (!pbo::is_compressed(entry)) {
+            f.seekg(entry.data_offset);
+            hdr = ogg::read_header(f, entry.data_size);
+        } else {
+            std::ostringstream buf;
+            pbo::extract_file(f, entry, buf);
+            std::string data = std::move(buf).str();
+            hdr = ogg::read_header(std::span(reinterpret_cast<const uint8_t*>(data.data()), data.size()));
+        }
 
         stmt.reset();
         stmt.bind_int64(1, pbo_id);
@@ -736,12 +876,19 @@ static void index_audio(SqliteStmt& stmt, int64_t pbo_id,
                         std::ifstream& f,
                         const pbo::Entry& entry) {
     try {
-        std::ostringstream buf;
-        pbo::extract_file(f, entry, buf);
-        std::string data = buf.str();
-        std::istringstream is(data);
-
-        auto audio = wss::read(is);
+        // Only the header is parsed; samples are neither read nor decoded.
+        f.clear();
+        wss::AudioInfo audio;
+        if (!pbo::is_compressed(entry)) {
+            f.seekg(entry.data_offset);
+            audio = wss::read_info(f, entry.data_size);
+        } else {
+            std::ostringstream buf;
+            pbo::extract_file(f, entry, buf);
+            std::string data = std::move(buf).str();
+            std::istringstream is(data);
+            audio = wss::read_info(is, data.size());
+        }
 
         stmt.reset();
         stmt.bind_int64(1, pbo_id);
@@ -758,12 +905,101 @@ static void index_audio(SqliteStmt& stmt, int64_t pbo_id,
     }
 }
 
+// Store the config files of a PBO in pbo_configs: every config.bin, and
+// config.cpp where no config.bin sits next to it (the engine prefers the
+// binarized one). Text configs are stored preprocessed, with #include
+// resolved against the same PBO; includes that point into other addons
+// are read as empty files so the rest of the config still parses.
+static int index_pbo_configs(SqliteStmt& stmt, int64_t pbo_id,
+                             const std::string& prefix,
+                             const pbo::PBO& pbo_data, std::ifstream& f,
+                             const std::string& pbo_path,
+                             BuildProgressFunc& progress,
+                             int pbo_idx, int pbo_total) {
+    auto split = [](const std::string& lower_path) {
+        auto slash = lower_path.rfind('/');
+        if (slash == std::string::npos) return std::pair<std::string, std::string>("", lower_path);
+        return std::pair(lower_path.substr(0, slash), lower_path.substr(slash + 1));
+    };
+    auto extract = [&](const pbo::Entry& entry) {
+        f.clear();
+        std::ostringstream buf;
+        pbo::extract_file(f, entry, buf);
+        return std::move(buf).str();
+    };
+
+    std::unordered_map<std::string, const pbo::Entry*> by_path;
+    std::unordered_set<std::string> bin_dirs;
+    for (const auto& entry : pbo_data.entries) {
+        std::string lower = armapath::to_slash_lower(entry.filename);
+        auto [dir, base] = split(lower);
+        if (base == "config.bin") bin_dirs.insert(dir);
+        by_path.emplace(std::move(lower), &entry);
+    }
+    std::string pfx = armapath::to_slash_lower(prefix);
+    while (!pfx.empty() && pfx.back() == '/') pfx.pop_back();
+
+    int count = 0;
+    for (const auto& entry : pbo_data.entries) {
+        std::string lower = armapath::to_slash_lower(entry.filename);
+        auto [dir, base] = split(lower);
+        bool binary = base == "config.bin";
+        if (!binary && (base != "config.cpp" || bin_dirs.contains(dir))) continue;
+
+        try {
+            std::string data = extract(entry);
+            const char* format = "bin";
+            if (!binary) {
+                config::TextOptions opts;
+                opts.include = [&](const std::string& target,
+                                   const std::string& from) -> std::optional<config::IncludedText> {
+                    std::string t = armapath::to_slash_lower(target);
+                    std::string path;
+                    if (!target.empty() && (target[0] == '\\' || target[0] == '/')) {
+                        if (pfx.empty() || !starts_with(t, pfx + "/")) return config::IncludedText{target, ""};
+                        path = t.substr(pfx.size() + 1);
+                    } else {
+                        auto from_dir = split(from.empty() ? lower : from).first;
+                        path = (fs::path(from_dir) / t).lexically_normal().generic_string();
+                    }
+                    auto it = by_path.find(path);
+                    if (it == by_path.end()) return config::IncludedText{target, ""};
+                    return config::IncludedText{path, extract(*it->second)};
+                };
+                std::ostringstream text;
+                config::write_text(text, config::parse_text(data, opts));
+                data = std::move(text).str();
+                format = "text";
+            }
+            stmt.reset();
+            stmt.bind_int64(1, pbo_id);
+            stmt.bind_text(2, entry.filename);
+            stmt.bind_text(3, format);
+            stmt.bind_blob(4, data.data(), data.size());
+            stmt.exec();
+            count++;
+        } catch (const std::exception& e) {
+            if (progress) {
+                BuildProgress bp;
+                bp.phase = "warning";
+                bp.pbo_path = pbo_path;
+                bp.file_name = std::format("{}: {}", entry.filename, e.what());
+                bp.pbo_index = pbo_idx;
+                bp.pbo_total = pbo_total;
+                progress(bp);
+            }
+        }
+    }
+    return count;
+}
+
 // Index a single PBO: insert into pbos, files, dirs, extensions, and metadata tables.
 struct PBOIndexCounts {
     int files = 0;
     int p3d = 0;
     int paa = 0;
     int audio = 0;
+    int configs = 0;
 };
 
 static PBOIndexCounts index_single_pbo(
@@ -772,6 +1008,7 @@ static PBOIndexCounts index_single_pbo(
     SqliteStmt& ext_stmt,
     SqliteStmt& model_stmt, SqliteStmt& mtex_stmt,
     SqliteStmt& paa_stmt, SqliteStmt& audio_stmt,
+    SqliteStmt* config_stmt,
     DirPathCache& dir_cache,
     const std::string& pbo_path,
     bool on_demand_metadata,
@@ -897,9 +1134,372 @@ static PBOIndexCounts index_single_pbo(
             counts.audio++;
         }
     }
+
+    if (config_stmt && pbo_file.is_open()) {
+        counts.configs = index_pbo_configs(*config_stmt, pbo_id, prefix, pbo_data, pbo_file,
+                                           pbo_path, progress, pbo_idx, pbo_total);
+    }
     return counts;
 }
 
+// ---------------------------------------------------------------------------
+// Merged config classes
+// ---------------------------------------------------------------------------
+
+namespace {
+
+std::string lower_ascii(std::string_view s) {
+    std::string out(s);
+    for (auto& c : out) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return out;
+}
+
+// AddonConfig is one stored config file with the CfgPatches classes it
+// declares and the requiredAddons they list (lowercase).
+struct AddonConfig {
+    int64_t pbo_id = 0;
+    config::Config cfg;
+    std::vector<std::string> patches;
+    std::vector<std::string> required;
+};
+
+struct MergedValue {
+    std::string key; // lowercase name
+    std::string name;
+    config::Entry value;
+};
+
+// MergedClass is a class of the merged config. Children and values are
+// keyed by lowercase name; deleted classes stay in place (flagged) so a
+// later addon can define them again.
+struct MergedClass {
+    std::string name;
+    std::string base; // declared parent name
+    std::string path;
+    int64_t pbo_id = 0;
+    bool defined = false; // a body was seen, not only "class X;"
+    bool deleted = false;
+    MergedClass* outer = nullptr;
+    const MergedClass* base_class = nullptr;
+    std::vector<MergedValue> values;
+    std::unordered_map<std::string, size_t> value_index;
+    std::vector<std::unique_ptr<MergedClass>> children;
+    std::unordered_map<std::string, MergedClass*> child_index;
+
+    bool live() const { return defined && !deleted; }
+
+    MergedClass* child(const std::string& key) const {
+        auto it = child_index.find(key);
+        return it != child_index.end() ? it->second : nullptr;
+    }
+};
+
+void collect_patches(AddonConfig& addon) {
+    for (const auto& ne : addon.cfg.root.entries) {
+        auto* patches = std::get_if<config::ClassEntryOwned>(&ne.entry);
+        if (!patches || lower_ascii(ne.name) != "cfgpatches") continue;
+        for (const auto& pe : patches->cls->entries) {
+            auto* patch = std::get_if<config::ClassEntryOwned>(&pe.entry);
+            if (!patch || patch->cls->external || patch->cls->deletion) continue;
+            addon.patches.push_back(lower_ascii(pe.name));
+            for (const auto& re : patch->cls->entries) {
+                auto* arr = std::get_if<config::ArrayEntry>(&re.entry);
+                if (!arr || lower_ascii(re.name) != "requiredaddons") continue;
+                for (const auto& el : arr->elements) {
+                    if (auto* s = std::get_if<config::StringElement>(&el))
+                        addon.required.push_back(lower_ascii(s->value));
+                }
+            }
+        }
+    }
+}
+
+// Order addons so each comes after the addons its patches require, as the
+// engine loads them. Ties and unresolvable requirements keep the stored
+// order (PBO path); a requiredAddons cycle is broken where it is found.
+std::vector<size_t> load_order(const std::vector<AddonConfig>& addons) {
+    std::unordered_map<std::string, size_t> provider;
+    for (size_t i = 0; i < addons.size(); ++i) {
+        for (const auto& p : addons[i].patches) provider.try_emplace(p, i);
+    }
+    std::vector<uint8_t> state(addons.size(), 0); // 0 new, 1 visiting, 2 placed
+    std::vector<size_t> order;
+    order.reserve(addons.size());
+    std::function<void(size_t)> visit = [&](size_t i) {
+        if (state[i] != 0) return;
+        state[i] = 1;
+        for (const auto& r : addons[i].required) {
+            auto it = provider.find(r);
+            if (it != provider.end()) visit(it->second);
+        }
+        state[i] = 2;
+        order.push_back(i);
+    };
+    for (size_t i = 0; i < addons.size(); ++i) visit(i);
+    return order;
+}
+
+// Apply one addon's class body on top of the merged class: new values are
+// added, existing ones replaced, "name[] += {...}" appends to an array
+// already in this class, and "delete X;" removes a subclass.
+void merge_class(MergedClass& dst, config::ConfigClass& src, int64_t pbo_id) {
+    for (auto& ne : src.entries) {
+        std::string key = lower_ascii(ne.name);
+        if (auto* ce = std::get_if<config::ClassEntryOwned>(&ne.entry)) {
+            auto& sc = *ce->cls;
+            MergedClass* child = dst.child(key);
+            if (sc.deletion) {
+                if (child) child->deleted = true;
+                continue;
+            }
+            if (!child) {
+                auto owned = std::make_unique<MergedClass>();
+                owned->name = ne.name;
+                owned->outer = &dst;
+                child = owned.get();
+                dst.child_index.emplace(key, child);
+                dst.children.push_back(std::move(owned));
+            }
+            if (sc.external) continue;
+            if (child->deleted) {
+                child->deleted = false;
+                child->defined = false;
+                child->values.clear();
+                child->value_index.clear();
+                child->children.clear();
+                child->child_index.clear();
+            }
+            if (!sc.parent.empty() || !child->defined) child->base = sc.parent;
+            child->defined = true;
+            child->pbo_id = pbo_id;
+            merge_class(*child, sc, pbo_id);
+            continue;
+        }
+
+        auto it = dst.value_index.find(key);
+        if (it == dst.value_index.end()) {
+            dst.value_index.emplace(key, dst.values.size());
+            dst.values.push_back({std::move(key), ne.name, std::move(ne.entry)});
+            continue;
+        }
+        auto& existing = dst.values[it->second].value;
+        auto* add = std::get_if<config::ArrayEntry>(&ne.entry);
+        auto* arr = std::get_if<config::ArrayEntry>(&existing);
+        if (add && add->expansion && arr) {
+            arr->elements.insert(arr->elements.end(), std::make_move_iterator(add->elements.begin()),
+                                 std::make_move_iterator(add->elements.end()));
+        } else {
+            existing = std::move(ne.entry);
+        }
+    }
+}
+
+// A parent name is looked up among the siblings of the class, then in each
+// enclosing scope outwards ("class Car: Car" refers to an outer Car).
+const MergedClass* resolve_base(const MergedClass& cls) {
+    if (cls.base.empty()) return nullptr;
+    std::string key = lower_ascii(cls.base);
+    for (const MergedClass* scope = cls.outer; scope; scope = scope->outer) {
+        const MergedClass* found = scope->child(key);
+        if (found && found != &cls && found->live()) return found;
+    }
+    return nullptr;
+}
+
+// Fill in paths and resolved bases once merging is complete.
+void link_classes(MergedClass& cls) {
+    for (auto& child : cls.children) {
+        if (!child->live()) continue;
+        child->path = cls.path.empty() ? child->name : cls.path + "/" + child->name;
+        child->base_class = resolve_base(*child);
+        link_classes(*child);
+    }
+}
+
+// FlatValue is a property of a class after inheritance: the value of the
+// nearest class that sets it, or an array joined through "+=".
+struct FlatValue {
+    const MergedValue* src = nullptr;
+    std::optional<config::Entry> joined;
+    bool inherited = false;
+
+    const config::Entry& value() const { return joined ? *joined : src->value; }
+};
+
+// Flatten the values of cls through its inheritance chain, base first.
+void flatten(const MergedClass& cls, std::vector<FlatValue>& flat,
+             std::unordered_map<std::string_view, size_t>& index) {
+    std::vector<const MergedClass*> chain;
+    for (const MergedClass* c = &cls; c; c = c->base_class) {
+        if (std::find(chain.begin(), chain.end(), c) != chain.end()) break; // inheritance cycle
+        chain.push_back(c);
+    }
+    flat.clear();
+    index.clear();
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        bool inherited = *it != &cls;
+        for (const auto& v : (*it)->values) {
+            auto [pos, inserted] = index.try_emplace(v.key, flat.size());
+            if (inserted) {
+                flat.push_back({&v, std::nullopt, inherited});
+                continue;
+            }
+            auto& f = flat[pos->second];
+            auto* add = std::get_if<config::ArrayEntry>(&v.value);
+            auto* base_arr = std::get_if<config::ArrayEntry>(&f.value());
+            if (add && add->expansion && base_arr) {
+                config::ArrayEntry arr = *base_arr;
+                arr.expansion = false;
+                arr.elements.insert(arr.elements.end(), add->elements.begin(), add->elements.end());
+                f.joined = config::Entry(std::move(arr));
+            } else {
+                f.joined.reset();
+            }
+            f.src = &v;
+            f.inherited = inherited;
+        }
+    }
+}
+
+const char* value_type(const config::Entry& e) {
+    if (std::holds_alternative<config::StringEntry>(e)) return "string";
+    if (std::holds_alternative<config::IntEntry>(e)) return "int";
+    if (std::holds_alternative<config::FloatEntry>(e)) return "float";
+    return "array";
+}
+
+std::string value_text(const config::Entry& e) {
+    if (auto* s = std::get_if<config::StringEntry>(&e)) return s->value;
+    return config::format_value(e);
+}
+
+struct ConfigWriter {
+    SqliteStmt class_stmt;
+    SqliteStmt value_stmt;
+    std::vector<FlatValue> flat;
+    std::unordered_map<std::string_view, size_t> index;
+    int classes = 0;
+
+    explicit ConfigWriter(sqlite3* db)
+        : class_stmt(db, "INSERT INTO config_classes (outer_id, path, name, base, pbo_id)"
+                         " VALUES (?1, ?2, ?3, ?4, ?5)"),
+          value_stmt(db, "INSERT INTO config_values (class_id, name, type, value, inherited)"
+                         " VALUES (?1, ?2, ?3, ?4, ?5)") {}
+
+    void write_children(sqlite3* db, const MergedClass& cls, int64_t outer_id) {
+        for (const auto& child : cls.children) {
+            if (!child->live()) continue;
+            class_stmt.reset();
+            if (outer_id > 0) class_stmt.bind_int64(1, outer_id);
+            else class_stmt.bind_null(1);
+            class_stmt.bind_text(2, child->path);
+            class_stmt.bind_text(3, child->name);
+            class_stmt.bind_text(4, child->base_class ? child->base_class->path : child->base);
+            class_stmt.bind_int64(5, child->pbo_id);
+            class_stmt.exec();
+            int64_t id = sqlite3_last_insert_rowid(db);
+            classes++;
+
+            flatten(*child, flat, index);
+            for (const auto& f : flat) {
+                value_stmt.reset();
+                value_stmt.bind_int64(1, id);
+                value_stmt.bind_text(2, f.src->name);
+                value_stmt.bind_text(3, value_type(f.value()));
+                value_stmt.bind_text(4, value_text(f.value()));
+                value_stmt.bind_int(5, f.inherited ? 1 : 0);
+                value_stmt.exec();
+            }
+            write_children(db, *child, id);
+        }
+    }
+};
+
+} // namespace
+
+// Rebuild config_classes/config_values from every stored config file.
+// Returns the number of classes written.
+static int rebuild_config_classes(sqlite3* db, BuildProgressFunc& progress) {
+    std::vector<AddonConfig> addons;
+    {
+        int total = 0;
+        {
+            SqliteStmt count(db, "SELECT COUNT(*) FROM pbo_configs");
+            if (count.step() == SQLITE_ROW) total = sqlite3_column_int(count.get(), 0);
+        }
+        SqliteStmt stmt(db,
+            "SELECT c.pbo_id, p.path, c.path, c.format, c.data"
+            " FROM pbo_configs c JOIN pbos p ON p.id = c.pbo_id"
+            " ORDER BY p.path, c.path");
+        int index = 0;
+        while (stmt.step() == SQLITE_ROW) {
+            auto text = [&](int col) {
+                const char* v = reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), col));
+                return std::string(v ? v : "");
+            };
+            std::string pbo_path = text(1);
+            std::string file = text(2);
+            if (progress) {
+                BuildProgress bp;
+                bp.phase = "config";
+                bp.pbo_path = pbo_path;
+                bp.file_name = file;
+                bp.file_index = index;
+                bp.file_total = total;
+                progress(bp);
+            }
+            index++;
+
+            AddonConfig addon;
+            addon.pbo_id = sqlite3_column_int64(stmt.get(), 0);
+            bool is_text = text(3) == "text";
+            std::string_view data(static_cast<const char*>(sqlite3_column_blob(stmt.get(), 4)),
+                                  static_cast<size_t>(sqlite3_column_bytes(stmt.get(), 4)));
+            try {
+                if (is_text) {
+                    addon.cfg = config::parse_text(data);
+                } else {
+                    std::istringstream is{std::string(data), std::ios::binary};
+                    addon.cfg = config::read(is);
+                }
+            } catch (const std::exception& e) {
+                if (progress) {
+                    BuildProgress bp;
+                    bp.phase = "warning";
+                    bp.pbo_path = pbo_path;
+                    bp.file_name = std::format("{}: {}", file, e.what());
+                    progress(bp);
+                }
+                continue;
+            }
+            collect_patches(addon);
+            addons.push_back(std::move(addon));
+        }
+    }
+
+    MergedClass root;
+    root.defined = true;
+    for (size_t i : load_order(addons)) {
+        merge_class(root, addons[i].cfg.root, addons[i].pbo_id);
+        addons[i].cfg = {};
+    }
+    link_classes(root);
+
+    exec_sql(db,
+        "DELETE FROM config_values;"
+        "DELETE FROM config_classes;"
+        "DROP INDEX IF EXISTS idx_config_values_class_id;"
+        "DROP INDEX IF EXISTS idx_config_values_name_value;");
+    int classes = 0;
+    {
+        ConfigWriter writer(db);
+        writer.write_children(db, root, 0);
+        classes = writer.classes;
+    }
+    exec_sql(db, config_value_indexes_sql);
+    return classes;
+}
+
 // ---------------------------------------------------------------------------
 // DB::build_db
 // ---------------------------------------------------------------------------
@@ -927,6 +1527,7 @@ BuildResult DB::build_db(const std::string& db_path,
         exec_sql(db, "PRAGMA journal_mode=WAL");
         exec_sql(db, "PRAGMA synchronous=NORMAL");
         exec_sql(db, schema_sql);
+        if (opts.index_configs) exec_sql(db, config_schema_sql);
 
         // Insert metadata.
         exec_sql(db, "BEGIN TRANSACTION");
@@ -1018,6 +1619,11 @@ BuildResult DB::build_db(const std::string& db_path,
                 "INSERT INTO audio_files (pbo_id, path, name, format, encoder,"
                 " sample_rate, channels, data_size)"
                 " VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8)");
+            std::optional<SqliteStmt> config_stmt;
+            if (opts.index_configs) {
+                config_stmt.emplace(db,
+                    "INSERT INTO pbo_configs (pbo_id, path, format, data) VALUES (?1, ?2, ?3, ?4)");
+            }
 
             DirPathCache dir_cache(db);
 
@@ -1034,6 +1640,7 @@ BuildResult DB::build_db(const std::string& db_path,
 
                 auto c = index_single_pbo(db, pbo_stmt, file_stmt, ext_stmt,
                                            model_stmt, mtex_stmt, paa_stmt, audio_stmt,
+                                           config_stmt ? &*config_stmt : nullptr,
                                            dir_cache,
                                            pbo_paths[i].path, opts.on_demand_metadata,
                                            progress, static_cast<int>(i) + 1, pbo_total,
@@ -1042,8 +1649,13 @@ BuildResult DB::build_db(const std::string& db_path,
                 result.p3d_count += c.p3d;
                 result.paa_count += c.paa;
                 result.audio_count += c.audio;
+                result.config_count += c.configs;
             }
 
+            if (opts.index_configs)
+                result.config_class_count = rebuild_config_classes(db, progress);
+            bump_model_generation(db);
+
             if (progress) {
                 BuildProgress bp;
                 bp.phase = "commit";
@@ -1058,6 +1670,8 @@ BuildResult DB::build_db(const std::string& db_path,
         // the database becomes unreadable after the rename.
         exec_sql(db, "PRAGMA wal_checkpoint(TRUNCATE)");
 
+        store_model_snapshot(db, db_path);
+
         sqlite3_close(db);
         db = nullptr;
 
@@ -1106,15 +1720,17 @@ static bool table_exists(sqlite3* db, const char* table) {
 
 DB DB::open(const std::string& path) {
     DB d;
-    d.impl_->db = open_db_handle(path, SQLITE_OPEN_READONLY);
+    d.impl_->path = path;
+    auto conn = d.impl_->acquire();
+    auto* db_handle = conn->db;
 
     // Verify meta table exists.
-    if (!table_exists(d.impl_->db, "meta"))
+    if (!table_exists(db_handle, "meta"))
         throw std::runtime_error("pboindex: not a valid database (no meta table)");
 
     // Verify schema version.
     {
-        SqliteStmt stmt(d.impl_->db,
+        SqliteStmt stmt(db_handle,
             "SELECT value FROM meta WHERE key = 'schema_version'");
         int rc = stmt.step();
         if (rc != SQLITE_ROW)
@@ -1128,8 +1744,6 @@ DB DB::open(const std::string& path) {
                             schema_version, ver ? ver : "(null)"));
     }
 
-    auto* db_handle = d.impl_->db;
-
     // Check required tables exist.
     const char* required_tables[] = {
         "pbos", "files", "p3d_models", "textures", "audio_files"
@@ -1152,6 +1766,13 @@ DB DB::open(const std::string& path) {
             "pboindex: incompatible database schema — 'p3d_models' table missing "
             "'pbo_id' column. Please rebuild the database.");
 
+    d.impl_->schema.has_dirs = table_exists(db_handle, "dirs");
+    d.impl_->schema.has_source = table_has_column(db_handle, "pbos", "source");
+    d.impl_->schema.has_vis_bbox = table_has_column(db_handle, "p3d_models", "vis_min_x");
+    d.impl_->schema.has_model_textures = table_exists(db_handle, "model_textures");
+    d.impl_->schema.has_configs = table_exists(db_handle, "config_classes");
+
+    d.impl_->release(std::move(conn));
     return d;
 }
 
@@ -1160,7 +1781,8 @@ DB DB::open(const std::string& path) {
 // ---------------------------------------------------------------------------
 
 Index DB::index() const {
-    SqliteStmt stmt(impl_->db, "SELECT path, prefix FROM pbos");
+    auto conn = impl_->lease();
+    auto& stmt = conn.stmt("SELECT path, prefix FROM pbos");
     std::vector<PBORef> refs;
     while (stmt.step() == SQLITE_ROW) {
         const char* p = reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 0));
@@ -1189,10 +1811,11 @@ Index DB::index() const {
 // ---------------------------------------------------------------------------
 
 DBStats DB::stats() const {
+    auto conn = impl_->lease();
     DBStats s;
 
     auto get_meta = [&](const char* key) -> std::string {
-        SqliteStmt stmt(impl_->db,
+        auto& stmt = conn.stmt(
             "SELECT value FROM meta WHERE key = ?1");
         stmt.bind_text(1, key);
         if (stmt.step() == SQLITE_ROW) {
@@ -1222,7 +1845,7 @@ DBStats DB::stats() const {
     }
 
     auto count_query = [&](const char* sql) -> int {
-        SqliteStmt stmt(impl_->db, sql);
+        auto& stmt = conn.stmt(sql);
         if (stmt.step() == SQLITE_ROW)
             return sqlite3_column_int(stmt.get(), 0);
         return 0;
@@ -1234,7 +1857,7 @@ DBStats DB::stats() const {
     s.file_count = count_query("SELECT COUNT(*) FROM files");
 
     {
-        SqliteStmt stmt(impl_->db,
+        auto& stmt = conn.stmt(
             "SELECT COALESCE(SUM(data_size), 0) FROM files");
         if (stmt.step() == SQLITE_ROW)
             s.total_data_size = sqlite3_column_int64(stmt.get(), 0);
@@ -1243,6 +1866,10 @@ DBStats DB::stats() const {
     s.p3d_model_count = count_query("SELECT COUNT(*) FROM p3d_models");
     s.texture_count = count_query("SELECT COUNT(*) FROM textures");
     s.audio_file_count = count_query("SELECT COUNT(*) FROM audio_files");
+    if (impl_->schema.has_configs) {
+        s.config_file_count = count_query("SELECT COUNT(*) FROM pbo_configs");
+        s.config_class_count = count_query("SELECT COUNT(*) FROM config_classes");
+    }
 
     return s;
 }
@@ -1254,15 +1881,16 @@ DBStats DB::stats() const {
 std::vector<DirEntry> DB::list_dir(const std::string& dir,
                                    size_t limit,
                                    size_t offset) const {
+    auto conn = impl_->lease();
     std::vector<DirEntry> entries;
-    bool has_dirs = table_exists(impl_->db, "dirs");
+    bool has_dirs = impl_->schema.has_dirs;
     bool paged_in_sql = has_dirs;
     const int64_t sql_limit = (limit > 0) ? static_cast<int64_t>(limit) : -1;
     const int64_t sql_offset = static_cast<int64_t>(offset);
 
     if (has_dirs) {
         if (dir.empty()) {
-            SqliteStmt stmt(impl_->db,
+            auto& stmt = conn.stmt(
                 "SELECT kind, name, pbo_path, prefix, file_path, data_size FROM ("
                 "  SELECT 0 AS kind, d.name AS name,"
                 "         '' AS pbo_path, '' AS prefix, '' AS file_path, 0 AS data_size"
@@ -1303,7 +1931,7 @@ std::vector<DirEntry> DB::list_dir(const std::string& dir,
                 });
             }
         } else {
-            SqliteStmt stmt(impl_->db,
+            auto& stmt = conn.stmt(
                 "SELECT kind, name, pbo_path, prefix, file_path, data_size FROM ("
                 "  SELECT 0 AS kind, d.name AS name,"
                 "         '' AS pbo_path, '' AS prefix, '' AS file_path, 0 AS data_size"
@@ -1353,7 +1981,7 @@ std::vector<DirEntry> DB::list_dir(const std::string& dir,
         if (!norm_dir.empty() && norm_dir.back() != '/')
             norm_dir += '/';
 
-        SqliteStmt stmt(impl_->db,
+        auto& stmt = conn.stmt(
             "SELECT p.path, p.prefix, f.path, f.data_size"
             " FROM files f JOIN pbos p ON f.pbo_id = p.id");
 
@@ -1446,7 +2074,8 @@ std::vector<DirEntry> DB::list_dir(const std::string& dir,
 // ---------------------------------------------------------------------------
 
 std::vector<FindResult> DB::all_files() const {
-    SqliteStmt stmt(impl_->db,
+    auto conn = impl_->lease();
+    auto& stmt = conn.stmt(
         "SELECT p.path, p.prefix, f.path, f.data_size"
         " FROM files f JOIN pbos p ON f.pbo_id = p.id"
         " ORDER BY f.path");
@@ -1487,8 +2116,9 @@ std::vector<FindResult> DB::find_files(const std::string& pattern,
     const int64_t sql_limit = (limit > 0) ? static_cast<int64_t>(limit) : -1;
     const int64_t sql_offset = static_cast<int64_t>(offset);
 
-    if (source.empty() || !table_has_column(impl_->db, "pbos", "source")) {
-        SqliteStmt stmt(impl_->db,
+    auto conn = impl_->lease();
+    if (source.empty() || !impl_->schema.has_source) {
+        auto& stmt = conn.stmt(
             "SELECT p.path, p.prefix, f.path, f.data_size"
             " FROM files f JOIN pbos p ON f.pbo_id = p.id"
             " WHERE LOWER(REPLACE(f.path, '\\', '/')) LIKE ?1"
@@ -1511,7 +2141,7 @@ std::vector<FindResult> DB::find_files(const std::string& pattern,
             results.push_back(std::move(fr));
         }
     } else {
-        SqliteStmt stmt(impl_->db,
+        auto& stmt = conn.stmt(
             "SELECT p.path, p.prefix, f.path, f.data_size"
             " FROM files f JOIN pbos p ON f.pbo_id = p.id"
             " WHERE LOWER(REPLACE(f.path, '\\', '/')) LIKE ?1"
@@ -1544,7 +2174,8 @@ std::vector<FindResult> DB::find_files(const std::string& pattern,
 // ---------------------------------------------------------------------------
 
 std::vector<std::string> DB::list_pbo_paths() const {
-    SqliteStmt stmt(impl_->db, "SELECT path FROM pbos ORDER BY path");
+    auto conn = impl_->lease();
+    auto& stmt = conn.stmt("SELECT path FROM pbos ORDER BY path");
     std::vector<std::string> paths;
     while (stmt.step() == SQLITE_ROW) {
         const char* v = reinterpret_cast<const char*>(
@@ -1555,15 +2186,25 @@ std::vector<std::string> DB::list_pbo_paths() const {
 }
 
 // ---------------------------------------------------------------------------
-// DB::query_model_bboxes
+// Model metadata helpers
 // ---------------------------------------------------------------------------
 
-std::unordered_map<std::string, ModelBBox> DB::query_model_bboxes() const {
-    // Check if visual columns exist (for compatibility with older databases).
-    bool has_vis = table_has_column(impl_->db, "p3d_models", "vis_min_x");
+// Full lowercase virtual path of a model: normalizePrefix/toSlashLower(path).
+static std::string model_virtual_path(const char* prefix, const char* path) {
+    std::string full_path;
+    if (prefix && *prefix) {
+        full_path = armapath::to_slash_lower(prefix);
+        if (!full_path.empty() && full_path.back() != '/')
+            full_path += '/';
+    }
+    full_path += armapath::to_slash_lower(std::string(path));
+    return full_path;
+}
 
-    std::string sql =
-        "SELECT m.path, p.prefix,"
+// SELECT over p3d_models (m) joined with pbos (p): the given leading
+// columns followed by the bounding box columns read by read_model_bbox.
+static std::string model_bbox_sql(const char* lead_columns, bool has_vis) {
+    std::string sql = std::string("SELECT ") + lead_columns + ","
         " m.bbox_min_x, m.bbox_min_y, m.bbox_min_z,"
         " m.bbox_max_x, m.bbox_max_y, m.bbox_max_z,"
         " m.bbox_center_x, m.bbox_center_y, m.bbox_center_z,"
@@ -1576,8 +2217,34 @@ std::unordered_map<std::string, ModelBBox> DB::query_model_bboxes() const {
             " m.vis_center_x, m.vis_center_y, m.vis_center_z";
     }
     sql += " FROM p3d_models m JOIN pbos p ON m.pbo_id = p.id";
+    return sql;
+}
 
-    SqliteStmt stmt(impl_->db, sql.c_str());
+static ModelBBox read_model_bbox(sqlite3_stmt* stmt, int col, bool has_vis) {
+    auto next = [&]() { return static_cast<float>(sqlite3_column_double(stmt, col++)); };
+    ModelBBox bbox;
+    for (auto& v : bbox.bbox_min) v = next();
+    for (auto& v : bbox.bbox_max) v = next();
+    for (auto& v : bbox.bbox_center) v = next();
+    bbox.bbox_radius = next();
+    for (auto& v : bbox.mi_max) v = next();
+    if (has_vis) {
+        for (auto& v : bbox.vis_min) v = next();
+        for (auto& v : bbox.vis_max) v = next();
+        for (auto& v : bbox.vis_center) v = next();
+    }
+    return bbox;
+}
+
+// ---------------------------------------------------------------------------
+// DB::query_model_bboxes
+// ---------------------------------------------------------------------------
+
+std::unordered_map<std::string, ModelBBox> DB::query_model_bboxes() const {
+    auto conn = impl_->lease();
+    // Visual columns are missing in older databases.
+    bool has_vis = impl_->schema.has_vis_bbox;
+    auto& stmt = conn.stmt(model_bbox_sql("m.path, p.prefix", has_vis));
 
     std::unordered_map<std::string, ModelBBox> result;
     while (stmt.step() == SQLITE_ROW) {
@@ -1587,45 +2254,7 @@ std::unordered_map<std::string, ModelBBox> DB::query_model_bboxes() const {
             sqlite3_column_text(stmt.get(), 1));
         if (!fp) continue;
 
-        // Build the full model path: normalizePrefix/toSlashLower(path)
-        std::string prefix = pfx ? pfx : "";
-        std::string full_path;
-        if (!prefix.empty()) {
-            full_path = armapath::to_slash_lower(prefix);
-            if (!full_path.empty() && full_path.back() != '/')
-                full_path += '/';
-        }
-        full_path += armapath::to_slash_lower(std::string(fp));
-
-        ModelBBox bbox;
-        int col = 2;
-        bbox.bbox_min[0] = static_cast<float>(sqlite3_column_double(stmt.get(), col++));
-        bbox.bbox_min[1] = static_cast<float>(sqlite3_column_double(stmt.get(), col++));
-        bbox.bbox_min[2] = static_cast<float>(sqlite3_column_double(stmt.get(), col++));
-        bbox.bbox_max[0] = static_cast<float>(sqlite3_column_double(stmt.get(), col++));
-        bbox.bbox_max[1] = static_cast<float>(sqlite3_column_double(stmt.get(), col++));
-        bbox.bbox_max[2] = static_cast<float>(sqlite3_column_double(stmt.get(), col++));
-        bbox.bbox_center[0] = static_cast<float>(sqlite3_column_double(stmt.get(), col++));
-        bbox.bbox_center[1] = static_cast<float>(sqlite3_column_double(stmt.get(), col++));
-        bbox.bbox_center[2] = static_cast<float>(sqlite3_column_double(stmt.get(), col++));
-        bbox.bbox_radius = static_cast<float>(sqlite3_column_double(stmt.get(), col++));
-        bbox.mi_max[0] = static_cast<float>(sqlite3_column_double(stmt.get(), col++));
-        bbox.mi_max[1] = static_cast<float>(sqlite3_column_double(stmt.get(), col++));
-        bbox.mi_max[2] = static_cast<float>(sqlite3_column_double(stmt.get(), col++));
-
-        if (has_vis) {
-            bbox.vis_min[0] = static_cast<float>(sqlite3_column_double(stmt.get(), col++));
-            bbox.vis_min[1] = static_cast<float>(sqlite3_column_double(stmt.get(), col++));
-            bbox.vis_min[2] = static_cast<float>(sqlite3_column_double(stmt.get(), col++));
-            bbox.vis_max[0] = static_cast<float>(sqlite3_column_double(stmt.get(), col++));
-            bbox.vis_max[1] = static_cast<float>(sqlite3_column_double(stmt.get(), col++));
-            bbox.vis_max[2] = static_cast<float>(sqlite3_column_double(stmt.get(), col++));
-            bbox.vis_center[0] = static_cast<float>(sqlite3_column_double(stmt.get(), col++));
-            bbox.vis_center[1] = static_cast<float>(sqlite3_column_double(stmt.get(), col++));
-            bbox.vis_center[2] = static_cast<float>(sqlite3_column_double(stmt.get(), col++));
-        }
-
-        result[full_path] = bbox;
+        result[model_virtual_path(pfx, fp)] = read_model_bbox(stmt.get(), 2, has_vis);
     }
     return result;
 }
@@ -1641,10 +2270,12 @@ DB::query_model_textures(const std::vector<std::string>& models) const {
     if (models.empty()) return result;
 
     // Check if model_textures table exists (Go schema).
-    if (!table_exists(impl_->db, "model_textures")) return result;
+    if (!impl_->schema.has_model_textures) return result;
+
+    auto conn = impl_->lease();
 
     // Query texture paths for each model by constructing the full model path.
-    SqliteStmt stmt(impl_->db,
+    auto& stmt = conn.stmt(
         "SELECT mt.texture_path"
         " FROM model_textures mt"
         " JOIN pbos p ON mt.pbo_id = p.id"
@@ -1679,7 +2310,8 @@ std::unordered_map<std::string, std::string> DB::query_model_paths() const {
     // p3d_models.path stores the raw entry filename (original case).
     // p3d_models.name stores the basename without extension (original case).
     // We join with pbos to get the prefix and build the full virtual path.
-    SqliteStmt stmt(impl_->db,
+    auto conn = impl_->lease();
+    auto& stmt = conn.stmt(
         "SELECT m.path, m.name, p.prefix"
         " FROM p3d_models m JOIN pbos p ON m.pbo_id = p.id");
 
@@ -1693,19 +2325,410 @@ std::unordered_map<std::string, std::string> DB::query_model_paths() const {
             sqlite3_column_text(stmt.get(), 2));
         if (!fp || !name) continue;
 
-        // Build the full lowercase virtual path: prefix/entry_path
-        std::string prefix = pfx ? pfx : "";
-        std::string full_path;
-        if (!prefix.empty()) {
-            full_path = armapath::to_slash_lower(prefix);
-            if (!full_path.empty() && full_path.back() != '/')
-                full_path += '/';
+        result[model_virtual_path(pfx, fp)] = name;
+    }
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// Model snapshot
+// ---------------------------------------------------------------------------
+//
+// Sidecar layout (native byte order):
+//   SnapshotHeader
+//   SnapshotRecord records[count]  sorted by path
+//   uint32_t by_base[count]        record indexes sorted by (base, path)
+//   char strings[strings_size]
+
+static constexpr char snapshot_magic[4] = {'A', '3', 'M', 'S'};
+static constexpr uint32_t snapshot_version = 2;
+
+// SnapshotStamp identifies the p3d_models contents a snapshot was built from:
+// the model generation in meta, which build_db and update_db advance
+// whenever they write models. Row counts or rowids are not enough, since
+// deleting and reinserting a PBO's models can leave both unchanged.
+struct SnapshotStamp {
+    int64_t generation = 0;
+    bool operator==(const SnapshotStamp&) const = default;
+};
+
+struct SnapshotHeader {
+    char magic[4];
+    uint32_t version;
+    SnapshotStamp stamp;
+    uint32_t count;
+    uint32_t strings_size;
+};
+
+struct SnapshotRecord {
+    uint32_t path_off, path_len; // lowercase virtual path
+    uint32_t name_off, name_len; // original-case basename without extension
+    uint32_t base_off, base_len; // lowercase name, key of the by_base index
+    ModelBBox bbox;
+};
+
+static_assert(std::is_trivially_copyable_v<ModelBBox>);
+static_assert(sizeof(SnapshotHeader) % alignof(SnapshotRecord) == 0);
+
+static SnapshotStamp model_snapshot_stamp(sqlite3* db) {
+    SqliteStmt stmt(db, "SELECT value FROM meta WHERE key = 'models_generation'");
+    SnapshotStamp st;
+    if (stmt.step() == SQLITE_ROW) st.generation = sqlite3_column_int64(stmt.get(), 0);
+    return st;
+}
+
+// Advance the model generation. A database without one (new, or built
+// before generations were stored) starts from the clock, so a rebuilt
+// database never repeats the generation of the one it replaces.
+static void bump_model_generation(sqlite3* db) {
+    int64_t generation = model_snapshot_stamp(db).generation;
+    if (generation > 0) {
+        generation++;
+    } else {
+        generation = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+    SqliteStmt stmt(db, "INSERT OR REPLACE INTO meta (key, value) VALUES ('models_generation', ?1)");
+    stmt.bind_int64(1, generation);
+    stmt.exec();
+}
+
+static std::vector<uint8_t> build_model_snapshot(sqlite3* db, const SnapshotStamp& stamp) {
+    struct Row {
+        std::string path;
+        std::string name;
+        ModelBBox bbox;
+    };
+
+    bool has_vis = table_has_column(db, "p3d_models", "vis_min_x");
+    SqliteStmt stmt(db, model_bbox_sql("m.path, m.name, p.prefix", has_vis).c_str());
+
+    std::vector<Row> rows;
+    while (stmt.step() == SQLITE_ROW) {
+        const char* fp = reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 0));
+        const char* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 1));
+        const char* pfx = reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 2));
+        if (!fp) continue;
+        rows.push_back({model_virtual_path(pfx, fp), name ? name : "",
+                        read_model_bbox(stmt.get(), 3, has_vis)});
+    }
+
+    // Sort by path; like query_model_bboxes, the last row of a duplicate path wins.
+    std::stable_sort(rows.begin(), rows.end(),
+                     [](const Row& a, const Row& b) { return a.path < b.path; });
+    size_t kept = 0;
+    for (size_t i = 0; i < rows.size(); i++) {
+        if (i + 1 < rows.size() && rows[i + 1].path == rows[i].path) continue;
+        if (kept != i) rows[kept] = std::move(rows[i]);
+        kept++;
+    }
+    rows.resize(kept);
+
+    std::vector<SnapshotRecord> records(rows.size());
+    std::string strings;
+    auto add_string = [&](const std::string& v, uint32_t& off, uint32_t& len) {
+        if (strings.size() + v.size() > std::numeric_limits<uint32_t>::max())
+            throw std::runtime_error("pboindex: model snapshot too large");
+        off = static_cast<uint32_t>(strings.size());
+        len = static_cast<uint32_t>(v.size());
+        strings += v;
+    };
+    for (size_t i = 0; i < rows.size(); i++) {
+        auto& rec = records[i];
+        add_string(rows[i].path, rec.path_off, rec.path_len);
+        add_string(rows[i].name, rec.name_off, rec.name_len);
+        std::string base = rows[i].name;
+        std::transform(base.begin(), base.end(), base.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        add_string(base, rec.base_off, rec.base_len);
+        rec.bbox = rows[i].bbox;
+    }
+
+    std::vector<uint32_t> by_base(records.size());
+    for (size_t i = 0; i < by_base.size(); i++) by_base[i] = static_cast<uint32_t>(i);
+    auto base_of = [&](uint32_t i) {
+        return std::string_view(strings).substr(records[i].base_off, records[i].base_len);
+    };
+    std::stable_sort(by_base.begin(), by_base.end(),
+                     [&](uint32_t a, uint32_t b) { return base_of(a) < base_of(b); });
+
+    SnapshotHeader hdr{};
+    std::memcpy(hdr.magic, snapshot_magic, sizeof(hdr.magic));
+    hdr.version = snapshot_version;
+    hdr.stamp = stamp;
+    hdr.count = static_cast<uint32_t>(records.size());
+    hdr.strings_size = static_cast<uint32_t>(strings.size());
+
+    std::vector<uint8_t> blob(sizeof(hdr) + records.size() * sizeof(SnapshotRecord) +
+                              by_base.size() * sizeof(uint32_t) + strings.size());
+    uint8_t* out = blob.data();
+    auto put = [&](const void* src, size_t n) {
+        if (n) std::memcpy(out, src, n);
+        out += n;
+    };
+    put(&hdr, sizeof(hdr));
+    put(records.data(), records.size() * sizeof(SnapshotRecord));
+    put(by_base.data(), by_base.size() * sizeof(uint32_t));
+    put(strings.data(), strings.size());
+    return blob;
+}
+
+static void write_snapshot_file(const std::string& path, const std::vector<uint8_t>& blob) {
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream f(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!f) throw std::runtime_error("pboindex: cannot create " + tmp_path);
+        f.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+        if (!f) throw std::runtime_error("pboindex: writing " + tmp_path);
+    }
+    fs::rename(tmp_path, path);
+}
+
+static void store_model_snapshot(sqlite3* db, const std::string& db_path) {
+    // Best effort: a missing or stale snapshot is rebuilt by DB::model_snapshot.
+    try {
+        write_snapshot_file(ModelSnapshot::sidecar_path(db_path),
+                            build_model_snapshot(db, model_snapshot_stamp(db)));
+    } catch (const std::exception&) {
+    }
+}
+
+struct ModelSnapshot::Impl {
+    binutil::MappedFile file; // mapped snapshot, or an in-memory one when none could be mapped
+
+    const SnapshotHeader* header = nullptr;
+    const SnapshotRecord* records = nullptr;
+    const uint32_t* by_base = nullptr;
+    const char* strings = nullptr;
+
+    // map maps a snapshot file; returns false if it is missing or malformed.
+    bool map(const std::string& path) {
+        if (file.map(path) && attach()) return true;
+        reset();
+        return false;
+    }
+
+    void adopt(std::vector<uint8_t> blob) {
+        file.adopt(std::move(blob));
+        if (!attach())
+            throw std::runtime_error("pboindex: invalid model snapshot");
+    }
+
+    void reset() {
+        file.reset();
+        header = nullptr;
+        records = nullptr;
+        by_base = nullptr;
+        strings = nullptr;
+    }
+
+    // attach validates the layout of data and sets the section pointers.
+    bool attach() {
+        const uint8_t* data = file.data();
+        size_t size = file.size();
+        if (size < sizeof(SnapshotHeader)) return false;
+        header = reinterpret_cast<const SnapshotHeader*>(data);
+        if (std::memcmp(header->magic, snapshot_magic, sizeof(snapshot_magic)) != 0 ||
+            header->version != snapshot_version)
+            return false;
+        size_t n = header->count;
+        size_t expected = sizeof(SnapshotHeader) + n * sizeof(SnapshotRecord) +
+                          n * sizeof(uint32_t) + header->strings_size;
+        if (size != expected) return false;
+        records = reinterpret_cast<const SnapshotRecord*>(data + sizeof(SnapshotHeader));
+        by_base = reinterpret_cast<const uint32_t*>(records + n);
+        strings = reinterpret_cast<const char*>(by_base + n);
+        return true;
+    }
+
+    size_t count() const { return header ? header->count : 0; }
+
+    std::string_view str(uint32_t off, uint32_t len) const {
+        if (static_cast<size_t>(off) + len > header->strings_size) return {};
+        return {strings + off, len};
+    }
+    std::string_view path(size_t i) const { return str(records[i].path_off, records[i].path_len); }
+    std::string_view base(size_t i) const { return str(records[i].base_off, records[i].base_len); }
+
+    const SnapshotRecord* find(std::string_view key) const {
+        size_t lo = 0, hi = count();
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (path(mid) < key) lo = mid + 1;
+            else hi = mid;
         }
-        full_path += armapath::to_slash_lower(std::string(fp));
+        return (lo < count() && path(lo) == key) ? &records[lo] : nullptr;
+    }
+};
+
+ModelSnapshot::ModelSnapshot() : impl_(std::make_unique<Impl>()) {}
+ModelSnapshot::~ModelSnapshot() = default;
+ModelSnapshot::ModelSnapshot(ModelSnapshot&& other) noexcept = default;
+ModelSnapshot& ModelSnapshot::operator=(ModelSnapshot&& other) noexcept = default;
+
+std::string ModelSnapshot::sidecar_path(const std::string& db_path) {
+    return db_path + ".models";
+}
 
-        result[full_path] = name;
+size_t ModelSnapshot::size() const {
+    return impl_ ? impl_->count() : 0;
+}
+
+const ModelBBox* ModelSnapshot::find_bbox(std::string_view path) const {
+    if (!impl_) return nullptr;
+    const auto* rec = impl_->find(path);
+    return rec ? &rec->bbox : nullptr;
+}
+
+std::string_view ModelSnapshot::find_name(std::string_view path) const {
+    if (!impl_) return {};
+    const auto* rec = impl_->find(path);
+    return rec ? impl_->str(rec->name_off, rec->name_len) : std::string_view{};
+}
+
+std::string_view ModelSnapshot::find_name_by_base(std::string_view base) const {
+    if (!impl_) return {};
+    size_t lo = 0, hi = impl_->count();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (impl_->base(impl_->by_base[mid]) < base) lo = mid + 1;
+        else hi = mid;
     }
-    return result;
+    if (lo == impl_->count() || impl_->base(impl_->by_base[lo]) != base) return {};
+    const auto& rec = impl_->records[impl_->by_base[lo]];
+    return impl_->str(rec.name_off, rec.name_len);
+}
+
+std::string_view ModelSnapshot::path_at(size_t i) const {
+    return impl_->path(i);
+}
+
+std::string_view ModelSnapshot::name_at(size_t i) const {
+    return impl_->str(impl_->records[i].name_off, impl_->records[i].name_len);
+}
+
+const ModelBBox& ModelSnapshot::bbox_at(size_t i) const {
+    return impl_->records[i].bbox;
+}
+
+// ---------------------------------------------------------------------------
+// DB::model_snapshot
+// ---------------------------------------------------------------------------
+
+ModelSnapshot DB::model_snapshot() const {
+    auto conn = impl_->lease();
+    auto stamp = model_snapshot_stamp(conn.handle());
+    auto path = ModelSnapshot::sidecar_path(impl_->path);
+
+    ModelSnapshot snap;
+    if (snap.impl_->map(path) && snap.impl_->header->stamp == stamp)
+        return snap;
+
+    auto blob = build_model_snapshot(conn.handle(), stamp);
+    try {
+        write_snapshot_file(path, blob);
+    } catch (const std::exception&) {
+        // Read-only location: the in-memory copy below still serves this session.
+    }
+    snap.impl_->adopt(std::move(blob));
+    return snap;
+}
+
+// ---------------------------------------------------------------------------
+// DB config class queries
+// ---------------------------------------------------------------------------
+
+// Class paths are stored with '/' separators and compared case-insensitively.
+static std::string config_class_path(const std::string& path) {
+    std::string p = path;
+    std::replace(p.begin(), p.end(), '\\', '/');
+    while (!p.empty() && p.front() == '/') p.erase(0, 1);
+    while (!p.empty() && p.back() == '/') p.pop_back();
+    return p;
+}
+
+static void require_configs(const SchemaFlags& schema) {
+    if (!schema.has_configs)
+        throw std::runtime_error(
+            "pboindex: database has no config index; rebuild with config indexing enabled");
+}
+
+std::optional<ConfigClassInfo> DB::find_config_class(const std::string& path) const {
+    require_configs(impl_->schema);
+    auto conn = impl_->lease();
+    auto& cls = conn.stmt(
+        "SELECT c.id, c.path, c.base, COALESCE(p.path, '')"
+        " FROM config_classes c LEFT JOIN pbos p ON p.id = c.pbo_id"
+        " WHERE c.path = ?1");
+    cls.bind_text(1, config_class_path(path));
+    if (cls.step() != SQLITE_ROW) return std::nullopt;
+
+    auto text = [](SqliteStmt& stmt, int col) {
+        const char* v = reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), col));
+        return std::string(v ? v : "");
+    };
+    ConfigClassInfo info;
+    int64_t id = sqlite3_column_int64(cls.get(), 0);
+    info.path = text(cls, 1);
+    info.base = text(cls, 2);
+    info.pbo_path = text(cls, 3);
+
+    auto& vals = conn.stmt(
+        "SELECT name, type, value, inherited FROM config_values"
+        " WHERE class_id = ?1 ORDER BY rowid");
+    vals.bind_int64(1, id);
+    while (vals.step() == SQLITE_ROW) {
+        ConfigValue v;
+        v.name = text(vals, 0);
+        v.type = text(vals, 1);
+        v.value = text(vals, 2);
+        v.inherited = sqlite3_column_int(vals.get(), 3) != 0;
+        info.values.push_back(std::move(v));
+    }
+    return info;
+}
+
+std::vector<std::string> DB::list_config_classes(const std::string& path) const {
+    require_configs(impl_->schema);
+    auto conn = impl_->lease();
+    std::string p = config_class_path(path);
+    SqliteStmt* stmt = nullptr;
+    if (p.empty()) {
+        stmt = &conn.stmt("SELECT path FROM config_classes WHERE outer_id IS NULL ORDER BY id");
+    } else {
+        stmt = &conn.stmt(
+            "SELECT c.path FROM config_classes c"
+            " JOIN config_classes o ON o.id = c.outer_id"
+            " WHERE o.path = ?1 ORDER BY c.id");
+        stmt->bind_text(1, p);
+    }
+    std::vector<std::string> paths;
+    while (stmt->step() == SQLITE_ROW) {
+        const char* v = reinterpret_cast<const char*>(sqlite3_column_text(stmt->get(), 0));
+        if (v) paths.emplace_back(v);
+    }
+    return paths;
+}
+
+std::vector<std::string> DB::find_config_classes(const std::string& name,
+                                                 const std::string& value,
+                                                 size_t limit) const {
+    require_configs(impl_->schema);
+    auto conn = impl_->lease();
+    auto& stmt = conn.stmt(
+        "SELECT c.path FROM config_values v"
+        " JOIN config_classes c ON c.id = v.class_id"
+        " WHERE v.name = ?1 AND v.value = ?2"
+        " ORDER BY c.id LIMIT ?3");
+    stmt.bind_text(1, name);
+    stmt.bind_text(2, value);
+    stmt.bind_int64(3, limit > 0 ? static_cast<int64_t>(limit) : -1);
+    std::vector<std::string> paths;
+    while (stmt.step() == SQLITE_ROW) {
+        const char* v = reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 0));
+        if (v) paths.emplace_back(v);
+    }
+    return paths;
 }
 
 // ---------------------------------------------------------------------------
@@ -1764,17 +2787,27 @@ UpdateResult DB::update_db(const std::string& db_path,
 
         exec_sql(db, "BEGIN TRANSACTION");
 
+        // Config tables are kept current once present. When they are first
+        // requested, unchanged PBOs have their configs read as well.
+        bool configs = table_exists(db, "pbo_configs");
+        bool backfill_configs = false;
+        if (!configs && opts.index_configs) {
+            exec_sql(db, config_schema_sql);
+            configs = backfill_configs = true;
+        }
+
         // Load existing PBOs from database.
         struct ExistingPBO {
             int64_t id;
             std::string path;
             int64_t file_size;
             std::string mod_time;
+            std::string prefix;
         };
         std::vector<ExistingPBO> existing;
         {
             SqliteStmt stmt(db,
-                "SELECT id, path, file_size, mod_time FROM pbos");
+                "SELECT id, path, file_size, mod_time, prefix FROM pbos");
             while (stmt.step() == SQLITE_ROW) {
                 ExistingPBO ep;
                 ep.id = sqlite3_column_int64(stmt.get(), 0);
@@ -1785,6 +2818,9 @@ UpdateResult DB::update_db(const std::string& db_path,
                 v = reinterpret_cast<const char*>(
                     sqlite3_column_text(stmt.get(), 3));
                 ep.mod_time = v ? v : "";
+                v = reinterpret_cast<const char*>(
+                    sqlite3_column_text(stmt.get(), 4));
+                ep.prefix = v ? v : "";
                 existing.push_back(std::move(ep));
             }
         }
@@ -1803,10 +2839,13 @@ UpdateResult DB::update_db(const std::string& db_path,
                 "DELETE FROM audio_files WHERE pbo_id = ?1",
                 "DELETE FROM model_textures WHERE pbo_id = ?1",
                 "DELETE FROM pbo_extensions WHERE pbo_id = ?1",
+                "DELETE FROM pbo_configs WHERE pbo_id = ?1",
             };
             for (const char* sql : del_sqls) {
                 if (std::strstr(sql, "model_textures") && !table_exists(db, "model_textures"))
                     continue;
+                if (std::strstr(sql, "pbo_configs") && !configs)
+                    continue;
                 if (std::strstr(sql, "pbo_extensions") && !table_exists(db, "pbo_extensions"))
                     continue;
                 SqliteStmt del(db, sql);
@@ -1865,6 +2904,12 @@ UpdateResult DB::update_db(const std::string& db_path,
             " sample_rate, channels, data_size)"
             " VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8)");
 
+        std::optional<SqliteStmt> config_stmt;
+        if (configs) {
+            config_stmt.emplace(db,
+                "INSERT INTO pbo_configs (pbo_id, path, format, data) VALUES (?1, ?2, ?3, ?4)");
+        }
+
         SqliteStmt del_pbo_stmt(db, "DELETE FROM pbos WHERE id = ?1");
 
         DirPathCache dir_cache(db);
@@ -1896,6 +2941,17 @@ UpdateResult DB::update_db(const std::string& db_path,
                 if (eit->second.file_size == static_cast<int64_t>(fsize) &&
                     eit->second.mod_time == mod_time) {
                     // Unchanged, skip.
+                    if (backfill_configs) {
+                        try {
+                            std::ifstream f(pbo_path, std::ios::binary);
+                            auto pbo_data = pbo::read(f);
+                            result.config_count += index_pbo_configs(
+                                *config_stmt, eit->second.id, eit->second.prefix, pbo_data, f,
+                                pbo_path, progress, static_cast<int>(i) + 1, pbo_total);
+                        } catch (const std::exception&) {
+                            // Unreadable now; its configs are picked up when it changes.
+                        }
+                    }
                     continue;
                 }
                 // Changed: remove old entry and all children, re-index.
@@ -1919,6 +2975,7 @@ UpdateResult DB::update_db(const std::string& db_path,
 
             auto c = index_single_pbo(db, pbo_stmt, file_stmt, ext_stmt,
                                        model_stmt, mtex_stmt, paa_stmt, audio_stmt,
+                                       config_stmt ? &*config_stmt : nullptr,
                                        dir_cache,
                                        pbo_path, opts.on_demand_metadata,
                                        progress, static_cast<int>(i) + 1, pbo_total,
@@ -1927,8 +2984,14 @@ UpdateResult DB::update_db(const std::string& db_path,
             result.p3d_count += c.p3d;
             result.paa_count += c.paa;
             result.audio_count += c.audio;
+            result.config_count += c.configs;
         }
 
+        if (configs && (result.added || result.updated || result.removed || backfill_configs))
+            result.config_class_count = rebuild_config_classes(db, progress);
+        if (result.added || result.updated || result.removed)
+            bump_model_generation(db);
+
         if (progress) {
             BuildProgress bp;
             bp.phase = "commit";
@@ -1936,6 +2999,7 @@ UpdateResult DB::update_db(const std::string& db_path,
         }
 
         exec_sql(db, "COMMIT");
+        store_model_snapshot(db, db_path);
         sqlite3_close(db);
         db = nullptr;
 
@@ -1957,12 +3021,14 @@ UpdateResult DB::update_db(const std::string& db_path,
 std::vector<std::string> DB::query_sources() const {
     std::vector<std::string> sources;
 
-    if (!table_has_column(impl_->db, "pbos", "source"))
+    if (!impl_->schema.has_source)
         return sources;
 
+    auto conn = impl_->lease();
+
     // Collect distinct sources from DB.
     std::unordered_set<std::string> found;
-    SqliteStmt stmt(impl_->db,
+    auto& stmt = conn.stmt(
         "SELECT DISTINCT source FROM pbos WHERE source != ''");
     while (stmt.step() == SQLITE_ROW) {
         const char* v = reinterpret_cast<const char*>(
@@ -1996,16 +3062,17 @@ std::vector<DirEntry> DB::list_dir_for_source(const std::string& dir,
                                               size_t limit,
                                               size_t offset) const {
     std::vector<DirEntry> entries;
-    bool has_dirs = table_exists(impl_->db, "dirs");
-    bool has_source_col = table_has_column(impl_->db, "pbos", "source");
+    bool has_dirs = impl_->schema.has_dirs;
+    bool has_source_col = impl_->schema.has_source;
     const int64_t sql_limit = (limit > 0) ? static_cast<int64_t>(limit) : -1;
     const int64_t sql_offset = static_cast<int64_t>(offset);
 
     if (!has_source_col) return list_dir(dir, limit, offset);
 
     if (has_dirs) {
+        auto conn = impl_->lease();
         if (dir.empty()) {
-            SqliteStmt stmt(impl_->db,
+            auto& stmt = conn.stmt(
                 "SELECT kind, name, pbo_path, prefix, file_path, data_size FROM ("
                 "  SELECT 0 AS kind, root_name AS name,"
                 "         '' AS pbo_path, '' AS prefix, '' AS file_path, 0 AS data_size"
@@ -2056,7 +3123,7 @@ std::vector<DirEntry> DB::list_dir_for_source(const std::string& dir,
             }
         } else {
             auto prefix = dir + "/";
-            SqliteStmt stmt(impl_->db,
+            auto& stmt = conn.stmt(
                 "SELECT kind, name, pbo_path, prefix, file_path, data_size FROM ("
                 "  SELECT 0 AS kind, child_name AS name,"
                 "         '' AS pbo_path, '' AS prefix, '' AS file_path, 0 AS data_size"
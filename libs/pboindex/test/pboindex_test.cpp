@@ -0,0 +1,258 @@
+#include "armatools/pboindex.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+using armatools::pboindex::BuildOptions;
+using armatools::pboindex::ConfigClassInfo;
+using armatools::pboindex::ConfigValue;
+using armatools::pboindex::DB;
+
+namespace {
+
+// Write an uncompressed PBO with a prefix header and the given files.
+void write_pbo(const fs::path& path, const std::string& prefix,
+               const std::vector<std::pair<std::string, std::string>>& files) {
+    std::ofstream out(path, std::ios::binary);
+    auto write_asciiz = [&](const std::string& s) {
+        out.write(s.data(), static_cast<std::streamsize>(s.size()));
+        out.put('\0');
+    };
+    auto write_u32 = [&](uint32_t v) {
+        out.write(reinterpret_cast<const char*>(&v), 4);
+    };
+    auto write_header = [&](const std::string& name, uint32_t method, uint32_t size) {
+        write_asciiz(name);
+        write_u32(method);
+        write_u32(size);
+        write_u32(0);
+        write_u32(0);
+        write_u32(size);
+    };
+
+    write_header("", 0x56657273, 0);
+    write_asciiz("prefix");
+    write_asciiz(prefix);
+    write_asciiz("");
+    for (const auto& [name, data] : files)
+        write_header(name, 0, static_cast<uint32_t>(data.size()));
+    write_header("", 0, 0);
+    for (const auto& [name, data] : files)
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    out.put('\0');
+    out.write(std::string(20, '\0').data(), 20);
+}
+
+// Test directory holding an "addons" folder and the database.
+struct TempGame {
+    fs::path root;
+
+    explicit TempGame(const std::string& name)
+        : root(fs::temp_directory_path() / ("armatools_pboindex_test_" + name)) {
+        fs::remove_all(root);
+        fs::create_directories(root / "addons");
+    }
+    ~TempGame() {
+        std::error_code ec;
+        fs::remove_all(root, ec);
+    }
+
+    std::string db() const { return (root / "index.db").string(); }
+    fs::path addon(const std::string& name) const { return root / "addons" / name; }
+};
+
+// A one-LOD MLOD model with two points spanning lo..hi.
+std::string mlod(float lo, float hi) {
+    std::string s = "MLOD";
+    auto u32 = [&](uint32_t v) { s.append(reinterpret_cast<const char*>(&v), 4); };
+    auto f32 = [&](float v) { s.append(reinterpret_cast<const char*>(&v), 4); };
+    u32(257);
+    u32(1);
+    s += "P3DM";
+    u32(28);
+    u32(256);
+    u32(2); // points
+    u32(0); // normals
+    u32(0); // faces
+    u32(0); // flags
+    for (float v : {lo, hi}) {
+        f32(v);
+        f32(v);
+        f32(v);
+        u32(0);
+    }
+    s += "TAGG";
+    s.push_back('\1');
+    s += "#EndOfFile#";
+    s.push_back('\0');
+    u32(0);
+    f32(1.0f);
+    return s;
+}
+
+const ConfigValue* find_value(const ConfigClassInfo& cls, const std::string& name) {
+    for (const auto& v : cls.values)
+        if (v.name == name) return &v;
+    return nullptr;
+}
+
+} // namespace
+
+TEST(PboIndex, ConfigMergeOrderInheritanceAndForwardDeclarations) {
+    TempGame game("config_merge");
+
+    // The override addon sorts first by path but requires the base addon,
+    // so it must be applied after it.
+    write_pbo(game.addon("a_override.pbo"), "test\\override", {{"config.cpp", R"(
+class CfgPatches {
+    class Test_Override { requiredAddons[] = {"Test_Base"}; };
+};
+class CfgVehicles {
+    class Vehicle;
+    class Ghost;
+    class Car: Vehicle {
+        speed = 80;
+    };
+    class Truck: Car {
+        cargo = 4;
+    };
+};
+)"}});
+    write_pbo(game.addon("b_base.pbo"), "test\\base", {{"config.cpp", R"(
+class CfgPatches {
+    class Test_Base { requiredAddons[] = {}; };
+};
+class CfgVehicles {
+    class Vehicle {
+        scope = 1;
+        speed = 10;
+    };
+    class Car: Vehicle {
+        speed = 50;
+        fuel = 1;
+    };
+};
+)"}});
+
+    BuildOptions opts;
+    opts.index_configs = true;
+    auto result = DB::build_db(game.db(), game.root.string(), "", {}, opts);
+    EXPECT_EQ(result.config_count, 2);
+
+    auto db = DB::open(game.db());
+
+    // "class Vehicle;" in the later addon keeps the earlier body.
+    auto vehicle = db.find_config_class("CfgVehicles/Vehicle");
+    ASSERT_TRUE(vehicle);
+    EXPECT_NE(vehicle->pbo_path.find("b_base.pbo"), std::string::npos);
+    ASSERT_TRUE(find_value(*vehicle, "speed"));
+    EXPECT_EQ(find_value(*vehicle, "speed")->value, "10");
+
+    // The later addon overrides speed; fuel survives from the first body.
+    auto car = db.find_config_class("cfgvehicles/car");
+    ASSERT_TRUE(car);
+    EXPECT_EQ(car->path, "CfgVehicles/Car");
+    EXPECT_EQ(car->base, "CfgVehicles/Vehicle");
+    EXPECT_NE(car->pbo_path.find("a_override.pbo"), std::string::npos);
+    ASSERT_TRUE(find_value(*car, "speed"));
+    EXPECT_EQ(find_value(*car, "speed")->value, "80");
+    EXPECT_FALSE(find_value(*car, "speed")->inherited);
+    ASSERT_TRUE(find_value(*car, "fuel"));
+    EXPECT_FALSE(find_value(*car, "fuel")->inherited);
+    ASSERT_TRUE(find_value(*car, "scope"));
+    EXPECT_EQ(find_value(*car, "scope")->value, "1");
+    EXPECT_TRUE(find_value(*car, "scope")->inherited);
+
+    // Inheritance goes through the merged parent.
+    auto truck = db.find_config_class("CfgVehicles/Truck");
+    ASSERT_TRUE(truck);
+    EXPECT_EQ(truck->base, "CfgVehicles/Car");
+    ASSERT_TRUE(find_value(*truck, "speed"));
+    EXPECT_EQ(find_value(*truck, "speed")->value, "80");
+    EXPECT_TRUE(find_value(*truck, "speed")->inherited);
+    ASSERT_TRUE(find_value(*truck, "cargo"));
+    EXPECT_EQ(find_value(*truck, "cargo")->value, "4");
+
+    // A class that is only ever forward-declared does not exist.
+    EXPECT_FALSE(db.find_config_class("CfgVehicles/Ghost"));
+    EXPECT_EQ(db.list_config_classes("CfgVehicles"),
+              (std::vector<std::string>{"CfgVehicles/Vehicle", "CfgVehicles/Car", "CfgVehicles/Truck"}));
+
+    EXPECT_EQ(db.find_config_classes("speed", "80"),
+              (std::vector<std::string>{"CfgVehicles/Car", "CfgVehicles/Truck"}));
+}
+
+TEST(PboIndex, ConfigQueriesRequireConfigIndex) {
+    TempGame game("no_configs");
+    auto db_path = game.db();
+    DB::build_db(db_path, game.root.string(), "", {});
+    auto db = DB::open(db_path);
+    EXPECT_THROW(db.find_config_class("CfgVehicles/Car"), std::runtime_error);
+}
+
+TEST(PboIndex, ModelSnapshotRoundTrip) {
+    TempGame game("snapshot");
+    write_pbo(game.addon("models.pbo"), "test\\models",
+              {{"Rock.p3d", mlod(-1, 1)}, {"data\\Tree.p3d", mlod(0, 4)}});
+    DB::build_db(game.db(), game.root.string(), "", {});
+    ASSERT_TRUE(fs::exists(armatools::pboindex::ModelSnapshot::sidecar_path(game.db())));
+
+    auto db = DB::open(game.db());
+    for (int pass = 0; pass < 2; pass++) {
+        // The first pass maps the sidecar written by build_db; the second
+        // opens it again through the stamp check.
+        auto snap = db.model_snapshot();
+        ASSERT_EQ(snap.size(), 2u);
+        EXPECT_EQ(snap.path_at(0), "test/models/data/tree.p3d");
+        EXPECT_EQ(snap.path_at(1), "test/models/rock.p3d");
+        EXPECT_EQ(snap.find_name("test/models/rock.p3d"), "Rock");
+        EXPECT_EQ(snap.find_name_by_base("tree"), "Tree");
+        EXPECT_TRUE(snap.find_name("test/models/bush.p3d").empty());
+        EXPECT_FALSE(snap.find_bbox("test/models/bush.p3d"));
+
+        auto bboxes = db.query_model_bboxes();
+        for (size_t i = 0; i < snap.size(); i++) {
+            auto it = bboxes.find(std::string(snap.path_at(i)));
+            ASSERT_NE(it, bboxes.end());
+            const auto* bbox = snap.find_bbox(snap.path_at(i));
+            ASSERT_TRUE(bbox);
+            EXPECT_EQ(std::memcmp(bbox, &it->second, sizeof(*bbox)), 0);
+        }
+    }
+}
+
+TEST(PboIndex, ModelSnapshotInvalidatedByUpdate) {
+    TempGame game("snapshot_update");
+    auto sidecar = armatools::pboindex::ModelSnapshot::sidecar_path(game.db());
+    write_pbo(game.addon("models.pbo"), "test\\models", {{"a.p3d", mlod(0, 1)}, {"b.p3d", mlod(0, 1)}});
+    DB::build_db(game.db(), game.root.string(), "", {});
+    auto stale = game.root / "stale.models";
+    fs::copy_file(sidecar, stale);
+
+    // Replacing the PBO deletes its two models and inserts two others,
+    // which reuse the same rowids.
+    write_pbo(game.addon("models.pbo"), "test\\models", {{"cc.p3d", mlod(0, 2)}, {"dd.p3d", mlod(0, 2)}});
+    auto result = DB::update_db(game.db(), game.root.string(), "", {});
+    EXPECT_EQ(result.updated, 1);
+
+    // Put the old sidecar back, as if rewriting it had failed: the
+    // snapshot must still notice that it is out of date.
+    fs::copy_file(stale, sidecar, fs::copy_options::overwrite_existing);
+    auto db = DB::open(game.db());
+    auto snap = db.model_snapshot();
+    ASSERT_EQ(snap.size(), 2u);
+    EXPECT_EQ(snap.path_at(0), "test/models/cc.p3d");
+    EXPECT_EQ(snap.path_at(1), "test/models/dd.p3d");
+    EXPECT_FALSE(snap.find_bbox("test/models/a.p3d"));
+
+    // The regenerated sidecar now matches.
+    EXPECT_EQ(db.model_snapshot().path_at(0), "test/models/cc.p3d");
+}
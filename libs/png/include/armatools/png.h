@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <string>
+
+namespace armatools::png {
+
+// Filter selects the PNG row filter. Adaptive picks, per row, the filter
+// with the smallest sum of absolute differences (the libpng heuristic).
+enum class Filter { None, Sub, Up, Average, Paeth, Adaptive };
+
+struct Options {
+    int level = 6;                    // zlib compression level, 0-9
+    Filter filter = Filter::Adaptive;
+    int threads = 0;                  // deflate threads; 0 = all cores
+    int chunk_rows = 0;               // rows per deflate chunk; 0 = about 256 KiB of pixels
+};
+
+// parse_filter maps "none", "sub", "up", "average", "paeth" or "adaptive"
+// to a Filter. Throws std::invalid_argument for other names.
+Filter parse_filter(const std::string& name);
+
+// Writer encodes an 8-bit PNG (1-4 channels) row by row.
+//
+// Rows are filtered on the calling thread and grouped into chunks that are
+// deflated in parallel, pigz-style: every chunk is primed with the last
+// 32 KiB of the previous one and ends on a byte-aligned sync flush, so the
+// chunks concatenate into a single zlib stream (one IDAT chunk each). Only
+// a few chunks per thread are buffered at once.
+class Writer {
+public:
+    Writer(std::ostream& out, int width, int height, int channels, const Options& opts = {});
+    ~Writer();
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    // WriteRow appends one row of width * channels bytes.
+    void write_row(std::span<const uint8_t> row);
+
+    // Finish flushes the remaining chunks and writes IEND. It throws if
+    // fewer than height rows were written.
+    void finish();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// write encodes a whole image of height rows, each width * channels bytes.
+void write(std::ostream& out, const uint8_t* pixels, int width, int height, int channels,
+           const Options& opts = {});
+
+} // namespace armatools::png
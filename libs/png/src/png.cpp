@@ -0,0 +1,405 @@
+#include "armatools/png.h"
+#include "armatools/parallel.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace armatools::png {
+
+namespace {
+
+constexpr size_t dict_size = 32768;              // deflate window
+constexpr size_t default_chunk_bytes = 256 * 1024;
+
+void put_u32be(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+uint8_t paeth(uint8_t a, uint8_t b, uint8_t c) {
+    int p = static_cast<int>(a) + static_cast<int>(b) - static_cast<int>(c);
+    int pa = std::abs(p - a);
+    int pb = std::abs(p - b);
+    int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    if (pb <= pc) return b;
+    return c;
+}
+
+// filter_row writes the filter type byte and the filtered bytes of row to
+// out (n + 1 bytes). prev is the previous raw row (zeros for the first).
+void filter_row(Filter type, const uint8_t* row, const uint8_t* prev, size_t n, size_t bpp,
+                uint8_t* out) {
+    out[0] = static_cast<uint8_t>(type);
+    uint8_t* dst = out + 1;
+    switch (type) {
+    case Filter::None:
+        std::memcpy(dst, row, n);
+        break;
+    case Filter::Sub:
+        for (size_t i = 0; i < n; i++)
+            dst[i] = static_cast<uint8_t>(row[i] - (i >= bpp ? row[i - bpp] : 0));
+        break;
+    case Filter::Up:
+        for (size_t i = 0; i < n; i++)
+            dst[i] = static_cast<uint8_t>(row[i] - prev[i]);
+        break;
+    case Filter::Average:
+        for (size_t i = 0; i < n; i++) {
+            unsigned left = i >= bpp ? row[i - bpp] : 0;
+            dst[i] = static_cast<uint8_t>(row[i] - ((left + prev[i]) >> 1));
+        }
+        break;
+    case Filter::Paeth:
+        for (size_t i = 0; i < n; i++) {
+            uint8_t left = i >= bpp ? row[i - bpp] : 0;
+            uint8_t up_left = i >= bpp ? prev[i - bpp] : 0;
+            dst[i] = static_cast<uint8_t>(row[i] - paeth(left, prev[i], up_left));
+        }
+        break;
+    case Filter::Adaptive:
+        break;
+    }
+}
+
+// Sum of the filtered bytes taken as signed values; smaller usually
+// deflates better.
+uint64_t filter_cost(const uint8_t* filtered, size_t n) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += static_cast<uint64_t>(std::abs(static_cast<int>(static_cast<int8_t>(filtered[i]))));
+    }
+    return sum;
+}
+
+struct Chunk {
+    std::vector<uint8_t> data; // filtered rows
+    std::vector<uint8_t> dict; // tail of the preceding chunk's data
+    bool last = false;
+
+    std::vector<uint8_t> deflated;
+    uLong adler = 0;
+    bool done = false;
+    std::string error;
+    std::exception_ptr exception; // thrown by a worker, rethrown by emit
+};
+
+void deflate_chunk(Chunk& c, int level, int strategy) {
+    if (c.data.size() > std::numeric_limits<uInt>::max()) {
+        c.error = "chunk too large";
+        return;
+    }
+    z_stream zs{};
+    if (deflateInit2(&zs, level, Z_DEFLATED, -15, 8, strategy) != Z_OK) {
+        c.error = "deflateInit2 failed";
+        return;
+    }
+    if (!c.dict.empty()) {
+        deflateSetDictionary(&zs, c.dict.data(), static_cast<uInt>(c.dict.size()));
+    }
+
+    c.deflated.resize(deflateBound(&zs, static_cast<uLong>(c.data.size())) + 16);
+    zs.next_in = c.data.data();
+    zs.avail_in = static_cast<uInt>(c.data.size());
+    const int flush = c.last ? Z_FINISH : Z_SYNC_FLUSH;
+    int ret;
+    for (;;) {
+        zs.next_out = c.deflated.data() + zs.total_out;
+        zs.avail_out = static_cast<uInt>(c.deflated.size() - zs.total_out);
+        ret = deflate(&zs, flush);
+        if (ret == Z_STREAM_END || (ret == Z_OK && zs.avail_out != 0)) break;
+        if (ret != Z_OK && ret != Z_BUF_ERROR) break;
+        c.deflated.resize(c.deflated.size() * 2);
+    }
+    bool ok = c.last ? ret == Z_STREAM_END : ret == Z_OK;
+    c.deflated.resize(zs.total_out);
+    deflateEnd(&zs);
+    if (!ok) {
+        c.error = "deflate failed";
+        return;
+    }
+    c.adler = adler32(adler32(0, Z_NULL, 0), c.data.data(), static_cast<uInt>(c.data.size()));
+    std::vector<uint8_t>().swap(c.data);
+    std::vector<uint8_t>().swap(c.dict);
+}
+
+} // namespace
+
+Filter parse_filter(const std::string& name) {
+    if (name == "none") return Filter::None;
+    if (name == "sub") return Filter::Sub;
+    if (name == "up") return Filter::Up;
+    if (name == "average") return Filter::Average;
+    if (name == "paeth") return Filter::Paeth;
+    if (name == "adaptive") return Filter::Adaptive;
+    throw std::invalid_argument("png: unknown filter " + name);
+}
+
+struct Writer::Impl {
+    std::ostream& out;
+    size_t height;
+    size_t row_bytes;
+    size_t bpp;
+    int level;
+    int strategy;
+    Filter filter;
+    size_t chunk_rows;
+    size_t max_pending;
+
+    size_t rows_written = 0;
+    bool finished = false;
+    bool stream_started = false;
+    uLong adler = 1;
+    std::vector<uint8_t> prev_row;
+    std::vector<uint8_t> scratch; // adaptive filter candidates
+    std::vector<uint8_t> dict_tail;
+    std::shared_ptr<Chunk> current;
+    std::deque<std::shared_ptr<Chunk>> pending; // submitted, in output order
+    std::deque<size_t> pending_sizes;            // filtered bytes per pending chunk
+
+    std::mutex mu;
+    std::condition_variable cv;
+    std::deque<std::shared_ptr<Chunk>> queue; // waiting for a worker
+    bool stop = false;
+    std::vector<std::thread> workers;
+
+    Impl(std::ostream& o, int width, int h, int channels, const Options& opts)
+        : out(o), height(static_cast<size_t>(h)),
+          row_bytes(static_cast<size_t>(width) * static_cast<size_t>(channels)),
+          bpp(static_cast<size_t>(channels)), level(std::clamp(opts.level, 0, 9)),
+          strategy(opts.filter == Filter::None ? Z_DEFAULT_STRATEGY : Z_FILTERED),
+          filter(opts.filter) {
+        size_t threads = binutil::worker_count(opts.threads);
+        chunk_rows = opts.chunk_rows > 0 ? static_cast<size_t>(opts.chunk_rows)
+                                         : std::max<size_t>(1, default_chunk_bytes / row_bytes);
+        max_pending = threads * 2;
+        prev_row.assign(row_bytes, 0);
+        if (threads > 1) {
+            for (size_t i = 0; i < threads; i++) workers.emplace_back([this] { work(); });
+        }
+    }
+
+    ~Impl() {
+        {
+            std::lock_guard lock(mu);
+            stop = true;
+        }
+        cv.notify_all();
+        for (auto& t : workers) t.join();
+    }
+
+    void work() {
+        for (;;) {
+            std::shared_ptr<Chunk> c;
+            {
+                std::unique_lock lock(mu);
+                cv.wait(lock, [&] { return stop || !queue.empty(); });
+                if (stop) return;
+                c = std::move(queue.front());
+                queue.pop_front();
+            }
+            try {
+                deflate_chunk(*c, level, strategy);
+            } catch (...) {
+                c->exception = std::current_exception();
+            }
+            {
+                std::lock_guard lock(mu);
+                c->done = true;
+            }
+            cv.notify_all();
+        }
+    }
+
+    void write_chunk(const char* type, std::span<const uint8_t> a, std::span<const uint8_t> b = {},
+                     std::span<const uint8_t> c = {}) {
+        size_t len = a.size() + b.size() + c.size();
+        if (len > 0x7fffffffu) throw std::runtime_error("png: chunk too large");
+        uint8_t head[8];
+        put_u32be(head, static_cast<uint32_t>(len));
+        std::memcpy(head + 4, type, 4);
+        uLong crc = crc32(0, head + 4, 4);
+        for (auto part : {a, b, c}) {
+            if (!part.empty()) crc = crc32(crc, part.data(), static_cast<uInt>(part.size()));
+        }
+        uint8_t tail[4];
+        put_u32be(tail, static_cast<uint32_t>(crc));
+        out.write(reinterpret_cast<const char*>(head), 8);
+        for (auto part : {a, b, c}) {
+            out.write(reinterpret_cast<const char*>(part.data()), static_cast<std::streamsize>(part.size()));
+        }
+        out.write(reinterpret_cast<const char*>(tail), 4);
+        if (!out) throw std::runtime_error("png: write failed");
+    }
+
+    void emit(Chunk& c, size_t raw_size) {
+        if (c.exception) std::rethrow_exception(c.exception);
+        if (!c.error.empty()) throw std::runtime_error("png: " + c.error);
+        std::array<uint8_t, 2> zhead{};
+        std::span<const uint8_t> prefix;
+        if (!stream_started) {
+            // zlib header: deflate, 32 KiB window, level hint, check bits.
+            int level_bits = level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+            zhead[0] = 0x78;
+            zhead[1] = static_cast<uint8_t>(level_bits << 6);
+            zhead[1] = static_cast<uint8_t>(zhead[1] + (31 - (zhead[0] * 256 + zhead[1]) % 31));
+            prefix = zhead;
+            stream_started = true;
+        }
+        adler = adler32_combine(adler, c.adler, static_cast<z_off_t>(raw_size));
+        std::array<uint8_t, 4> trailer{};
+        std::span<const uint8_t> suffix;
+        if (c.last) {
+            put_u32be(trailer.data(), static_cast<uint32_t>(adler));
+            suffix = trailer;
+        }
+        write_chunk("IDAT", prefix, c.deflated, suffix);
+    }
+
+    // drain writes finished chunks in order, blocking until at most keep
+    // chunks are still pending.
+    void drain(size_t keep) {
+        while (!pending.empty()) {
+            auto& front = pending.front();
+            {
+                std::unique_lock lock(mu);
+                if (pending.size() > keep) {
+                    cv.wait(lock, [&] { return front->done; });
+                } else if (!front->done) {
+                    return;
+                }
+            }
+            emit(*front, pending_sizes.front());
+            pending.pop_front();
+            pending_sizes.pop_front();
+        }
+    }
+
+    void submit() {
+        auto c = std::move(current);
+        c->dict = dict_tail;
+        if (c->data.size() >= dict_size) {
+            dict_tail.assign(c->data.end() - static_cast<std::ptrdiff_t>(dict_size), c->data.end());
+        } else {
+            dict_tail.insert(dict_tail.end(), c->data.begin(), c->data.end());
+            if (dict_tail.size() > dict_size) {
+                dict_tail.erase(dict_tail.begin(),
+                                dict_tail.end() - static_cast<std::ptrdiff_t>(dict_size));
+            }
+        }
+        pending_sizes.push_back(c->data.size());
+        pending.push_back(c);
+        if (workers.empty()) {
+            deflate_chunk(*c, level, strategy);
+            c->done = true;
+        } else {
+            {
+                std::lock_guard lock(mu);
+                queue.push_back(c);
+            }
+            cv.notify_all();
+        }
+        drain(max_pending - 1);
+    }
+
+    void write_row(std::span<const uint8_t> row) {
+        if (finished) throw std::runtime_error("png: write after finish");
+        if (row.size() != row_bytes) throw std::runtime_error("png: row size mismatch");
+        if (rows_written >= height) throw std::runtime_error("png: too many rows");
+
+        if (!current) {
+            current = std::make_shared<Chunk>();
+            current->data.reserve(std::min(chunk_rows, height - rows_written) * (row_bytes + 1));
+        }
+        auto& data = current->data;
+        size_t off = data.size();
+        data.resize(off + row_bytes + 1);
+        uint8_t* dst = data.data() + off;
+
+        if (filter != Filter::Adaptive) {
+            filter_row(filter, row.data(), prev_row.data(), row_bytes, bpp, dst);
+        } else {
+            scratch.resize(row_bytes + 1);
+            uint64_t best_cost = std::numeric_limits<uint64_t>::max();
+            for (Filter f : {Filter::None, Filter::Sub, Filter::Up, Filter::Average, Filter::Paeth}) {
+                uint8_t* cand = (f == Filter::None) ? dst : scratch.data();
+                filter_row(f, row.data(), prev_row.data(), row_bytes, bpp, cand);
+                uint64_t cost = filter_cost(cand + 1, row_bytes);
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    if (cand != dst) std::memcpy(dst, cand, row_bytes + 1);
+                }
+            }
+        }
+
+        std::memcpy(prev_row.data(), row.data(), row_bytes);
+        rows_written++;
+        if (rows_written == height) current->last = true;
+        if (current->last || data.size() >= chunk_rows * (row_bytes + 1)) submit();
+    }
+
+    void finish() {
+        if (finished) return;
+        if (rows_written != height) throw std::runtime_error("png: missing rows");
+        drain(0);
+        write_chunk("IEND", {});
+        out.flush();
+        finished = true;
+    }
+};
+
+Writer::Writer(std::ostream& out, int width, int height, int channels, const Options& opts) {
+    if (width <= 0 || height <= 0 || channels < 1 || channels > 4) {
+        throw std::invalid_argument("png: invalid dimensions or channels");
+    }
+    impl_ = std::make_unique<Impl>(out, width, height, channels, opts);
+
+    static constexpr uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    static constexpr uint8_t color_types[5] = {0, 0, 4, 2, 6};
+    out.write(reinterpret_cast<const char*>(signature), 8);
+    uint8_t ihdr[13];
+    put_u32be(ihdr, static_cast<uint32_t>(width));
+    put_u32be(ihdr + 4, static_cast<uint32_t>(height));
+    ihdr[8] = 8; // bit depth
+    ihdr[9] = color_types[channels];
+    ihdr[10] = 0; // deflate
+    ihdr[11] = 0; // adaptive filtering
+    ihdr[12] = 0; // no interlace
+    impl_->write_chunk("IHDR", ihdr);
+}
+
+Writer::~Writer() = default;
+
+void Writer::write_row(std::span<const uint8_t> row) {
+    impl_->write_row(row);
+}
+
+void Writer::finish() {
+    impl_->finish();
+}
+
+void write(std::ostream& out, const uint8_t* pixels, int width, int height, int channels,
+           const Options& opts) {
+    Writer w(out, width, height, channels, opts);
+    size_t row_bytes = static_cast<size_t>(width) * static_cast<size_t>(channels);
+    for (size_t y = 0; y < static_cast<size_t>(height); y++) {
+        w.write_row({pixels + y * row_bytes, row_bytes});
+    }
+    w.finish();
+}
+
+} // namespace armatools::png
@@ -0,0 +1,206 @@
+#include "armatools/png.h"
+
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+using namespace armatools::png;
+
+namespace {
+
+struct Decoded {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint8_t color_type = 0;
+    int idat_chunks = 0;
+    std::vector<uint8_t> pixels;
+};
+
+uint32_t get_u32be(const uint8_t* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+uint8_t paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return static_cast<uint8_t>(a);
+    if (pb <= pc) return static_cast<uint8_t>(b);
+    return static_cast<uint8_t>(c);
+}
+
+// Minimal reference decoder: checks chunk CRCs, inflates the IDAT stream
+// with zlib (which verifies the adler32 trailer) and undoes the filters.
+Decoded decode(const std::string& file, int channels) {
+    Decoded d;
+    auto bytes = reinterpret_cast<const uint8_t*>(file.data());
+    EXPECT_EQ(std::memcmp(bytes, "\x89PNG\r\n\x1a\n", 8), 0);
+    std::vector<uint8_t> zdata;
+    size_t pos = 8;
+    bool seen_end = false;
+    while (pos + 12 <= file.size()) {
+        uint32_t len = get_u32be(bytes + pos);
+        std::string type(file.data() + pos + 4, 4);
+        const uint8_t* data = bytes + pos + 8;
+        uLong crc = crc32(0, bytes + pos + 4, 4 + len);
+        EXPECT_EQ(crc, get_u32be(data + len)) << type;
+        if (type == "IHDR") {
+            d.width = get_u32be(data);
+            d.height = get_u32be(data + 4);
+            d.color_type = data[9];
+        } else if (type == "IDAT") {
+            zdata.insert(zdata.end(), data, data + len);
+            d.idat_chunks++;
+        } else if (type == "IEND") {
+            seen_end = true;
+        }
+        pos += 12 + len;
+    }
+    EXPECT_TRUE(seen_end);
+    EXPECT_EQ(pos, file.size());
+
+    size_t stride = size_t(d.width) * size_t(channels);
+    std::vector<uint8_t> raw(d.height * (stride + 1));
+    uLongf raw_len = static_cast<uLongf>(raw.size());
+    EXPECT_EQ(uncompress(raw.data(), &raw_len, zdata.data(), static_cast<uLong>(zdata.size())), Z_OK);
+    EXPECT_EQ(raw_len, raw.size());
+
+    d.pixels.assign(d.height * stride, 0);
+    for (size_t y = 0; y < d.height; y++) {
+        const uint8_t* src = raw.data() + y * (stride + 1);
+        uint8_t* dst = d.pixels.data() + y * stride;
+        const uint8_t* up = y > 0 ? dst - stride : nullptr;
+        auto bpp = size_t(channels);
+        for (size_t i = 0; i < stride; i++) {
+            int a = i >= bpp ? dst[i - bpp] : 0;
+            int b = up ? up[i] : 0;
+            int c = (up && i >= bpp) ? up[i - bpp] : 0;
+            int pred = 0;
+            switch (src[0]) {
+            case 0: pred = 0; break;
+            case 1: pred = a; break;
+            case 2: pred = b; break;
+            case 3: pred = (a + b) / 2; break;
+            case 4: pred = paeth(a, b, c); break;
+            default: ADD_FAILURE() << "bad filter " << int(src[0]); return d;
+            }
+            dst[i] = static_cast<uint8_t>(src[1 + i] + pred);
+        }
+    }
+    return d;
+}
+
+// Smooth gradient with noise, so every filter gets picked somewhere.
+std::vector<uint8_t> make_image(int w, int h, int channels, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> px(size_t(w) * size_t(h) * size_t(channels));
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            for (int c = 0; c < channels; c++) {
+                size_t i = (size_t(y) * size_t(w) + size_t(x)) * size_t(channels) + size_t(c);
+                int v = (x * 3 + y * 2 + c * 40) + ((y / 16) % 2 ? int(rng() % 8) : 0);
+                px[i] = static_cast<uint8_t>(v);
+            }
+        }
+    }
+    return px;
+}
+
+std::string encode(const std::vector<uint8_t>& px, int w, int h, int channels, const Options& opts) {
+    std::ostringstream out;
+    write(out, px.data(), w, h, channels, opts);
+    return out.str();
+}
+
+} // namespace
+
+TEST(Png, RoundTripAllFilters) {
+    const int w = 67, h = 41;
+    auto px = make_image(w, h, 4, 1);
+    for (Filter f : {Filter::None, Filter::Sub, Filter::Up, Filter::Average, Filter::Paeth,
+                     Filter::Adaptive}) {
+        Options opts;
+        opts.filter = f;
+        opts.threads = 1;
+        auto d = decode(encode(px, w, h, 4, opts), 4);
+        EXPECT_EQ(d.width, uint32_t(w));
+        EXPECT_EQ(d.height, uint32_t(h));
+        EXPECT_EQ(d.color_type, 6);
+        EXPECT_EQ(d.pixels, px) << "filter " << int(f);
+    }
+}
+
+TEST(Png, ChannelCounts) {
+    const uint8_t color_types[] = {0, 0, 4, 2, 6};
+    for (int channels = 1; channels <= 4; channels++) {
+        auto px = make_image(33, 20, channels, 2);
+        auto d = decode(encode(px, 33, 20, channels, {}), channels);
+        EXPECT_EQ(d.color_type, color_types[channels]);
+        EXPECT_EQ(d.pixels, px) << channels << " channels";
+    }
+}
+
+TEST(Png, ParallelChunksMatchSerial) {
+    const int w = 300, h = 257;
+    auto px = make_image(w, h, 4, 3);
+    Options serial;
+    serial.threads = 1;
+    serial.chunk_rows = 10;
+    std::string reference = encode(px, w, h, 4, serial);
+
+    for (int threads : {2, 3, 8}) {
+        for (int chunk_rows : {1, 10, 64, 1000}) {
+            Options opts;
+            opts.threads = threads;
+            opts.chunk_rows = chunk_rows;
+            std::string got = encode(px, w, h, 4, opts);
+            auto d = decode(got, 4);
+            EXPECT_EQ(d.pixels, px) << threads << " threads, " << chunk_rows << " rows";
+            EXPECT_EQ(d.idat_chunks, (h + std::min(chunk_rows, h) - 1) / std::min(chunk_rows, h));
+            if (chunk_rows == 10) {
+                EXPECT_EQ(got, reference) << "output depends on thread count";
+            }
+        }
+    }
+}
+
+TEST(Png, CompressionLevels) {
+    auto px = make_image(128, 128, 3, 4);
+    for (int level : {0, 1, 6, 9}) {
+        Options opts;
+        opts.level = level;
+        opts.threads = 2;
+        opts.chunk_rows = 16;
+        auto d = decode(encode(px, 128, 128, 3, opts), 3);
+        EXPECT_EQ(d.pixels, px) << "level " << level;
+    }
+}
+
+TEST(Png, WriterRowErrors) {
+    std::ostringstream out;
+    Writer w(out, 4, 2, 3);
+    std::vector<uint8_t> row(12, 0);
+    EXPECT_THROW(w.write_row({row.data(), 11}), std::runtime_error);
+    w.write_row(row);
+    EXPECT_THROW(w.finish(), std::runtime_error);
+    w.write_row(row);
+    EXPECT_THROW(w.write_row(row), std::runtime_error);
+    w.finish();
+    EXPECT_THROW(Writer(out, 0, 1, 4), std::invalid_argument);
+    EXPECT_THROW(Writer(out, 1, 1, 5), std::invalid_argument);
+}
+
+TEST(Png, ParseFilter) {
+    EXPECT_EQ(parse_filter("none"), Filter::None);
+    EXPECT_EQ(parse_filter("sub"), Filter::Sub);
+    EXPECT_EQ(parse_filter("up"), Filter::Up);
+    EXPECT_EQ(parse_filter("average"), Filter::Average);
+    EXPECT_EQ(parse_filter("paeth"), Filter::Paeth);
+    EXPECT_EQ(parse_filter("adaptive"), Filter::Adaptive);
+    EXPECT_THROW(parse_filter("fast"), std::invalid_argument);
+}
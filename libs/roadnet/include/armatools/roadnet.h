@@ -64,6 +64,10 @@ const std::unordered_map<RoadType, RoadProps>& oprw_road_props();
 // ExtractFromObjects extracts road polylines from OFP placed objects.
 std::vector<Polyline> extract_from_objects(const std::vector<wrp::ObjectRecord>& objects);
 
+// extract_from_objects variant reusing a model table built from the same objects.
+std::vector<Polyline> extract_from_objects(const std::vector<wrp::ObjectRecord>& objects,
+                                           const wrp::ModelTable& models);
+
 // ExtractFromRoadLinks extracts road polylines from OPRW v12+ RoadLinks.
 std::vector<Polyline> extract_from_road_links(const std::vector<std::vector<wrp::RoadLink>>& links);
 
@@ -1,10 +1,11 @@
 #include <armatools/roadnet.h>
+#include <armatools/parallel.h>
 
 #include <algorithm>
 #include <cmath>
-#include <map>
+#include <cstdint>
+#include <span>
 #include <unordered_map>
-#include <unordered_set>
 
 namespace armatools::roadnet {
 constexpr double kPi = 3.141592653589793238462643383279502884;
@@ -102,7 +103,7 @@ struct SegGeom {
 
 struct RoadSeg {
     int obj_idx = 0;
-    std::string model;
+    uint32_t model_id = 0;
     RoadType type;
     SegGeom geom;
     std::array<double, 2> center{};
@@ -114,7 +115,7 @@ struct RoadSeg {
 
 struct Intersection {
     int obj_idx = 0;
-    std::string model;
+    uint32_t model_id = 0;
     std::array<double, 2> center{};
     double elev = 0;
     std::array<double, 2> fwd_dir{};
@@ -125,15 +126,6 @@ struct Intersection {
 // Helpers
 // ---------------------------------------------------------------------------
 
-static std::string base_name(const std::string& model_name) {
-    std::string s = model_name;
-    for (auto& c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
-    auto pos = s.find_last_of("\\/");
-    if (pos != std::string::npos) s = s.substr(pos + 1);
-    if (s.size() > 4 && s.substr(s.size() - 4) == ".p3d") s.resize(s.size() - 4);
-    return s;
-}
-
 static std::array<double, 2> fwd_xz(const std::array<float, 12>& m) {
     double fx = static_cast<double>(m[6]);
     double fz = static_cast<double>(m[8]);
@@ -211,51 +203,77 @@ static bool parse_road_model(const std::string& base, RoadType& rt, SegGeom& geo
     return false;
 }
 
-static RoadSeg make_road_seg(int idx, const wrp::ObjectRecord& obj, const RoadType& rt, const SegGeom& geom) {
+// RoadModel is the classification of one distinct model, shared by all of
+// its placements.
+struct RoadModel {
+    enum class Kind { none, intersection, segment };
+    Kind kind = Kind::none;
+    bool is_xroad = false;
+    RoadType type;
+    SegGeom geom;
+};
+
+static RoadModel classify_model(const std::string& base) {
+    RoadModel m;
+
+    if (base.starts_with("kr_")) {
+        m.kind = RoadModel::Kind::intersection;
+        m.is_xroad = base.find('x') != std::string::npos;
+        return m;
+    }
+
+    if (base == "nam_okruzi" || base == "nam_dlazba") {
+        m.kind = RoadModel::Kind::intersection;
+        return m;
+    }
+
+    if (base == "most_stred30") {
+        m.kind = RoadModel::Kind::segment;
+        m.type = type_bridge;
+        m.geom = {SegShape::straight, 50, 25, 0, 0};
+        return m;
+    }
+
+    if (parse_road_model(base, m.type, m.geom)) m.kind = RoadModel::Kind::segment;
+    return m;
+}
+
+static RoadSeg make_road_seg(int idx, uint32_t model_id, const wrp::ObjectRecord& obj,
+                             const RoadType& rt, const SegGeom& geom) {
     auto fwd = fwd_xz(obj.transform);
     double cx = obj.position[0], cz = obj.position[2];
     return {
-        idx, obj.model_name, rt, geom,
+        idx, model_id, rt, geom,
         {cx, cz}, obj.position[1], fwd,
         {cx + geom.half * fwd[0], cz + geom.half * fwd[1]},
         {cx - geom.half * fwd[0], cz - geom.half * fwd[1]}
     };
 }
 
-static void classify_objects(const std::vector<wrp::ObjectRecord>& objects,
+static void classify_objects(const std::vector<wrp::ObjectRecord>& objects, const wrp::ModelTable& models,
                              std::vector<RoadSeg>& segs, std::vector<Intersection>& intxs) {
+    std::vector<RoadModel> classes;
+    classes.reserve(models.size());
+    for (const auto& e : models.entries()) classes.push_back(classify_model(e.base_name));
+
     for (size_t i = 0; i < objects.size(); i++) {
         auto& obj = objects[i];
-        std::string base = base_name(obj.model_name);
-
-        if (base.substr(0, 3) == "kr_") {
-            intxs.push_back({
-                static_cast<int>(i), obj.model_name,
-                {obj.position[0], obj.position[2]}, obj.position[1],
-                fwd_xz(obj.transform), base.find('x') != std::string::npos
-            });
-            continue;
-        }
+        uint32_t id = models.id(i);
+        const auto& rm = classes[id];
 
-        if (base == "nam_okruzi" || base == "nam_dlazba") {
+        switch (rm.kind) {
+        case RoadModel::Kind::intersection:
             intxs.push_back({
-                static_cast<int>(i), obj.model_name,
+                static_cast<int>(i), id,
                 {obj.position[0], obj.position[2]}, obj.position[1],
-                fwd_xz(obj.transform), false
+                fwd_xz(obj.transform), rm.is_xroad
             });
-            continue;
-        }
-
-        if (base == "most_stred30") {
-            SegGeom geom = {SegShape::straight, 50, 25, 0, 0};
-            segs.push_back(make_road_seg(static_cast<int>(i), obj, type_bridge, geom));
-            continue;
-        }
-
-        RoadType rt;
-        SegGeom geom;
-        if (parse_road_model(base, rt, geom)) {
-            segs.push_back(make_road_seg(static_cast<int>(i), obj, rt, geom));
+            break;
+        case RoadModel::Kind::segment:
+            segs.push_back(make_road_seg(static_cast<int>(i), id, obj, rm.type, rm.geom));
+            break;
+        case RoadModel::Kind::none:
+            break;
         }
     }
 }
@@ -268,6 +286,9 @@ static constexpr double seg_match_tol = 3.0;
 static constexpr double intx_match_tol = 10.0;
 static constexpr double cell_size = 10.0;
 
+// Networks with at least this many segments are traced on several threads.
+static constexpr size_t parallel_segs = 4096;
+
 struct Peer {
     int seg = -1;
     bool front = false;
@@ -278,9 +299,69 @@ struct Peer {
     bool is_intx() const { return intx >= 0 && seg < 0; }
 };
 
-static std::array<int, 2> hash_cell_key(const std::array<double, 2>& pos) {
-    return {static_cast<int>(std::floor(pos[0] / cell_size)),
-            static_cast<int>(std::floor(pos[1] / cell_size))};
+// CellIndex is a static spatial hash: items sorted by packed cell key, so
+// the 3x3 cells around a point are three contiguous ranges. Items of one
+// cell keep their insertion order; their positions are stored alongside.
+struct CellIndex {
+    std::vector<uint64_t> keys;
+    std::vector<int> items;
+    std::vector<std::array<double, 2>> positions;
+
+    static std::array<int, 2> cell(const std::array<double, 2>& pos) {
+        return {static_cast<int>(std::floor(pos[0] / cell_size)),
+                static_cast<int>(std::floor(pos[1] / cell_size))};
+    }
+
+    // pack orders keys by column, then row; the sign bit is flipped so
+    // negative cells sort first.
+    static uint64_t pack(int cx, int cz) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cx) ^ 0x80000000u) << 32) |
+               (static_cast<uint32_t>(cz) ^ 0x80000000u);
+    }
+
+    void build(const std::vector<std::array<double, 2>>& points) {
+        std::vector<std::pair<uint64_t, int>> entries(points.size());
+        for (size_t i = 0; i < points.size(); i++) {
+            auto c = cell(points[i]);
+            entries[i] = {pack(c[0], c[1]), static_cast<int>(i)};
+        }
+        std::sort(entries.begin(), entries.end());
+        keys.resize(entries.size());
+        items.resize(entries.size());
+        positions.resize(entries.size());
+        for (size_t i = 0; i < entries.size(); i++) {
+            keys[i] = entries[i].first;
+            items[i] = entries[i].second;
+            positions[i] = points[static_cast<size_t>(entries[i].second)];
+        }
+    }
+
+    // for_each_near calls fn(item, position) for every item in the 3x3
+    // cells around pos, column by column.
+    template <typename Fn>
+    void for_each_near(const std::array<double, 2>& pos, Fn&& fn) const {
+        auto c = cell(pos);
+        for (int dx = -1; dx <= 1; dx++) {
+            auto lo = std::lower_bound(keys.begin(), keys.end(), pack(c[0] + dx, c[1] - 1));
+            auto hi = std::upper_bound(lo, keys.end(), pack(c[0] + dx, c[1] + 1));
+            for (auto i = static_cast<size_t>(lo - keys.begin()); i < static_cast<size_t>(hi - keys.begin()); i++)
+                fn(items[i], positions[i]);
+        }
+    }
+};
+
+// parallel_ranges splits [0, n) into one contiguous range per thread and
+// calls fn(begin, end) for each; small inputs run on the calling thread.
+template <typename Fn>
+static void parallel_ranges(size_t n, const Fn& fn) {
+    size_t n_threads = 1;
+    if (n >= parallel_segs)
+        n_threads = std::min(binutil::worker_count(0), n / (parallel_segs / 4));
+    size_t per = (n + n_threads - 1) / n_threads;
+    binutil::parallel_for(n_threads, n_threads, [&](size_t t) {
+        size_t begin = std::min(t * per, n);
+        fn(begin, std::min(begin + per, n));
+    });
 }
 
 struct Network {
@@ -289,137 +370,112 @@ struct Network {
     std::vector<std::array<Peer, 2>> adj; // [back, front] per segment
 
     void build();
-    std::vector<Polyline> trace_all();
+    std::vector<Polyline> trace_all() const;
 
 private:
-    std::pair<int, int> find_chain_start(int seg_idx, std::vector<bool>& visited);
-    Polyline trace_from(int start_idx, int start_port, std::vector<bool>& visited);
+    // Traced is a polyline with the pass and segment index that started
+    // it, which give the order of a serial trace.
+    struct Traced {
+        int pass = 0;
+        int seg = 0;
+        Polyline pl;
+    };
+
+    std::pair<int, int> find_chain_start(int seg_idx, const std::vector<uint8_t>& visited) const;
+    Polyline trace_from(int start_idx, int start_port, std::vector<uint8_t>& visited) const;
+    void trace_component(std::span<const int> members, std::vector<uint8_t>& visited,
+                         std::vector<Traced>& out) const;
 };
 
 void Network::build() {
     adj.resize(segs.size());
 
-    struct EpEntry {
-        int seg_idx;
-        bool is_front;
-        std::array<double, 2> pos;
-    };
-
-    // Spatial hash for endpoints
-    std::map<std::array<int, 2>, std::vector<EpEntry>> hash;
-    std::vector<EpEntry> all_eps;
-
+    // Endpoint p is the back (even) or front (odd) port of segment p / 2.
+    std::vector<std::array<double, 2>> eps(segs.size() * 2);
     for (size_t i = 0; i < segs.size(); i++) {
-        for (bool is_front : {false, true}) {
-            auto& pos = is_front ? segs[i].front : segs[i].back;
-            EpEntry ep{static_cast<int>(i), is_front, pos};
-            all_eps.push_back(ep);
-            hash[hash_cell_key(pos)].push_back(ep);
-        }
+        eps[i * 2] = segs[i].back;
+        eps[i * 2 + 1] = segs[i].front;
     }
+    CellIndex ep_index;
+    ep_index.build(eps);
 
-    // Find best segment-segment matches
+    // Find best segment-segment matches. Endpoints are queried in cell
+    // order, which keeps the lookups local, and collected in index order.
     struct MatchCandidate {
-        EpEntry a, b;
-        double dist;
+        int a = -1, b = -1; // endpoints
+        double dist = 0;
     };
-    std::vector<MatchCandidate> candidates;
-
-    for (auto& ep : all_eps) {
-        auto ck = hash_cell_key(ep.pos);
-        double best_dist = seg_match_tol;
-        EpEntry best_peer{};
-        bool found = false;
-
-        for (int dx = -1; dx <= 1; dx++) {
-            for (int dz = -1; dz <= 1; dz++) {
-                auto nk = std::array<int, 2>{ck[0] + dx, ck[1] + dz};
-                auto it = hash.find(nk);
-                if (it == hash.end()) continue;
-                for (auto& other : it->second) {
-                    if (other.seg_idx == ep.seg_idx) continue;
-                    double d = dist2d(ep.pos, other.pos);
-                    if (d < best_dist) {
-                        best_dist = d;
-                        best_peer = other;
-                        found = true;
-                    }
+    std::vector<MatchCandidate> best(eps.size());
+    parallel_ranges(eps.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            int item = ep_index.items[i];
+            auto p = static_cast<size_t>(item);
+            const auto& pos = ep_index.positions[i];
+            double best_dist = seg_match_tol;
+            ep_index.for_each_near(pos, [&](int other, const std::array<double, 2>& other_pos) {
+                if (static_cast<size_t>(other) / 2 == p / 2) return;
+                double d = dist2d(pos, other_pos);
+                if (d < best_dist) {
+                    best_dist = d;
+                    best[p] = {item, other, d};
                 }
-            }
-        }
-        if (found) {
-            candidates.push_back({ep, best_peer, best_dist});
+            });
         }
-    }
-
-    std::sort(candidates.begin(), candidates.end(),
-              [](auto& a, auto& b) { return a.dist < b.dist; });
+    });
+    std::vector<MatchCandidate> candidates;
+    for (const auto& c : best)
+        if (c.b >= 0) candidates.push_back(c);
 
-    std::unordered_set<int64_t> matched;
-    auto port_key = [](int seg_idx, bool is_front) -> int64_t {
-        return static_cast<int64_t>(seg_idx) * 2 + (is_front ? 1 : 0);
-    };
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](auto& a, auto& b) { return a.dist < b.dist; });
 
+    std::vector<uint8_t> matched(eps.size(), 0);
     for (auto& c : candidates) {
-        int64_t ka = port_key(c.a.seg_idx, c.a.is_front);
-        int64_t kb = port_key(c.b.seg_idx, c.b.is_front);
-        if (matched.count(ka) || matched.count(kb)) continue;
-        matched.insert(ka);
-        matched.insert(kb);
-
-        size_t pa = c.a.is_front ? 1 : 0;
-        size_t pb = c.b.is_front ? 1 : 0;
-        adj[static_cast<size_t>(c.a.seg_idx)][pa] = {c.b.seg_idx, c.b.is_front, -1};
-        adj[static_cast<size_t>(c.b.seg_idx)][pb] = {c.a.seg_idx, c.a.is_front, -1};
+        auto ka = static_cast<size_t>(c.a), kb = static_cast<size_t>(c.b);
+        if (matched[ka] || matched[kb]) continue;
+        matched[ka] = matched[kb] = 1;
+        adj[ka / 2][ka % 2] = {c.b / 2, kb % 2 == 1, -1};
+        adj[kb / 2][kb % 2] = {c.a / 2, ka % 2 == 1, -1};
     }
 
     // Match unmatched endpoints to intersections
     if (!intxs.empty()) {
-        std::map<std::array<int, 2>, std::vector<int>> intx_hash;
-        for (size_t i = 0; i < intxs.size(); i++) {
-            intx_hash[hash_cell_key(intxs[i].center)].push_back(static_cast<int>(i));
-        }
-
-        for (size_t seg_idx = 0; seg_idx < segs.size(); seg_idx++) {
-            for (size_t port_idx = 0; port_idx < 2; port_idx++) {
-                if (adj[seg_idx][port_idx].connected()) continue;
-                auto& pos = (port_idx == 1) ? segs[seg_idx].front : segs[seg_idx].back;
-                auto ck = hash_cell_key(pos);
+        std::vector<std::array<double, 2>> centers(intxs.size());
+        for (size_t i = 0; i < intxs.size(); i++) centers[i] = intxs[i].center;
+        CellIndex intx_index;
+        intx_index.build(centers);
+
+        parallel_ranges(eps.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                auto p = static_cast<size_t>(ep_index.items[i]);
+                if (matched[p]) continue;
+                const auto& pos = ep_index.positions[i];
                 double best_dist = intx_match_tol;
                 int best_intx = -1;
-
-                for (int dx = -1; dx <= 1; dx++) {
-                    for (int dz = -1; dz <= 1; dz++) {
-                        auto nk = std::array<int, 2>{ck[0] + dx, ck[1] + dz};
-                        auto it = intx_hash.find(nk);
-                        if (it == intx_hash.end()) continue;
-                        for (int intx_idx : it->second) {
-                            double d = dist2d(pos, intxs[static_cast<size_t>(intx_idx)].center);
-                            if (d < best_dist) {
-                                best_dist = d;
-                                best_intx = intx_idx;
-                            }
-                        }
+                intx_index.for_each_near(pos, [&](int intx_idx, const std::array<double, 2>& center) {
+                    double d = dist2d(pos, center);
+                    if (d < best_dist) {
+                        best_dist = d;
+                        best_intx = intx_idx;
                     }
-                }
-                if (best_intx >= 0) {
-                    adj[seg_idx][port_idx] = {-1, false, best_intx};
-                }
+                });
+                if (best_intx >= 0) adj[p / 2][p % 2] = {-1, false, best_intx};
             }
-        }
+        });
     }
 }
 
-std::pair<int, int> Network::find_chain_start(int seg_idx, std::vector<bool>& visited) {
+// find_chain_start walks back from seg_idx to the start of its chain. With
+// at most one peer per port, the only segment a walk can revisit is the
+// one it started from.
+std::pair<int, int> Network::find_chain_start(int seg_idx, const std::vector<uint8_t>& visited) const {
     int cur = seg_idx;
     int entry_port = 0;
 
-    std::unordered_set<int> seen;
     for (;;) {
-        seen.insert(cur);
         auto& p = adj[static_cast<size_t>(cur)][static_cast<size_t>(entry_port)];
         if (!p.is_segment()) return {cur, entry_port};
-        if (seen.count(p.seg) || visited[static_cast<size_t>(p.seg)]) return {cur, entry_port};
+        if (p.seg == seg_idx || visited[static_cast<size_t>(p.seg)]) return {cur, entry_port};
 
         int next_cur = p.seg;
         int next_entry = p.front ? 0 : 1;
@@ -428,7 +484,7 @@ std::pair<int, int> Network::find_chain_start(int seg_idx, std::vector<bool>& vi
     }
 }
 
-Polyline Network::trace_from(int start_idx, int start_port, std::vector<bool>& visited) {
+Polyline Network::trace_from(int start_idx, int start_port, std::vector<uint8_t>& visited) const {
     auto& seg = segs[static_cast<size_t>(start_idx)];
     Polyline pl;
     pl.type = seg.type;
@@ -447,7 +503,7 @@ Polyline Network::trace_from(int start_idx, int start_port, std::vector<bool>& v
 
     for (;;) {
         auto& s = segs[static_cast<size_t>(cur)];
-        visited[static_cast<size_t>(cur)] = true;
+        visited[static_cast<size_t>(cur)] = 1;
         pl.seg_count++;
         pl.length += s.geom.length;
         pl.points.push_back(s.center);
@@ -482,31 +538,95 @@ Polyline Network::trace_from(int start_idx, int start_port, std::vector<bool>& v
     return pl;
 }
 
-std::vector<Polyline> Network::trace_all() {
-    std::vector<bool> visited(segs.size(), false);
-    std::vector<Polyline> polylines;
-
+// trace_component traces the segments of one component in index order.
+// Walks never leave a component, so components can be traced
+// concurrently on a shared visited array.
+void Network::trace_component(std::span<const int> members, std::vector<uint8_t>& visited,
+                              std::vector<Traced>& out) const {
     // First pass: start from dead ends and intersections
-    for (size_t i = 0; i < segs.size(); i++) {
-        if (visited[i]) continue;
-        auto [chain_start, start_port] = find_chain_start(static_cast<int>(i), visited);
+    for (int i : members) {
+        if (visited[static_cast<size_t>(i)]) continue;
+        auto [chain_start, start_port] = find_chain_start(i, visited);
         if (visited[static_cast<size_t>(chain_start)]) continue;
         auto pl = trace_from(chain_start, start_port, visited);
-        if (pl.seg_count > 0) polylines.push_back(std::move(pl));
+        if (pl.seg_count > 0) out.push_back({0, i, std::move(pl)});
     }
 
     // Second pass: loops
-    for (size_t i = 0; i < segs.size(); i++) {
-        if (visited[i]) continue;
-        auto pl = trace_from(static_cast<int>(i), 1, visited);
+    for (int i : members) {
+        if (visited[static_cast<size_t>(i)]) continue;
+        auto pl = trace_from(i, 1, visited);
         if (pl.seg_count > 0) {
             pl.start_kind = "loop";
             pl.end_kind = "loop";
             if (pl.points.size() > 1) pl.points.push_back(pl.points[0]);
-            polylines.push_back(std::move(pl));
+            out.push_back({1, i, std::move(pl)});
+        }
+    }
+}
+
+std::vector<Polyline> Network::trace_all() const {
+    // Label the components joined by segment-segment links; each component
+    // is a chain or a ring. Members are listed in index order.
+    const size_t n = segs.size();
+    std::vector<int> comp(n, -1);
+    std::vector<size_t> counts;
+    std::vector<int> stack;
+    for (size_t i = 0; i < n; i++) {
+        if (comp[i] >= 0) continue;
+        auto id = static_cast<int>(counts.size());
+        counts.push_back(0);
+        comp[i] = id;
+        stack.push_back(static_cast<int>(i));
+        while (!stack.empty()) {
+            auto cur = static_cast<size_t>(stack.back());
+            stack.pop_back();
+            counts.back()++;
+            for (const auto& p : adj[cur]) {
+                if (p.is_segment() && comp[static_cast<size_t>(p.seg)] < 0) {
+                    comp[static_cast<size_t>(p.seg)] = id;
+                    stack.push_back(p.seg);
+                }
+            }
         }
     }
+    std::vector<size_t> offsets(counts.size() + 1, 0);
+    for (size_t c = 0; c < counts.size(); c++) offsets[c + 1] = offsets[c] + counts[c];
+    std::vector<int> members(n);
+    std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < n; i++) members[fill[static_cast<size_t>(comp[i])]++] = static_cast<int>(i);
+
+    std::vector<uint8_t> visited(n, 0);
+    auto trace_range = [&](size_t c_begin, size_t c_end, std::vector<Traced>& out) {
+        std::span<const int> all(members);
+        for (size_t c = c_begin; c < c_end; c++)
+            trace_component(all.subspan(offsets[c], counts[c]), visited, out);
+    };
 
+    size_t n_threads = 1;
+    if (n >= parallel_segs)
+        n_threads = std::min(binutil::worker_count(0), counts.size());
+    // Threads take runs of whole components with about n / n_threads
+    // segments each.
+    std::vector<size_t> bounds(n_threads + 1, counts.size());
+    for (size_t t = 0; t < n_threads; t++)
+        bounds[t] = static_cast<size_t>(std::lower_bound(offsets.begin(), offsets.end() - 1, t * n / n_threads) -
+                                        offsets.begin());
+    std::vector<std::vector<Traced>> parts(n_threads);
+    binutil::parallel_for(n_threads, n_threads, [&](size_t t) { trace_range(bounds[t], bounds[t + 1], parts[t]); });
+
+    // Restore the order of a serial trace: all first-pass polylines by
+    // starting segment, then the loops.
+    std::vector<Traced> traced;
+    for (auto& part : parts)
+        traced.insert(traced.end(), std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()));
+    std::sort(traced.begin(), traced.end(), [](const Traced& a, const Traced& b) {
+        return a.pass != b.pass ? a.pass < b.pass : a.seg < b.seg;
+    });
+
+    std::vector<Polyline> polylines;
+    polylines.reserve(traced.size());
+    for (auto& t : traced) polylines.push_back(std::move(t.pl));
     return polylines;
 }
 
@@ -515,9 +635,14 @@ std::vector<Polyline> Network::trace_all() {
 // ---------------------------------------------------------------------------
 
 std::vector<Polyline> extract_from_objects(const std::vector<wrp::ObjectRecord>& objects) {
+    return extract_from_objects(objects, wrp::ModelTable::build(objects));
+}
+
+std::vector<Polyline> extract_from_objects(const std::vector<wrp::ObjectRecord>& objects,
+                                           const wrp::ModelTable& models) {
     std::vector<RoadSeg> segs;
     std::vector<Intersection> intxs;
-    classify_objects(objects, segs, intxs);
+    classify_objects(objects, models, segs, intxs);
 
     if (segs.empty()) return {};
 
@@ -0,0 +1,92 @@
+#include "armatools/roadnet.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace armatools::roadnet;
+using armatools::wrp::ObjectRecord;
+
+namespace {
+
+// piece places a road model at (x, z) facing along +Z (north) or -Z.
+ObjectRecord piece(const std::string& model, double x, double z, bool north = true) {
+    ObjectRecord o;
+    o.model_name = model;
+    o.position = {x, 0, z};
+    o.transform[8] = north ? 1.0f : -1.0f;
+    return o;
+}
+
+// chain lays n 12 m segments northwards from (x, z0).
+void chain(std::vector<ObjectRecord>& objs, const std::string& model, double x, double z0, int n) {
+    for (int i = 0; i < n; i++) objs.push_back(piece(model, x, z0 + 6 + 12 * i, i % 2 == 0));
+}
+
+} // namespace
+
+TEST(RoadNet, ChainBetweenDeadEnds) {
+    std::vector<ObjectRecord> objs;
+    chain(objs, "asf12.p3d", 0, 0, 5);
+    auto pls = extract_from_objects(objs);
+    ASSERT_EQ(pls.size(), 1u);
+    EXPECT_EQ(pls[0].type, type_asphalt);
+    EXPECT_EQ(pls[0].seg_count, 5);
+    EXPECT_EQ(pls[0].length, 60);
+    EXPECT_EQ(pls[0].start_kind, "dead_end");
+    EXPECT_EQ(pls[0].end_kind, "dead_end");
+    EXPECT_EQ(pls[0].points.size(), 7u);
+    EXPECT_EQ(pls[0].props.id, 1);
+}
+
+TEST(RoadNet, TypeChangeAndIntersection) {
+    std::vector<ObjectRecord> objs;
+    chain(objs, "asf12.p3d", 0, 0, 3);
+    chain(objs, "sil12.p3d", 0, 36, 2);
+    objs.push_back(piece("kr_t_asf_asf.p3d", 0, 66));
+    auto pls = extract_from_objects(objs);
+    ASSERT_EQ(pls.size(), 2u);
+    EXPECT_EQ(pls[0].type, type_asphalt);
+    EXPECT_EQ(pls[0].end_kind, "type_change");
+    EXPECT_EQ(pls[1].type, type_silnice);
+    EXPECT_EQ(pls[1].end_kind, "intersection");
+    EXPECT_EQ(pls[1].points.back()[1], 66);
+}
+
+TEST(RoadNet, Loop) {
+    // Four segments around a 12 m square, each facing along its side.
+    std::vector<ObjectRecord> objs;
+    objs.push_back(piece("asf12.p3d", 0, 6));
+    objs.push_back(piece("asf12.p3d", 12, 6, false));
+    auto east = piece("asf12.p3d", 6, 12);
+    east.transform[6] = 1.0f;
+    east.transform[8] = 0;
+    auto west = piece("asf12.p3d", 6, 0);
+    west.transform[6] = -1.0f;
+    west.transform[8] = 0;
+    objs.push_back(east);
+    objs.push_back(west);
+
+    // A ring has no chain start, so it is traced from the segment before
+    // the first one until it meets itself.
+    auto pls = extract_from_objects(objs);
+    ASSERT_EQ(pls.size(), 1u);
+    EXPECT_EQ(pls[0].end_kind, "loop");
+    EXPECT_EQ(pls[0].seg_count, 4);
+    EXPECT_EQ(pls[0].length, 48);
+}
+
+TEST(RoadNet, ManyChainsKeepObjectOrder) {
+    // 5000 segments: above the 4096 at which matching and tracing go
+    // parallel.
+    std::vector<ObjectRecord> objs;
+    for (int c = 0; c < 500; c++) chain(objs, c % 2 ? "sil12.p3d" : "ces12.p3d", c * 100.0, 0, 10);
+    auto pls = extract_from_objects(objs);
+    ASSERT_EQ(pls.size(), 500u);
+    for (size_t c = 0; c < pls.size(); c++) {
+        EXPECT_EQ(pls[c].seg_count, 10);
+        EXPECT_EQ(pls[c].points.front()[0], static_cast<double>(c) * 100);
+    }
+}
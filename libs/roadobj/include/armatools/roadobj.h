@@ -13,6 +13,9 @@ public:
     // classify returns the road type for a model, or nullopt if not a road.
     std::optional<std::string> classify(const std::string& model_name) const;
 
+    // classify_base is classify for a name already reduced by base_name.
+    std::optional<std::string> classify_base(const std::string& base) const;
+
     // is_road returns true if the model matches any road pattern.
     bool is_road(const std::string& model_name) const;
 
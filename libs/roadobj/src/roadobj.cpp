@@ -50,7 +50,10 @@ static bool is_road_suffix(const std::string& s) {
 }
 
 std::optional<std::string> RoadMap::classify(const std::string& model_name) const {
-    std::string base = base_name(model_name);
+    return classify_base(base_name(model_name));
+}
+
+std::optional<std::string> RoadMap::classify_base(const std::string& base) const {
     for (const auto& r : rules_) {
         if (r.match(base)) return r.road_type;
     }
@@ -0,0 +1,28 @@
+#include "armatools/roadobj.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace armatools::roadobj;
+
+TEST(RoadObj, ClassifyBaseMatchesClassify) {
+    auto m = default_map();
+    const std::vector<std::string> names = {
+        "data3d\\ASF10 25.p3d", "data3d\\asf6konec.p3d", "data3d\\sil25", "o\\cesta10 100.P3D",
+        "kr_t_asf_asf.p3d", "data3d\\nam_okruzi.p3d", "data3d\\kos25.p3d", "data3d\\asfaltka12.p3d",
+        "data3d\\asf.p3d", "data3d\\asfx25.p3d", "data3d\\silnice.p3d", "trees\\str_bk.p3d",
+        "asf25", "/roads/ces12.p3d", "",
+    };
+    for (const auto& name : names) {
+        EXPECT_EQ(m.classify_base(base_name(name)), m.classify(name)) << name;
+    }
+    EXPECT_EQ(m.classify_base("asf10 25"), "Road");
+    EXPECT_EQ(m.classify_base("sil25"), "MainRoad");
+    EXPECT_EQ(m.classify_base("cesta10 100"), "Track");
+    EXPECT_EQ(m.classify_base("kr_t_asf_asf"), "Road");
+    EXPECT_FALSE(m.classify_base("asfx25"));
+    // classify_base expects a reduced name; a full path does not match.
+    EXPECT_FALSE(m.classify_base("data3d\\asf25.p3d"));
+}
@@ -248,15 +248,14 @@ Material parse(const std::filesystem::path& path) {
     return parse_bytes(data);
 }
 
-Material parse_bytes(std::string_view data_view) {
-    std::string data(data_view);
-    std::istringstream ss(data, std::ios::binary);
-
+Material parse_bytes(std::string_view data) {
     config::Config cfg;
-    if (data.size() >= 4 && data[0] == '\0' && data[1] == 'r' && data[2] == 'a' && data[3] == 'P')
+    if (data.size() >= 4 && data[0] == '\0' && data[1] == 'r' && data[2] == 'a' && data[3] == 'P') {
+        std::istringstream ss(std::string(data), std::ios::binary);
         cfg = config::read(ss);
-    else
-        cfg = config::parse_text(ss);
+    } else {
+        cfg = config::parse_text(data);
+    }
 
     return parse(cfg);
 }
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
+#include <span>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <variant>
 #include <vector>
@@ -34,6 +38,17 @@ using AttrValue = std::variant<std::string, int64_t, double>;
 
 // --- Writer ---
 
+// Shape is one record for the bulk writers: polyline parts or polygon
+// rings, and attribute values in field order.
+struct Shape {
+    std::vector<std::vector<Point>> parts;
+    std::vector<AttrValue> attrs;
+};
+
+// Writer encodes records into in-memory .shp/.shx/.dbf buffers and writes
+// each file in large blocks. The bulk writers size every record up front
+// and encode large batches on several threads; the output is identical to
+// writing the shapes one by one.
 class Writer {
 public:
     ~Writer();
@@ -44,6 +59,8 @@ public:
                          const std::vector<AttrValue>& attrs);
     void write_polygon(const std::vector<std::vector<Point>>& rings,
                        const std::vector<AttrValue>& attrs);
+    void write_poly_lines(std::span<const Shape> shapes);
+    void write_polygons(std::span<const Shape> shapes);
     void close();
 
     static std::unique_ptr<Writer> create(const std::string& base_path,
@@ -57,6 +74,110 @@ private:
 
 // --- Reader ---
 
+struct File;
+
+// PartView is one part of a record, read in place from the .shp data.
+// Points are copied out on access since the file gives no alignment
+// guarantee.
+class PartView {
+public:
+    class iterator {
+    public:
+        using value_type = Point;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        Point operator*() const { Point pt; std::memcpy(&pt, p_, sizeof pt); return pt; }
+        iterator& operator++() { p_ += sizeof(Point); return *this; }
+        iterator operator++(int) { auto it = *this; ++*this; return it; }
+        bool operator==(const iterator&) const = default;
+
+    private:
+        friend class PartView;
+        explicit iterator(const uint8_t* p) : p_(p) {}
+        const uint8_t* p_ = nullptr;
+    };
+
+    PartView() = default;
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    Point operator[](size_t i) const { return *iterator(data_ + i * sizeof(Point)); }
+    iterator begin() const { return iterator(data_); }
+    iterator end() const { return iterator(data_ + size_ * sizeof(Point)); }
+
+private:
+    friend class RecordView;
+    PartView(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// RecordView is one record of a Reader. Only the header is decoded;
+// parts are views into the mapped file. Parts with invalid indices are
+// empty.
+class RecordView {
+public:
+    ShapeType type() const { return type_; }
+    const BBox& bbox() const { return bbox_; }
+    size_t part_count() const { return num_parts_; }
+    size_t point_count() const { return num_points_; }
+    PartView part(size_t i) const;
+
+private:
+    friend class Reader;
+    ShapeType type_{};
+    BBox bbox_;
+    const uint8_t* parts_ = nullptr;  // le32 start index per part
+    const uint8_t* points_ = nullptr; // 16 bytes per point
+    size_t num_parts_ = 0;
+    size_t num_points_ = 0;
+};
+
+// Reader memory-maps a Shapefile set (.shp, .shx, .dbf) and decodes
+// records on demand. Record offsets come from the .shx index, or from a
+// scan of the record headers when it is missing or inconsistent; the
+// .dbf is optional. Attribute values are read in place through the typed
+// accessors, which take a column index from field_index().
+class Reader {
+public:
+    ~Reader();
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    ShapeType type() const;
+    const BBox& bbox() const;
+    size_t size() const;
+    const std::vector<Field>& fields() const;
+
+    // field_index returns the column of a DBF field (case-insensitive), or
+    // -1 if there is none.
+    int field_index(std::string_view name) const;
+
+    // record decodes the header of record i. Throws std::runtime_error if
+    // the record is truncated.
+    RecordView record(size_t i) const;
+
+    // query returns the indices of the records whose bounding box
+    // intersects area, in file order. Geometry is not decoded.
+    std::vector<size_t> query(const BBox& area) const;
+
+    // text returns a field value with surrounding spaces trimmed, or "" for
+    // column -1 and records without a DBF row.
+    std::string_view text(size_t record, int column) const;
+
+    // integer and number parse a field value, returning fallback if it is
+    // empty or not a number.
+    int64_t integer(size_t record, int column, int64_t fallback = 0) const;
+    double number(size_t record, int column, double fallback = 0) const;
+
+    static std::unique_ptr<Reader> open(const std::string& base_path);
+private:
+    friend File open(const std::string& base_path);
+    Reader() = default;
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
 struct Record {
     ShapeType type{};
     BBox bbox;
@@ -74,7 +195,8 @@ struct File {
     std::vector<std::vector<std::array<double, 2>>> polylines() const;
 };
 
-// open reads an ESRI Shapefile set (.shp + .dbf).
+// open reads an ESRI Shapefile set (.shp + .dbf) into memory. Prefer
+// Reader for large files.
 File open(const std::string& base_path);
 
 // read_bbox reads just the bounding box from a .shp file header.
@@ -1,13 +1,19 @@
 #include "armatools/shp.h"
+#include "armatools/mapped_file.h"
+#include "armatools/parallel.h"
 
 #include <algorithm>
 #include <array>
+#include <cctype>
 #include <cfloat>
+#include <charconv>
 #include <cmath>
 #include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <format>
 #include <stdexcept>
+#include <string_view>
 
 namespace armatools::shp {
 
@@ -46,22 +52,51 @@ static void put_le_f64(uint8_t* dst, double v) {
     put_le64(dst, bits);
 }
 
-static void write_le32(std::ofstream& f, int32_t v) {
-    f.write(reinterpret_cast<const char*>(&v), 4);
-}
+// --- Writer implementation ---
+
+// Encoded bytes are buffered per file and written once this much is
+// pending.
+static constexpr size_t kFlushBytes = size_t{4} << 20;
+
+// Batches smaller than this are encoded on the calling thread.
+static constexpr size_t kParallelShapes = 4096;
 
-static void write_le_f64(std::ofstream& f, double v) {
-    f.write(reinterpret_cast<const char*>(&v), 8);
+static void merge_bbox(double* bbox, bool& init, const double* rec) {
+    if (!init) {
+        std::copy_n(rec, 4, bbox);
+        init = true;
+        return;
+    }
+    bbox[0] = std::min(bbox[0], rec[0]);
+    bbox[1] = std::min(bbox[1], rec[1]);
+    bbox[2] = std::max(bbox[2], rec[2]);
+    bbox[3] = std::max(bbox[3], rec[3]);
 }
 
-// --- Writer implementation ---
+// put_field writes s into a DBF field of width size, left-aligned and
+// space-padded. Numeric text wider than the field becomes asterisks.
+static void put_field(uint8_t* dst, std::string_view s, size_t size, bool numeric) {
+    if (numeric && s.size() > size) {
+        std::memset(dst, '*', size);
+        return;
+    }
+    size_t n = std::min(s.size(), size);
+    if (numeric) {
+        std::memset(dst, ' ', size - n);
+        std::memcpy(dst + size - n, s.data(), n);
+    } else {
+        std::memcpy(dst, s.data(), n);
+        std::memset(dst + n, ' ', size - n);
+    }
+}
 
 struct Writer::Impl {
     std::ofstream shp, shx, dbf;
+    std::vector<uint8_t> shp_buf, shx_buf, dbf_buf;
     std::vector<Field> fields;
     ShapeType shape_type;
     int rec_num = 0;
-    int shp_offset = 50; // header is 100 bytes = 50 16-bit words
+    uint64_t shp_offset = 50; // header is 100 bytes = 50 16-bit words
     double bbox[4] = {0, 0, 0, 0}; // xMin, yMin, xMax, yMax
     bool bbox_init = false;
 
@@ -80,7 +115,7 @@ struct Writer::Impl {
         f.write(reinterpret_cast<const char*>(hdr.data()), 100);
     }
 
-    void write_updated_header(std::ofstream& f, int file_len_words) {
+    void write_updated_header(std::ofstream& f, uint64_t file_len_words) {
         std::array<uint8_t, 100> hdr{};
         put_be32(hdr.data(), 9994);
         put_be32(hdr.data() + 24, static_cast<uint32_t>(file_len_words));
@@ -117,59 +152,65 @@ struct Writer::Impl {
         dbf.write(reinterpret_cast<const char*>(&term), 1);
     }
 
-    void write_dbf_record(const std::vector<AttrValue>& attrs) {
-        uint8_t del = 0x20;
-        dbf.write(reinterpret_cast<const char*>(&del), 1);
+    // encode_dbf_record writes one record_size() byte DBF record to dst.
+    // Values are formatted with std::to_chars exactly as std::format would.
+    void encode_dbf_record(uint8_t* dst, const std::vector<AttrValue>& attrs) const {
+        *dst++ = 0x20; // not deleted
 
+        // Fixed notation of a double can need ~310 digits plus decimals.
+        char tmp[640];
         for (size_t i = 0; i < fields.size(); i++) {
             const auto& f = fields[i];
-            std::string s;
+            const AttrValue* v = i < attrs.size() ? &attrs[i] : nullptr;
+            std::string_view s;
+            bool numeric = f.type == 'N' || f.type == 'F';
+
             if (f.type == 'C') {
-                std::string val;
-                if (i < attrs.size()) {
-                    if (auto* sv = std::get_if<std::string>(&attrs[i])) val = *sv;
-                    else if (auto* iv = std::get_if<int64_t>(&attrs[i])) val = std::to_string(*iv);
-                    else if (auto* dv = std::get_if<double>(&attrs[i])) val = std::format("{}", *dv);
-                }
-                s = val;
-                s.resize(f.size, ' ');
-            } else if (f.type == 'N') {
-                if (f.dec > 0) {
-                    double val = 0;
-                    if (i < attrs.size()) {
-                        if (auto* dv = std::get_if<double>(&attrs[i])) val = *dv;
-                        else if (auto* iv = std::get_if<int64_t>(&attrs[i])) val = static_cast<double>(*iv);
-                    }
-                    s = std::format("{:>{}.{}f}", val, f.size, f.dec);
-                } else {
-                    int64_t val = 0;
-                    if (i < attrs.size()) {
-                        if (auto* iv = std::get_if<int64_t>(&attrs[i])) val = *iv;
-                        else if (auto* dv = std::get_if<double>(&attrs[i])) val = static_cast<int64_t>(*dv);
+                if (v) {
+                    if (auto* sv = std::get_if<std::string>(v)) {
+                        s = *sv;
+                    } else if (auto* iv = std::get_if<int64_t>(v)) {
+                        auto r = std::to_chars(tmp, tmp + sizeof(tmp), *iv);
+                        s = {tmp, r.ptr};
+                    } else if (auto* dv = std::get_if<double>(v)) {
+                        auto r = std::to_chars(tmp, tmp + sizeof(tmp), *dv);
+                        s = {tmp, r.ptr};
                     }
-                    s = std::format("{:>{}d}", val, f.size);
                 }
-                if (s.size() > f.size)
-                    s = std::string(f.size, '*');
-            } else if (f.type == 'F') {
+            } else if (f.type == 'F' || (f.type == 'N' && f.dec > 0)) {
                 double val = 0;
-                if (i < attrs.size()) {
-                    if (auto* dv = std::get_if<double>(&attrs[i])) val = *dv;
-                    else if (auto* iv = std::get_if<int64_t>(&attrs[i])) val = static_cast<double>(*iv);
+                if (v) {
+                    if (auto* dv = std::get_if<double>(v)) val = *dv;
+                    else if (auto* iv = std::get_if<int64_t>(v)) val = static_cast<double>(*iv);
+                }
+                auto r = std::to_chars(tmp, tmp + sizeof(tmp), val, std::chars_format::fixed, f.dec);
+                s = {tmp, r.ptr};
+            } else if (f.type == 'N') {
+                int64_t val = 0;
+                if (v) {
+                    if (auto* iv = std::get_if<int64_t>(v)) val = *iv;
+                    else if (auto* dv = std::get_if<double>(v)) val = static_cast<int64_t>(*dv);
                 }
-                s = std::format("{:>{}.{}f}", val, f.size, f.dec);
-                if (s.size() > f.size)
-                    s = std::string(f.size, '*');
-            } else {
-                s.resize(f.size, ' ');
+                auto r = std::to_chars(tmp, tmp + sizeof(tmp), val);
+                s = {tmp, r.ptr};
             }
-            if (s.size() > f.size) s.resize(f.size);
-            dbf.write(s.data(), static_cast<std::streamsize>(s.size()));
+            put_field(dst, s, f.size, numeric);
+            dst += f.size;
         }
     }
 
-    void write_poly_shape(const std::vector<std::vector<Point>>& parts,
-                          const std::vector<AttrValue>& attrs) {
+    static size_t shp_record_bytes(const std::vector<std::vector<Point>>& parts) {
+        size_t points = 0;
+        for (const auto& part : parts) points += part.size();
+        return 8 + 4 + 32 + 4 + 4 + parts.size() * 4 + points * 16;
+    }
+
+    // encode_shape writes the .shp record, .shx entry and .dbf record of
+    // one shape and returns its bounding box in rec_bbox.
+    void encode_shape(uint8_t* shp_dst, uint8_t* shx_dst, uint8_t* dbf_dst,
+                      const std::vector<std::vector<Point>>& parts,
+                      const std::vector<AttrValue>& attrs,
+                      int number, uint64_t offset_words, double* rec_bbox) const {
         int total_points = 0;
         double x_min = DBL_MAX, y_min = DBL_MAX, x_max = -DBL_MAX, y_max = -DBL_MAX;
         for (const auto& part : parts) {
@@ -181,57 +222,115 @@ struct Writer::Impl {
                 if (p.y > y_max) y_max = p.y;
             }
         }
-
-        if (!bbox_init) {
-            bbox[0] = x_min; bbox[1] = y_min; bbox[2] = x_max; bbox[3] = y_max;
-            bbox_init = true;
-        } else {
-            if (x_min < bbox[0]) bbox[0] = x_min;
-            if (y_min < bbox[1]) bbox[1] = y_min;
-            if (x_max > bbox[2]) bbox[2] = x_max;
-            if (y_max > bbox[3]) bbox[3] = y_max;
-        }
+        rec_bbox[0] = x_min; rec_bbox[1] = y_min; rec_bbox[2] = x_max; rec_bbox[3] = y_max;
 
         int num_parts = static_cast<int>(parts.size());
         int content_bytes = 4 + 32 + 4 + 4 + num_parts * 4 + total_points * 16;
         int content_words = content_bytes / 2;
 
-        rec_num++;
-
         // SHX index entry (big-endian)
-        std::array<uint8_t, 8> shx_buf{};
-        put_be32(shx_buf.data(), static_cast<uint32_t>(shp_offset));
-        put_be32(shx_buf.data() + 4, static_cast<uint32_t>(content_words));
-        shx.write(reinterpret_cast<const char*>(shx_buf.data()), 8);
+        put_be32(shx_dst, static_cast<uint32_t>(offset_words));
+        put_be32(shx_dst + 4, static_cast<uint32_t>(content_words));
 
         // SHP record header (big-endian)
-        std::array<uint8_t, 8> rec_hdr{};
-        put_be32(rec_hdr.data(), static_cast<uint32_t>(rec_num));
-        put_be32(rec_hdr.data() + 4, static_cast<uint32_t>(content_words));
-        shp.write(reinterpret_cast<const char*>(rec_hdr.data()), 8);
-
-        // Shape type (little-endian)
-        write_le32(shp, static_cast<int32_t>(shape_type));
-        // Bounding box
-        write_le_f64(shp, x_min); write_le_f64(shp, y_min);
-        write_le_f64(shp, x_max); write_le_f64(shp, y_max);
-        // numParts, numPoints
-        write_le32(shp, num_parts); write_le32(shp, total_points);
+        put_be32(shp_dst, static_cast<uint32_t>(number));
+        put_be32(shp_dst + 4, static_cast<uint32_t>(content_words));
+        uint8_t* d = shp_dst + 8;
+        // Shape type, bounding box, numParts, numPoints (little-endian)
+        put_le32(d, static_cast<uint32_t>(shape_type));
+        put_le_f64(d + 4, x_min); put_le_f64(d + 12, y_min);
+        put_le_f64(d + 20, x_max); put_le_f64(d + 28, y_max);
+        put_le32(d + 36, static_cast<uint32_t>(num_parts));
+        put_le32(d + 40, static_cast<uint32_t>(total_points));
+        d += 44;
         // Part start indices
-        int32_t idx = 0;
+        uint32_t idx = 0;
         for (const auto& part : parts) {
-            write_le32(shp, idx);
-            idx += static_cast<int32_t>(part.size());
+            put_le32(d, idx);
+            d += 4;
+            idx += static_cast<uint32_t>(part.size());
         }
         // Points
-        for (const auto& part : parts)
-            for (const auto& p : part) {
-                write_le_f64(shp, p.x);
-                write_le_f64(shp, p.y);
+        for (const auto& part : parts) {
+            std::memcpy(d, part.data(), part.size() * sizeof(Point));
+            d += part.size() * sizeof(Point);
+        }
+
+        encode_dbf_record(dbf_dst, attrs);
+    }
+
+    void write_shape(const std::vector<std::vector<Point>>& parts,
+                     const std::vector<AttrValue>& attrs) {
+        size_t shp_bytes = shp_record_bytes(parts);
+        size_t dbf_bytes = static_cast<size_t>(record_size());
+        size_t shp_at = shp_buf.size(), shx_at = shx_buf.size(), dbf_at = dbf_buf.size();
+        shp_buf.resize(shp_at + shp_bytes);
+        shx_buf.resize(shx_at + 8);
+        dbf_buf.resize(dbf_at + dbf_bytes);
+
+        double rec_bbox[4];
+        encode_shape(shp_buf.data() + shp_at, shx_buf.data() + shx_at, dbf_buf.data() + dbf_at,
+                     parts, attrs, ++rec_num, shp_offset, rec_bbox);
+        merge_bbox(bbox, bbox_init, rec_bbox);
+        shp_offset += shp_bytes / 2;
+        flush(false);
+    }
+
+    // write_shapes encodes a batch into the buffers. Record sizes depend
+    // only on point counts, so every record's offsets are known before
+    // encoding and threads can fill disjoint ranges.
+    void write_shapes(std::span<const Shape> shapes) {
+        if (shapes.empty()) return;
+        size_t dbf_bytes = static_cast<size_t>(record_size());
+        std::vector<size_t> shp_at(shapes.size() + 1);
+        shp_at[0] = shp_buf.size();
+        for (size_t i = 0; i < shapes.size(); i++)
+            shp_at[i + 1] = shp_at[i] + shp_record_bytes(shapes[i].parts);
+        size_t shx_base = shx_buf.size(), dbf_base = dbf_buf.size();
+        shp_buf.resize(shp_at.back());
+        shx_buf.resize(shx_base + shapes.size() * 8);
+        dbf_buf.resize(dbf_base + shapes.size() * dbf_bytes);
+
+        int first_number = rec_num + 1;
+        uint64_t first_words = shp_offset - shp_at[0] / 2;
+        size_t n_threads = 1;
+        if (shapes.size() >= kParallelShapes)
+            n_threads = std::min(binutil::worker_count(0), shapes.size() / (kParallelShapes / 4));
+        struct Range { double bbox[4]; bool init = false; };
+        std::vector<Range> ranges(n_threads);
+        size_t per = (shapes.size() + n_threads - 1) / n_threads;
+        binutil::parallel_for(n_threads, n_threads, [&](size_t t) {
+            double* range_bbox = ranges[t].bbox;
+            bool& range_init = ranges[t].init;
+            size_t end = std::min((t + 1) * per, shapes.size());
+            for (size_t i = std::min(t * per, shapes.size()); i < end; i++) {
+                double rec_bbox[4];
+                encode_shape(shp_buf.data() + shp_at[i], shx_buf.data() + shx_base + i * 8,
+                             dbf_buf.data() + dbf_base + i * dbf_bytes,
+                             shapes[i].parts, shapes[i].attrs,
+                             first_number + static_cast<int>(i), first_words + shp_at[i] / 2,
+                             rec_bbox);
+                merge_bbox(range_bbox, range_init, rec_bbox);
             }
+        });
 
-        shp_offset += 4 + content_words;
-        write_dbf_record(attrs);
+        for (const auto& r : ranges)
+            if (r.init) merge_bbox(bbox, bbox_init, r.bbox);
+        rec_num += static_cast<int>(shapes.size());
+        shp_offset += (shp_at.back() - shp_at[0]) / 2;
+        flush(false);
+    }
+
+    void flush(bool all) {
+        auto drain = [all](std::ofstream& f, std::vector<uint8_t>& buf) {
+            if (buf.empty() || (!all && buf.size() < kFlushBytes)) return;
+            f.write(reinterpret_cast<const char*>(buf.data()), static_cast<std::streamsize>(buf.size()));
+            buf.clear();
+        };
+        drain(shp, shp_buf);
+        drain(shx, shx_buf);
+        drain(dbf, dbf_buf);
+        if (!shp || !shx || !dbf) throw std::runtime_error("shp: write failed");
     }
 };
 
@@ -273,26 +372,39 @@ void Writer::write_poly_line(const std::vector<std::vector<Point>>& parts,
                               const std::vector<AttrValue>& attrs) {
     if (impl_->shape_type != ShapeType::poly_line)
         throw std::runtime_error("shp: write_poly_line called on non-polyline writer");
-    impl_->write_poly_shape(parts, attrs);
+    impl_->write_shape(parts, attrs);
 }
 
 void Writer::write_polygon(const std::vector<std::vector<Point>>& rings,
                             const std::vector<AttrValue>& attrs) {
     if (impl_->shape_type != ShapeType::polygon)
         throw std::runtime_error("shp: write_polygon called on non-polygon writer");
-    impl_->write_poly_shape(rings, attrs);
+    impl_->write_shape(rings, attrs);
+}
+
+void Writer::write_poly_lines(std::span<const Shape> shapes) {
+    if (impl_->shape_type != ShapeType::poly_line)
+        throw std::runtime_error("shp: write_poly_lines called on non-polyline writer");
+    impl_->write_shapes(shapes);
+}
+
+void Writer::write_polygons(std::span<const Shape> shapes) {
+    if (impl_->shape_type != ShapeType::polygon)
+        throw std::runtime_error("shp: write_polygons called on non-polygon writer");
+    impl_->write_shapes(shapes);
 }
 
 void Writer::close() {
     if (!impl_) return;
     auto& impl = *impl_;
+    impl.flush(true);
 
     // Update SHP header
     impl.shp.seekp(0);
     impl.write_updated_header(impl.shp, impl.shp_offset);
 
     // Update SHX header
-    int shx_len = 50 + impl.rec_num * 4;
+    uint64_t shx_len = 50 + static_cast<uint64_t>(impl.rec_num) * 4;
     impl.shx.seekp(0);
     impl.write_updated_header(impl.shx, shx_len);
 
@@ -309,101 +421,129 @@ void Writer::close() {
 
 // --- Reader ---
 
-static Record parse_record(const uint8_t* data, size_t len) {
-    if (len < 4) throw std::runtime_error("shp: record too short");
-    auto st = static_cast<ShapeType>(get_le32(data));
-    if (st != ShapeType::poly_line && st != ShapeType::polygon)
-        return Record{st, {}, {}, {}};
-    if (len < 44) throw std::runtime_error("shp: poly record too short");
+static std::vector<uint8_t> read_file(const std::string& path) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) throw std::runtime_error(std::format("shp: cannot open {}", path));
+    auto size = f.tellg();
+    f.seekg(0);
+    std::vector<uint8_t> data(static_cast<size_t>(size));
+    f.read(reinterpret_cast<char*>(data.data()), size);
+    return data;
+}
 
-    Record rec;
-    rec.type = st;
-    rec.bbox.x_min = get_le_f64(data + 4);
-    rec.bbox.y_min = get_le_f64(data + 12);
-    rec.bbox.x_max = get_le_f64(data + 20);
-    rec.bbox.y_max = get_le_f64(data + 28);
-
-    int num_parts = static_cast<int>(get_le32(data + 36));
-    int num_points = static_cast<int>(get_le32(data + 40));
-
-    std::vector<int> part_starts(static_cast<size_t>(num_parts));
-    size_t offset = 44;
-    for (size_t i = 0; i < static_cast<size_t>(num_parts); i++) {
-        if (offset + 4 > len) throw std::runtime_error("shp: truncated part indices");
-        part_starts[i] = static_cast<int>(get_le32(data + offset));
-        offset += 4;
-    }
+// open_file maps path, or reads it into memory where mapping fails (empty
+// files, some network shares). Returns false if the file cannot be opened
+// at all.
+static bool open_file(binutil::MappedFile& file, const std::string& path) {
+    if (file.map(path)) return true;
+    if (!std::filesystem::exists(path)) return false;
+    file.adopt(read_file(path));
+    return true;
+}
 
-    std::vector<Point> all_points(static_cast<size_t>(num_points));
-    for (size_t i = 0; i < static_cast<size_t>(num_points); i++) {
-        if (offset + 16 > len) throw std::runtime_error("shp: truncated points");
-        all_points[i].x = get_le_f64(data + offset);
-        all_points[i].y = get_le_f64(data + offset + 8);
-        offset += 16;
-    }
+static bool is_poly(ShapeType st) {
+    return st == ShapeType::poly_line || st == ShapeType::polygon;
+}
 
-    rec.parts.resize(static_cast<size_t>(num_parts));
-    for (size_t i = 0; i < static_cast<size_t>(num_parts); i++) {
-        int start = part_starts[i];
-        int end = (i + 1 < static_cast<size_t>(num_parts)) ? part_starts[i + 1] : num_points;
-        if (start >= 0 && end <= num_points && start < end)
-            rec.parts[i].assign(all_points.begin() + start, all_points.begin() + end);
-    }
-    return rec;
+static BBox get_bbox(const uint8_t* p) {
+    return {get_le_f64(p), get_le_f64(p + 8), get_le_f64(p + 16), get_le_f64(p + 24)};
+}
+
+static bool ieq(std::string_view a, std::string_view b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) ==
+                      std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+PartView RecordView::part(size_t i) const {
+    if (i >= num_parts_) throw std::out_of_range("shp: part index out of range");
+    auto start = static_cast<int32_t>(get_le32(parts_ + i * 4));
+    auto end = i + 1 < num_parts_ ? static_cast<int32_t>(get_le32(parts_ + (i + 1) * 4))
+                                  : static_cast<int32_t>(num_points_);
+    if (start < 0 || end > static_cast<int32_t>(num_points_) || start >= end) return {};
+    return {points_ + static_cast<size_t>(start) * 16, static_cast<size_t>(end - start)};
 }
 
-static void parse_dbf(const std::vector<uint8_t>& data, std::vector<Field>& fields,
-                       std::vector<std::unordered_map<std::string, std::string>>& records) {
-    if (data.size() < 32) return;
-    int num_records = static_cast<int>(get_le32(data.data() + 4));
-    int header_size = get_le16(data.data() + 8);
-    int record_size = get_le16(data.data() + 10);
-
-    size_t pos = 32;
-    while (pos < static_cast<size_t>(header_size - 1) && pos + 32 <= data.size()) {
-        if (data[pos] == 0x0D) break;
-        std::string name(reinterpret_cast<const char*>(data.data() + pos), 11);
-        auto nul = name.find('\0');
-        if (nul != std::string::npos) name.resize(nul);
-        while (!name.empty() && name.back() == ' ') name.pop_back();
-        fields.push_back({name, static_cast<char>(data[pos + 11]),
-                          data[pos + 16], data[pos + 17]});
-        pos += 32;
+struct Reader::Impl {
+    binutil::MappedFile shp, shx, dbf;
+    ShapeType type{};
+    BBox bbox;
+
+    struct Span { size_t offset, size; }; // record content in shp
+    std::vector<Span> records;
+
+    std::vector<Field> fields;
+    std::vector<size_t> field_offsets; // leading fields that fit in a row, after the deletion flag
+    size_t dbf_header = 0;
+    size_t dbf_row = 0;
+    size_t dbf_rows = 0;
+
+    // index_from_shx fills records from the .shx index. Returns false if
+    // any entry falls outside the .shp, so the caller can rescan.
+    bool index_from_shx() {
+        if (shx.size() < 100 || get_be32(shx.data()) != 9994) return false;
+        size_t n = (shx.size() - 100) / 8;
+        records.reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            const uint8_t* e = shx.data() + 100 + i * 8;
+            size_t off = size_t{get_be32(e)} * 2;
+            size_t len = size_t{get_be32(e + 4)} * 2;
+            if (off < 100 || off + 8 + len > shp.size() ||
+                size_t{get_be32(shp.data() + off + 4)} * 2 != len) {
+                records.clear();
+                return false;
+            }
+            records.push_back({off + 8, len});
+        }
+        return true;
     }
 
-    pos = static_cast<size_t>(header_size);
-    for (int i = 0; i < num_records && pos + static_cast<size_t>(record_size) <= data.size(); i++) {
-        const uint8_t* rec_data = data.data() + pos + 1; // skip deletion flag
-        std::unordered_map<std::string, std::string> attrs;
-        int f_offset = 0;
-        for (const auto& f : fields) {
-            if (f_offset + f.size > record_size - 1) break;
-            std::string val(reinterpret_cast<const char*>(rec_data + f_offset), f.size);
-            // Trim spaces
-            auto start = val.find_first_not_of(' ');
-            auto end = val.find_last_not_of(' ');
-            if (start != std::string::npos)
-                attrs[f.name] = val.substr(start, end - start + 1);
-            else
-                attrs[f.name] = "";
-            f_offset += f.size;
+    // index_from_shp walks the record headers, stopping at the first
+    // truncated record.
+    void index_from_shp() {
+        size_t file_len = std::min(size_t{get_be32(shp.data() + 24)} * 2, shp.size());
+        size_t pos = 100;
+        while (pos + 8 <= file_len) {
+            size_t len = size_t{get_be32(shp.data() + pos + 4)} * 2;
+            pos += 8;
+            if (pos + len > shp.size()) break;
+            records.push_back({pos, len});
+            pos += len;
         }
-        records.push_back(std::move(attrs));
-        pos += static_cast<size_t>(record_size);
     }
-}
 
-static std::vector<uint8_t> read_file(const std::string& path) {
-    std::ifstream f(path, std::ios::binary | std::ios::ate);
-    if (!f) throw std::runtime_error(std::format("shp: cannot open {}", path));
-    auto size = f.tellg();
-    f.seekg(0);
-    std::vector<uint8_t> data(static_cast<size_t>(size));
-    f.read(reinterpret_cast<char*>(data.data()), size);
-    return data;
-}
+    void parse_dbf_header() {
+        if (dbf.size() < 32) return;
+        dbf_rows = get_le32(dbf.data() + 4);
+        dbf_header = get_le16(dbf.data() + 8);
+        dbf_row = get_le16(dbf.data() + 10);
+
+        size_t pos = 32;
+        while (pos + 1 < dbf_header && pos + 32 <= dbf.size()) {
+            if (dbf.data()[pos] == 0x0D) break;
+            const char* raw = reinterpret_cast<const char*>(dbf.data() + pos);
+            std::string name(raw, strnlen(raw, 11));
+            while (!name.empty() && name.back() == ' ') name.pop_back();
+            fields.push_back({name, static_cast<char>(dbf.data()[pos + 11]),
+                              dbf.data()[pos + 16], dbf.data()[pos + 17]});
+            pos += 32;
+        }
 
-File open(const std::string& base_path) {
+        size_t offset = 0;
+        for (const auto& f : fields) {
+            if (offset + f.size + 1 > dbf_row) break;
+            field_offsets.push_back(offset);
+            offset += f.size;
+        }
+
+        if (dbf_header > dbf.size()) dbf_rows = 0;
+        else if (dbf_row > 0) dbf_rows = std::min(dbf_rows, (dbf.size() - dbf_header) / dbf_row);
+    }
+};
+
+std::unique_ptr<Reader> Reader::open(const std::string& base_path) {
     std::string base = base_path;
     for (const auto& ext : {".shp", ".shx", ".dbf", ".SHP", ".SHX", ".DBF"}) {
         if (base.size() > 4 && base.substr(base.size() - 4) == std::string(ext).substr(0, 4)) {
@@ -412,47 +552,137 @@ File open(const std::string& base_path) {
         }
     }
 
-    auto shp_data = read_file(base + ".shp");
-    if (shp_data.size() < 100)
-        throw std::runtime_error(std::format("shp: file too short ({} bytes)", shp_data.size()));
+    std::unique_ptr<Reader> r(new Reader());
+    r->impl_ = std::make_unique<Impl>();
+    auto& im = *r->impl_;
 
-    uint32_t file_code = get_be32(shp_data.data());
+    if (!open_file(im.shp, base + ".shp"))
+        throw std::runtime_error(std::format("shp: cannot open {}.shp", base));
+    if (im.shp.size() < 100)
+        throw std::runtime_error(std::format("shp: file too short ({} bytes)", im.shp.size()));
+    uint32_t file_code = get_be32(im.shp.data());
     if (file_code != 9994)
         throw std::runtime_error(std::format("shp: bad file code {}", file_code));
 
-    int file_len = static_cast<int>(get_be32(shp_data.data() + 24)) * 2;
-    auto shape_type = static_cast<ShapeType>(get_le32(shp_data.data() + 32));
+    im.type = static_cast<ShapeType>(get_le32(im.shp.data() + 32));
+    im.bbox = get_bbox(im.shp.data() + 36);
 
-    File result;
-    result.type = shape_type;
-    result.bbox.x_min = get_le_f64(shp_data.data() + 36);
-    result.bbox.y_min = get_le_f64(shp_data.data() + 44);
-    result.bbox.x_max = get_le_f64(shp_data.data() + 52);
-    result.bbox.y_max = get_le_f64(shp_data.data() + 60);
-
-    // Parse records
-    int pos = 100;
-    while (pos < file_len && pos < static_cast<int>(shp_data.size())) {
-        if (pos + 8 > static_cast<int>(shp_data.size())) break;
-        int content_len = static_cast<int>(get_be32(shp_data.data() + pos + 4)) * 2;
-        pos += 8;
-        if (pos + content_len > static_cast<int>(shp_data.size())) break;
-        result.records.push_back(parse_record(shp_data.data() + pos,
-                                              static_cast<size_t>(content_len)));
-        pos += content_len;
-    }
+    if (!open_file(im.shx, base + ".shx") || !im.index_from_shx()) im.index_from_shp();
+    im.shx.reset();
 
-    // Parse DBF
+    // DBF is optional
     try {
-        auto dbf_data = read_file(base + ".dbf");
-        std::vector<std::unordered_map<std::string, std::string>> dbf_records;
-        parse_dbf(dbf_data, result.fields, dbf_records);
-        for (size_t i = 0; i < result.records.size() && i < dbf_records.size(); i++)
-            result.records[i].attrs = std::move(dbf_records[i]);
+        if (open_file(im.dbf, base + ".dbf")) im.parse_dbf_header();
     } catch (...) {
-        // DBF is optional
+    }
+    return r;
+}
+
+Reader::~Reader() = default;
+
+ShapeType Reader::type() const { return impl_->type; }
+const BBox& Reader::bbox() const { return impl_->bbox; }
+size_t Reader::size() const { return impl_->records.size(); }
+const std::vector<Field>& Reader::fields() const { return impl_->fields; }
+
+int Reader::field_index(std::string_view name) const {
+    for (size_t i = 0; i < impl_->fields.size(); i++)
+        if (ieq(impl_->fields[i].name, name)) return static_cast<int>(i);
+    return -1;
+}
+
+RecordView Reader::record(size_t i) const {
+    if (i >= impl_->records.size()) throw std::out_of_range("shp: record index out of range");
+    auto [offset, len] = impl_->records[i];
+    const uint8_t* data = impl_->shp.data() + offset;
+    if (len < 4) throw std::runtime_error("shp: record too short");
+
+    RecordView rec;
+    rec.type_ = static_cast<ShapeType>(get_le32(data));
+    if (!is_poly(rec.type_)) return rec;
+    if (len < 44) throw std::runtime_error("shp: poly record too short");
+
+    rec.bbox_ = get_bbox(data + 4);
+    size_t num_parts = get_le32(data + 36);
+    size_t num_points = get_le32(data + 40);
+    if (num_parts > (len - 44) / 4) throw std::runtime_error("shp: truncated part indices");
+    if (num_points > (len - 44 - num_parts * 4) / 16) throw std::runtime_error("shp: truncated points");
+    rec.num_parts_ = num_parts;
+    rec.num_points_ = num_points;
+    rec.parts_ = data + 44;
+    rec.points_ = rec.parts_ + num_parts * 4;
+    return rec;
+}
+
+std::vector<size_t> Reader::query(const BBox& area) const {
+    std::vector<size_t> result;
+    const uint8_t* base = impl_->shp.data();
+    for (size_t i = 0; i < impl_->records.size(); i++) {
+        auto [offset, len] = impl_->records[i];
+        if (len < 36 || !is_poly(static_cast<ShapeType>(get_le32(base + offset)))) continue;
+        BBox b = get_bbox(base + offset + 4);
+        if (b.x_min <= area.x_max && b.x_max >= area.x_min &&
+            b.y_min <= area.y_max && b.y_max >= area.y_min)
+            result.push_back(i);
+    }
+    return result;
+}
+
+std::string_view Reader::text(size_t record, int column) const {
+    const auto& im = *impl_;
+    if (column < 0 || static_cast<size_t>(column) >= im.field_offsets.size() || record >= im.dbf_rows) return {};
+    auto col = static_cast<size_t>(column);
+    const char* p = reinterpret_cast<const char*>(im.dbf.data() + im.dbf_header + record * im.dbf_row + 1 +
+                                                  im.field_offsets[col]);
+    std::string_view v(p, im.fields[col].size);
+    auto start = v.find_first_not_of(' ');
+    if (start == std::string_view::npos) return {};
+    return v.substr(start, v.find_last_not_of(' ') - start + 1);
+}
+
+int64_t Reader::integer(size_t record, int column, int64_t fallback) const {
+    auto v = text(record, column);
+    if (!v.empty() && v.front() == '+') v.remove_prefix(1);
+    int64_t out = 0;
+    auto [ptr, ec] = std::from_chars(v.data(), v.data() + v.size(), out);
+    return ec == std::errc() ? out : fallback;
+}
+
+double Reader::number(size_t record, int column, double fallback) const {
+    auto v = text(record, column);
+    if (!v.empty() && v.front() == '+') v.remove_prefix(1);
+    double out = 0;
+    auto [ptr, ec] = std::from_chars(v.data(), v.data() + v.size(), out);
+    return ec == std::errc() ? out : fallback;
+}
+
+File open(const std::string& base_path) {
+    auto r = Reader::open(base_path);
+
+    File result;
+    result.type = r->type();
+    result.bbox = r->bbox();
+    result.fields = r->fields();
+    result.records.resize(r->size());
+    for (size_t i = 0; i < r->size(); i++) {
+        auto view = r->record(i);
+        auto& rec = result.records[i];
+        rec.type = view.type();
+        rec.bbox = view.bbox();
+        rec.parts.resize(view.part_count());
+        for (size_t j = 0; j < view.part_count(); j++) {
+            auto part = view.part(j);
+            rec.parts[j].assign(part.begin(), part.end());
+        }
     }
 
+    // Records without a DBF row keep an empty attribute map.
+    for (size_t i = 0; i < result.records.size(); i++) {
+        if (i >= r->impl_->dbf_rows) break;
+        auto& attrs = result.records[i].attrs;
+        for (size_t f = 0; f < r->impl_->field_offsets.size(); f++)
+            attrs[result.fields[f].name] = std::string(r->text(i, static_cast<int>(f)));
+    }
     return result;
 }
 
@@ -0,0 +1,156 @@
+#include "armatools/shp.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace armatools::shp;
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string slurp(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    std::ostringstream s;
+    s << f.rdbuf();
+    return s.str();
+}
+
+std::string temp_base(const std::string& name) {
+    return (fs::temp_directory_path() / ("armatools_shp_test_" + name)).string();
+}
+
+const std::vector<Field> road_fields = {
+    {"ID", 'N', 4, 0}, {"TYPE", 'C', 8, 0}, {"WIDTH", 'N', 6, 1}, {"LENGTH", 'F', 10, 2},
+};
+
+std::vector<Shape> sample_roads(size_t n) {
+    std::vector<Shape> shapes(n);
+    for (size_t i = 0; i < n; i++) {
+        double x = static_cast<double>(i);
+        shapes[i].parts = {{{x, 0}, {x + 1, 2}, {x + 3, -1}}};
+        if (i % 3 == 0) shapes[i].parts.push_back({{x, 5}, {x, 6}});
+        shapes[i].attrs = {static_cast<int64_t>(i), std::string(i % 2 ? "main" : "track_road"),
+                           6.5, 12345678.9};
+    }
+    return shapes;
+}
+
+} // namespace
+
+TEST(Shp, BulkWriteMatchesSingleRecords) {
+    // Large enough to take the parallel path.
+    auto shapes = sample_roads(10000);
+    auto one = temp_base("one");
+    auto bulk = temp_base("bulk");
+    {
+        auto w = Writer::create(one, ShapeType::poly_line, road_fields);
+        for (const auto& s : shapes) w->write_poly_line(s.parts, s.attrs);
+        w->close();
+    }
+    {
+        auto w = Writer::create(bulk, ShapeType::poly_line, road_fields);
+        w->write_poly_line(shapes[0].parts, shapes[0].attrs);
+        w->write_poly_lines(std::span<const Shape>(shapes).subspan(1));
+        w->close();
+    }
+    for (const char* ext : {".shp", ".shx", ".dbf"})
+        EXPECT_EQ(slurp(one + ext), slurp(bulk + ext)) << ext;
+
+    for (const auto& base : {one, bulk})
+        for (const char* ext : {".shp", ".shx", ".dbf", ".cpg"}) fs::remove(base + ext);
+}
+
+TEST(Shp, RoundTrip) {
+    auto shapes = sample_roads(5);
+    auto base = temp_base("roundtrip");
+    {
+        auto w = Writer::create(base, ShapeType::poly_line, road_fields);
+        w->write_poly_lines(shapes);
+    }
+
+    auto f = open(base);
+    ASSERT_EQ(f.records.size(), 5u);
+    EXPECT_EQ(f.bbox.x_min, 0);
+    EXPECT_EQ(f.bbox.x_max, 7);
+    EXPECT_EQ(f.bbox.y_min, -1);
+    EXPECT_EQ(f.bbox.y_max, 6);
+    ASSERT_EQ(f.records[3].parts.size(), 2u);
+    EXPECT_EQ(f.records[3].parts[1][1].y, 6);
+    EXPECT_EQ(f.records[1].attrs.at("TYPE"), "main");
+    EXPECT_EQ(f.records[0].attrs.at("TYPE"), "track_ro"); // truncated to the field width
+    EXPECT_EQ(attr_int(f.records[4].attrs, "ID"), 4);
+    EXPECT_EQ(f.records[2].attrs.at("WIDTH"), "6.5");
+    EXPECT_EQ(f.records[2].attrs.at("LENGTH"), "**********"); // wider than the field
+
+    for (const char* ext : {".shp", ".shx", ".dbf", ".cpg"}) fs::remove(base + ext);
+}
+
+TEST(Shp, ReaderQueryAndColumns) {
+    auto shapes = sample_roads(10);
+    auto base = temp_base("reader");
+    {
+        auto w = Writer::create(base, ShapeType::poly_line, road_fields);
+        w->write_poly_lines(shapes);
+    }
+
+    auto r = Reader::open(base + ".shp");
+    ASSERT_EQ(r->size(), 10u);
+    EXPECT_EQ(r->type(), ShapeType::poly_line);
+    EXPECT_EQ(r->field_index("width"), 2);
+    EXPECT_EQ(r->field_index("MISSING"), -1);
+
+    // Records span x in [i, i + 3].
+    auto hits = r->query({5.5, 0, 6.5, 1});
+    EXPECT_EQ(hits, (std::vector<size_t>{3, 4, 5, 6}));
+
+    auto rec = r->record(3);
+    ASSERT_EQ(rec.part_count(), 2u);
+    auto part = rec.part(0);
+    ASSERT_EQ(part.size(), 3u);
+    EXPECT_EQ(part[2].x, 6);
+    EXPECT_EQ(part[2].y, -1);
+    std::vector<Point> pts(part.begin(), part.end());
+    EXPECT_EQ(pts[1].x, 4);
+
+    int id = r->field_index("ID");
+    int width = r->field_index("WIDTH");
+    int type = r->field_index("TYPE");
+    int length = r->field_index("LENGTH");
+    EXPECT_EQ(r->integer(7, id), 7);
+    EXPECT_EQ(r->number(7, width), 6.5);
+    EXPECT_EQ(r->text(7, type), "main");
+    EXPECT_EQ(r->number(7, length, -1), -1); // "**********"
+    EXPECT_EQ(r->text(7, -1), "");
+
+    auto f = open(base);
+    for (size_t i = 0; i < f.records.size(); i++) {
+        EXPECT_EQ(f.records[i].attrs.at("TYPE"), r->text(i, type));
+        EXPECT_EQ(f.records[i].parts.size(), r->record(i).part_count());
+    }
+
+    for (const char* ext : {".shp", ".shx", ".dbf", ".cpg"}) fs::remove(base + ext);
+}
+
+TEST(Shp, ReaderWithoutIndex) {
+    auto shapes = sample_roads(4);
+    auto base = temp_base("noindex");
+    {
+        auto w = Writer::create(base, ShapeType::poly_line, road_fields);
+        w->write_poly_lines(shapes);
+    }
+    fs::remove(base + ".shx");
+    fs::remove(base + ".dbf");
+
+    auto r = Reader::open(base);
+    ASSERT_EQ(r->size(), 4u);
+    EXPECT_TRUE(r->fields().empty());
+    EXPECT_EQ(r->record(3).part(1)[1].y, 6);
+    EXPECT_EQ(r->integer(0, r->field_index("ID"), 42), 42);
+
+    for (const char* ext : {".shp", ".cpg"}) fs::remove(base + ext);
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <istream>
 #include <string>
@@ -123,6 +124,18 @@ struct StatsInfo {
     bool has_cell_flags = false;
 };
 
+// Byte offsets of the sections needed to patch objects in place, recorded
+// while parsing OPRW. Offsets are -1 when unknown (other formats or a
+// non-seekable stream). Every object record stores its model index as an
+// int32 at byte 4.
+struct LayoutInfo {
+    long long models_offset = -1;  // model count followed by asciiz names
+    long long models_end = -1;
+    long long objects_offset = -1; // first object record
+    long long objects_size = 0;    // record bytes, excluding the legacy end sentinel
+    int object_record_size = 0;
+};
+
 struct Options { bool strict = false; bool no_objects = false; bool no_mapinfo = false; bool debug = false; };
 
 struct WorldData {
@@ -130,6 +143,7 @@ struct WorldData {
     GridInfo grid;
     BoundsInfo bounds;
     StatsInfo stats;
+    LayoutInfo layout;
     std::vector<Warning> warnings;
 
     std::vector<TextureEntry> textures;
@@ -151,9 +165,44 @@ struct WorldData {
     std::vector<MapInfoEntry> map_info_entries;
 };
 
+// ModelEntry is one distinct model of an object list.
+struct ModelEntry {
+    std::string name;      // as stored in ObjectRecord::model_name
+    std::string base_name; // lowercase file name without directory and ".p3d"
+    uint32_t object_count = 0;
+};
+
+// ModelTable interns the model names of an object list, so per-model work
+// (name parsing, classification, replacement lookups) runs once per distinct
+// model and is then looked up per object by a dense id.
+class ModelTable {
+public:
+    // build interns the model names of objects in first-seen order.
+    static ModelTable build(const std::vector<ObjectRecord>& objects);
+
+    size_t size() const { return entries_.size(); }
+    const ModelEntry& operator[](uint32_t id) const { return entries_[id]; }
+    const std::vector<ModelEntry>& entries() const { return entries_; }
+
+    // id returns the model id of objects[object_index] of the list passed to build.
+    uint32_t id(size_t object_index) const { return ids_[object_index]; }
+    const std::vector<uint32_t>& ids() const { return ids_; }
+
+private:
+    std::vector<ModelEntry> entries_;
+    std::vector<uint32_t> ids_;
+};
+
 // read auto-detects format and parses a WRP file.
 WorldData read(std::istream& r, Options opts = {});
 
+// read_quad_tree_into decodes one serialized OPRW quadtree over a size_x x
+// size_y grid of elem_size-byte elements (1, 2 or 4) into out, row-major,
+// and leaves r just past the tree. skip_quad_tree steps over one tree
+// without decoding its leaves.
+void read_quad_tree_into(std::istream& r, int size_x, int size_y, int elem_size, uint8_t* out);
+void skip_quad_tree(std::istream& r);
+
 // extract_position_rotation extracts position, rotation, and scale from a 4x3 transform matrix.
 void extract_position_rotation(const std::array<float, 12>& m,
                                 std::array<double, 3>& pos, Rotation& rot, double& scale);
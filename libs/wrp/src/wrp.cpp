@@ -5,6 +5,7 @@
 #include <armatools/lzo.h>
 
 #include <algorithm>
+#include <bit>
 #include <cctype>
 #include <cmath>
 #include <cstdint>
@@ -16,6 +17,8 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace armatools::wrp {
@@ -34,8 +37,8 @@ static WorldData read_1wvr(std::istream& r, Options opts);
 static WorldData read_oprw_legacy(std::istream& r, int ver, Options opts);
 static WorldData read_oprw_modern(std::istream& r, int version, Options opts);
 
-static std::vector<uint8_t> read_quad_tree(std::istream& r, int size_x, int size_y, int elem_size);
-static void skip_quad_tree(std::istream& r);
+template <typename T>
+static std::vector<T> read_quad_tree(std::istream& r, int size_x, int size_y);
 
 static void read_1wvr_nets(std::istream& r, WorldData& w);
 
@@ -346,6 +349,58 @@ void extract_position_rotation(const std::array<float, 12>& m_in,
     rot.roll  = rad_to_deg(z_rad);
 }
 
+// ---------------------------------------------------------------------------
+// ModelTable
+// ---------------------------------------------------------------------------
+
+static std::string model_base_name(const std::string& model_name) {
+    auto pos = model_name.find_last_of("\\/");
+    std::string s = pos == std::string::npos ? model_name : model_name.substr(pos + 1);
+    for (auto& c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    if (s.size() > 4 && s.compare(s.size() - 4, 4, ".p3d") == 0) s.resize(s.size() - 4);
+    return s;
+}
+
+ModelTable ModelTable::build(const std::vector<ObjectRecord>& objects) {
+    constexpr uint32_t no_id = std::numeric_limits<uint32_t>::max();
+    // model_index bounds the slot table; anything larger is hashed instead.
+    constexpr size_t max_index_slots = size_t(1) << 20;
+
+    ModelTable t;
+    t.ids_.resize(objects.size());
+
+    // model_index is normally a dense key already, so it is tried first. The
+    // name check keeps stale or colliding indexes correct; those fall back
+    // to the name hash, which is keyed on views into objects.
+    std::vector<uint32_t> by_index;
+    std::unordered_map<std::string_view, uint32_t> by_name;
+
+    for (size_t i = 0; i < objects.size(); i++) {
+        const auto& obj = objects[i];
+        const size_t slot = static_cast<size_t>(obj.model_index);
+        const bool indexed = obj.model_index >= 0 && slot < max_index_slots;
+
+        uint32_t id = no_id;
+        if (indexed && slot < by_index.size()) {
+            uint32_t cand = by_index[slot];
+            if (cand != no_id && t.entries_[cand].name == obj.model_name) id = cand;
+        }
+        if (id == no_id) {
+            auto [it, inserted] = by_name.try_emplace(obj.model_name, static_cast<uint32_t>(t.entries_.size()));
+            if (inserted) t.entries_.push_back({obj.model_name, model_base_name(obj.model_name), 0});
+            id = it->second;
+            if (indexed) {
+                if (slot >= by_index.size()) by_index.resize(slot + 1, no_id);
+                if (by_index[slot] == no_id) by_index[slot] = id;
+            }
+        }
+
+        t.ids_[i] = id;
+        t.entries_[id].object_count++;
+    }
+    return t;
+}
+
 // ---------------------------------------------------------------------------
 // read (top-level dispatcher)
 // ---------------------------------------------------------------------------
@@ -468,15 +523,20 @@ static WorldData read_oprw_legacy(std::istream& r, int ver, Options opts) {
 
     // 8. nModels + Model[n]
     {
+        w.layout.models_offset = stream_offset(r);
         uint32_t n_models = read_u32(r);
         w.models.resize(n_models);
         for (uint32_t i = 0; i < n_models; i++) {
             w.models[i] = read_asciiz(r);
         }
         w.stats.model_count = static_cast<int>(n_models);
+        w.layout.models_end = stream_offset(r);
     }
 
     // 9. Objects (terminated by 0xFFFFFFFF sentinel)
+    w.layout.objects_offset = stream_offset(r);
+    w.layout.object_record_size = 56;
+    long long n_records = 0;
     if (!opts.no_objects) {
         for (;;) {
             uint32_t obj_id = read_u32(r);
@@ -503,14 +563,17 @@ static WorldData read_oprw_legacy(std::istream& r, int ver, Options opts) {
             extract_position_rotation(transform, pos, rot, scale);
 
             w.objects.push_back({obj_id, mi, model_name, transform, pos, rot, scale});
+            n_records++;
         }
     } else {
         for (;;) {
             uint32_t obj_id = read_u32(r);
             if (obj_id == 0xFFFFFFFF) break;
             read_bytes(r, 52); // model_idx(4) + transform(48)
+            n_records++;
         }
     }
+    w.layout.objects_size = n_records * w.layout.object_record_size;
 
     w.stats.object_count = static_cast<int>(w.objects.size());
 
@@ -522,6 +585,12 @@ static WorldData read_oprw_legacy(std::istream& r, int ver, Options opts) {
 // ---------------------------------------------------------------------------
 // QuadTree
 // ---------------------------------------------------------------------------
+//
+// Serialized layout: a root flag byte followed by either a single 4-byte leaf
+// (flag 0) or a node. A node is a u16 child mask and 16 entries in row-major
+// 4x4 order; set bits are nested nodes, clear bits are 4-byte leaves. A leaf
+// packs a small tile of elements (1x1 u32, 2x1 u16 or 2x2 u8) that repeats
+// across the whole area it covers.
 
 static int ceil_log2(int n) {
     if (n <= 1) return 0;
@@ -551,66 +620,138 @@ static std::pair<int, int> calculate_log_dimensions(int size_x, int size_y,
     return {log_total_x, log_total_y};
 }
 
-static void fill_leaf(std::vector<uint8_t>& buf, int stride,
-                       int x0, int y0, int w, int h,
-                       const uint8_t* leaf, int elem_size,
-                       int leaf_log_x, int leaf_log_y)
-{
-    int leaf_w = 1 << leaf_log_x;
-    int leaf_h = 1 << leaf_log_y;
-
-    for (int dy = 0; dy < h; dy++) {
-        for (int dx = 0; dx < w; dx++) {
-            int lx = dx % leaf_w;
-            int ly = dy % leaf_h;
-
-            const uint8_t* elem_data;
-            switch (elem_size) {
-            case 4:
-                elem_data = leaf;
-                break;
-            case 2:
-                elem_data = leaf + lx * 2;
-                break;
-            case 1:
-            default:
-                elem_data = leaf + (ly * leaf_w + lx);
-                break;
-            }
+// QuadTreeBlob pulls the serialized tree from the stream in a few large
+// chunks instead of one istream read per flag and leaf. The format has no
+// length prefix, so chunks grow geometrically (capped by the size of a full
+// tree) and finish() seeks the stream back over whatever was over-read.
+class QuadTreeBlob {
+public:
+    QuadTreeBlob(std::istream& r, size_t max_size) : r_(r), remaining_(max_size) {}
+
+    const uint8_t* take(size_t n) {
+        if (buf_.size() - pos_ < n) refill(n);
+        const uint8_t* p = buf_.data() + pos_;
+        pos_ += n;
+        return p;
+    }
 
-            size_t dst_off = static_cast<size_t>((y0 + dy) * stride + (x0 + dx)) * static_cast<size_t>(elem_size);
-            std::memcpy(&buf[dst_off], elem_data, static_cast<size_t>(elem_size));
-        }
+    void skip(size_t n) { take(n); }
+
+    uint8_t u8() { return *take(1); }
+
+    uint16_t u16() {
+        uint16_t v;
+        std::memcpy(&v, take(2), 2);
+        return v;
     }
-}
 
-static void read_quad_tree_node(std::istream& r, std::vector<uint8_t>& buf, int stride,
-                                 int x0, int y0, int w, int h,
-                                 int elem_size, int leaf_log_x, int leaf_log_y)
-{
-    uint16_t flag_mask = read_u16(r);
+    void finish() {
+        size_t unused = buf_.size() - pos_;
+        r_.clear();
+        if (unused == 0) return;
+        r_.seekg(-static_cast<std::streamoff>(unused), std::ios::cur);
+        if (!r_) throw std::runtime_error("quadtree: failed to rewind stream after read-ahead");
+        buf_.resize(pos_);
+    }
 
-    int child_w = w / 4;
-    int child_h = h / 4;
+private:
+    static constexpr size_t kInitialChunk = 64 * 1024;
+    static constexpr size_t kMaxChunk = 8 * 1024 * 1024;
 
-    for (int i = 0; i < 16; i++) {
-        int cx = x0 + (i % 4) * child_w;
-        int cy = y0 + (i / 4) * child_h;
+    void refill(size_t need) {
+        size_t have = buf_.size() - pos_;
+        if (pos_ > 0) {
+            std::memmove(buf_.data(), buf_.data() + pos_, have);
+            buf_.resize(have);
+            pos_ = 0;
+        }
+        size_t want = std::max(need - have, std::max(kInitialChunk, chunk_));
+        want = std::min(want, remaining_);
+        chunk_ = std::min(std::max(kInitialChunk, chunk_) * 2, kMaxChunk);
+
+        buf_.resize(have + want);
+        size_t got = 0;
+        if (want > 0 && !eof_) {
+            r_.read(reinterpret_cast<char*>(buf_.data() + have), static_cast<std::streamsize>(want));
+            got = static_cast<size_t>(r_.gcount());
+            if (got < want) eof_ = true;
+        }
+        buf_.resize(have + got);
+        remaining_ -= got;
+        if (buf_.size() < need) throw std::runtime_error("quadtree: unexpected end of data");
+    }
 
-        if (flag_mask & (1 << i)) {
-            // Subtree node
-            read_quad_tree_node(r, buf, stride, cx, cy, child_w, child_h,
-                                elem_size, leaf_log_x, leaf_log_y);
-        } else {
-            // Leaf: 4 bytes
-            auto leaf_data = read_bytes(r, 4);
-            fill_leaf(buf, stride, cx, cy, child_w, child_h,
-                      leaf_data.data(), elem_size, leaf_log_x, leaf_log_y);
+    std::istream& r_;
+    std::vector<uint8_t> buf_;
+    size_t pos_ = 0;
+    size_t remaining_;
+    size_t chunk_ = 0;
+    bool eof_ = false;
+};
+
+// Size in bytes of a fully populated tree with the given number of node levels;
+// an upper bound on any serialized tree over the same grid.
+static size_t quad_tree_max_bytes(int levels) {
+    size_t nodes = 0;
+    size_t level_nodes = 1;
+    for (int i = 0; i < levels; i++) {
+        nodes += level_nodes;
+        level_nodes *= 16;
+    }
+    return 1 + nodes * 2 + level_nodes * 4;
+}
+
+// Writes one leaf over the w x h block at (x0, y0), clipped to the real
+// size_x x size_y grid. Block origins are multiples of the leaf tile width,
+// so every block row is the leaf's row pattern (ly = row % leaf_h) repeated;
+// rows are built once per leaf row and copied down the block.
+static void fill_leaf(uint8_t* out, int size_x, int size_y,
+                      int x0, int y0, int w, int h,
+                      const uint8_t* leaf, int elem_size,
+                      int leaf_log_x, int leaf_log_y)
+{
+    int x1 = std::min(x0 + w, size_x);
+    int y1 = std::min(y0 + h, size_y);
+    if (x0 >= x1 || y0 >= y1) return;
+
+    const size_t es = static_cast<size_t>(elem_size);
+    const size_t stride = static_cast<size_t>(size_x) * es;
+    const size_t row_bytes = static_cast<size_t>(x1 - x0) * es;
+    const size_t pattern_bytes = (size_t{1} << leaf_log_x) * es;
+    const int leaf_h = 1 << leaf_log_y;
+
+    uint8_t* block = out + static_cast<size_t>(y0) * stride + static_cast<size_t>(x0) * es;
+    int pattern_rows = std::min(leaf_h, y1 - y0);
+    for (int ly = 0; ly < pattern_rows; ly++) {
+        const uint8_t* pattern = leaf + static_cast<size_t>(ly) * pattern_bytes;
+        uint8_t* row = block + static_cast<size_t>(ly) * stride;
+        if (std::all_of(pattern + 1, pattern + pattern_bytes,
+                        [&](uint8_t b) { return b == pattern[0]; })) {
+            std::memset(row, pattern[0], row_bytes);
+            continue;
         }
+        size_t filled = std::min(pattern_bytes, row_bytes);
+        std::memcpy(row, pattern, filled);
+        while (filled < row_bytes) {
+            size_t n = std::min(filled, row_bytes - filled);
+            std::memcpy(row + filled, row, n);
+            filled += n;
+        }
+    }
+    for (int dy = pattern_rows; dy < y1 - y0; dy++) {
+        std::memcpy(block + static_cast<size_t>(dy) * stride,
+                    block + static_cast<size_t>(dy % leaf_h) * stride, row_bytes);
     }
 }
 
-static std::vector<uint8_t> read_quad_tree(std::istream& r, int size_x, int size_y, int elem_size) {
+struct QuadTreeFrame {
+    int x0, y0;
+    int child_w, child_h;
+    uint16_t mask;
+    int next;
+};
+
+void read_quad_tree_into(std::istream& r, int size_x, int size_y, int elem_size, uint8_t* out) {
     if (elem_size != 1 && elem_size != 2 && elem_size != 4) {
         throw std::runtime_error(
             std::format("quadtree: invalid elem_size {} (must be 1, 2, or 4)", elem_size));
@@ -630,56 +771,89 @@ static std::vector<uint8_t> read_quad_tree(std::istream& r, int size_x, int size
 
     int total_x = 1 << log_total_x;
     int total_y = 1 << log_total_y;
+    int levels = (log_total_x - leaf_log_x) / log_branch;
+    size_x = std::max(size_x, 0);
+    size_y = std::max(size_y, 0);
 
-    std::vector<uint8_t> virtual_buf(
-        static_cast<size_t>(total_x) * static_cast<size_t>(total_y) * static_cast<size_t>(elem_size), 0);
+    QuadTreeBlob blob(r, quad_tree_max_bytes(levels));
 
-    // Read root flag
-    uint8_t flag = read_u8(r);
-
-    if (flag == 0) {
+    if (blob.u8() == 0) {
         // Single leaf covers entire grid
-        auto leaf_data = read_bytes(r, 4);
-        fill_leaf(virtual_buf, total_x, 0, 0, total_x, total_y,
-                  leaf_data.data(), elem_size, leaf_log_x, leaf_log_y);
-    } else {
-        read_quad_tree_node(r, virtual_buf, total_x, 0, 0, total_x, total_y,
-                            elem_size, leaf_log_x, leaf_log_y);
+        fill_leaf(out, size_x, size_y, 0, 0, total_x, total_y,
+                  blob.take(4), elem_size, leaf_log_x, leaf_log_y);
+        blob.finish();
+        return;
     }
 
-    // Extract actual grid from virtual grid
-    if (total_x == size_x && total_y == size_y) {
-        return virtual_buf;
-    }
+    std::vector<QuadTreeFrame> stack;
+    stack.reserve(static_cast<size_t>(levels) + 1);
+    stack.push_back({0, 0, total_x / 4, total_y / 4, blob.u16(), 0});
 
-    std::vector<uint8_t> out(static_cast<size_t>(size_x) * static_cast<size_t>(size_y) * static_cast<size_t>(elem_size));
-    for (int y = 0; y < size_y; y++) {
-        size_t src_off = static_cast<size_t>(y) * static_cast<size_t>(total_x) * static_cast<size_t>(elem_size);
-        size_t dst_off = static_cast<size_t>(y) * static_cast<size_t>(size_x) * static_cast<size_t>(elem_size);
-        std::memcpy(&out[dst_off], &virtual_buf[src_off],
-                     static_cast<size_t>(size_x) * static_cast<size_t>(elem_size));
-    }
-    return out;
-}
-
-static void skip_quad_tree_node(std::istream& r) {
-    uint16_t flag_mask = read_u16(r);
-    for (int i = 0; i < 16; i++) {
-        if (flag_mask & (1 << i)) {
-            skip_quad_tree_node(r);
+    while (!stack.empty()) {
+        QuadTreeFrame& f = stack.back();
+        if (f.next == 16) {
+            stack.pop_back();
+            continue;
+        }
+        int i = f.next++;
+        int cx = f.x0 + (i % 4) * f.child_w;
+        int cy = f.y0 + (i / 4) * f.child_h;
+        int cw = f.child_w;
+        int ch = f.child_h;
+
+        if (f.mask & (1 << i)) {
+            stack.push_back({cx, cy, cw / 4, ch / 4, blob.u16(), 0});
         } else {
-            read_bytes(r, 4);
+            fill_leaf(out, size_x, size_y, cx, cy, cw, ch,
+                      blob.take(4), elem_size, leaf_log_x, leaf_log_y);
         }
     }
+
+    blob.finish();
 }
 
-static void skip_quad_tree(std::istream& r) {
-    uint8_t flag = read_u8(r);
-    if (flag == 0) {
-        read_bytes(r, 4);
+template <typename T>
+static std::vector<T> read_quad_tree(std::istream& r, int size_x, int size_y) {
+    std::vector<T> out(static_cast<size_t>(std::max(size_x, 0)) *
+                       static_cast<size_t>(std::max(size_y, 0)));
+    read_quad_tree_into(r, size_x, size_y, static_cast<int>(sizeof(T)),
+                        reinterpret_cast<uint8_t*>(out.data()));
+    return out;
+}
+
+// skip_quad_tree walks only the child masks and steps over each run of
+// sibling leaves in one jump; leaf bytes are never decoded.
+void skip_quad_tree(std::istream& r) {
+    QuadTreeBlob blob(r, std::numeric_limits<size_t>::max());
+
+    if (blob.u8() == 0) {
+        blob.skip(4);
+        blob.finish();
         return;
     }
-    skip_quad_tree_node(r);
+
+    struct Frame { uint16_t mask; int next; };
+    std::vector<Frame> stack;
+    stack.push_back({blob.u16(), 0});
+
+    while (!stack.empty()) {
+        Frame& f = stack.back();
+        if (f.next == 16) {
+            stack.pop_back();
+            continue;
+        }
+        unsigned rest = static_cast<unsigned>(f.mask) >> f.next;
+        int leaves = std::min(rest == 0 ? 16 : std::countr_zero(rest), 16 - f.next);
+        if (leaves > 0) {
+            blob.skip(static_cast<size_t>(leaves) * 4);
+            f.next += leaves;
+            continue;
+        }
+        f.next++;
+        stack.push_back({blob.u16(), 0});
+    }
+
+    blob.finish();
 }
 
 // ---------------------------------------------------------------------------
@@ -762,9 +936,7 @@ struct OprwModernParser {
         // 3. Geography QuadTree (int16, elemSize=2)
         {
             debug_log(opts, std::format("Geography quadtree at offset {}", stream_offset(r)));
-            auto geo_data = read_quad_tree(r, land_range_x, land_range_y, 2);
-            auto s = make_stream(geo_data);
-            auto geo_flags = read_u16_slice(s, static_cast<size_t>(land_cells));
+            auto geo_flags = read_quad_tree<uint16_t>(r, land_range_x, land_range_y);
             w.cell_bit_flags.resize(static_cast<size_t>(land_cells));
             for (size_t i = 0; i < static_cast<size_t>(land_cells); i++) {
                 w.cell_bit_flags[i] = static_cast<uint32_t>(geo_flags[i]);
@@ -776,7 +948,7 @@ struct OprwModernParser {
 
         // 4. SoundMap QuadTree (byte, elemSize=1)
         debug_log(opts, std::format("SoundMap quadtree at offset {}", stream_offset(r)));
-        w.cell_env_sounds = read_quad_tree(r, land_range_x, land_range_y, 1);
+        w.cell_env_sounds = read_quad_tree<uint8_t>(r, land_range_x, land_range_y);
 
         // 5. Mountains: count(int32) + Vector3P[]
         {
@@ -795,9 +967,7 @@ struct OprwModernParser {
         // 6. Materials QuadTree (uint16, elemSize=2)
         {
             debug_log(opts, std::format("Materials quadtree at offset {}", stream_offset(r)));
-            auto mat_data = read_quad_tree(r, land_range_x, land_range_y, 2);
-            auto s = make_stream(mat_data);
-            w.cell_texture_indexes = read_u16_slice(s, static_cast<size_t>(land_cells));
+            w.cell_texture_indexes = read_quad_tree<uint16_t>(r, land_range_x, land_range_y);
         }
 
         // 7. Random (v<21): compressed (LandRange*2 bytes)
@@ -864,6 +1034,7 @@ struct OprwModernParser {
         // 12. Models: count(int32) + asciiz[]
         {
             debug_log(opts, std::format("Models at offset {}", stream_offset(r)));
+            w.layout.models_offset = stream_offset(r);
             int32_t n_models = read_i32(r);
             debug_log(opts, std::format("Models count {}", n_models));
             w.models.resize(static_cast<size_t>(n_models));
@@ -871,6 +1042,7 @@ struct OprwModernParser {
                 w.models[i] = read_asciiz(r);
             }
             w.stats.model_count = static_cast<int>(n_models);
+            w.layout.models_end = stream_offset(r);
         }
 
         // 13. ClassedModels (v>=15)
@@ -945,6 +1117,9 @@ struct OprwModernParser {
         // 23. Objects: 60-byte records (SizeOfObjects/60 entries)
         debug_log(opts, std::format("Objects at offset {}", stream_offset(r)));
         int n_objects = static_cast<int>(size_of_objects) / 60;
+        w.layout.objects_offset = stream_offset(r);
+        w.layout.objects_size = static_cast<long long>(n_objects) * 60;
+        w.layout.object_record_size = 60;
         if (!opts.no_objects) {
             w.objects.reserve(static_cast<size_t>(n_objects));
             for (int i = 0; i < n_objects; i++) {
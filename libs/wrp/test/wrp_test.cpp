@@ -0,0 +1,257 @@
+#include "armatools/wrp.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace armatools::wrp;
+
+namespace {
+
+// Leaf tile of a quadtree over elem_size-byte elements: 2x2 u8, 2x1 u16 or
+// 1x1 u32.
+struct LeafShape {
+    int w, h;
+};
+
+LeafShape leaf_shape(int elem_size) {
+    if (elem_size == 1) return {2, 2};
+    if (elem_size == 2) return {2, 1};
+    return {1, 1};
+}
+
+// Node levels of a tree covering size_x x size_y: each level splits 4x4.
+int tree_levels(int size_x, int size_y, int elem_size) {
+    auto leaf = leaf_shape(elem_size);
+    int levels = 0;
+    int64_t w = leaf.w, h = leaf.h;
+    while (w < size_x || h < size_y) {
+        w *= 4;
+        h *= 4;
+        levels++;
+    }
+    return levels;
+}
+
+// Random serialized tree: a node at depth d nests with probability nest
+// while d + 1 < levels. Leaves are random bytes.
+void gen_node(std::string& out, std::mt19937& rng, int depth, int levels, double nest) {
+    std::bernoulli_distribution nested(nest);
+    uint16_t mask = 0;
+    if (depth + 1 < levels)
+        for (int i = 0; i < 16; i++)
+            if (nested(rng)) mask = static_cast<uint16_t>(mask | (1u << i));
+    out.append(reinterpret_cast<const char*>(&mask), 2);
+    for (int i = 0; i < 16; i++) {
+        if (mask & (1u << i)) {
+            gen_node(out, rng, depth + 1, levels, nest);
+        } else {
+            for (int b = 0; b < 4; b++) out.push_back(static_cast<char>(rng()));
+        }
+    }
+}
+
+std::string gen_tree(std::mt19937& rng, int levels, double nest) {
+    std::string out;
+    if (levels == 0 || nest == 0) {
+        out.push_back('\0');
+        for (int b = 0; b < 4; b++) out.push_back(static_cast<char>(rng()));
+        return out;
+    }
+    out.push_back('\1');
+    gen_node(out, rng, 0, levels, nest);
+    return out;
+}
+
+// Reference decoder: walks the tree recursively and sets every element of a
+// block one at a time, clipping to the grid.
+struct Reference {
+    const std::string& data;
+    size_t pos = 0;
+    int size_x, size_y, elem_size;
+    std::vector<uint8_t> out;
+
+    Reference(const std::string& d, int sx, int sy, int es)
+        : data(d), size_x(sx), size_y(sy), elem_size(es),
+          out(static_cast<size_t>(sx) * static_cast<size_t>(sy) * static_cast<size_t>(es)) {}
+
+    void leaf(int x0, int y0, int w, int h) {
+        auto shape = leaf_shape(elem_size);
+        const char* bytes = data.data() + pos;
+        pos += 4;
+        for (int y = y0; y < y0 + h && y < size_y; y++) {
+            for (int x = x0; x < x0 + w && x < size_x; x++) {
+                int e = (y % shape.h) * shape.w + (x % shape.w);
+                std::memcpy(&out[(static_cast<size_t>(y) * static_cast<size_t>(size_x) + static_cast<size_t>(x)) *
+                                 static_cast<size_t>(elem_size)],
+                            bytes + e * elem_size, static_cast<size_t>(elem_size));
+            }
+        }
+    }
+
+    void node(int x0, int y0, int w, int h) {
+        uint16_t mask;
+        std::memcpy(&mask, data.data() + pos, 2);
+        pos += 2;
+        for (int i = 0; i < 16; i++) {
+            int cx = x0 + (i % 4) * (w / 4);
+            int cy = y0 + (i / 4) * (h / 4);
+            if (mask & (1u << i)) node(cx, cy, w / 4, h / 4);
+            else leaf(cx, cy, w / 4, h / 4);
+        }
+    }
+
+    void run() {
+        auto shape = leaf_shape(elem_size);
+        int levels = tree_levels(size_x, size_y, elem_size);
+        int w = shape.w << (2 * levels);
+        int h = shape.h << (2 * levels);
+        if (data[pos++] == 0) leaf(0, 0, w, h);
+        else node(0, 0, w, h);
+    }
+};
+
+// Decodes tree (followed by a trailer) with read_quad_tree_into and
+// skip_quad_tree and checks the grid and where each leaves the stream.
+void check_tree(const std::string& tree, int size_x, int size_y, int elem_size, const std::string& what) {
+    Reference ref(tree, size_x, size_y, elem_size);
+    ref.run();
+    ASSERT_EQ(ref.pos, tree.size()) << what;
+
+    const std::string trailer = "TAIL";
+    std::istringstream in(tree + trailer);
+    std::vector<uint8_t> grid(ref.out.size(), 0xCD);
+    read_quad_tree_into(in, size_x, size_y, elem_size, grid.data());
+    EXPECT_EQ(grid, ref.out) << what;
+    EXPECT_EQ(static_cast<size_t>(in.tellg()), tree.size()) << what;
+    char tail[4];
+    ASSERT_TRUE(in.read(tail, 4)) << what;
+    EXPECT_EQ(std::string(tail, 4), trailer) << what;
+
+    std::istringstream skip_in(tree + trailer);
+    skip_quad_tree(skip_in);
+    EXPECT_EQ(static_cast<size_t>(skip_in.tellg()), tree.size()) << what;
+}
+
+} // namespace
+
+TEST(QuadTree, UniformTreesFillTheGrid) {
+    std::mt19937 rng(1);
+    for (int es : {1, 2, 4}) {
+        for (auto [sx, sy] : {std::pair{1, 1}, std::pair{7, 5}, std::pair{64, 64}, std::pair{1, 300}}) {
+            auto tree = gen_tree(rng, tree_levels(sx, sy, es), 0);
+            check_tree(tree, sx, sy, es,
+                       "uniform es " + std::to_string(es) + " " + std::to_string(sx) + "x" + std::to_string(sy));
+        }
+    }
+}
+
+TEST(QuadTree, MixedLeavesWithClippedEdges) {
+    std::mt19937 rng(2);
+    for (int es : {1, 2, 4}) {
+        for (auto [sx, sy] : {std::pair{16, 16}, std::pair{37, 23}, std::pair{100, 3}, std::pair{255, 256}}) {
+            for (double nest : {0.2, 0.7}) {
+                auto tree = gen_tree(rng, tree_levels(sx, sy, es), nest);
+                check_tree(tree, sx, sy, es,
+                           "mixed es " + std::to_string(es) + " " + std::to_string(sx) + "x" +
+                               std::to_string(sy) + " nest " + std::to_string(nest));
+            }
+        }
+    }
+}
+
+TEST(QuadTree, TreeLargerThanOneReadChunk) {
+    // Dense enough to take several read-ahead refills.
+    std::mt19937 rng(3);
+    auto tree = gen_tree(rng, tree_levels(600, 500, 4), 0.9);
+    ASSERT_GT(tree.size(), 256u * 1024u);
+    check_tree(tree, 600, 500, 4, "large");
+}
+
+TEST(QuadTree, TruncatedTreeThrows) {
+    std::mt19937 rng(4);
+    auto tree = gen_tree(rng, tree_levels(64, 64, 2), 0.5);
+    std::vector<uint8_t> grid(64 * 64 * 2);
+    std::istringstream in(tree.substr(0, tree.size() - 3));
+    EXPECT_THROW(read_quad_tree_into(in, 64, 64, 2, grid.data()), std::runtime_error);
+    std::istringstream skip_in(tree.substr(0, tree.size() - 3));
+    EXPECT_THROW(skip_quad_tree(skip_in), std::runtime_error);
+}
+
+TEST(QuadTree, RejectsInvalidElementSize) {
+    std::istringstream in(std::string(5, '\0'));
+    uint8_t out[16];
+    EXPECT_THROW(read_quad_tree_into(in, 2, 2, 3, out), std::runtime_error);
+}
+
+namespace {
+
+ObjectRecord object(int model_index, const std::string& model_name) {
+    ObjectRecord o;
+    o.model_index = model_index;
+    o.model_name = model_name;
+    return o;
+}
+
+} // namespace
+
+TEST(ModelTable, InternsNamesInFirstSeenOrder) {
+    std::vector<ObjectRecord> objs = {
+        object(2, "ca\\Plants\\Tree.p3d"), object(0, "ca\\roads\\asf10 25.p3d"),
+        object(2, "ca\\Plants\\Tree.p3d"), object(1, "misc\\BUSH"), object(0, "ca\\roads\\asf10 25.p3d"),
+    };
+    auto t = ModelTable::build(objs);
+    ASSERT_EQ(t.size(), 3u);
+    EXPECT_EQ(t[0].name, "ca\\Plants\\Tree.p3d");
+    EXPECT_EQ(t[0].base_name, "tree");
+    EXPECT_EQ(t[0].object_count, 2u);
+    EXPECT_EQ(t[1].name, "ca\\roads\\asf10 25.p3d");
+    EXPECT_EQ(t[1].base_name, "asf10 25");
+    EXPECT_EQ(t[2].base_name, "bush");
+    EXPECT_EQ(t[2].object_count, 1u);
+    EXPECT_EQ(t.ids(), (std::vector<uint32_t>{0, 1, 0, 2, 1}));
+}
+
+TEST(ModelTable, StaleModelIndexFallsBackToName) {
+    // Index 0 is reused for another name, "a" also appears under other
+    // indexes, and two indexes are outside the slot table.
+    std::vector<ObjectRecord> objs = {
+        object(0, "a.p3d"), object(0, "b.p3d"), object(5, "a.p3d"), object(-1, "b.p3d"),
+        object(1 << 24, "c.p3d"), object(0, "a.p3d"), object(5, "c.p3d"), object(1 << 24, "a.p3d"),
+    };
+    auto t = ModelTable::build(objs);
+    ASSERT_EQ(t.size(), 3u);
+    EXPECT_EQ(t.ids(), (std::vector<uint32_t>{0, 1, 0, 1, 2, 0, 2, 0}));
+    for (size_t i = 0; i < objs.size(); i++) EXPECT_EQ(t[t.id(i)].name, objs[i].model_name) << i;
+    EXPECT_EQ(t[0].object_count, 4u);
+    EXPECT_EQ(t[1].object_count, 2u);
+    EXPECT_EQ(t[2].object_count, 2u);
+}
+
+TEST(ModelTable, MatchesNameInterningOnRandomObjects) {
+    std::mt19937 rng(5);
+    std::vector<std::string> names;
+    for (int i = 0; i < 40; i++) names.push_back("m\\model" + std::to_string(i) + ".p3d");
+    std::vector<ObjectRecord> objs;
+    for (int i = 0; i < 5000; i++) {
+        auto n = rng() % names.size();
+        // Mostly the true index, sometimes a stale one.
+        int idx = rng() % 8 == 0 ? static_cast<int>(rng() % names.size()) : static_cast<int>(n);
+        objs.push_back(object(idx, names[n]));
+    }
+    auto t = ModelTable::build(objs);
+
+    std::vector<std::string> order;
+    for (const auto& o : objs)
+        if (std::find(order.begin(), order.end(), o.model_name) == order.end()) order.push_back(o.model_name);
+    ASSERT_EQ(t.size(), order.size());
+    for (size_t id = 0; id < order.size(); id++) EXPECT_EQ(t[static_cast<uint32_t>(id)].name, order[id]);
+    for (size_t i = 0; i < objs.size(); i++) ASSERT_EQ(t[t.id(i)].name, objs[i].model_name) << i;
+}
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <istream>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -17,6 +19,74 @@ struct AudioData {
 };
 
 // read parses a WSS (Bohemia proprietary) or standard RIFF WAVE file.
+// It is a Decoder run to the end of the stream.
 AudioData read(std::istream& r);
 
+// AudioInfo describes a WSS or WAVE file without its samples.
+struct AudioInfo {
+    uint32_t sample_rate = 0;
+    uint16_t channels = 0;
+    uint16_t bits_per_sample = 0;
+    std::string format; // "PCM", "Delta8", "Delta4"
+    uint64_t samples = 0; // 16-bit samples read would decode, all channels
+    double duration = 0.0;
+};
+
+// read_info parses the header of a WSS or RIFF WAVE file of size bytes
+// starting at r's position. Sample data is skipped rather than read or
+// decoded; the result matches what read reports.
+AudioInfo read_info(std::istream& r, uint64_t size);
+
+// Decoder decodes a WSS or RIFF WAVE stream in chunks, so playback can
+// start before the whole file is read. Samples come out as interleaved
+// 16-bit frames of frame_channels() samples; Delta4 and Delta8 are decoded
+// straight into that layout without per-channel copies.
+//
+// The stream must outlive the decoder. Non-seekable streams are buffered
+// whole when the decoder is constructed.
+class Decoder {
+public:
+    // Decoder parses the header at r's position. Throws std::runtime_error
+    // for unknown or unsupported formats.
+    explicit Decoder(std::istream& r);
+    ~Decoder();
+
+    Decoder(const Decoder&) = delete;
+    Decoder& operator=(const Decoder&) = delete;
+
+    const AudioInfo& info() const { return info_; }
+
+    // frame_channels is info().channels, or 1 when the header says 0.
+    size_t frame_channels() const { return ch_; }
+
+    // frames is the total number of frames decode produces.
+    uint64_t frames() const { return frames_; }
+
+    // decode writes up to max_frames frames to out and returns how many it
+    // wrote; 0 means the end of the stream. A trailing partial frame is
+    // padded with silence.
+    size_t decode(int16_t* out, size_t max_frames);
+
+private:
+    enum class Codec { PCM16, PCM8, Delta8, Delta4 };
+
+    std::unique_ptr<std::istream> owned_; // buffered copy of a non-seekable stream
+    std::istream* r_;
+    AudioInfo info_;
+    Codec codec_ = Codec::PCM16;
+    size_t ch_ = 1;
+    size_t block_bytes_ = 0;  // input bytes per block
+    size_t block_frames_ = 1; // output frames per block
+    size_t chunk_blocks_ = 0; // blocks decoded per pass
+    uint64_t frames_ = 0;
+    uint64_t data_left_ = 0;  // undecoded payload bytes
+    std::vector<uint8_t> in_;
+    std::vector<int32_t> deltas_;
+    std::vector<int32_t> acc_;     // running value per channel
+    std::vector<int16_t> pending_; // second Delta4 frame held back by an odd request
+    bool has_pending_ = false;
+
+    void decode_blocks(int16_t* out, size_t blocks);
+};
+
 } // namespace armatools::wss
@@ -2,38 +2,43 @@
 #include "armatools/binutil.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstring>
 #include <format>
+#include <iterator>
 #include <limits>
 #include <sstream>
 #include <stdexcept>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace armatools::wss {
 
-static std::vector<int16_t> decompress_byte_mono(const std::vector<uint8_t>& data) {
+// Delta8 stores one exponent-coded step per byte; the step depends only on
+// the byte, so it is computed once per value.
+static std::array<int32_t, 256> make_delta8_table() {
     constexpr double magic = (std::log(10.0) * std::log2(std::exp(1.0))) / 28.12574042515172;
-    std::vector<int16_t> out(data.size());
-    int16_t last = 0;
-    for (size_t i = 0; i < data.size(); i++) {
-        auto src = static_cast<int8_t>(data[i]);
-        if (src != 0) {
-            double af = std::abs(static_cast<double>(src)) * magic;
-            double rnd = std::round(af);
-            af = std::pow(2.0, af - rnd) * std::pow(2.0, rnd);
-            if (src < 0) af *= -1;
-            int64_t v = static_cast<int64_t>(std::round(af)) + last;
-            v = std::clamp(v, static_cast<int64_t>(std::numeric_limits<int16_t>::min()),
-                              static_cast<int64_t>(std::numeric_limits<int16_t>::max()));
-            last = static_cast<int16_t>(v);
-        }
-        out[i] = last;
+    std::array<int32_t, 256> table{};
+    for (int b = 0; b < 256; b++) {
+        auto src = static_cast<int8_t>(b);
+        if (src == 0) continue;
+        double af = std::abs(static_cast<double>(src)) * magic;
+        double rnd = std::round(af);
+        af = std::pow(2.0, af - rnd) * std::pow(2.0, rnd);
+        if (src < 0) af *= -1;
+        table[static_cast<size_t>(b)] = static_cast<int32_t>(std::round(af));
     }
-    return out;
+    return table;
 }
 
-static constexpr int16_t pcm_index[15] = {
-    -8192, -4096, -2048, -1024, -512, -256, -64, 0, 64, 256, 512, 1024, 2048, 4096, 8192
+static const std::array<int32_t, 256> delta8_table = make_delta8_table();
+
+// Delta4 nibbles index a fixed step table; 15 means no change.
+static constexpr int32_t delta4_table[16] = {
+    -8192, -4096, -2048, -1024, -512, -256, -64, 0, 64, 256, 512, 1024, 2048, 4096, 8192, 0
 };
 
 static int16_t clamp_i16(int32_t v) {
@@ -41,64 +46,139 @@ static int16_t clamp_i16(int32_t v) {
                                               static_cast<int32_t>(std::numeric_limits<int16_t>::max())));
 }
 
-static std::vector<int16_t> decompress_nibble_mono(const std::vector<uint8_t>& data) {
-    std::vector<int16_t> out;
-    out.reserve(data.size() * 2);
-    int32_t delta = 0;
-    for (uint8_t b : data) {
-        int hi = (b >> 4) & 0x0F;
-        int lo = b & 0x0F;
-        if (hi < 15) delta += pcm_index[hi];
-        out.push_back(clamp_i16(delta));
-        if (lo < 15) delta += pcm_index[lo];
-        out.push_back(clamp_i16(delta));
-    }
-    return out;
-}
+#if defined(__SSE2__)
+// Helpers for running sums over four interleaved int32 samples holding
+// 4/CH frames. carry holds the running value of each channel in every lane
+// of that channel.
 
-static std::vector<uint8_t> samples_to_bytes(const std::vector<int16_t>& samples) {
-    std::vector<uint8_t> out(samples.size() * 2);
-    for (size_t i = 0; i < samples.size(); i++) {
-        auto v = static_cast<uint16_t>(samples[i]);
-        out[i * 2] = static_cast<uint8_t>(v & 0xFF);
-        out[i * 2 + 1] = static_cast<uint8_t>((v >> 8) & 0xFF);
-    }
-    return out;
+template <size_t CH>
+static __m128i load_carry(const int32_t* acc) {
+    if constexpr (CH == 1) return _mm_set1_epi32(acc[0]);
+    else if constexpr (CH == 2) return _mm_setr_epi32(acc[0], acc[1], acc[0], acc[1]);
+    else return _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc));
 }
 
-using DecompressFunc = std::vector<int16_t>(*)(const std::vector<uint8_t>&);
+template <size_t CH>
+static void store_carry(__m128i carry, int32_t* acc) {
+    alignas(16) int32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), carry);
+    std::copy_n(lanes, CH, acc);
+}
 
-static std::vector<uint8_t> decompress_channels(const std::vector<uint8_t>& data, int channels,
-                                                  DecompressFunc decompress) {
-    if (channels <= 1) return samples_to_bytes(decompress(data));
+// prefix adds each sample to the later samples of its channel.
+template <size_t CH>
+static __m128i prefix(__m128i v) {
+    if constexpr (CH == 1) {
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+    } else if constexpr (CH == 2) {
+        v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+    }
+    return v;
+}
 
-    std::vector<std::vector<uint8_t>> ch_data(static_cast<size_t>(channels));
-    for (size_t i = 0; i < data.size(); i++)
-        ch_data[i % static_cast<size_t>(channels)].push_back(data[i]);
+// last_frame broadcasts the final frame of v to every frame.
+template <size_t CH>
+static __m128i last_frame(__m128i v) {
+    if constexpr (CH == 1) return _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3));
+    else if constexpr (CH == 2) return _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 2, 3, 2));
+    else return v;
+}
 
-    std::vector<std::vector<int16_t>> ch_samples(static_cast<size_t>(channels));
-    size_t max_len = 0;
-    for (int ch = 0; ch < channels; ch++) {
-        ch_samples[static_cast<size_t>(ch)] = decompress(ch_data[static_cast<size_t>(ch)]);
-        max_len = std::max(max_len, ch_samples[static_cast<size_t>(ch)].size());
+// Delta4 sums wrap like the reference int32 accumulator and are saturated
+// only on output, which _mm_packs_epi32 does for free.
+template <size_t CH>
+static size_t sum_delta4_sse(const int32_t* d, size_t n, int32_t* acc, int16_t* out) {
+    __m128i carry = load_carry<CH>(acc);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = prefix<CH>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(d + i)));
+        v = _mm_add_epi32(v, carry);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(v, v));
+        carry = last_frame<CH>(v);
     }
+    store_carry<CH>(carry, acc);
+    return i;
+}
 
-    std::vector<uint8_t> out(max_len * static_cast<size_t>(channels) * 2, 0);
-    for (size_t i = 0; i < max_len; i++) {
-        for (int ch = 0; ch < channels; ch++) {
-            auto& cs = ch_samples[static_cast<size_t>(ch)];
-            if (i < cs.size()) {
-                size_t off = (i * static_cast<size_t>(channels) + static_cast<size_t>(ch)) * 2;
-                auto v = static_cast<uint16_t>(cs[i]);
-                out[off] = static_cast<uint8_t>(v & 0xFF);
-                out[off + 1] = static_cast<uint8_t>((v >> 8) & 0xFF);
+// Delta8 saturates the running value itself, which a prefix sum cannot
+// express. Blocks whose unclamped sums stay in range are exact; the rest
+// are redone sample by sample.
+template <size_t CH>
+static size_t sum_delta8_sse(const int32_t* d, size_t n, int32_t* acc, int16_t* out) {
+    __m128i carry = load_carry<CH>(acc);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = prefix<CH>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(d + i)));
+        v = _mm_add_epi32(v, carry);
+        __m128i packed = _mm_packs_epi32(v, v);
+        __m128i widened = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(widened, v)) != 0xFFFF) {
+            store_carry<CH>(carry, acc);
+            for (size_t j = i; j < i + 4; j++) {
+                int32_t& a = acc[j % CH];
+                a = clamp_i16(a + d[j]);
+                out[j] = static_cast<int16_t>(a);
             }
+            carry = load_carry<CH>(acc);
+            continue;
         }
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), packed);
+        carry = last_frame<CH>(v);
+    }
+    store_carry<CH>(carry, acc);
+    return i;
+}
+#endif
+
+// sum_delta4 turns n interleaved Delta4 steps into samples, continuing the
+// per-channel sums in acc.
+static void sum_delta4(const int32_t* d, size_t n, size_t ch, int32_t* acc, int16_t* out) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    if (ch == 1) i = sum_delta4_sse<1>(d, n, acc, out);
+    else if (ch == 2) i = sum_delta4_sse<2>(d, n, acc, out);
+    else if (ch == 4) i = sum_delta4_sse<4>(d, n, acc, out);
+#endif
+    for (; i < n; i++) {
+        int32_t& a = acc[i % ch];
+        a = static_cast<int32_t>(static_cast<uint32_t>(a) + static_cast<uint32_t>(d[i]));
+        out[i] = clamp_i16(a);
+    }
+}
+
+// sum_delta8 turns n interleaved Delta8 steps into samples, continuing the
+// per-channel values in acc.
+static void sum_delta8(const int32_t* d, size_t n, size_t ch, int32_t* acc, int16_t* out) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    if (ch == 1) i = sum_delta8_sse<1>(d, n, acc, out);
+    else if (ch == 2) i = sum_delta8_sse<2>(d, n, acc, out);
+    else if (ch == 4) i = sum_delta8_sse<4>(d, n, acc, out);
+#endif
+    for (; i < n; i++) {
+        int32_t& a = acc[i % ch];
+        a = clamp_i16(a + d[i]);
+        out[i] = static_cast<int16_t>(a);
     }
-    return out;
 }
 
-static AudioData read_wss(std::istream& r) {
+static void set_duration(AudioInfo& info) {
+    if (info.channels > 0 && info.sample_rate > 0)
+        info.duration = static_cast<double>(info.samples) / info.channels / info.sample_rate;
+}
+
+// Layout locates the sample data of a parsed file.
+struct Layout {
+    AudioInfo info;
+    std::streamoff data_pos = -1; // stream position of the first sample byte
+    uint64_t data_size = 0;
+    bool pcm8 = false;            // unsigned 8-bit WAVE samples
+};
+
+static Layout read_wss_layout(std::istream& r, uint64_t size) {
+    constexpr uint64_t header_size = 26; // signature, compression and a WAVEFORMATEX
+    if (size < header_size) throw std::runtime_error("wss: truncated header");
     uint32_t compression_raw = binutil::read_u32(r);
     binutil::read_u16(r); // format
     uint16_t channels = binutil::read_u16(r);
@@ -108,92 +188,239 @@ static AudioData read_wss(std::istream& r) {
     uint16_t bps = binutil::read_u16(r);
     binutil::read_u16(r); // output size
 
-    std::ostringstream buf;
-    buf << r.rdbuf();
-    std::string s = buf.str();
-    std::vector<uint8_t> data(s.begin(), s.end());
-
+    Layout l;
+    l.data_pos = r.tellg();
+    l.data_size = size - header_size;
     uint32_t compression = compression_raw & 0xFF;
-    if (compression == 0 && data.size() % 2 != 0) compression = 4;
+    if (compression == 0 && l.data_size % 2 != 0) compression = 4;
 
-    std::vector<uint8_t> pcm;
-    std::string format_name;
+    AudioInfo& info = l.info;
+    info = {sample_rate, channels, bps, "", 0, 0.0};
+    // Delta streams interleave channels byte by byte; a short last frame is
+    // padded.
+    uint64_t ch = std::max<uint64_t>(channels, 1);
+    uint64_t per_channel = (l.data_size + ch - 1) / ch;
     switch (compression) {
-        case 0: pcm = data; format_name = "PCM"; break;
-        case 8: pcm = decompress_channels(data, channels, decompress_byte_mono); format_name = "Delta8"; break;
-        case 4: pcm = decompress_channels(data, channels, decompress_nibble_mono); format_name = "Delta4"; break;
+        case 0: info.format = "PCM"; info.samples = l.data_size / 2; break;
+        case 8: info.format = "Delta8"; info.samples = per_channel * ch; break;
+        case 4: info.format = "Delta4"; info.samples = per_channel * 2 * ch; break;
         default: throw std::runtime_error(std::format("wss: unsupported compression type {}", compression));
     }
-
-    AudioData ad{sample_rate, channels, bps, format_name, std::move(pcm), 0.0};
-    size_t num_samples = ad.pcm.size() / 2;
-    if (channels > 0 && sample_rate > 0)
-        ad.duration = static_cast<double>(num_samples) / channels / sample_rate;
-    return ad;
+    set_duration(info);
+    return l;
 }
 
-static AudioData read_wav(std::istream& r) {
+// read_wav_layout reads the size bytes following the RIFF signature.
+static Layout read_wav_layout(std::istream& r, uint64_t size) {
+    if (size < 8) throw std::runtime_error("wss: truncated header");
     binutil::read_u32(r); // file size
     std::string wave = binutil::read_signature(r);
     if (wave != "WAVE") throw std::runtime_error(std::format("wss: expected WAVE, got {}", wave));
 
-    uint16_t audio_format = 0, channels = 0, bps = 0;
-    uint32_t sample_rate = 0;
-    std::vector<uint8_t> raw_data;
+    uint16_t audio_format = 0;
+    Layout l;
+    AudioInfo& info = l.info;
     bool got_fmt = false, got_data = false;
 
-    while (r.peek() != std::char_traits<char>::eof()) {
-        std::string chunk_id;
-        try { chunk_id = binutil::read_signature(r); } catch (...) { break; }
+    uint64_t remaining = size - 8;
+    while (remaining >= 8) {
+        std::string chunk_id = binutil::read_signature(r);
         uint32_t chunk_size = binutil::read_u32(r);
+        remaining -= 8;
+        uint64_t padded = chunk_size + (chunk_size % 2);
 
         if (chunk_id == "fmt ") {
             audio_format = binutil::read_u16(r);
-            channels = binutil::read_u16(r);
-            sample_rate = binutil::read_u32(r);
+            info.channels = binutil::read_u16(r);
+            info.sample_rate = binutil::read_u32(r);
             binutil::read_u32(r); binutil::read_u16(r);
-            bps = binutil::read_u16(r);
-            if (chunk_size > 16) r.seekg(static_cast<std::streamoff>(chunk_size - 16), std::ios::cur);
+            info.bits_per_sample = binutil::read_u16(r);
+            if (padded > 16) r.seekg(static_cast<std::streamoff>(padded - 16), std::ios::cur);
             got_fmt = true;
         } else if (chunk_id == "data") {
-            raw_data = binutil::read_bytes(r, chunk_size);
+            if (chunk_size > remaining) throw std::runtime_error("wss: truncated data chunk");
+            l.data_pos = r.tellg();
+            l.data_size = chunk_size;
             got_data = true;
+            if (got_fmt) break; // nothing after the samples is needed
+            r.seekg(static_cast<std::streamoff>(padded), std::ios::cur);
         } else {
-            r.seekg(static_cast<std::streamoff>(chunk_size), std::ios::cur);
+            r.seekg(static_cast<std::streamoff>(padded), std::ios::cur);
         }
-        if (chunk_size % 2 != 0) r.seekg(1, std::ios::cur);
+        remaining -= std::min(padded, remaining);
     }
 
     if (!got_fmt) throw std::runtime_error("wss: no fmt chunk");
     if (!got_data) throw std::runtime_error("wss: no data chunk");
     if (audio_format != 1) throw std::runtime_error(std::format("wss: unsupported audio format {}", audio_format));
 
-    std::vector<uint8_t> pcm;
-    if (bps == 16) {
-        pcm = raw_data;
-    } else if (bps == 8) {
-        pcm.resize(raw_data.size() * 2);
-        for (size_t i = 0; i < raw_data.size(); i++) {
-            auto sample = static_cast<int16_t>((static_cast<int16_t>(raw_data[i]) - 128) * 256);
-            pcm[i * 2] = static_cast<uint8_t>(static_cast<uint16_t>(sample) & 0xFF);
-            pcm[i * 2 + 1] = static_cast<uint8_t>((static_cast<uint16_t>(sample) >> 8) & 0xFF);
-        }
+    info.format = "PCM";
+    if (info.bits_per_sample == 16) {
+        info.samples = l.data_size / 2;
+    } else if (info.bits_per_sample == 8) {
+        info.samples = l.data_size;
+        l.pcm8 = true;
     } else {
-        throw std::runtime_error(std::format("wss: unsupported PCM bit depth {}", bps));
+        throw std::runtime_error(std::format("wss: unsupported PCM bit depth {}", info.bits_per_sample));
     }
-
-    AudioData ad{sample_rate, channels, bps, "PCM", std::move(pcm), 0.0};
-    size_t num_samples = ad.pcm.size() / 2;
-    if (channels > 0 && sample_rate > 0)
-        ad.duration = static_cast<double>(num_samples) / channels / sample_rate;
-    return ad;
+    set_duration(info);
+    return l;
 }
 
-AudioData read(std::istream& r) {
+static Layout read_layout(std::istream& r, uint64_t size) {
+    if (size < 4) throw std::runtime_error("wss: truncated header");
     std::string sig = binutil::read_signature(r);
-    if (sig == "WSS0") return read_wss(r);
-    if (sig == "RIFF") return read_wav(r);
+    if (sig == "WSS0") return read_wss_layout(r, size);
+    if (sig == "RIFF") return read_wav_layout(r, size - 4);
     throw std::runtime_error(std::format("wss: unknown format signature {}", sig));
 }
 
+AudioInfo read_info(std::istream& r, uint64_t size) {
+    return read_layout(r, size).info;
+}
+
+Decoder::Decoder(std::istream& r) : r_(&r) {
+    uint64_t size = 0;
+    std::streampos start = r.tellg();
+    if (start != std::streampos(-1) && r.seekg(0, std::ios::end)) {
+        size = static_cast<uint64_t>(r.tellg() - start);
+        r.seekg(start);
+    } else {
+        r.clear();
+        std::string s{std::istreambuf_iterator<char>(r), std::istreambuf_iterator<char>()};
+        size = s.size();
+        owned_ = std::make_unique<std::istringstream>(std::move(s));
+        r_ = owned_.get();
+    }
+
+    Layout l = read_layout(*r_, size);
+    info_ = std::move(l.info);
+    ch_ = std::max<size_t>(info_.channels, 1);
+    if (l.data_size > 0) r_->seekg(l.data_pos);
+
+    data_left_ = l.data_size;
+    if (info_.format == "Delta8") {
+        codec_ = Codec::Delta8;
+        block_bytes_ = ch_;
+    } else if (info_.format == "Delta4") {
+        codec_ = Codec::Delta4;
+        block_bytes_ = ch_;
+        block_frames_ = 2;
+    } else if (l.pcm8) {
+        codec_ = Codec::PCM8;
+        block_bytes_ = ch_;
+    } else {
+        codec_ = Codec::PCM16;
+        block_bytes_ = ch_ * 2;
+        data_left_ &= ~uint64_t{1}; // a trailing odd byte is not a sample
+    }
+    frames_ = (data_left_ + block_bytes_ - 1) / block_bytes_ * block_frames_;
+
+    // About 64 KiB of input per pass keeps the scratch buffers in cache.
+    chunk_blocks_ = std::max<size_t>(1, 65536 / block_bytes_);
+    if (codec_ != Codec::PCM16) in_.resize(chunk_blocks_ * block_bytes_);
+    if (codec_ == Codec::Delta8 || codec_ == Codec::Delta4)
+        deltas_.resize(chunk_blocks_ * block_frames_ * ch_);
+    acc_.assign(ch_, 0);
+    if (codec_ == Codec::Delta4) pending_.resize(2 * ch_);
+}
+
+Decoder::~Decoder() = default;
+
+size_t Decoder::decode(int16_t* out, size_t max_frames) {
+    size_t done = 0;
+    if (has_pending_ && max_frames > 0) {
+        std::copy_n(pending_.begin() + static_cast<std::ptrdiff_t>(ch_), ch_, out);
+        has_pending_ = false;
+        done = 1;
+    }
+    while (done < max_frames && data_left_ > 0) {
+        size_t blocks = std::min((max_frames - done) / block_frames_, chunk_blocks_);
+        if (blocks == 0) {
+            // One Delta4 frame requested: decode its block and keep the
+            // second frame for the next call.
+            decode_blocks(pending_.data(), 1);
+            std::copy_n(pending_.begin(), ch_, out + done * ch_);
+            has_pending_ = true;
+            return done + 1;
+        }
+        uint64_t left_blocks = (data_left_ + block_bytes_ - 1) / block_bytes_;
+        blocks = static_cast<size_t>(std::min<uint64_t>(blocks, left_blocks));
+        decode_blocks(out + done * ch_, blocks);
+        done += blocks * block_frames_;
+    }
+    return done;
+}
+
+// decode_blocks decodes the next blocks blocks into out. The last block of
+// the stream may be short; its missing samples are written as silence.
+void Decoder::decode_blocks(int16_t* out, size_t blocks) {
+    size_t want = blocks * block_bytes_;
+    auto n = static_cast<size_t>(std::min<uint64_t>(want, data_left_));
+    auto* dst = codec_ == Codec::PCM16 ? reinterpret_cast<char*>(out) : reinterpret_cast<char*>(in_.data());
+    if (!r_->read(dst, static_cast<std::streamsize>(n)))
+        throw std::runtime_error("wss: truncated sample data");
+    data_left_ -= n;
+    size_t samples = blocks * block_frames_ * ch_;
+
+    switch (codec_) {
+    case Codec::PCM16:
+        std::memset(dst + n, 0, want - n);
+        return;
+    case Codec::PCM8:
+        for (size_t i = 0; i < n; i++)
+            out[i] = static_cast<int16_t>((static_cast<int32_t>(in_[i]) - 128) * 256);
+        std::fill(out + n, out + samples, int16_t{0});
+        return;
+    case Codec::Delta8:
+        for (size_t i = 0; i < n; i++) deltas_[i] = delta8_table[in_[i]];
+        std::fill(deltas_.begin() + static_cast<std::ptrdiff_t>(n),
+                  deltas_.begin() + static_cast<std::ptrdiff_t>(samples), 0);
+        sum_delta8(deltas_.data(), samples, ch_, acc_.data(), out);
+        break;
+    case Codec::Delta4:
+        // Each block of one byte per channel holds two frames: the high
+        // nibbles, then the low ones.
+        std::fill(in_.begin() + static_cast<std::ptrdiff_t>(n),
+                  in_.begin() + static_cast<std::ptrdiff_t>(want), uint8_t{0xFF});
+        for (size_t b = 0; b < blocks; b++) {
+            const uint8_t* src = in_.data() + b * ch_;
+            int32_t* d = deltas_.data() + b * 2 * ch_;
+            for (size_t c = 0; c < ch_; c++) {
+                d[c] = delta4_table[src[c] >> 4];
+                d[ch_ + c] = delta4_table[src[c] & 0x0F];
+            }
+        }
+        sum_delta4(deltas_.data(), samples, ch_, acc_.data(), out);
+        break;
+    }
+
+    if (n < want) {
+        // Silence the channels past the end of the data in the last block.
+        size_t present = n % block_bytes_;
+        int16_t* last = out + samples - block_frames_ * ch_;
+        for (size_t f = 0; f < block_frames_; f++)
+            std::fill(last + f * ch_ + present, last + (f + 1) * ch_, int16_t{0});
+    }
+}
+
+AudioData read(std::istream& r) {
+    Decoder dec(r);
+    const AudioInfo& info = dec.info();
+    AudioData ad{info.sample_rate, info.channels, info.bits_per_sample, info.format, {}, info.duration};
+    ad.pcm.resize(static_cast<size_t>(info.samples) * 2);
+
+    // Decode in slices that stay in cache and copy them into place; the
+    // last frame may be padded past info.samples.
+    size_t ch = dec.frame_channels();
+    std::vector<int16_t> buf(std::max<size_t>(1, 32768 / ch) * ch);
+    size_t pos = 0;
+    while (size_t frames = dec.decode(buf.data(), buf.size() / ch)) {
+        size_t bytes = std::min(frames * ch * 2, ad.pcm.size() - pos);
+        std::memcpy(ad.pcm.data() + pos, buf.data(), bytes);
+        pos += bytes;
+    }
+    return ad;
+}
+
 } // namespace armatools::wss
@@ -0,0 +1,205 @@
+#include "armatools/wss.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <initializer_list>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace armatools::wss;
+
+namespace {
+
+void put_u16(std::string& s, uint16_t v) { s.append(reinterpret_cast<const char*>(&v), 2); }
+void put_u32(std::string& s, uint32_t v) { s.append(reinterpret_cast<const char*>(&v), 4); }
+
+std::string wss_file(uint32_t compression, uint16_t channels, const std::vector<uint8_t>& data) {
+    std::string s = "WSS0";
+    put_u32(s, compression);
+    put_u16(s, 1);
+    put_u16(s, channels);
+    put_u32(s, 22050);
+    put_u32(s, 0);
+    put_u16(s, 0);
+    put_u16(s, 16);
+    put_u16(s, 0);
+    s.append(data.begin(), data.end());
+    return s;
+}
+
+// Straightforward per-channel decoders the optimized ones must match.
+int16_t clamp16(int64_t v) { return static_cast<int16_t>(std::clamp<int64_t>(v, -32768, 32767)); }
+
+std::vector<int16_t> reference_delta8(const std::vector<uint8_t>& data, size_t ch) {
+    const double magic = (std::log(10.0) * std::log2(std::exp(1.0))) / 28.12574042515172;
+    size_t frames = (data.size() + ch - 1) / ch;
+    std::vector<int16_t> out(frames * ch, 0);
+    for (size_t c = 0; c < ch; c++) {
+        int16_t last = 0;
+        for (size_t f = 0; f * ch + c < data.size(); f++) {
+            auto src = static_cast<int8_t>(data[f * ch + c]);
+            if (src != 0) {
+                double af = std::abs(static_cast<double>(src)) * magic;
+                double rnd = std::round(af);
+                af = std::pow(2.0, af - rnd) * std::pow(2.0, rnd);
+                if (src < 0) af = -af;
+                last = clamp16(static_cast<int64_t>(std::round(af)) + last);
+            }
+            out[f * ch + c] = last;
+        }
+    }
+    return out;
+}
+
+std::vector<int16_t> reference_delta4(const std::vector<uint8_t>& data, size_t ch) {
+    static constexpr int32_t steps[15] = {-8192, -4096, -2048, -1024, -512, -256, -64, 0,
+                                          64, 256, 512, 1024, 2048, 4096, 8192};
+    size_t blocks = (data.size() + ch - 1) / ch;
+    std::vector<int16_t> out(blocks * 2 * ch, 0);
+    for (size_t c = 0; c < ch; c++) {
+        int32_t delta = 0;
+        for (size_t b = 0; b * ch + c < data.size(); b++) {
+            uint8_t v = data[b * ch + c];
+            if ((v >> 4) < 15) delta += steps[v >> 4];
+            out[(2 * b) * ch + c] = clamp16(delta);
+            if ((v & 15) < 15) delta += steps[v & 15];
+            out[(2 * b + 1) * ch + c] = clamp16(delta);
+        }
+    }
+    return out;
+}
+
+std::vector<int16_t> samples_of(const AudioData& ad) {
+    std::vector<int16_t> s(ad.pcm.size() / 2);
+    std::memcpy(s.data(), ad.pcm.data(), s.size() * 2);
+    return s;
+}
+
+std::vector<uint8_t> random_bytes(size_t n, uint32_t seed, int spread) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> data(n);
+    for (auto& b : data) b = static_cast<uint8_t>(static_cast<int>(rng() % static_cast<uint32_t>(2 * spread + 1)) - spread);
+    return data;
+}
+
+} // namespace
+
+TEST(Wss, Delta8MatchesReference) {
+    // Small steps stay in range; large ones clip and take the exact path.
+    for (int spread : {3, 127}) {
+        for (uint16_t ch : std::initializer_list<uint16_t>{1, 2, 3, 4}) {
+            auto data = random_bytes(1001, ch, spread);
+            std::istringstream in(wss_file(8, ch, data));
+            auto ad = read(in);
+            EXPECT_EQ(ad.format, "Delta8");
+            EXPECT_EQ(samples_of(ad), reference_delta8(data, ch)) << "channels " << ch << " spread " << spread;
+        }
+    }
+}
+
+TEST(Wss, Delta4MatchesReference) {
+    for (uint16_t ch : std::initializer_list<uint16_t>{1, 2, 3, 4}) {
+        auto data = random_bytes(777, 10u + ch, 127);
+        std::istringstream in(wss_file(4, ch, data));
+        auto ad = read(in);
+        EXPECT_EQ(ad.format, "Delta4");
+        EXPECT_EQ(samples_of(ad), reference_delta4(data, ch)) << "channels " << ch;
+    }
+}
+
+TEST(Wss, DecoderStreamsInAnyChunkSize) {
+    auto data = random_bytes(999, 5, 127);
+    auto expected = reference_delta4(data, 2);
+    std::istringstream in(wss_file(4, 2, data));
+    Decoder dec(in);
+    ASSERT_EQ(dec.frame_channels(), 2u);
+    ASSERT_EQ(dec.frames() * 2, expected.size());
+
+    // Odd request sizes split Delta4 blocks between calls.
+    std::vector<int16_t> got, buf;
+    for (size_t n = 1; ; n = n % 7 + 1) {
+        buf.assign(n * 2, 0);
+        size_t frames = dec.decode(buf.data(), n);
+        if (frames == 0) break;
+        got.insert(got.end(), buf.begin(), buf.begin() + static_cast<std::ptrdiff_t>(frames * 2));
+    }
+    EXPECT_EQ(got, expected);
+}
+
+TEST(Wss, OddPcmPayloadIsDelta4) {
+    std::vector<uint8_t> data = {0x8E, 0xF0, 0x12};
+    std::istringstream in(wss_file(0, 1, data));
+    auto ad = read(in);
+    EXPECT_EQ(ad.format, "Delta4");
+    EXPECT_EQ(samples_of(ad), reference_delta4(data, 1));
+}
+
+TEST(Wss, Wave8BitIsWidened) {
+    std::string s = "RIFF";
+    put_u32(s, 0);
+    s += "WAVE";
+    s += "data";
+    put_u32(s, 3);
+    s += std::string("\x00\x80\xFF", 3);
+    s.push_back(0);
+    s += "fmt ";
+    put_u32(s, 16);
+    put_u16(s, 1);
+    put_u16(s, 1);
+    put_u32(s, 8000);
+    put_u32(s, 8000);
+    put_u16(s, 1);
+    put_u16(s, 8);
+
+    std::istringstream in(s);
+    auto ad = read(in);
+    EXPECT_EQ(ad.format, "PCM");
+    EXPECT_EQ(samples_of(ad), (std::vector<int16_t>{-32768, 0, 32512}));
+}
+
+TEST(Wss, ReadInfoMatchesRead) {
+    auto check = [](const std::string& file, const std::string& what) {
+        std::istringstream info_in(file);
+        auto info = read_info(info_in, file.size());
+        std::istringstream in(file);
+        auto ad = read(in);
+        EXPECT_EQ(info.format, ad.format) << what;
+        EXPECT_EQ(info.channels, ad.channels) << what;
+        EXPECT_EQ(info.sample_rate, ad.sample_rate) << what;
+        EXPECT_EQ(info.bits_per_sample, ad.bits_per_sample) << what;
+        EXPECT_EQ(info.samples, ad.pcm.size() / 2) << what;
+        EXPECT_DOUBLE_EQ(info.duration, ad.duration) << what;
+    };
+
+    // Sizes that do not divide by the channel count pad the last frame.
+    for (uint16_t ch : std::initializer_list<uint16_t>{1, 2, 3, 4}) {
+        for (size_t n : {size_t{64}, size_t{99}, size_t{1001}}) {
+            auto data = random_bytes(n, 7u + ch, 127);
+            auto what = "channels " + std::to_string(ch) + " bytes " + std::to_string(n);
+            check(wss_file(8, ch, data), "Delta8 " + what);
+            check(wss_file(4, ch, data), "Delta4 " + what);
+            if (n % 2 == 0) check(wss_file(0, ch, data), "PCM " + what);
+        }
+    }
+
+    std::string wave = "RIFF";
+    put_u32(wave, 0);
+    wave += "WAVE";
+    wave += "fmt ";
+    put_u32(wave, 16);
+    put_u16(wave, 1);
+    put_u16(wave, 2);
+    put_u32(wave, 44100);
+    put_u32(wave, 44100 * 4);
+    put_u16(wave, 4);
+    put_u16(wave, 16);
+    wave += "data";
+    put_u32(wave, 40);
+    wave += std::string(40, '\x11');
+    check(wave, "WAVE PCM16");
+}
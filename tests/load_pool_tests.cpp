@@ -0,0 +1,151 @@
+#include "services/load_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using load_pool::LruCache;
+using load_pool::Pool;
+using load_pool::Priority;
+
+namespace {
+
+// Gate blocks a load until opened; started fires once the load is running.
+struct Gate {
+    std::promise<void> started;
+    std::promise<void> open;
+    std::shared_future<void> opened = open.get_future().share();
+
+    std::function<int()> load(int value) {
+        return [this, value]() {
+            started.set_value();
+            opened.wait();
+            return value;
+        };
+    }
+};
+
+bool is_ready(const std::shared_future<int>& f) {
+    return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+}  // namespace
+
+TEST(LruCacheTest, EvictsLeastRecentlyUsedOverBudget) {
+    LruCache<int> cache(100);
+    cache.put("a", 1, 40);
+    cache.put("b", 2, 40);
+    int v = 0;
+    ASSERT_TRUE(cache.find("a", v));
+    EXPECT_EQ(v, 1);
+
+    // "b" is now the least recently used and goes first.
+    cache.put("c", 3, 40);
+    EXPECT_FALSE(cache.find("b", v));
+    EXPECT_TRUE(cache.find("a", v));
+    EXPECT_TRUE(cache.find("c", v));
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_EQ(cache.bytes(), 80u);
+
+    // Replacing a value re-charges its cost.
+    cache.put("a", 10, 60);
+    EXPECT_EQ(cache.bytes(), 100u);
+    ASSERT_TRUE(cache.find("a", v));
+    EXPECT_EQ(v, 10);
+}
+
+TEST(LruCacheTest, KeepsNewestEntryOverBudget) {
+    LruCache<int> cache(100);
+    cache.put("a", 1, 40);
+    cache.put("big", 2, 500);
+    int v = 0;
+    EXPECT_FALSE(cache.find("a", v));
+    ASSERT_TRUE(cache.find("big", v));
+    EXPECT_EQ(v, 2);
+    EXPECT_EQ(cache.size(), 1u);
+    EXPECT_EQ(cache.bytes(), 500u);
+}
+
+TEST(LoadPoolTest, CoalescesRequestsInFlight) {
+    Pool<int> pool(1);
+    Gate gate;
+    auto running = pool.submit("busy", Priority::Visible, gate.load(7));
+    gate.started.get_future().wait();
+
+    std::atomic<int> loads{0};
+    auto load = [&loads]() {
+        ++loads;
+        return 42;
+    };
+    auto first = pool.submit("tex", Priority::Visible, load);
+    auto second = pool.submit("tex", Priority::Prefetch, load);
+    // A key that is already loading shares its future too.
+    auto again = pool.submit("busy", Priority::Visible, []() { return -1; });
+
+    gate.open.set_value();
+    EXPECT_EQ(running.get(), 7);
+    EXPECT_EQ(again.get(), 7);
+    EXPECT_EQ(first.get(), 42);
+    EXPECT_EQ(second.get(), 42);
+    EXPECT_EQ(loads.load(), 1);
+}
+
+TEST(LoadPoolTest, PromotionSkipsStaleQueueCopy) {
+    Pool<int> pool(1);
+    Gate gate;
+    auto running = pool.submit("busy", Priority::Visible, gate.load(0));
+    gate.started.get_future().wait();
+
+    std::mutex mu;
+    std::vector<std::string> order;
+    auto record = [&](const std::string& key) {
+        return [&, key]() {
+            std::lock_guard lock(mu);
+            order.push_back(key);
+            return 1;
+        };
+    };
+    auto bg = pool.submit("bg", Priority::Background, record("bg"));
+    auto pf = pool.submit("pf", Priority::Prefetch, record("pf"));
+    auto promoted = pool.submit("bg", Priority::Visible, record("bg-again"));
+
+    gate.open.set_value();
+    bg.get();
+    pf.get();
+    promoted.get();
+    std::lock_guard lock(mu);
+    // The promoted job runs first, once, with its original load.
+    EXPECT_EQ(order, (std::vector<std::string>{"bg", "pf"}));
+}
+
+TEST(LoadPoolTest, DestructionResolvesQueuedJobs) {
+    auto pool = std::make_unique<Pool<int>>(1);
+    Gate gate;
+    auto running = pool->submit("busy", Priority::Visible, gate.load(5));
+    gate.started.get_future().wait();
+    auto queued = pool->submit("queued", Priority::Background, []() { return 9; });
+
+    // Queued jobs are resolved before the destructor waits for running
+    // loads, so the gate can be opened once they are.
+    std::thread destroy([&pool]() { pool.reset(); });
+    EXPECT_EQ(queued.get(), 0);
+    EXPECT_FALSE(is_ready(running));
+    gate.open.set_value();
+    destroy.join();
+    EXPECT_EQ(running.get(), 5);
+}
+
+TEST(LoadPoolTest, ThrowingLoadResolvesToDefault) {
+    Pool<int> pool(2);
+    auto f = pool.submit("bad", Priority::Visible, []() -> int { throw std::runtime_error("bad"); });
+    EXPECT_EQ(f.get(), 0);
+}
@@ -0,0 +1,65 @@
+#include "services/texture_data.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+namespace {
+
+armatools::paa::Image make_image(int w, int h, uint8_t alpha) {
+    armatools::paa::Image img;
+    img.width = w;
+    img.height = h;
+    img.pixels.resize(static_cast<size_t>(w) * static_cast<size_t>(h) * 4);
+    for (size_t i = 0; i < img.pixels.size(); i += 4) {
+        img.pixels[i] = static_cast<uint8_t>(i / 4);
+        img.pixels[i + 1] = 80;
+        img.pixels[i + 2] = 160;
+        img.pixels[i + 3] = alpha;
+    }
+    return img;
+}
+
+std::string encode(const armatools::paa::Image& img, const std::string& format) {
+    std::ostringstream out;
+    armatools::paa::encode(out, img, format);
+    return out.str();
+}
+
+}  // namespace
+
+TEST(TextureDataTest, KeepsDxtCompressedAndChargesMipBytes) {
+    const std::string path = "a3/data/test_co.paa";
+    std::istringstream in(encode(make_image(64, 64, 255), "dxt1"));
+    auto tex = texture_data::decode(in, path, true);
+    ASSERT_TRUE(tex);
+    EXPECT_EQ(tex->header.format, "DXT1");
+    EXPECT_EQ(tex->header.width, 64);
+    EXPECT_TRUE(tex->image.pixels.empty());
+    ASSERT_FALSE(tex->mips.empty());
+    EXPECT_EQ(tex->mips[0].width, 64);
+
+    size_t mip_bytes = 0;
+    for (const auto& mip : tex->mips) mip_bytes += mip.data.size();
+    EXPECT_EQ(mip_bytes, 64u * 64u / 2u);
+    EXPECT_EQ(texture_data::cost(tex.get()),
+              texture_data::cache_entry_overhead + path.size() + mip_bytes);
+    EXPECT_LT(texture_data::cost(tex.get()), 64u * 64u * 4u);
+}
+
+TEST(TextureDataTest, ExpandsWhenNotKeepingCompressed) {
+    std::istringstream in(encode(make_image(32, 32, 128), "dxt5"));
+    auto tex = texture_data::decode(in, "t.paa", false);
+    ASSERT_TRUE(tex);
+    EXPECT_TRUE(tex->mips.empty());
+    ASSERT_EQ(tex->image.pixels.size(), 32u * 32u * 4u);
+    EXPECT_EQ(texture_data::cost(tex.get()),
+              texture_data::cache_entry_overhead + 5u + 32u * 32u * 4u);
+}
+
+TEST(TextureDataTest, FailedDecodeCostsOverheadOnly) {
+    std::istringstream in(std::string(8, '\0'));
+    EXPECT_FALSE(texture_data::decode(in, "bad.paa", true));
+    EXPECT_EQ(texture_data::cost(nullptr), texture_data::cache_entry_overhead);
+    EXPECT_EQ(texture_data::layered_cost(nullptr), texture_data::cache_entry_overhead);
+}
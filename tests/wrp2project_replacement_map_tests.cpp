@@ -0,0 +1,68 @@
+#include "replacement_map.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using armatools::wrp::ModelTable;
+using armatools::wrp::ObjectRecord;
+
+namespace {
+
+ObjectRecord object(int model_index, const std::string& model_name) {
+    ObjectRecord o;
+    o.model_index = model_index;
+    o.model_name = model_name;
+    return o;
+}
+
+// The per-object lookup resolve replaced.
+std::string per_object(const ReplacementMap& rm, const std::string& model_name) {
+    return rm.is_matched(model_name) ? rm.lookup(model_name).first : "";
+}
+
+}  // namespace
+
+TEST(ReplacementMapTest, ResolveMatchesPerObjectLookup) {
+    ReplacementMap rm;
+    rm.add_entry("ca\\plants\\tree.p3d", "new\\oak.p3d");
+    rm.add_entry("CA\\Roads\\asf10 25", "new\\road.p3d");
+    rm.add_entry("misc\\bush.p3d", "unmatched");
+    rm.add_entry("other\\rock.p3d", "new\\stone.p3d");
+    rm.exact[rmap_norm_path("ca\\junk.p3d")] = "UNMATCHED";
+
+    std::vector<ObjectRecord> objs = {
+        object(0, "ca\\plants\\tree.p3d"),
+        object(1, "CA\\PLANTS\\TREE.P3D"),
+        object(2, "/ca/plants/tree.p3d"),
+        object(3, "ca\\roads\\asf10 25.p3d"),
+        object(4, "misc\\bush.p3d"),
+        object(5, "elsewhere\\rock.p3d"),
+        object(6, "elsewhere\\ROCK"),
+        object(7, "ca\\junk.p3d"),
+        object(8, "nowhere\\thing.p3d"),
+        object(0, "ca\\plants\\tree.p3d"),
+        object(4, "elsewhere\\bush.p3d"),
+        object(1, "nowhere\\thing.p3d"),
+    };
+    auto table = ModelTable::build(objs);
+    auto resolved = rm.resolve(table);
+    ASSERT_EQ(resolved.size(), table.size());
+    for (size_t i = 0; i < objs.size(); i++) {
+        EXPECT_EQ(resolved[table.id(i)], per_object(rm, objs[i].model_name)) << objs[i].model_name;
+    }
+
+    EXPECT_EQ(resolved[table.id(1)], "new\\oak.p3d");
+    EXPECT_EQ(resolved[table.id(3)], "new\\road.p3d");
+    EXPECT_EQ(resolved[table.id(4)], "");
+    EXPECT_EQ(resolved[table.id(6)], "new\\stone.p3d");
+    EXPECT_EQ(resolved[table.id(7)], "");
+    EXPECT_EQ(resolved[table.id(8)], "");
+}
+
+TEST(ReplacementMapTest, ResolveEmptyTable) {
+    ReplacementMap rm;
+    rm.add_entry("a.p3d", "b.p3d");
+    EXPECT_TRUE(rm.resolve(ModelTable::build({})).empty());
+}
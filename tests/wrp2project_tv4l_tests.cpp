@@ -0,0 +1,467 @@
+#include "project.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+void write_tv4l(ProjectInfo& p);
+
+// write_tv4l hands every layer to write_alb1_file (tv4p.cpp); capture the
+// payloads instead of writing files.
+namespace {
+std::mutex g_files_mu;
+std::map<std::string, std::vector<uint8_t>> g_files;
+}  // namespace
+
+void write_alb1_file(const std::string& path, const std::vector<uint8_t>& payload) {
+    std::lock_guard lock(g_files_mu);
+    g_files[fs::path(path).filename().string()] = payload;
+}
+
+namespace {
+
+struct Reader {
+    const std::vector<uint8_t>& data;
+    size_t pos = 0;
+
+    template <typename T>
+    T get() {
+        if (pos + sizeof(T) > data.size()) throw std::runtime_error("read past end");
+        T v;
+        std::memcpy(&v, data.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return v;
+    }
+    std::vector<uint8_t> bytes(size_t n) {
+        if (pos + n > data.size()) throw std::runtime_error("read past end");
+        std::vector<uint8_t> out(data.begin() + static_cast<std::ptrdiff_t>(pos),
+                                 data.begin() + static_cast<std::ptrdiff_t>(pos + n));
+        pos += n;
+        return out;
+    }
+};
+
+// Layer is the CLayer record of one captured .tv4l payload.
+struct Layer {
+    uint32_t ptr = 0;
+    std::string name;
+    uint32_t object_count = 0;
+    uint32_t layer_id = 0;
+    std::vector<uint8_t> tree;
+};
+
+Layer parse_layer(const std::vector<uint8_t>& payload) {
+    Reader r{payload};
+    Layer layer;
+    EXPECT_EQ(r.get<uint8_t>(), 0x05); // CLayer
+    r.get<uint8_t>();
+    layer.ptr = r.get<uint32_t>();
+    while (r.pos < payload.size()) {
+        auto tag = r.get<uint8_t>();
+        r.get<uint8_t>();
+        auto type = r.get<uint8_t>();
+        uint32_t u32 = 0;
+        std::vector<uint8_t> bytes;
+        switch (type) {
+        case 0x01: case 0x09: r.get<uint8_t>(); break;
+        case 0x05: case 0x06: case 0x07: case 0x0A: u32 = r.get<uint32_t>(); break;
+        case 0x0B: bytes = r.bytes(r.get<uint16_t>()); break;
+        case 0x0C: case 0x0D: bytes = r.bytes(r.get<uint32_t>()); break;
+        default: throw std::runtime_error("unknown tag type");
+        }
+        if (tag == 0x0A) layer.name.assign(bytes.begin(), bytes.end());
+        if (tag == 0x21) layer.object_count = u32;
+        if (tag == 0x22) layer.tree = std::move(bytes);
+        if (tag == 0x24) layer.layer_id = u32;
+    }
+    return layer;
+}
+
+struct BBox {
+    double min_x, min_y, max_x, max_y;
+
+    bool operator==(const BBox&) const = default;
+
+    // TB child order: 0=SE, 1=NE, 2=SW, 3=NW.
+    BBox child(int c) const {
+        double mid_x = (min_x + max_x) / 2;
+        double mid_y = (min_y + max_y) / 2;
+        switch (c) {
+        case 0: return {mid_x, min_y, max_x, mid_y};
+        case 1: return {mid_x, mid_y, max_x, max_y};
+        case 2: return {min_x, min_y, mid_x, mid_y};
+        default: return {min_x, mid_y, mid_x, max_y};
+        }
+    }
+    int quadrant(double x, double y) const {
+        double mid_x = (min_x + max_x) / 2;
+        double mid_y = (min_y + max_y) / 2;
+        if (x >= mid_x) return y < mid_y ? 0 : 1;
+        return y < mid_y ? 2 : 3;
+    }
+};
+
+struct Obj {
+    double x, y;
+    float z, yaw, pitch, roll, scale;
+    uint32_t id;
+    uint32_t hash;
+    std::vector<int> path; // quadrant at every depth below the root
+};
+
+// Tree walks a serialized layer tree, checks the node rules on the way and
+// collects the objects with the quadrant path of their leaf.
+struct Tree {
+    BBox root{};
+    std::vector<Obj> objects;
+    size_t leaves = 0;
+    size_t max_leaf_depth = 0;
+
+    explicit Tree(const std::vector<uint8_t>& blob) {
+        Reader r{blob};
+        auto payload_size = r.get<uint32_t>();
+        EXPECT_EQ(payload_size, blob.size() - 4);
+        std::vector<int> path;
+        inner(r, nullptr, 0, path);
+        EXPECT_EQ(r.pos, blob.size());
+    }
+
+    static BBox bbox(Reader& r) {
+        BBox b{};
+        b.min_y = r.get<double>();
+        b.min_x = r.get<double>();
+        b.max_y = r.get<double>();
+        b.max_x = r.get<double>();
+        return b;
+    }
+
+    size_t inner(Reader& r, const BBox* expect, int depth, std::vector<int>& path) {
+        auto type = r.get<uint8_t>();
+        BBox b = bbox(r);
+        if (expect) {
+            EXPECT_EQ(b, *expect);
+        } else {
+            root = b;
+        }
+        EXPECT_EQ(r.get<int32_t>(), depth);
+        EXPECT_EQ(r.get<int32_t>(), 0);
+        auto mask = r.get<uint8_t>();
+        if (depth < 8) {
+            EXPECT_EQ(type, 0x01);
+            EXPECT_EQ(mask, 0x0F);
+        }
+        if (type == 0xFF) {
+            EXPECT_EQ(depth, 8);
+            EXPECT_EQ(mask, 0);
+        }
+        size_t count = 0;
+        for (int c = 0; c < 4; c++) {
+            if ((mask & (1 << c)) == 0) continue;
+            BBox cb = b.child(c);
+            path.push_back(c);
+            size_t n = type == 0x10 ? leaf(r, cb, depth + 1, path) : inner(r, &cb, depth + 1, path);
+            path.pop_back();
+            // Only the dense upper levels keep empty children.
+            if (depth >= 8) {
+                EXPECT_GT(n, 0u);
+            }
+            count += n;
+        }
+        if (type == 0x01 && depth >= 8) {
+            EXPECT_GT(count, 16u);
+        }
+        if (type == 0x10) {
+            EXPECT_TRUE(count <= 16 || depth + 1 == 14);
+        }
+        return count;
+    }
+
+    size_t leaf(Reader& r, const BBox& expect, int depth, const std::vector<int>& path) {
+        leaves++;
+        max_leaf_depth = std::max(max_leaf_depth, static_cast<size_t>(depth));
+        EXPECT_EQ(bbox(r), expect);
+        EXPECT_EQ(r.get<int32_t>(), depth);
+        auto first_hash = static_cast<uint32_t>(r.get<int32_t>());
+        auto groups = r.get<int32_t>();
+        EXPECT_GT(groups, 0);
+        size_t count = 0;
+        uint32_t prev_hash = 0;
+        for (int g = 0; g < groups; g++) {
+            auto n = r.get<int32_t>();
+            auto hash = r.get<uint32_t>();
+            EXPECT_GT(n, 0);
+            if (g == 0) {
+                EXPECT_EQ(hash, first_hash);
+            } else {
+                EXPECT_GT(hash, prev_hash);
+            }
+            prev_hash = hash;
+            uint32_t prev_id = 0;
+            for (int i = 0; i < n; i++) {
+                Obj o{};
+                o.x = r.get<double>();
+                o.y = r.get<double>();
+                o.yaw = r.get<float>();
+                o.pitch = r.get<float>();
+                o.roll = r.get<float>();
+                o.scale = r.get<float>();
+                o.z = r.get<float>();
+                o.id = r.get<uint32_t>();
+                o.hash = hash;
+                o.path = path;
+                // A group keeps the layer's object order.
+                if (i > 0) {
+                    EXPECT_GT(o.id, prev_id);
+                }
+                prev_id = o.id;
+                objects.push_back(std::move(o));
+            }
+            count += static_cast<size_t>(n);
+        }
+        return count;
+    }
+};
+
+// Reference serializer: the per-node copying writer TreeWriter replaced.
+struct Reference {
+    std::vector<uint8_t> buf;
+
+    template <typename T>
+    void put(T v) {
+        auto p = reinterpret_cast<const uint8_t*>(&v);
+        buf.insert(buf.end(), p, p + sizeof(T));
+    }
+    void put_bbox(const BBox& b) {
+        put(b.min_y);
+        put(b.min_x);
+        put(b.max_y);
+        put(b.max_x);
+    }
+
+    void leaf(const BBox& b, int depth, const std::vector<Obj>& objs) {
+        std::map<uint32_t, std::vector<Obj>> by_hash;
+        for (const auto& o : objs) by_hash[o.hash].push_back(o);
+        put_bbox(b);
+        put(static_cast<int32_t>(depth));
+        put(static_cast<int32_t>(by_hash.begin()->first));
+        put(static_cast<int32_t>(by_hash.size()));
+        for (const auto& [hash, group] : by_hash) {
+            put(static_cast<int32_t>(group.size()));
+            put(hash);
+            for (const auto& o : group) {
+                put(o.x);
+                put(o.y);
+                put(o.yaw);
+                put(o.pitch);
+                put(o.roll);
+                put(o.scale);
+                put(o.z);
+                put(o.id);
+            }
+        }
+    }
+
+    void inner(const BBox& b, int depth, const std::vector<Obj>& objs) {
+        std::array<std::vector<Obj>, 4> children;
+        for (const auto& o : objs) children[static_cast<size_t>(b.quadrant(o.x, o.y))].push_back(o);
+        uint8_t type = 0x01;
+        uint8_t mask = 0;
+        if (depth < 8) {
+            mask = 0x0F;
+        } else if (depth == 8 && objs.empty()) {
+            type = 0xFF;
+        } else {
+            for (size_t c = 0; c < 4; c++)
+                if (!children[c].empty()) mask = static_cast<uint8_t>(mask | (1u << c));
+            type = (depth + 1 >= 14 || objs.size() <= 16) ? 0x10 : 0x01;
+        }
+        put(type);
+        put_bbox(b);
+        put(static_cast<int32_t>(depth));
+        put(static_cast<int32_t>(0));
+        put(mask);
+        for (size_t c = 0; c < 4; c++) {
+            if ((mask & (1u << c)) == 0) continue;
+            if (type == 0x10) leaf(b.child(static_cast<int>(c)), depth + 1, children[c]);
+            else inner(b.child(static_cast<int>(c)), depth + 1, children[c]);
+        }
+    }
+
+    static std::vector<uint8_t> serialize(const BBox& root, const std::vector<Obj>& objs) {
+        Reference ref;
+        ref.put(uint32_t{0});
+        ref.inner(root, 0, objs);
+        auto size = static_cast<uint32_t>(ref.buf.size() - 4);
+        std::memcpy(ref.buf.data(), &size, 4);
+        return ref.buf;
+    }
+};
+
+const std::vector<std::string> kModels = {"tree_a", "tree_b", "bush", "rock", "Rock"};
+
+// A layer of n objects: a tight cluster (down to the deepest level), a
+// stack of objects at one position, a spread over the layer bbox and a
+// few points outside it.
+std::vector<LayerObject> layer_objects(std::mt19937& rng, size_t n, double cx) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<LayerObject> objs;
+    for (size_t i = 0; i < n; i++) {
+        LayerObject o;
+        switch (i % 4) {
+        case 0: o.x = cx + 1000 + unit(rng) * 8; o.y = 500000 + unit(rng) * 8; break;
+        case 1: o.x = cx - 2000; o.y = 700000; break;
+        case 2: o.x = cx - 440000 + unit(rng) * 880000; o.y = unit(rng) * 1340000; break;
+        default: o.x = cx + (unit(rng) - 0.5) * 2000000; o.y = -1000 - unit(rng) * 1000; break;
+        }
+        o.z = unit(rng) * 100;
+        o.yaw = unit(rng) * 1000 - 500;
+        o.pitch = unit(rng) * 20 - 10;
+        o.roll = unit(rng) * 20 - 10;
+        o.scale = 0.5 + unit(rng);
+        o.model_name = kModels[rng() % kModels.size()];
+        objs.push_back(o);
+    }
+    return objs;
+}
+
+class Tv4lTest : public ::testing::Test {
+protected:
+    fs::path dir;
+    ProjectInfo p;
+
+    void SetUp() override {
+        dir = fs::temp_directory_path() / "armatools_tv4l_test";
+        fs::remove_all(dir);
+        p.name = "Test";
+        p.output_dir = dir.string();
+        std::lock_guard lock(g_files_mu);
+        g_files.clear();
+    }
+    void TearDown() override { fs::remove_all(dir); }
+
+    Layer layer(const std::string& file) {
+        std::lock_guard lock(g_files_mu);
+        auto it = g_files.find(file);
+        if (it == g_files.end()) throw std::runtime_error("no layer " + file);
+        return parse_layer(it->second);
+    }
+};
+
+}  // namespace
+
+TEST_F(Tv4lTest, TreeMatchesReferenceWriter) {
+    std::mt19937 rng(1);
+    for (size_t n : {0u, 1u, 17u, 300u, 5000u}) {
+        auto name = "layer " + std::to_string(n);
+        p.categories = {name};
+        p.cat_objects[name] = layer_objects(rng, n, 0);
+        write_tv4l(p);
+
+        auto l = layer("layer_" + std::to_string(n) + ".tv4l");
+        ASSERT_EQ(l.object_count, n);
+        Tree tree(l.tree);
+        ASSERT_EQ(tree.objects.size(), n);
+
+        const auto& src = p.cat_objects[name];
+        std::vector<Obj> objs(n);
+        for (auto& o : tree.objects) {
+            ASSERT_GE(o.id, 10000u);
+            size_t i = o.id - 10000;
+            ASSERT_LT(i, n);
+            EXPECT_EQ(objs[i].id, 0u) << "object " << i << " written twice";
+            EXPECT_EQ(o.x, src[i].x);
+            EXPECT_EQ(o.y, src[i].y);
+            EXPECT_EQ(o.hash, armatools::tb::sdbm_hash(src[i].model_name));
+            EXPECT_GE(o.yaw, 0.0f);
+            EXPECT_LT(o.yaw, 360.0f);
+            // The leaf is the one the object's quadrant path leads to.
+            BBox b = tree.root;
+            for (int c : o.path) {
+                EXPECT_EQ(b.quadrant(o.x, o.y), c) << "object " << i;
+                b = b.child(c);
+            }
+            objs[i] = o;
+        }
+        if (n >= 300) {
+            EXPECT_EQ(tree.max_leaf_depth, 14u);
+        }
+        EXPECT_EQ(l.tree, Reference::serialize(tree.root, objs)) << n;
+    }
+}
+
+TEST_F(Tv4lTest, LeafGroupsByTemplateHash) {
+    // One leaf: the groups come out in hash order, each in layer order.
+    std::vector<std::string> models = {"b", "a", "b", "c", "a", "b"};
+    auto& objs = p.cat_objects["grouped"];
+    for (size_t i = 0; i < models.size(); i++) {
+        LayerObject o;
+        o.x = 100000 + static_cast<double>(i);
+        o.y = 600000;
+        o.model_name = models[i];
+        objs.push_back(o);
+    }
+    p.categories = {"grouped"};
+    write_tv4l(p);
+
+    Tree tree(layer("grouped.tv4l").tree);
+    EXPECT_EQ(tree.leaves, 1u);
+    ASSERT_EQ(tree.objects.size(), models.size());
+    std::vector<size_t> order(models.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return armatools::tb::sdbm_hash(models[a]) < armatools::tb::sdbm_hash(models[b]);
+    });
+    for (size_t i = 0; i < order.size(); i++) EXPECT_EQ(tree.objects[i].id, 10000 + order[i]) << i;
+}
+
+TEST_F(Tv4lTest, ParallelLayersKeepPointerOrder) {
+    // Layers are written concurrently; pointers and ids still follow the
+    // category order, and the output does not depend on scheduling.
+    std::mt19937 rng(2);
+    constexpr uint32_t active = 0x20000;
+    constexpr size_t layers = 24;
+    for (size_t i = 0; i < layers; i++) {
+        auto name = "cat " + std::to_string(i);
+        p.categories.push_back(name);
+        p.cat_objects[name] = layer_objects(rng, 50 + i * 40, 0);
+        p.cat_lib_names[name] = "lib_" + std::to_string(i);
+    }
+    p.active_layer_ptr = active;
+    write_tv4l(p);
+
+    std::map<std::string, std::vector<uint8_t>> first;
+    {
+        std::lock_guard lock(g_files_mu);
+        first = g_files;
+    }
+    ASSERT_EQ(first.size(), layers + 1);
+    auto def = layer("default.tv4l");
+    EXPECT_EQ(def.ptr, 0x10008u);
+    EXPECT_EQ(def.layer_id, 1u);
+    EXPECT_EQ(def.object_count, 0u);
+    for (size_t i = 0; i < layers; i++) {
+        auto l = layer("cat_" + std::to_string(i) + ".tv4l");
+        EXPECT_EQ(l.name, "cat_" + std::to_string(i));
+        EXPECT_EQ(l.layer_id, 2 + i);
+        EXPECT_EQ(l.ptr, i == 0 ? active : 0x10008u + 8 * static_cast<uint32_t>(i)) << i;
+        EXPECT_EQ(l.object_count, 50 + i * 40);
+    }
+    EXPECT_EQ(p.next_alb1_ptr_counter, 0x10008u + 8 * (layers - 1));
+
+    p.next_alb1_ptr_counter = 0x10000;
+    write_tv4l(p);
+    std::lock_guard lock(g_files_mu);
+    EXPECT_TRUE(g_files == first);
+}
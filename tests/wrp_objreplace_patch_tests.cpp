@@ -0,0 +1,213 @@
+#include "wrp_patch.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Bytes {
+    std::string s;
+    void u8(uint8_t v) { s.push_back(static_cast<char>(v)); }
+    void u16(uint16_t v) { s.append(reinterpret_cast<const char*>(&v), 2); }
+    void u32(uint32_t v) { s.append(reinterpret_cast<const char*>(&v), 4); }
+    void f32(float v) { s.append(reinterpret_cast<const char*>(&v), 4); }
+    void asciiz(const std::string& v) { s.append(v.c_str(), v.size() + 1); }
+    void fill(size_t n, uint8_t seed) {
+        for (size_t i = 0; i < n; ++i) u8(static_cast<uint8_t>(seed + i * 13));
+    }
+    void leaf_quad_tree(uint32_t value) {
+        u8(0);
+        u32(value);
+    }
+    void transform(float x, float z) {
+        for (float v : {1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, x, 5.0f, z}) f32(v);
+    }
+};
+
+const std::vector<std::string> kModels = {"a\\rock.p3d", "a\\tree.p3d", "a\\bush.p3d"};
+const std::vector<uint32_t> kObjectModels = {0, 1, 2, 1, 0, 2, 2};
+
+// OPRW v20 (classed models, road net and map info around the object
+// records) on a 2x2 grid with raw (uncompressed) sections.
+std::string modern_wrp() {
+    Bytes b;
+    b.s = "OPRW";
+    b.u32(20);
+    for (uint32_t v : {2u, 2u, 2u, 2u}) b.u32(v);
+    b.f32(50.0f);
+    b.leaf_quad_tree(0x00010002); // geography
+    b.leaf_quad_tree(0x03030303); // sound map
+    b.u32(1);                     // peaks
+    for (float v : {10.0f, 20.0f, 30.0f}) b.f32(v);
+    b.leaf_quad_tree(0); // materials
+    b.fill(8, 1);        // random
+    b.fill(4, 2);        // grass approx
+    for (float v : {1.0f, 2.0f, 3.0f, 4.0f}) b.f32(v);
+    b.u32(0); // material names
+    b.u32(static_cast<uint32_t>(kModels.size()));
+    for (const auto& m : kModels) b.asciiz(m);
+    b.u32(1); // classed models
+    b.asciiz("Land_Lamp");
+    b.asciiz("a\\lamp.p3d");
+    for (float v : {1.0f, 2.0f, 3.0f}) b.f32(v);
+    b.u32(7);
+    b.leaf_quad_tree(0x11111111); // object offsets
+    b.u32(static_cast<uint32_t>(kObjectModels.size() * 60));
+    b.leaf_quad_tree(0x22222222); // map object offsets
+    b.u32(16);                    // map info size
+    b.fill(4, 3);                 // persistent
+    b.fill(4, 4);                 // subdivision hints
+    b.u32(100);                   // max object id
+    b.u32(0);                     // road net size
+    b.u32(1);                     // cell 0: one road link
+    b.u16(2);
+    for (float v : {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 12.0f}) b.f32(v);
+    b.u32(42);
+    b.asciiz("a\\road.p3d");
+    b.transform(0.0f, 6.0f);
+    for (int i = 0; i < 3; ++i) b.u32(0);
+    for (size_t i = 0; i < kObjectModels.size(); ++i) {
+        b.u32(static_cast<uint32_t>(i + 1));
+        b.u32(kObjectModels[i]);
+        b.transform(static_cast<float>(i) * 10.0f, 3.0f);
+        b.u32(static_cast<uint32_t>(0xAB00 + i)); // shape param
+    }
+    b.u32(0); // map info: one type-0 entry
+    b.u32(9);
+    b.f32(1.0f);
+    b.f32(2.0f);
+    return b.s;
+}
+
+// Legacy OPRW v3 on a 4x4 grid: objects end with a 0xFFFFFFFF sentinel.
+std::string legacy_wrp() {
+    Bytes b;
+    b.s = "OPRW";
+    b.u32(3);
+    for (uint32_t v : {4u, 4u, 4u, 4u}) b.u32(v);
+    b.fill(64, 5); // cell flags
+    b.fill(16, 6); // env sounds
+    b.u32(0);      // peaks
+    b.fill(32, 0); // texture indexes
+    b.fill(64, 7); // ext flags
+    for (int i = 0; i < 16; ++i) b.f32(static_cast<float>(i));
+    b.u32(1);
+    b.asciiz("a\\ground.paa");
+    b.u8(9);
+    b.u32(static_cast<uint32_t>(kModels.size()));
+    for (const auto& m : kModels) b.asciiz(m);
+    for (size_t i = 0; i < kObjectModels.size(); ++i) {
+        b.u32(static_cast<uint32_t>(i + 1));
+        b.u32(kObjectModels[i]);
+        b.transform(static_cast<float>(i) * 10.0f, 3.0f);
+    }
+    b.u32(0xFFFFFFFF);
+    return b.s;
+}
+
+std::string read_file(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+armatools::wrp::WorldData read_wrp(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return armatools::wrp::read(in);
+}
+
+// Patches data with a table that renames tree.p3d and folds bush.p3d into
+// rock.p3d, then checks the result byte range by byte range.
+void check_patch(const std::string& data, const std::string& name) {
+    auto dir = fs::temp_directory_path() / ("armatools_wrp_patch_test_" + name);
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    auto input = dir / "in.wrp";
+    auto output = dir / "out.wrp";
+    std::ofstream(input, std::ios::binary) << data;
+
+    auto before = read_wrp(input);
+    ASSERT_EQ(before.models, kModels);
+    ASSERT_EQ(before.objects.size(), kObjectModels.size());
+    const auto& layout = before.layout;
+
+    ModelTablePatch patch;
+    patch.names = {"a\\rock.p3d", "b\\oak_big.p3d"};
+    patch.remap = {0, 1, 0};
+    auto result = patch_wrp(input, output, layout, patch);
+    EXPECT_EQ(result.objects, kObjectModels.size());
+    EXPECT_EQ(result.objects_per_model, (std::vector<uint64_t>{2, 2, 3}));
+
+    auto after = read_wrp(output);
+    EXPECT_EQ(after.models, patch.names);
+    ASSERT_EQ(after.objects.size(), before.objects.size());
+    for (size_t i = 0; i < after.objects.size(); ++i) {
+        EXPECT_EQ(after.objects[i].model_index, static_cast<int>(patch.remap[kObjectModels[i]])) << i;
+        EXPECT_EQ(after.objects[i].object_id, before.objects[i].object_id);
+        EXPECT_EQ(after.objects[i].transform, before.objects[i].transform);
+    }
+    EXPECT_EQ(after.classed_models.size(), before.classed_models.size());
+    ASSERT_EQ(after.road_links.size(), before.road_links.size());
+    for (size_t i = 0; i < after.road_links.size(); ++i) {
+        ASSERT_EQ(after.road_links[i].size(), before.road_links[i].size());
+        for (size_t j = 0; j < after.road_links[i].size(); ++j) {
+            EXPECT_EQ(after.road_links[i][j].object_id, before.road_links[i][j].object_id);
+            EXPECT_EQ(after.road_links[i][j].p3d_path, before.road_links[i][j].p3d_path);
+        }
+    }
+    EXPECT_EQ(after.map_info, before.map_info);
+
+    // Everything but the model table and the object model indexes is
+    // byte-identical; the rest of the file only shifts with the table.
+    std::string out = read_file(output);
+    EXPECT_EQ(result.bytes_written, out.size());
+    auto models_offset = static_cast<size_t>(layout.models_offset);
+    auto models_end = static_cast<size_t>(layout.models_end);
+    size_t new_table = 4 + std::string("a\\rock.p3d").size() + 1 + std::string("b\\oak_big.p3d").size() + 1;
+    ASSERT_EQ(out.size(), data.size() - (models_end - models_offset) + new_table);
+    EXPECT_EQ(out.substr(0, models_offset), data.substr(0, models_offset));
+
+    std::string tail_in = data.substr(models_end);
+    std::string tail_out = out.substr(models_offset + new_table);
+    auto objects = static_cast<size_t>(layout.objects_offset) - models_end;
+    auto rec = static_cast<size_t>(layout.object_record_size);
+    for (size_t i = 0; i < kObjectModels.size(); ++i) {
+        size_t field = objects + i * rec + 4;
+        uint32_t idx;
+        std::memcpy(&idx, tail_out.data() + field, 4);
+        EXPECT_EQ(idx, patch.remap[kObjectModels[i]]);
+        tail_in.replace(field, 4, 4, '\0');
+        tail_out.replace(field, 4, 4, '\0');
+    }
+    EXPECT_EQ(tail_out, tail_in);
+
+    // Patching in place gives the same file.
+    patch_wrp(input, input, layout, patch);
+    EXPECT_EQ(read_file(input), out);
+    EXPECT_FALSE(fs::exists(dir / "in.wrp.tmp"));
+    fs::remove_all(dir);
+}
+
+}  // namespace
+
+TEST(WrpPatchTest, ModernRoundTrip) {
+    check_patch(modern_wrp(), "modern");
+}
+
+TEST(WrpPatchTest, LegacyRoundTrip) {
+    check_patch(legacy_wrp(), "legacy");
+}
+
+TEST(WrpPatchTest, RejectsUnknownLayout) {
+    ModelTablePatch patch;
+    armatools::wrp::LayoutInfo layout;
+    EXPECT_THROW(patch_wrp("missing.wrp", "out.wrp", layout, patch), std::runtime_error);
+}
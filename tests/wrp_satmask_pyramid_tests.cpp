@@ -0,0 +1,219 @@
+#include "pyramid_writer.h"
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <zlib.h>
+
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int kWidth = 601;
+constexpr int kHeight = 301;
+
+// Test mosaic: a position-dependent pattern, transparent in the area of
+// the bottom-right tile of the deepest level.
+std::array<uint8_t, 4> source_pixel(int x, int y) {
+    if (x >= 512 && y >= 256) return {0, 0, 0, 0};
+    return {static_cast<uint8_t>(x * 7 + y * 3), static_cast<uint8_t>(x ^ y),
+            static_cast<uint8_t>(x * y), 255};
+}
+
+// The 2x2 box filter over the samples that exist, rounded half up.
+std::array<uint8_t, 4> halved_pixel(int x, int y) {
+    std::array<unsigned, 4> sum{};
+    unsigned count = 0;
+    for (int sy = 2 * y; sy < std::min(2 * y + 2, kHeight); ++sy) {
+        for (int sx = 2 * x; sx < std::min(2 * x + 2, kWidth); ++sx) {
+            auto p = source_pixel(sx, sy);
+            for (size_t c = 0; c < 4; ++c) sum[c] += p[c];
+            ++count;
+        }
+    }
+    std::array<uint8_t, 4> out{};
+    for (size_t c = 0; c < 4; ++c) out[c] = static_cast<uint8_t>((sum[c] + count / 2) / count);
+    return out;
+}
+
+PyramidOptions test_options(PyramidFormat format) {
+    PyramidOptions opts;
+    opts.format = format;
+    opts.threads = 2;
+    opts.encode.filter = armatools::png::Filter::None;
+    opts.name = "test layer";
+    return opts;
+}
+
+size_t write_mosaic(const fs::path& path, const PyramidOptions& opts) {
+    PyramidWriter writer(path, kWidth, kHeight, opts);
+    EXPECT_EQ(writer.max_zoom(), 2);
+    std::vector<uint8_t> row(static_cast<size_t>(kWidth) * 4);
+    for (int y = 0; y < kHeight; ++y) {
+        for (int x = 0; x < kWidth; ++x) {
+            auto p = source_pixel(x, y);
+            std::memcpy(row.data() + static_cast<size_t>(x) * 4, p.data(), 4);
+        }
+        writer.write_row(row);
+    }
+    writer.finish();
+    return writer.tiles_written();
+}
+
+uint32_t get_u32be(const uint8_t* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+// Decodes an RGBA tile written with Filter::None.
+std::vector<uint8_t> decode_tile(const std::string& file, uint32_t size) {
+    auto bytes = reinterpret_cast<const uint8_t*>(file.data());
+    std::vector<uint8_t> zdata;
+    for (size_t pos = 8; pos + 12 <= file.size();) {
+        uint32_t len = get_u32be(bytes + pos);
+        if (std::memcmp(bytes + pos + 4, "IHDR", 4) == 0) {
+            EXPECT_EQ(get_u32be(bytes + pos + 8), size);
+            EXPECT_EQ(get_u32be(bytes + pos + 12), size);
+        } else if (std::memcmp(bytes + pos + 4, "IDAT", 4) == 0) {
+            zdata.insert(zdata.end(), bytes + pos + 8, bytes + pos + 8 + len);
+        }
+        pos += 12 + len;
+    }
+    size_t stride = size_t{size} * 4;
+    std::vector<uint8_t> raw(size * (stride + 1));
+    uLongf raw_len = static_cast<uLongf>(raw.size());
+    EXPECT_EQ(uncompress(raw.data(), &raw_len, zdata.data(), static_cast<uLong>(zdata.size())), Z_OK);
+    std::vector<uint8_t> pixels(size * stride);
+    for (size_t y = 0; y < size; ++y) {
+        EXPECT_EQ(raw[y * (stride + 1)], 0);
+        std::memcpy(pixels.data() + y * stride, raw.data() + y * (stride + 1) + 1, stride);
+    }
+    return pixels;
+}
+
+std::string read_file(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+struct TempDir {
+    fs::path path;
+    explicit TempDir(const std::string& name)
+        : path(fs::temp_directory_path() / ("armatools_pyramid_test_" + name)) {
+        fs::remove_all(path);
+        fs::create_directories(path);
+    }
+    ~TempDir() {
+        std::error_code ec;
+        fs::remove_all(path, ec);
+    }
+};
+
+}  // namespace
+
+TEST(PyramidWriterTest, XyzTilesPerZoomAndDownsample) {
+    TempDir dir("xyz");
+    auto out = pyramid_path(dir.path, "sat", PyramidFormat::Xyz);
+    size_t written = write_mosaic(out, test_options(PyramidFormat::Xyz));
+
+    // z2: 601x301 in 3x2 tiles, one of them transparent; z1: 301x151 in
+    // 2x1; z0: 151x76 in one tile.
+    std::map<int, std::set<std::pair<int, int>>> tiles;
+    for (const auto& e : fs::recursive_directory_iterator(out)) {
+        if (e.path().extension() != ".png") continue;
+        auto rel = fs::relative(e.path(), out);
+        auto it = rel.begin();
+        int z = std::stoi((it++)->string());
+        int x = std::stoi((it++)->string());
+        int y = std::stoi(it->stem().string());
+        tiles[z].insert({x, y});
+    }
+    EXPECT_EQ(tiles[2], (std::set<std::pair<int, int>>{{0, 0}, {1, 0}, {2, 0}, {0, 1}, {1, 1}}));
+    EXPECT_EQ(tiles[1], (std::set<std::pair<int, int>>{{0, 0}, {1, 0}}));
+    EXPECT_EQ(tiles[0], (std::set<std::pair<int, int>>{{0, 0}}));
+    EXPECT_EQ(written, 8u);
+
+    // Full resolution at z2, one box-filter step at z1, including the odd
+    // right and bottom edges.
+    auto z2 = decode_tile(read_file(out / "2" / "1" / "1.png"), 256);
+    for (int y = 0; y < 256; ++y) {
+        for (int x = 0; x < 256; ++x) {
+            auto expected = y + 256 < kHeight ? source_pixel(x + 256, y + 256) : std::array<uint8_t, 4>{};
+            ASSERT_EQ(std::memcmp(&z2[static_cast<size_t>(y * 256 + x) * 4], expected.data(), 4), 0)
+                << "z2 pixel " << x << "," << y;
+        }
+    }
+    auto z1 = decode_tile(read_file(out / "1" / "1" / "0.png"), 256);
+    for (int y = 0; y < 256; ++y) {
+        for (int x = 0; x < 256; ++x) {
+            bool inside = x + 256 < (kWidth + 1) / 2 && y < (kHeight + 1) / 2;
+            auto expected = inside ? halved_pixel(x + 256, y) : std::array<uint8_t, 4>{};
+            ASSERT_EQ(std::memcmp(&z1[static_cast<size_t>(y * 256 + x) * 4], expected.data(), 4), 0)
+                << "z1 pixel " << x << "," << y;
+        }
+    }
+
+    std::string meta = read_file(out / "metadata.json");
+    EXPECT_NE(meta.find("\"name\":\"test layer\""), std::string::npos);
+    EXPECT_NE(meta.find("\"maxzoom\":2"), std::string::npos);
+    EXPECT_NE(meta.find("\"width\":601,\"height\":301"), std::string::npos);
+}
+
+TEST(PyramidWriterTest, MBTilesMetadataAndTmsRows) {
+    TempDir dir("mbtiles");
+    auto xyz = pyramid_path(dir.path, "sat", PyramidFormat::Xyz);
+    auto mbtiles = pyramid_path(dir.path, "sat", PyramidFormat::MBTiles);
+    EXPECT_EQ(mbtiles.filename(), "sat.mbtiles");
+    write_mosaic(xyz, test_options(PyramidFormat::Xyz));
+    EXPECT_EQ(write_mosaic(mbtiles, test_options(PyramidFormat::MBTiles)), 8u);
+
+    sqlite3* db = nullptr;
+    ASSERT_EQ(sqlite3_open_v2(mbtiles.string().c_str(), &db, SQLITE_OPEN_READONLY, nullptr), SQLITE_OK);
+    auto text = [](sqlite3_stmt* stmt, int col) {
+        const char* v = reinterpret_cast<const char*>(sqlite3_column_text(stmt, col));
+        return std::string(v ? v : "");
+    };
+
+    std::map<std::string, std::string> meta;
+    sqlite3_stmt* stmt = nullptr;
+    ASSERT_EQ(sqlite3_prepare_v2(db, "SELECT name, value FROM metadata", -1, &stmt, nullptr), SQLITE_OK);
+    while (sqlite3_step(stmt) == SQLITE_ROW) meta[text(stmt, 0)] = text(stmt, 1);
+    sqlite3_finalize(stmt);
+    EXPECT_EQ(meta, (std::map<std::string, std::string>{
+                        {"name", "test layer"}, {"format", "png"}, {"type", "baselayer"},
+                        {"version", "1"}, {"minzoom", "0"}, {"maxzoom", "2"},
+                        {"tile_size", "256"}, {"width", "601"}, {"height", "301"}}));
+
+    // Rows count from the bottom; every tile matches the Xyz file of the
+    // flipped row.
+    std::set<std::tuple<int, int, int>> tiles;
+    ASSERT_EQ(sqlite3_prepare_v2(db, "SELECT zoom_level, tile_column, tile_row, tile_data FROM tiles", -1,
+                                 &stmt, nullptr),
+              SQLITE_OK);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int z = sqlite3_column_int(stmt, 0);
+        int x = sqlite3_column_int(stmt, 1);
+        int row = sqlite3_column_int(stmt, 2);
+        tiles.insert({z, x, row});
+        std::string data(static_cast<const char*>(sqlite3_column_blob(stmt, 3)),
+                         static_cast<size_t>(sqlite3_column_bytes(stmt, 3)));
+        int y = (1 << z) - 1 - row;
+        EXPECT_EQ(data, read_file(xyz / std::to_string(z) / std::to_string(x) / (std::to_string(y) + ".png")))
+            << z << "/" << x << "/" << y;
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+
+    EXPECT_EQ(tiles, (std::set<std::tuple<int, int, int>>{
+                         {2, 0, 3}, {2, 1, 3}, {2, 2, 3}, {2, 0, 2}, {2, 1, 2},
+                         {1, 0, 1}, {1, 1, 1}, {0, 0, 0}}));
+}
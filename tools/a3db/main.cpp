@@ -56,6 +56,8 @@ static void stderr_progress(const armatools::pboindex::BuildProgress& p) {
         std::cerr << std::format("\r[{:>{}}/{:d}] {} -- {} {}/{}: {}\033[K",
                                   p.pbo_index + 1, width, p.pbo_total, pbo_name,
                                   p.phase, p.file_index + 1, p.file_total, p.file_name);
+    } else if (p.phase == "config") {
+        std::cerr << std::format("\rMerging configs {}/{}: {}\033[K", p.file_index + 1, p.file_total, pbo_name);
     } else if (p.phase == "commit") {
         std::cerr << "\nCommitting...\n";
     }
@@ -70,7 +72,7 @@ static bool has_any_search_path(const Config& cfg) {
         || !cfg.ofp.empty() || !cfg.arma1.empty() || !cfg.arma2.empty();
 }
 
-static void do_build(const Config& cfg, bool on_demand) {
+static void do_build(const Config& cfg, bool on_demand, bool configs) {
     if (!has_any_search_path(cfg)) {
         std::cerr << "Error: no PBO search paths. Use -arma3, -workshop, -ofp, -arma1, -arma2, -config, or config mods[].\n";
         return;
@@ -81,11 +83,15 @@ static void do_build(const Config& cfg, bool on_demand) {
         return;
     }
 
-    armatools::pboindex::BuildOptions opts{.on_demand_metadata = on_demand};
+    armatools::pboindex::BuildOptions opts{.on_demand_metadata = on_demand, .index_configs = configs};
     try {
         auto result = armatools::pboindex::DB::build_db(cfg.db, cfg.arma3, cfg.workshop, cfg.mods, opts, stderr_progress, game_dirs_from_config(cfg));
         std::cerr << std::format("\nIndexed {} PBOs, {} files, {} P3D models, {} textures, {} audio files\n",
                                   result.pbo_count, result.file_count, result.p3d_count, result.paa_count, result.audio_count);
+        if (configs) {
+            std::cerr << std::format("Merged {} config files into {} classes\n",
+                                      result.config_count, result.config_class_count);
+        }
     } catch (const std::exception& e) {
         std::cerr << "Error: building database: " << e.what() << '\n';
         return;
@@ -98,7 +104,7 @@ static void do_build(const Config& cfg, bool on_demand) {
     }
 }
 
-static void do_update(Config cfg, bool on_demand) {
+static void do_update(Config cfg, bool on_demand, bool configs) {
     if (!has_any_search_path(cfg)) {
         std::cerr << "Error: no PBO search paths.\n";
         return;
@@ -110,16 +116,19 @@ static void do_update(Config cfg, bool on_demand) {
 
     if (!fs::exists(cfg.db)) {
         std::cerr << "No existing database found, doing full build.\n";
-        do_build(cfg, on_demand);
+        do_build(cfg, on_demand, configs);
         return;
     }
 
-    armatools::pboindex::BuildOptions opts{.on_demand_metadata = on_demand};
+    armatools::pboindex::BuildOptions opts{.on_demand_metadata = on_demand, .index_configs = configs};
     try {
         auto result = armatools::pboindex::DB::update_db(cfg.db, cfg.arma3, cfg.workshop, cfg.mods, opts, stderr_progress, game_dirs_from_config(cfg));
         std::cerr << std::format("\nAdded {}, updated {}, removed {} PBOs ({} files, {} P3D, {} textures, {} audio)\n",
                                   result.added, result.updated, result.removed,
                                   result.file_count, result.p3d_count, result.paa_count, result.audio_count);
+        if (result.config_class_count > 0) {
+            std::cerr << std::format("Merged config rebuilt: {} classes\n", result.config_class_count);
+        }
     } catch (const std::exception& e) {
         std::string msg = e.what();
         if (msg.find("schema version mismatch") != std::string::npos ||
@@ -129,7 +138,7 @@ static void do_update(Config cfg, bool on_demand) {
             fs::remove(cfg.db, ec);
             fs::remove(cfg.db + "-wal", ec);
             fs::remove(cfg.db + "-shm", ec);
-            do_build(cfg, on_demand);
+            do_build(cfg, on_demand, configs);
             return;
         }
         std::cerr << "Error: updating database: " << msg << '\n';
@@ -173,6 +182,58 @@ static void do_find(const std::string& db_path,
     std::cerr << "\n";
 }
 
+static void do_class(const std::string& db_path, const std::string& class_path, bool pretty) {
+    if (db_path.empty()) {
+        std::cerr << "Error: -db is required for -class.\n";
+        return;
+    }
+
+    auto db = armatools::pboindex::DB::open(db_path);
+    auto info = db.find_config_class(class_path);
+    if (!info) {
+        std::cerr << "No class " << class_path << '\n';
+        return;
+    }
+
+    json values = json::array();
+    for (const auto& v : info->values) {
+        values.push_back({
+            {"name", v.name},
+            {"type", v.type},
+            {"value", v.value},
+            {"inherited", v.inherited},
+        });
+    }
+    json out = {
+        {"path", info->path},
+        {"base", info->base},
+        {"pbo_path", info->pbo_path},
+        {"values", values},
+        {"classes", db.list_config_classes(info->path)},
+    };
+    if (pretty) std::cout << std::setw(2) << out << '\n';
+    else std::cout << out << '\n';
+}
+
+static void do_where(const std::string& db_path, const std::string& expr, bool pretty, size_t limit) {
+    if (db_path.empty()) {
+        std::cerr << "Error: -db is required for -where.\n";
+        return;
+    }
+    auto eq = expr.find('=');
+    if (eq == std::string::npos) {
+        std::cerr << "Error: -where expects name=value.\n";
+        return;
+    }
+
+    auto db = armatools::pboindex::DB::open(db_path);
+    auto paths = db.find_config_classes(expr.substr(0, eq), expr.substr(eq + 1), limit);
+    json arr = paths;
+    if (pretty) std::cout << std::setw(2) << arr << '\n';
+    else std::cout << arr << '\n';
+    std::cerr << "Found " << paths.size() << " classes\n";
+}
+
 static void do_info(const std::string& db_path) {
     if (db_path.empty()) {
         std::cerr << "Error: -db is required for -info.\n";
@@ -202,6 +263,10 @@ static void do_info(const std::string& db_path) {
     std::cout << "P3D models:     " << stats.p3d_model_count << '\n';
     std::cout << "Textures:       " << stats.texture_count << '\n';
     std::cout << "Audio files:    " << stats.audio_file_count << '\n';
+    if (stats.config_file_count > 0) {
+        std::cout << std::format("Configs:        {} files, {} merged classes\n",
+                                 stats.config_file_count, stats.config_class_count);
+    }
     std::cout << std::format("Total data:     {:.1f} MB\n", static_cast<double>(stats.total_data_size) / 1024 / 1024);
 }
 
@@ -212,7 +277,9 @@ static void print_usage() {
               << "  Build  (default)  Scan PBOs, write SQLite database\n"
               << "  Update (-update)  Incremental update (only changed PBOs)\n"
               << "  Find   (-find)    Search database for files\n"
-              << "  Info   (-info)    Show database statistics\n\n"
+              << "  Info   (-info)    Show database statistics\n"
+              << "  Class  (-class)   Show a class of the merged game config\n"
+              << "  Where  (-where)   Find config classes by property value\n\n"
               << "Flags:\n"
               << "  -config <path>    Config file with game paths (JSON)\n"
               << "  -arma3 <dir>      Arma 3 directory\n"
@@ -221,13 +288,16 @@ static void print_usage() {
               << "  -arma1 <dir>      Arma: Armed Assault directory\n"
               << "  -arma2 <dir>      Arma 2 directory\n"
               << "  -db <path>        Database file path\n"
-              << "  -ondemand         Skip eager P3D/PAA/audio parsing\n"
+              << "  -ondemand         Skip eager P3D/PAA/audio parsing\n"
+              << "  -configs          Index config.bin/config.cpp and merge all classes\n"
+              << "  -class <path>     Show a merged config class (CfgVehicles/Car)\n"
+              << "  -where <n=value>  Find config classes whose property n equals value\n"
               << "  -find <pattern>   Find files matching glob pattern\n"
-              << "  -limit <n>        Max rows for -find (0 = no limit)\n"
+              << "  -limit <n>        Max rows for -find and -where (0 = no limit)\n"
               << "  -offset <n>       Row offset for -find pagination\n"
               << "  -info             Show database statistics\n"
               << "  -update           Incremental update\n"
-              << "  --pretty          Pretty-print JSON output (for -find)\n";
+              << "  --pretty          Pretty-print JSON output (for -find, -class, -where)\n";
 }
 
 int main(int argc, char* argv[]) {
@@ -239,7 +309,10 @@ int main(int argc, char* argv[]) {
     std::string arma2_flag;
     std::string db_flag;
     bool on_demand = false;
+    bool configs = false;
     std::string find_pattern;
+    std::string class_path;
+    std::string where_expr;
     bool info_flag = false;
     bool update_flag = false;
     bool pretty = false;
@@ -256,6 +329,9 @@ int main(int argc, char* argv[]) {
         else if (std::strcmp(argv[i], "-arma2") == 0 && i + 1 < argc) arma2_flag = argv[++i];
         else if (std::strcmp(argv[i], "-db") == 0 && i + 1 < argc) db_flag = argv[++i];
         else if (std::strcmp(argv[i], "-ondemand") == 0) on_demand = true;
+        else if (std::strcmp(argv[i], "-configs") == 0) configs = true;
+        else if (std::strcmp(argv[i], "-class") == 0 && i + 1 < argc) class_path = argv[++i];
+        else if (std::strcmp(argv[i], "-where") == 0 && i + 1 < argc) where_expr = argv[++i];
         else if (std::strcmp(argv[i], "-find") == 0 && i + 1 < argc) find_pattern = argv[++i];
         else if (std::strcmp(argv[i], "-info") == 0) info_flag = true;
         else if (std::strcmp(argv[i], "-update") == 0) update_flag = true;
@@ -298,12 +374,26 @@ int main(int argc, char* argv[]) {
 
     if (!find_pattern.empty()) {
         do_find(cfg.db, find_pattern, pretty, find_limit, find_offset);
+    } else if (!class_path.empty()) {
+        try {
+            do_class(cfg.db, class_path, pretty);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << '\n';
+            return 1;
+        }
+    } else if (!where_expr.empty()) {
+        try {
+            do_where(cfg.db, where_expr, pretty, find_limit);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << '\n';
+            return 1;
+        }
     } else if (info_flag) {
         do_info(cfg.db);
     } else if (update_flag) {
-        do_update(cfg, on_demand);
+        do_update(cfg, on_demand, configs);
     } else {
-        do_build(cfg, on_demand);
+        do_build(cfg, on_demand, configs);
     }
 
     return 0;
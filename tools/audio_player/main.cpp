@@ -43,33 +43,37 @@ static const BackendEntry g_all_backends[] = {
 
 static constexpr size_t g_all_backends_count = sizeof(g_all_backends) / sizeof(g_all_backends[0]);
 
-struct PcmPlayback {
-    const uint8_t* data;
-    size_t size;
-    size_t pos;
+// WssPlayback decodes a WSS/WAV stream on the audio thread as the device
+// asks for frames, so playback starts without decoding the whole file.
+struct WssPlayback {
+    armatools::wss::Decoder& decoder;
+    std::atomic<bool> done{false};
 };
 
-static void pcm_callback(ma_device* device, void* output, const void* /*input*/, ma_uint32 frame_count) {
-    auto* pb = static_cast<PcmPlayback*>(device->pUserData);
-    size_t bytes_per_frame = static_cast<size_t>(device->playback.channels) * ma_get_bytes_per_sample(device->playback.format);
-    size_t bytes_needed = frame_count * bytes_per_frame;
-    size_t bytes_available = pb->size - pb->pos;
-    size_t to_copy = std::min(bytes_needed, bytes_available);
-
-    std::memcpy(output, pb->data + pb->pos, to_copy);
-    if (to_copy < bytes_needed)
-        std::memset(static_cast<uint8_t*>(output) + to_copy, 0, bytes_needed - to_copy);
-    pb->pos += to_copy;
+static void wss_callback(ma_device* device, void* output, const void* /*input*/, ma_uint32 frame_count) {
+    auto* pb = static_cast<WssPlayback*>(device->pUserData);
+    auto* out = static_cast<int16_t*>(output);
+    size_t ch = pb->decoder.frame_channels();
+    size_t got = 0;
+    if (!pb->done.load()) {
+        try {
+            got = pb->decoder.decode(out, frame_count);
+        } catch (const std::exception&) {
+            // A read error ends playback like the end of the stream.
+        }
+        if (got < frame_count) pb->done.store(true);
+    }
+    std::memset(out + got * ch, 0, (frame_count - got) * ch * sizeof(int16_t));
 }
 
-static int play_pcm(const armatools::wss::AudioData& ad, ma_context* ctx, const ma_device_id* dev_id) {
-    PcmPlayback pb{ad.pcm.data(), ad.pcm.size(), 0};
+static int play_decoder(armatools::wss::Decoder& decoder, ma_context* ctx, const ma_device_id* dev_id) {
+    WssPlayback pb{decoder};
 
     ma_device_config config = ma_device_config_init(ma_device_type_playback);
     config.playback.format = ma_format_s16;
-    config.playback.channels = ad.channels;
-    config.sampleRate = ad.sample_rate;
-    config.dataCallback = pcm_callback;
+    config.playback.channels = static_cast<ma_uint32>(decoder.frame_channels());
+    config.sampleRate = decoder.info().sample_rate;
+    config.dataCallback = wss_callback;
     config.pUserData = &pb;
     if (dev_id)
         config.playback.pDeviceID = dev_id;
@@ -90,7 +94,7 @@ static int play_pcm(const armatools::wss::AudioData& ad, ma_context* ctx, const
     }
 
     std::fprintf(stderr, "Playing... (Ctrl+C to stop)\n");
-    while (!g_stop.load() && pb.pos < pb.size)
+    while (!g_stop.load() && !pb.done.load())
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
 
     ma_device_uninit(&device);
@@ -176,12 +180,13 @@ static int play_wss(const std::string& path, ma_context* ctx, const ma_device_id
         return 1;
     }
     try {
-        auto ad = armatools::wss::read(f);
-        std::fprintf(stderr, "Format:      %s\n", ad.format.c_str());
-        std::fprintf(stderr, "Sample rate: %u Hz\n", ad.sample_rate);
-        std::fprintf(stderr, "Channels:    %u\n", ad.channels);
-        std::fprintf(stderr, "Duration:    %.2f s\n", ad.duration);
-        return play_pcm(ad, ctx, dev_id);
+        armatools::wss::Decoder decoder(f);
+        const auto& info = decoder.info();
+        std::fprintf(stderr, "Format:      %s\n", info.format.c_str());
+        std::fprintf(stderr, "Sample rate: %u Hz\n", info.sample_rate);
+        std::fprintf(stderr, "Channels:    %u\n", info.channels);
+        std::fprintf(stderr, "Duration:    %.2f s\n", info.duration);
+        return play_decoder(decoder, ctx, dev_id);
     } catch (const std::exception& e) {
         std::fprintf(stderr, "Error: %s\n", e.what());
         return 1;
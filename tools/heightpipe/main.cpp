@@ -26,6 +26,7 @@ struct Cli {
     bool meso = true;
     bool micro = true;
     uint32_t seed = 1;
+    int threads = 0;
     bool dump = false;
     std::string dump_slope;
     std::string dump_curv;
@@ -37,7 +38,7 @@ static void usage() {
         << "Usage: heightpipe <input.rawf32> <output.rawf32> --in-width N --in-height N\n"
         << "       --scale {2|4|8|16} --resample bicubic|lanczos3\n"
         << "       --correction preset|none|unsharp|curv_gain|residual|guided_sharp|hybrid|terrain_16x\n"
-        << "       --macro 0|1 --meso 0|1 --micro 0|1 --seed N\n"
+        << "       --macro 0|1 --meso 0|1 --micro 0|1 --seed N --threads N\n"
         << "       [--dump slope.raw curvature.raw flow.raw]\n\n"
         << "RAW format: little-endian float32 array, row-major, no header.\n";
 }
@@ -87,6 +88,7 @@ static int parse_cli(int argc, char** argv, Cli& cli) {
         else if (std::strcmp(argv[i], "--meso") == 0 && i + 1 < argc) cli.meso = parse_bool01(argv[++i]);
         else if (std::strcmp(argv[i], "--micro") == 0 && i + 1 < argc) cli.micro = parse_bool01(argv[++i]);
         else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) cli.seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) cli.threads = std::stoi(argv[++i]);
         else if (std::strcmp(argv[i], "--dump") == 0 && i + 3 < argc) {
             cli.dump = true;
             cli.dump_slope = argv[++i];
@@ -149,6 +151,7 @@ int main(int argc, char** argv) {
         opt.scale = cli.scale;
         opt.resample = cli.resample;
         opt.seed = cli.seed;
+        opt.threads = cli.threads;
         opt.dump_slope = cli.dump;
         opt.dump_curvature = cli.dump;
         opt.dump_flow = cli.dump;
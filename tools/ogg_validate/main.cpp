@@ -1,5 +1,8 @@
 #include "armatools/ogg.h"
+#include "armatools/parallel.h"
 #include "armatools/pbo.h"
+#include "armatools/pboindex.h"
+#include "armatools/wss.h"
 
 #include <nlohmann/json.hpp>
 
@@ -10,8 +13,12 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <map>
+#include <span>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 namespace fs = std::filesystem;
@@ -20,6 +27,7 @@ using json = nlohmann::ordered_json;
 struct Issue {
     std::string level;
     std::string message;
+    std::string check; // check name, or the failing step for errors
 };
 
 struct Result {
@@ -29,22 +37,41 @@ struct Result {
     int channels = 0;
     std::string status; // "ok", "info", "warn", "error"
     std::vector<Issue> issues;
+    std::string format;   // "OGG", or the WSS/WAV sample format
+    double duration = 0;  // WSS/WAV only
 };
 
-static Result validate_ogg_data(const std::vector<uint8_t>& data, const std::string& path) {
+static Result error_result(const std::string& path, const std::string& check, const std::string& message) {
+    return {path, "", 0, 0, "error", {{"error", std::format("{}: {}", check, message), check}}, "", 0};
+}
+
+static void set_status(Result& res) {
+    for (const auto& iss : res.issues) {
+        if (iss.level == "error") {
+            res.status = "error";
+        } else if (iss.level == "warn" && res.status != "error") {
+            res.status = "warn";
+        } else if (iss.level == "info" && res.status == "ok") {
+            res.status = "info";
+        }
+    }
+}
+
+// validate_ogg runs the checks on the header returned by read_header, which
+// only reads the Vorbis header pages.
+template <typename ReadHeader>
+static Result validate_ogg(const std::string& path, ReadHeader&& read_header) {
     Result res;
     res.path = path;
     res.status = "ok";
-
-    std::string str(data.begin(), data.end());
-    std::istringstream stream(str);
+    res.format = "OGG";
 
     armatools::ogg::Header hdr;
     try {
-        hdr = armatools::ogg::read_header(stream);
+        hdr = read_header();
     } catch (const std::exception& e) {
         res.status = "error";
-        res.issues.push_back({"error", std::format("parse: {}", e.what())});
+        res.issues.push_back({"error", std::format("parse: {}", e.what()), "parse"});
         return res;
     }
 
@@ -54,12 +81,12 @@ static Result validate_ogg_data(const std::vector<uint8_t>& data, const std::str
 
     // Check 1: Pre-1.0 encoder
     if (armatools::ogg::is_pre_one_encoder(hdr.encoder)) {
-        res.issues.push_back({"warn", std::format("pre-1.0 encoder ({})", hdr.encoder)});
+        res.issues.push_back({"warn", std::format("pre-1.0 encoder ({})", hdr.encoder), "old-encoder"});
     }
 
     // Check 2: Floor type 0
     if (hdr.floor_type == 0 && !hdr.codebooks.empty()) {
-        res.issues.push_back({"warn", "uses floor type 0"});
+        res.issues.push_back({"warn", "uses floor type 0", "floor-type-0"});
     }
 
     // Check 3: lookup1Values precision risk
@@ -68,37 +95,105 @@ static Result validate_ogg_data(const std::vector<uint8_t>& data, const std::str
         if (cb.lookup_type == 1 && armatools::ogg::lookup1_values_precision_risk(cb.entries, cb.dimensions)) {
             res.issues.push_back({"warn",
                 std::format("codebook {}: lookup1Values precision risk (entries={}, dims={})",
-                            i, cb.entries, cb.dimensions)});
+                            i, cb.entries, cb.dimensions), "lookup1values"});
         }
     }
 
     // Check 4: Low sample rate
     if (hdr.sample_rate > 0 && hdr.sample_rate < 44100) {
-        res.issues.push_back({"info", std::format("low sample rate ({} Hz)", hdr.sample_rate)});
+        res.issues.push_back({"info", std::format("low sample rate ({} Hz)", hdr.sample_rate), "low-sample-rate"});
     }
 
-    // Determine overall status
-    for (const auto& iss : res.issues) {
-        if (iss.level == "error") {
-            res.status = "error";
-        } else if (iss.level == "warn" && res.status != "error") {
-            res.status = "warn";
-        } else if (iss.level == "info" && res.status == "ok") {
-            res.status = "info";
-        }
+    set_status(res);
+    return res;
+}
+
+// validate_wss reports the metadata of a WSS or WAV file from its header;
+// samples are not decoded.
+template <typename ReadInfo>
+static Result validate_wss(const std::string& path, ReadInfo&& read_info) {
+    Result res;
+    res.path = path;
+    res.status = "ok";
+
+    armatools::wss::AudioInfo info;
+    try {
+        info = read_info();
+    } catch (const std::exception& e) {
+        res.status = "error";
+        res.issues.push_back({"error", std::format("parse: {}", e.what()), "parse"});
+        return res;
     }
 
+    res.format = info.format;
+    res.sample_rate = static_cast<int>(info.sample_rate);
+    res.channels = info.channels;
+    res.duration = info.duration;
+    if (info.sample_rate > 0 && info.sample_rate < 44100) {
+        res.issues.push_back({"info", std::format("low sample rate ({} Hz)", info.sample_rate), "low-sample-rate"});
+    }
+
+    set_status(res);
     return res;
 }
 
+enum class AudioKind { None, Ogg, Wss };
+
+static AudioKind audio_kind(const std::string& name) {
+    std::string lower = name;
+    for (auto& c : lower) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    if (lower.ends_with(".ogg")) return AudioKind::Ogg;
+    if (lower.ends_with(".wss") || lower.ends_with(".wav")) return AudioKind::Wss;
+    return AudioKind::None;
+}
+
+// probe_entry validates one audio entry of an open PBO. Stored entries are
+// read in place, only as far as their headers.
+static Result probe_entry(std::ifstream& f, const armatools::pbo::Entry& entry,
+                          const std::string& path, AudioKind kind) {
+    f.clear(); // a failed probe of the previous entry leaves failbit set
+    if (!armatools::pbo::is_compressed(entry)) {
+        auto seek = [&] {
+            if (!f.seekg(entry.data_offset))
+                throw std::runtime_error(std::format("seek to offset {}", entry.data_offset));
+        };
+        if (kind == AudioKind::Ogg) {
+            return validate_ogg(path, [&] {
+                seek();
+                return armatools::ogg::read_header(f, entry.data_size);
+            });
+        }
+        return validate_wss(path, [&] {
+            seek();
+            return armatools::wss::read_info(f, entry.data_size);
+        });
+    }
+
+    std::ostringstream buf;
+    try {
+        armatools::pbo::extract_file(f, entry, buf);
+    } catch (const std::exception& e) {
+        return error_result(path, "extract", e.what());
+    }
+
+    std::string s = std::move(buf).str();
+    if (kind == AudioKind::Ogg) {
+        return validate_ogg(path, [&] {
+            return armatools::ogg::read_header(
+                std::span(reinterpret_cast<const uint8_t*>(s.data()), s.size()));
+        });
+    }
+    return validate_wss(path, [&] {
+        std::istringstream is(s);
+        return armatools::wss::read_info(is, s.size());
+    });
+}
+
 static Result validate_file(const std::string& path) {
     std::ifstream f(path, std::ios::binary);
-    if (!f) {
-        return {path, "", 0, 0, "error", {{"error", std::format("open: {}", path)}}};
-    }
+    if (!f) return error_result(path, "open", path);
 
-    std::vector<uint8_t> data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
-    return validate_ogg_data(data, path);
+    return validate_ogg(path, [&] { return armatools::ogg::read_header(f); });
 }
 
 static std::vector<Result> scan_pbo(const std::string& pbo_path) {
@@ -118,22 +213,8 @@ static std::vector<Result> scan_pbo(const std::string& pbo_path) {
 
     std::vector<Result> results;
     for (const auto& entry : pbo.entries) {
-        std::string lower = entry.filename;
-        for (auto& c : lower) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
-        if (lower.size() < 4 || lower.substr(lower.size() - 4) != ".ogg") continue;
-
-        std::ostringstream buf;
-        try {
-            armatools::pbo::extract_file(f, entry, buf);
-        } catch (const std::exception& e) {
-            results.push_back({pbo_path + "::" + entry.filename, "", 0, 0, "error",
-                              {{"error", std::format("extract: {}", e.what())}}});
-            continue;
-        }
-
-        std::string s = buf.str();
-        std::vector<uint8_t> data(s.begin(), s.end());
-        results.push_back(validate_ogg_data(data, pbo_path + "::" + entry.filename));
+        if (audio_kind(entry.filename) != AudioKind::Ogg) continue;
+        results.push_back(probe_entry(f, entry, pbo_path + "::" + entry.filename, AudioKind::Ogg));
     }
 
     return results;
@@ -157,6 +238,131 @@ static std::vector<Result> scan_dir(const std::string& dir) {
     return results;
 }
 
+// --- Corpus mode ---
+
+// CorpusUnit is one task of a corpus scan: a loose audio file, or a PBO
+// whose audio entries are checked in order. entries restricts a PBO to the
+// listed entry names; empty means every audio entry.
+struct CorpusUnit {
+    std::string path;
+    bool is_pbo = false;
+    std::vector<std::string> entries;
+};
+
+static std::vector<CorpusUnit> units_from_db(const std::string& db_path) {
+    auto db = armatools::pboindex::DB::open(db_path);
+    std::map<std::string, std::vector<std::string>> by_pbo;
+    for (const char* pattern : {"*.ogg", "*.wss", "*.wav"}) {
+        for (auto& fr : db.find_files(pattern))
+            by_pbo[fr.pbo_path].push_back(std::move(fr.file_path));
+    }
+
+    std::vector<CorpusUnit> units;
+    units.reserve(by_pbo.size());
+    for (auto& [pbo_path, entries] : by_pbo) units.push_back({pbo_path, true, std::move(entries)});
+    return units;
+}
+
+static std::vector<CorpusUnit> units_from_dir(const std::string& dir) {
+    std::vector<CorpusUnit> units;
+    for (const auto& entry : fs::recursive_directory_iterator(dir, fs::directory_options::skip_permission_denied)) {
+        if (!entry.is_regular_file()) continue;
+        std::string name = entry.path().filename().string();
+        std::string lower = name;
+        for (auto& c : lower) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        if (lower.ends_with(".pbo")) units.push_back({entry.path().string(), true, {}});
+        else if (audio_kind(name) != AudioKind::None) units.push_back({entry.path().string(), false, {}});
+    }
+    std::sort(units.begin(), units.end(), [](const CorpusUnit& a, const CorpusUnit& b) { return a.path < b.path; });
+    return units;
+}
+
+static std::vector<Result> scan_unit(const CorpusUnit& unit) {
+    std::ifstream f(unit.path, std::ios::binary);
+    if (!f) return {error_result(unit.path, "open", unit.path)};
+
+    if (!unit.is_pbo) {
+        if (audio_kind(unit.path) == AudioKind::Ogg)
+            return {validate_ogg(unit.path, [&] { return armatools::ogg::read_header(f); })};
+        return {validate_wss(unit.path, [&] {
+            return armatools::wss::read_info(f, static_cast<uint64_t>(fs::file_size(unit.path)));
+        })};
+    }
+
+    armatools::pbo::PBO pbo;
+    try {
+        pbo = armatools::pbo::read(f);
+    } catch (const std::exception& e) {
+        return {error_result(unit.path, "pbo", e.what())};
+    }
+
+    std::unordered_set<std::string> wanted(unit.entries.begin(), unit.entries.end());
+    std::vector<Result> results;
+    for (const auto& entry : pbo.entries) {
+        AudioKind kind = audio_kind(entry.filename);
+        if (kind == AudioKind::None) continue;
+        if (!wanted.empty() && !wanted.count(entry.filename)) continue;
+        results.push_back(probe_entry(f, entry, unit.path + "::" + entry.filename, kind));
+    }
+    return results;
+}
+
+static json result_json(const Result& r) {
+    json obj = {
+        {"path", r.path},
+        {"format", r.format},
+        {"encoder", r.encoder},
+        {"sampleRate", r.sample_rate},
+        {"channels", r.channels},
+    };
+    if (r.format != "OGG" && r.duration > 0) obj["duration"] = r.duration;
+    obj["status"] = r.status;
+    if (!r.issues.empty()) {
+        json issues = json::array();
+        for (const auto& iss : r.issues)
+            issues.push_back({{"check", iss.check}, {"level", iss.level}, {"message", iss.message}});
+        obj["issues"] = issues;
+    }
+    return obj;
+}
+
+// run_corpus scans units on a thread pool and writes one JSON line per
+// audio file in unit order as soon as each unit is done, followed by a
+// summary line with status and issue counts.
+static void run_corpus(const std::vector<CorpusUnit>& units, int threads, bool warn_only) {
+    std::map<std::string, int> status_counts{{"ok", 0}, {"info", 0}, {"warn", 0}, {"error", 0}};
+    std::map<std::string, int> issue_counts;
+    int total = 0;
+    armatools::binutil::ordered_for<std::vector<Result>>(
+        units.size(), armatools::binutil::worker_count(threads),
+        [&](size_t i, std::vector<Result>& results) {
+            try {
+                results = scan_unit(units[i]);
+            } catch (const std::exception& e) {
+                results = {error_result(units[i].path, "scan", e.what())};
+            }
+        },
+        [&](size_t, std::vector<Result>& results) {
+            for (const auto& r : results) {
+                total++;
+                status_counts[r.status]++;
+                for (const auto& iss : r.issues) issue_counts[iss.check]++;
+                if (warn_only && r.status != "warn" && r.status != "error") continue;
+                std::cout << result_json(r).dump() << '\n';
+            }
+            std::cout.flush();
+        });
+
+    json summary = {{"files", total}};
+    for (const auto& [status, count] : status_counts) summary[status] = count;
+    summary["issues"] = issue_counts;
+    std::cout << json{{"summary", summary}}.dump() << '\n';
+
+    std::cerr << std::format("Scanned {} files: {} ok, {} warnings, {} errors\n", total,
+                             status_counts["ok"] + status_counts["info"], status_counts["warn"],
+                             status_counts["error"]);
+}
+
 static void print_result(const Result& r) {
     std::string label = r.status;
     for (auto& c : label) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
@@ -173,34 +379,52 @@ static void print_result(const Result& r) {
 }
 
 static void print_usage() {
-    std::cerr << "Usage: ogg_validate [flags] [file.ogg|file.pbo|dir ...]\n\n"
+    std::cerr << "Usage: ogg_validate [flags] [file.ogg|file.pbo|dir ...]\n"
+              << "       ogg_validate --db a3.db|--dir dir [--threads N] [--warn]\n\n"
               << "Validate OGG/Vorbis files for compatibility issues.\n\n"
               << "Modes:\n"
               << "  File mode (default)   Validate OGG files from arguments\n"
               << "  PBO mode              Auto-detected from .pbo extension\n"
-              << "  Directory mode (-r)   Recursively scan for .ogg and .pbo files\n\n"
+              << "  Directory mode (-r)   Recursively scan for .ogg and .pbo files\n"
+              << "  Corpus mode           --db or --dir: check every .ogg, .wss and .wav\n"
+              << "                        in parallel, JSON Lines output with a summary\n\n"
               << "Checks:\n"
               << "  old-encoder           Pre-1.0 Vorbis encoder (WARN)\n"
               << "  floor-type-0          Uses deprecated floor type 0 (WARN)\n"
               << "  lookup1values         Codebook triggers float precision bug (WARN)\n"
               << "  low-sample-rate       Sample rate below 44100 Hz (INFO)\n\n"
               << "Flags:\n"
-              << "  -r         Recursively scan directories\n"
-              << "  --json     JSON output\n"
-              << "  --warn     Show only files with warnings/errors\n";
+              << "  -r            Recursively scan directories\n"
+              << "  --json        JSON output\n"
+              << "  --warn        Show only files with warnings/errors\n"
+              << "  --db path     Corpus mode: audio files listed in a pboindex database\n"
+              << "  --dir dir     Corpus mode: .pbo and audio files under dir\n"
+              << "  --threads N   Corpus mode worker threads (default: all cores)\n";
 }
 
 int main(int argc, char* argv[]) {
     bool recursive = false;
     bool json_out = false;
     bool warn_only = false;
+    std::string db_path;
+    std::string corpus_dir;
+    int threads = 0;
     std::vector<std::string> positional;
 
     for (int i = 1; i < argc; i++) {
         if (std::strcmp(argv[i], "-r") == 0) recursive = true;
         else if (std::strcmp(argv[i], "--json") == 0) json_out = true;
         else if (std::strcmp(argv[i], "--warn") == 0) warn_only = true;
-        else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+        else if (std::strcmp(argv[i], "--db") == 0 && i + 1 < argc) db_path = argv[++i];
+        else if (std::strcmp(argv[i], "--dir") == 0 && i + 1 < argc) corpus_dir = argv[++i];
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            try {
+                threads = std::max(0, std::stoi(argv[++i]));
+            } catch (...) {
+                std::cerr << "Error: invalid value for --threads\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
             print_usage();
             return 0;
         } else {
@@ -208,6 +432,18 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if (!db_path.empty() || !corpus_dir.empty()) {
+        std::vector<CorpusUnit> units;
+        try {
+            units = !db_path.empty() ? units_from_db(db_path) : units_from_dir(corpus_dir);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << '\n';
+            return 1;
+        }
+        run_corpus(units, threads, warn_only);
+        return 0;
+    }
+
     if (positional.empty()) {
         print_usage();
         return 1;
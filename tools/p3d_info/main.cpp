@@ -59,14 +59,15 @@ std::vector<uint8_t> extract_from_pbo(const std::string& pbo_path,
 
 armatools::rvmat::Material parse_rvmat_bytes(const std::vector<uint8_t>& data) {
     if (data.empty()) throw std::runtime_error("rvmat: empty data");
-    std::string s(reinterpret_cast<const char*>(data.data()), data.size());
-    std::istringstream iss(s, std::ios::binary);
+    std::string_view s(reinterpret_cast<const char*>(data.data()), data.size());
 
     armatools::config::Config cfg;
-    if (data.size() >= 4 && data[0] == 0x00 && data[1] == 'r' && data[2] == 'a' && data[3] == 'P')
+    if (data.size() >= 4 && data[0] == 0x00 && data[1] == 'r' && data[2] == 'a' && data[3] == 'P') {
+        std::istringstream iss(std::string(s), std::ios::binary);
         cfg = armatools::config::read(iss);
-    else
-        cfg = armatools::config::parse_text(iss);
+    } else {
+        cfg = armatools::config::parse_text(s);
+    }
 
     return armatools::rvmat::parse(cfg);
 }
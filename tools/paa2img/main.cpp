@@ -1,4 +1,5 @@
 #include "armatools/paa.h"
+#include "armatools/png.h"
 
 #include <cstring>
 #include <filesystem>
@@ -7,9 +8,6 @@
 #include <sstream>
 #include <string>
 
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include <stb_image_write.h>
-
 namespace fs = std::filesystem;
 
 static void print_usage() {
@@ -21,11 +19,7 @@ static void print_usage() {
 }
 
 static void write_png_to_stream(std::ostream& out, const armatools::paa::Image& img) {
-    stbi_write_png_to_func(
-        [](void* ctx, void* data, int size) {
-            static_cast<std::ostream*>(ctx)->write(static_cast<const char*>(data), size);
-        },
-        &out, img.width, img.height, 4, img.pixels.data(), img.width * 4);
+    armatools::png::write(out, img.pixels.data(), img.width, img.height, 4);
 }
 
 int main(int argc, char* argv[]) {
@@ -79,15 +73,24 @@ int main(int argc, char* argv[]) {
     std::cerr << "PAA: " << input_name << " (" << hdr.format << ", " << hdr.width << "x" << hdr.height << ")\n";
 
     if (output == "-" || (from_stdin && output.empty())) {
-        write_png_to_stream(std::cout, img);
+        try {
+            write_png_to_stream(std::cout, img);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: writing stdout: " << e.what() << '\n';
+            return 1;
+        }
     } else {
         std::string out_path = output;
         if (out_path.empty()) {
             fs::path p(input_name);
             out_path = (p.parent_path() / p.stem()).string() + ".png";
         }
-        if (!stbi_write_png(out_path.c_str(), img.width, img.height, 4, img.pixels.data(), img.width * 4)) {
-            std::cerr << "Error: writing " << out_path << '\n';
+        try {
+            std::ofstream out(out_path, std::ios::binary);
+            if (!out) throw std::runtime_error("cannot open output file");
+            write_png_to_stream(out, img);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: writing " << out_path << ": " << e.what() << '\n';
             return 1;
         }
         std::cerr << "Output: " << out_path << '\n';
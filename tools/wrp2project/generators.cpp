@@ -1,6 +1,7 @@
 #include "project.h"
 
 #include "armatools/config.h"
+#include "armatools/dem.h"
 #include "armatools/forestshape.h"
 #include "armatools/objcat.h"
 #include "armatools/roadnet.h"
@@ -87,15 +88,14 @@ static double find_float(const armatools::config::ConfigClass& cls, const std::s
 }
 
 MapMetadata* read_map_metadata(const std::string& path) {
-    std::ifstream f(path);
-    if (!f) {
+    if (!std::filesystem::exists(path)) {
         LOGW("cannot open config", path);
         return nullptr;
     }
 
     armatools::config::Config cfg;
     try {
-        cfg = armatools::config::parse_text(f);
+        cfg = armatools::config::parse_text_file(path);
     } catch (const std::exception& e) {
         LOGW("parsing config:", e.what());
         return nullptr;
@@ -174,33 +174,9 @@ static std::string meta_float_str(const MapMetadata* m, double MapMetadata::*fie
 // Heightmap
 // ============================================================================
 
-static std::vector<float> resample_elevations(const std::vector<float>& src,
-                                                int src_w, int src_h, int dst_w, int dst_h) {
-    std::vector<float> dst(static_cast<size_t>(dst_w) * static_cast<size_t>(dst_h));
-    for (int dy = 0; dy < dst_h; dy++) {
-        double sy = static_cast<double>(dy) * static_cast<double>(src_h - 1) / static_cast<double>(dst_h - 1);
-        int y0 = static_cast<int>(sy);
-        int y1 = std::min(y0 + 1, src_h - 1);
-        double fy = sy - y0;
-
-        for (int dx = 0; dx < dst_w; dx++) {
-            double sx = static_cast<double>(dx) * static_cast<double>(src_w - 1) / static_cast<double>(dst_w - 1);
-            int x0 = static_cast<int>(sx);
-            int x1 = std::min(x0 + 1, src_w - 1);
-            double fx = sx - x0;
-
-            double v00 = src[static_cast<size_t>(y0 * src_w + x0)];
-            double v10 = src[static_cast<size_t>(y0 * src_w + x1)];
-            double v01 = src[static_cast<size_t>(y1 * src_w + x0)];
-            double v11 = src[static_cast<size_t>(y1 * src_w + x1)];
-            double v = v00 * (1 - fx) * (1 - fy) + v10 * fx * (1 - fy) + v01 * (1 - fx) * fy + v11 * fx * fy;
-            dst[static_cast<size_t>(dy * dst_w + dx)] = static_cast<float>(v);
-        }
-    }
-    return dst;
-}
-
-void init_heightmap(ProjectInfo& p, int scale) {
+void init_heightmap(ProjectInfo& p, const HeightmapOptions& opts) {
+    namespace hp = armatools::heightpipe;
+    int scale = opts.scale;
     auto& w = *p.world;
     if (w.elevations.empty()) return;
 
@@ -230,9 +206,20 @@ void init_heightmap(ProjectInfo& p, int scale) {
     int dst_h = src_h * scale;
     LOGI(std::format("Heightmap: upscaling {}x{} -> {}x{} ({}x)", src_w, src_h, dst_w, dst_h, scale));
 
+    // WRP elevations are grid vertices: keep the origin so that output
+    // sample i lands on source vertex i / scale at the new cell size.
+    hp::Heightmap src(src_w, src_h);
+    src.data = w.elevations;
+    hp::Heightmap up = hp::resample(src, scale, {.method = opts.resample, .align = hp::SampleAlign::Origin});
+    if (opts.correction != hp::CorrectionPreset::None) {
+        auto cp = hp::correction_preset_for_scale(scale, opts.correction);
+        cp.align = hp::SampleAlign::Origin;
+        up = hp::apply_upscale_corrections(up, src, scale, cp, 1);
+    }
+
     p.hm_width = dst_w;
     p.hm_height = dst_h;
-    p.hm_elevations = resample_elevations(w.elevations, src_w, src_h, dst_w, dst_h);
+    p.hm_elevations = std::move(up.data);
 }
 
 void write_heightmap_asc(ProjectInfo& p) {
@@ -246,22 +233,7 @@ void write_heightmap_asc(ProjectInfo& p) {
     std::ofstream f(path);
     if (!f) throw std::runtime_error("cannot create " + path);
 
-    f << std::format("ncols         {}\n", width);
-    f << std::format("nrows         {}\n", height);
-    f << std::format("xllcorner     {:.6f}\n", p.offset_x);
-    f << std::format("yllcorner     {:.6f}\n", p.offset_z);
-    f << std::format("cellsize      {:.6f}\n", cell_size);
-    f << "NODATA_value  -9999\n";
-
-    // ESRI ASCII Grid: top-to-bottom; WRP: row 0 = south. Write reversed.
-    for (int row = height - 1; row >= 0; row--) {
-        int offset = row * width;
-        for (int col = 0; col < width; col++) {
-            if (col > 0) f << ' ';
-            f << std::format("{:.4f}", p.hm_elevations[static_cast<size_t>(offset + col)]);
-        }
-        f << '\n';
-    }
+    armatools::dem::write_asc(f, {p.hm_elevations.data(), width, height, cell_size, p.offset_x, p.offset_z});
 }
 
 // ============================================================================
@@ -628,9 +600,9 @@ static void write_road_type_entry(std::ofstream& f, const std::string& type_name
 
 void write_roads_lib(ProjectInfo& p) {
     std::unordered_map<std::string, int> used_types;
-    for (const auto& obj : p.world->objects) {
-        auto rt = p.road_map->classify(obj.model_name);
-        if (rt) used_types[*rt]++;
+    for (const auto& e : p.models().entries()) {
+        auto rt = p.road_map->classify_base(e.base_name);
+        if (rt) used_types[*rt] += static_cast<int>(e.object_count);
     }
 
     std::vector<std::string> types;
@@ -790,36 +762,41 @@ static void write_objects_txt_file(const std::string& path,
     }
 }
 
-static void build_model_meta(const ProjectInfo& p, const std::vector<std::string>& models,
-                              std::unordered_map<std::string, armatools::tb::ModelMeta>& meta) {
-    if (!p.db_path.empty()) {
-        try {
-            auto db = armatools::pboindex::DB::open(p.db_path);
-            auto bboxes = db.query_model_bboxes();
-            for (const auto& model : models) {
-                if (meta.count(model)) continue;
-                std::string key = armatools::armapath::to_slash_lower(model);
-                auto it = bboxes.find(key);
-                if (it == bboxes.end()) continue;
-                const auto& bb = it->second;
-                armatools::tb::ModelMeta m;
-                m.height = bb.mi_max[1];
-                m.bb_radius = bb.mi_max[2];
-                m.bb_hscale = (bb.mi_max[2] != 0) ? bb.mi_max[0] / bb.mi_max[2] : 1.0f;
-                if (bb.vis_max[0] != 0 || bb.vis_max[1] != 0 || bb.vis_max[2] != 0) {
-                    m.bbox_min = {bb.vis_min[0], bb.vis_min[1], bb.vis_min[2]};
-                    m.bbox_max = {bb.vis_max[0], bb.vis_max[1], bb.vis_max[2]};
-                    m.bbox_center = {bb.vis_center[0], bb.vis_center[1], bb.vis_center[2]};
-                } else {
-                    m.bbox_min = {bb.bbox_min[0], bb.bbox_min[1], bb.bbox_min[2]};
-                    m.bbox_max = {bb.bbox_max[0], bb.bbox_max[1], bb.bbox_max[2]};
-                    m.bbox_center = {bb.bbox_center[0], bb.bbox_center[1], bb.bbox_center[2]};
-                }
-                meta[model] = m;
-            }
-        } catch (const std::exception& e) {
-            LOGW("querying model bboxes:", e.what());
+static std::optional<armatools::pboindex::ModelSnapshot> open_model_snapshot(const ProjectInfo& p) {
+    if (p.db_path.empty()) return std::nullopt;
+    try {
+        auto db = armatools::pboindex::DB::open(p.db_path);
+        return db.model_snapshot();
+    } catch (const std::exception& e) {
+        LOGW("loading model metadata:", e.what());
+    }
+    return std::nullopt;
+}
+
+static void build_model_meta(const armatools::pboindex::ModelSnapshot* snap,
+                             const std::vector<std::string>& models,
+                             std::unordered_map<std::string, armatools::tb::ModelMeta>& meta) {
+    if (!snap) return;
+    for (const auto& model : models) {
+        if (meta.count(model)) continue;
+        std::string key = armatools::armapath::to_slash_lower(model);
+        const auto* found = snap->find_bbox(key);
+        if (!found) continue;
+        const auto& bb = *found;
+        armatools::tb::ModelMeta m;
+        m.height = bb.mi_max[1];
+        m.bb_radius = bb.mi_max[2];
+        m.bb_hscale = (bb.mi_max[2] != 0) ? bb.mi_max[0] / bb.mi_max[2] : 1.0f;
+        if (bb.vis_max[0] != 0 || bb.vis_max[1] != 0 || bb.vis_max[2] != 0) {
+            m.bbox_min = {bb.vis_min[0], bb.vis_min[1], bb.vis_min[2]};
+            m.bbox_max = {bb.vis_max[0], bb.vis_max[1], bb.vis_max[2]};
+            m.bbox_center = {bb.vis_center[0], bb.vis_center[1], bb.vis_center[2]};
+        } else {
+            m.bbox_min = {bb.bbox_min[0], bb.bbox_min[1], bb.bbox_min[2]};
+            m.bbox_max = {bb.bbox_max[0], bb.bbox_max[1], bb.bbox_max[2]};
+            m.bbox_center = {bb.bbox_center[0], bb.bbox_center[1], bb.bbox_center[2]};
         }
+        meta[model] = m;
     }
     if (meta.size() > 0) {
         LOGI(std::format("Model metadata: resolved bounding boxes for {}/{} models",
@@ -830,19 +807,23 @@ static void build_model_meta(const ProjectInfo& p, const std::vector<std::string
 void write_objects(ProjectInfo& p) {
     auto& w = *p.world;
 
-    // Apply replacements before categorization
+    // Apply replacements before categorization, resolved once per model
     if (p.replace_map) {
+        const auto& table = p.models();
+        auto targets = p.replace_map->resolve(table);
+        for (auto& t : targets) {
+            // For multi-match (";"-separated), use the first candidate
+            auto semi = t.find(';');
+            if (semi != std::string::npos) t.resize(semi);
+        }
         int replaced = 0;
-        for (auto& obj : w.objects) {
-            auto [new_name, found] = p.replace_map->lookup(obj.model_name);
-            if (found && rmap_to_lower(new_name) != "unmatched") {
-                // For multi-match (";"-separated), use the first candidate
-                auto semi = new_name.find(';');
-                if (semi != std::string::npos) new_name = new_name.substr(0, semi);
-                obj.model_name = new_name;
-                replaced++;
-            }
+        for (size_t i = 0; i < w.objects.size(); i++) {
+            const auto& t = targets[table.id(i)];
+            if (t.empty()) continue;
+            w.objects[i].model_name = t;
+            replaced++;
         }
+        p.model_table.reset();
         for (auto& m : w.models) {
             auto [new_name, found] = p.replace_map->lookup(m);
             if (found && rmap_to_lower(new_name) != "unmatched") {
@@ -859,12 +840,19 @@ void write_objects(ProjectInfo& p) {
     std::unordered_map<std::string, std::vector<armatools::wrp::ObjectRecord>> cat_objects;
     std::unordered_map<std::string, std::unordered_map<std::string, bool>> cat_model_set;
 
-    for (const auto& obj : w.objects) {
-        if (obj.model_name.empty()) continue;
-        if (p.road_map->is_road(obj.model_name)) continue;
-        std::string cat = armatools::objcat::category(obj.model_name);
-        cat_objects[cat].push_back(obj);
-        cat_model_set[cat][obj.model_name] = true;
+    // Category per model; "" marks roads and unnamed objects, which are skipped.
+    const auto& table = p.models();
+    std::vector<std::string> model_cats(table.size());
+    for (uint32_t id = 0; id < table.size(); id++) {
+        const auto& e = table[id];
+        if (e.name.empty() || p.road_map->classify_base(e.base_name)) continue;
+        model_cats[id] = armatools::objcat::category(e.name);
+        cat_model_set[model_cats[id]][e.name] = true;
+    }
+
+    for (size_t i = 0; i < w.objects.size(); i++) {
+        const auto& cat = model_cats[table.id(i)];
+        if (!cat.empty()) cat_objects[cat].push_back(w.objects[i]);
     }
 
     for (const auto& m : w.models) {
@@ -888,30 +876,25 @@ void write_objects(ProjectInfo& p) {
         }
     }
     auto all_models = sorted_keys(all_model_set);
+    auto snap = open_model_snapshot(p);
     std::unordered_map<std::string, armatools::tb::ModelMeta> meta;
-    build_model_meta(p, all_models, meta);
+    build_model_meta(snap ? &*snap : nullptr, all_models, meta);
 
-    // Build case correction map from pboindex DB (lowercase basename -> original-case basename)
+    // Build case correction map from pboindex DB (lowercase basename -> original-case basename),
+    // limited to the models this map places.
     std::unordered_map<std::string, std::string> case_map;
-    if (!p.db_path.empty()) {
-        try {
-            auto db = armatools::pboindex::DB::open(p.db_path);
-            auto model_paths = db.query_model_paths();
-            for (const auto& [full_path, original_name] : model_paths) {
-                // original_name is basename without extension in original case
-                std::string lower_name = original_name;
-                std::transform(lower_name.begin(), lower_name.end(), lower_name.begin(),
-                               [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-                // Only set if not already set (first occurrence wins)
-                if (!case_map.count(lower_name))
-                    case_map[lower_name] = original_name;
-            }
-            if (!case_map.empty())
-                LOGI(std::format("Template names: resolved original case for {} model basenames",
-                                                      case_map.size()));
-        } catch (const std::exception& e) {
-            LOGW("querying model paths for case correction:", e.what());
+    if (snap) {
+        for (const auto& model : all_models) {
+            std::string lower_name = armatools::tb::p3d_base_name(model);
+            std::transform(lower_name.begin(), lower_name.end(), lower_name.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            if (case_map.count(lower_name)) continue;
+            auto original_name = snap->find_name_by_base(lower_name);
+            if (!original_name.empty()) case_map[lower_name] = std::string(original_name);
         }
+        if (!case_map.empty())
+            LOGI(std::format("Template names: resolved original case for {} model basenames",
+                                                  case_map.size()));
     }
 
     // Build per-category dedup name maps (full model path -> unique display name)
@@ -1057,9 +1040,17 @@ void write_road_shapes(ProjectInfo& p) {
     std::vector<armatools::roadnet::Polyline> polylines;
 
     if (!p.roads_shp.empty()) {
-        // Import from existing shapefile
-        auto src = armatools::shp::open(p.roads_shp);
-        if (src.records.empty()) return;
+        // Import the roads of an existing shapefile that touch the map area
+        auto src = armatools::shp::Reader::open(p.roads_shp);
+        std::vector<size_t> records;
+        if (p.world->bounds.world_size_x > 0 && p.world->bounds.world_size_y > 0) {
+            records = src->query({p.offset_x, p.offset_z, p.offset_x + p.world->bounds.world_size_x,
+                                  p.offset_z + p.world->bounds.world_size_y});
+        } else {
+            records.resize(src->size());
+            for (size_t i = 0; i < records.size(); i++) records[i] = i;
+        }
+        if (records.empty()) return;
 
         auto base_path = (fs::path(p.output_dir) / "data" / "roads" / "roads").string();
         std::vector<armatools::shp::Field> fields = {
@@ -1069,21 +1060,27 @@ void write_road_shapes(ProjectInfo& p) {
         };
         auto w = armatools::shp::Writer::create(base_path, armatools::shp::ShapeType::poly_line, fields);
 
-        for (const auto& rec : src.records) {
-            for (const auto& part : rec.parts) {
+        int id_col = src->field_index("ID");
+        int width_col = src->field_index("WIDTH");
+        int order_col = src->field_index("ORDER");
+        int segments_col = src->field_index("SEGMENTS");
+        int road_type_col = src->field_index("ROADTYPE");
+        int map_col = src->field_index("MAP");
+
+        std::vector<armatools::shp::Shape> shapes;
+        for (size_t r : records) {
+            auto rec = src->record(r);
+            for (size_t pi = 0; pi < rec.part_count(); pi++) {
+                auto part = rec.part(pi);
                 if (part.size() < 2) continue;
                 std::vector<armatools::shp::Point> points(part.begin(), part.end());
 
-                int id = armatools::shp::attr_int(rec.attrs, "ID");
-                double width = armatools::shp::attr_float64(rec.attrs, "WIDTH");
-                int order = armatools::shp::attr_int(rec.attrs, "ORDER");
-                int segments = armatools::shp::attr_int(rec.attrs, "SEGMENTS");
-                std::string road_type;
-                auto rt = rec.attrs.find("ROADTYPE");
-                if (rt != rec.attrs.end()) road_type = rt->second;
-                std::string map_type;
-                auto mt = rec.attrs.find("MAP");
-                if (mt != rec.attrs.end()) map_type = mt->second;
+                int id = static_cast<int>(src->integer(r, id_col));
+                double width = src->number(r, width_col);
+                int order = static_cast<int>(src->integer(r, order_col));
+                int segments = static_cast<int>(src->integer(r, segments_col));
+                std::string road_type(src->text(r, road_type_col));
+                std::string map_type(src->text(r, map_col));
 
                 double length = 0;
                 for (size_t i = 1; i < points.size(); i++) {
@@ -1096,17 +1093,17 @@ void write_road_shapes(ProjectInfo& p) {
                 if (map_type.empty()) map_type = map_type_from_id(id);
                 if (width == 0) width = width_from_id(id);
 
-                std::vector<armatools::shp::AttrValue> attrs = {
+                shapes.push_back({{std::move(points)}, {
                     static_cast<int64_t>(id), static_cast<int64_t>(order), road_type,
                     width, width + 2, map_type,
                     static_cast<int64_t>(segments), length,
-                };
-                w->write_poly_line({points}, attrs);
+                }});
             }
         }
+        w->write_poly_lines(shapes);
         w->close();
-        LOGI(std::format("Roads: imported {} records from {}",
-                                              src.records.size(), fs::path(p.roads_shp).filename().string()));
+        LOGI(std::format("Roads: imported {} of {} records from {}", records.size(),
+                                              src->size(), fs::path(p.roads_shp).filename().string()));
         return;
     }
 
@@ -1115,7 +1112,7 @@ void write_road_shapes(ProjectInfo& p) {
         polylines = armatools::roadnet::extract_from_road_links(p.world->road_links);
     }
     if (polylines.empty() && !p.world->objects.empty()) {
-        polylines = armatools::roadnet::extract_from_objects(p.world->objects);
+        polylines = armatools::roadnet::extract_from_objects(p.world->objects, p.models());
     }
     if (polylines.empty()) return;
 
@@ -1130,21 +1127,24 @@ void write_road_shapes(ProjectInfo& p) {
     double total_length = 0;
     std::unordered_map<std::string, int> type_counts;
 
+    std::vector<armatools::shp::Shape> shapes;
+    shapes.reserve(polylines.size());
     for (const auto& pl : polylines) {
         if (pl.points.size() < 2) continue;
         std::vector<armatools::shp::Point> points;
+        points.reserve(pl.points.size());
         for (const auto& pt : pl.points)
             points.push_back({pt[0] + p.offset_x, pt[1] + p.offset_z});
 
-        std::vector<armatools::shp::AttrValue> attrs = {
+        shapes.push_back({{std::move(points)}, {
             static_cast<int64_t>(pl.props.id), static_cast<int64_t>(pl.props.order),
             std::string(pl.type), pl.props.width, pl.props.terrain, pl.props.map_type,
             static_cast<int64_t>(pl.seg_count), pl.length,
-        };
-        w->write_poly_line({points}, attrs);
+        }});
         total_length += pl.length;
         type_counts[pl.type]++;
     }
+    w->write_poly_lines(shapes);
     w->close();
 
     LOGI(std::format("Roads: {} polylines, {:.0f}m total",
@@ -1154,7 +1154,7 @@ void write_road_shapes(ProjectInfo& p) {
 void write_forest_shapes(ProjectInfo& p) {
     if (p.world->objects.empty()) return;
 
-    auto polygons = armatools::forestshape::extract_from_objects(p.world->objects);
+    auto polygons = armatools::forestshape::extract_from_objects(p.world->objects, p.models());
     if (polygons.empty()) return;
 
     auto base_path = (fs::path(p.output_dir) / "source" / "forest").string();
@@ -1164,11 +1164,14 @@ void write_forest_shapes(ProjectInfo& p) {
     auto w = armatools::shp::Writer::create(base_path, armatools::shp::ShapeType::polygon, fields);
 
     double total_area = 0;
+    std::vector<armatools::shp::Shape> shapes;
+    shapes.reserve(polygons.size());
     for (const auto& poly : polygons) {
         if (poly.exterior.size() < 4) continue;
         std::vector<std::vector<armatools::shp::Point>> rings;
         auto offset_ring = [&](const std::vector<std::array<double, 2>>& ring) {
             std::vector<armatools::shp::Point> pts;
+            pts.reserve(ring.size());
             for (const auto& pt : ring)
                 pts.push_back({pt[0] + p.offset_x, pt[1] + p.offset_z});
             return pts;
@@ -1177,13 +1180,13 @@ void write_forest_shapes(ProjectInfo& p) {
         for (const auto& hole : poly.holes)
             rings.push_back(offset_ring(hole));
 
-        std::vector<armatools::shp::AttrValue> attrs = {
+        shapes.push_back({std::move(rings), {
             static_cast<int64_t>(poly.id), std::string(poly.type),
             static_cast<int64_t>(poly.cell_count), static_cast<int64_t>(static_cast<int>(poly.area)),
-        };
-        w->write_polygon(rings, attrs);
+        }});
         total_area += poly.area;
     }
+    w->write_polygons(shapes);
     w->close();
     LOGI(std::format("Forest: {} polygons, {:.2f} km^2",
                                           polygons.size(), total_area / 1e6));
@@ -60,6 +60,11 @@ std::string ProjectInfo::p_drive_dir() const {
     return map_name + lower_name;
 }
 
+const armatools::wrp::ModelTable& ProjectInfo::models() {
+    if (!model_table) model_table = armatools::wrp::ModelTable::build(world->objects);
+    return *model_table;
+}
+
 static double detect_offset_from_shp(const std::string& shp_path, double map_size_x) {
     try {
         auto bbox = armatools::shp::read_bbox(shp_path);
@@ -97,6 +102,8 @@ static void print_usage() {
     armatools::cli::print("  --split <n>       Max objects per text import file (default: 10000, 0=no split)");
     armatools::cli::print("  --style <f>       JSON file mapping categories to TML shape/color styles");
     armatools::cli::print("  --hm-scale <n>    Heightmap upscale factor (1, 2, 4, 8, 16)");
+    armatools::cli::print("  --hm-resample <m> Upscale kernel: bicubic|lanczos3 (default: bicubic)");
+    armatools::cli::print("  --hm-correct <p>  Upscale correction preset: none|sharp|retain_detail|terrain_16x (default: none)");
     armatools::cli::print("  --extract-models  Extract P3D models and textures to drive");
     armatools::cli::print("  --empty-layers    Generate TV4L layers without objects (for txt import)");
     armatools::cli::print("  --replace <f>     Apply model name replacements from TSV file");
@@ -118,7 +125,9 @@ int main(int argc, char* argv[]) {
     std::string db_path;
     int split_size = 10000;
     std::string style_path;
-    int hm_scale = 1;
+    HeightmapOptions hm_opts;
+    std::string hm_resample = "bicubic";
+    std::string hm_correct = "none";
     bool extract_models = false;
     bool empty_layers = false;
     std::string replace_file;
@@ -142,7 +151,9 @@ int main(int argc, char* argv[]) {
         else if (std::strcmp(argv[i], "--db") == 0 && i + 1 < argc) db_path = argv[++i];
         else if (std::strcmp(argv[i], "--split") == 0 && i + 1 < argc) split_size = std::stoi(argv[++i]);
         else if (std::strcmp(argv[i], "--style") == 0 && i + 1 < argc) style_path = argv[++i];
-        else if (std::strcmp(argv[i], "--hm-scale") == 0 && i + 1 < argc) hm_scale = std::stoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--hm-scale") == 0 && i + 1 < argc) hm_opts.scale = std::stoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--hm-resample") == 0 && i + 1 < argc) hm_resample = argv[++i];
+        else if (std::strcmp(argv[i], "--hm-correct") == 0 && i + 1 < argc) hm_correct = argv[++i];
         else if (std::strcmp(argv[i], "--extract-models") == 0) extract_models = true;
         else if (std::strcmp(argv[i], "--empty-layers") == 0) empty_layers = true;
         else if (std::strcmp(argv[i], "--replace") == 0 && i + 1 < argc) replace_file = argv[++i];
@@ -161,6 +172,22 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    namespace hp = armatools::heightpipe;
+    if (hm_resample == "bicubic") hm_opts.resample = hp::ResampleMethod::Bicubic;
+    else if (hm_resample == "lanczos3") hm_opts.resample = hp::ResampleMethod::Lanczos3;
+    else {
+        LOGE("--hm-resample must be bicubic or lanczos3");
+        return 1;
+    }
+    if (hm_correct == "none") hm_opts.correction = hp::CorrectionPreset::None;
+    else if (hm_correct == "sharp") hm_opts.correction = hp::CorrectionPreset::Sharp;
+    else if (hm_correct == "retain_detail") hm_opts.correction = hp::CorrectionPreset::RetainDetail;
+    else if (hm_correct == "terrain_16x") hm_opts.correction = hp::CorrectionPreset::Terrain16x;
+    else {
+        LOGE("--hm-correct must be none, sharp, retain_detail or terrain_16x");
+        return 1;
+    }
+
     std::string input_path = positional[0];
     input_path = expand_user_path(input_path);
     std::string input_display = fs::path(input_path).filename().string();
@@ -329,7 +356,7 @@ int main(int argc, char* argv[]) {
     if (!replace_file.empty()) proj.replace_map = &rmap;
 
     // Initialize heightmap (with optional upscale)
-    init_heightmap(proj, hm_scale);
+    init_heightmap(proj, hm_opts);
 
     // Generate all output files
     struct Step {
@@ -3,10 +3,12 @@
 #include "replacement_map.h"
 
 #include "armatools/wrp.h"
+#include "armatools/heightpipe.h"
 #include "armatools/roadobj.h"
 #include "armatools/tb.h"
 
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -36,6 +38,13 @@ struct MapMetadata {
     std::string start_date;
 };
 
+// HeightmapOptions controls the heightmap upscale in init_heightmap.
+struct HeightmapOptions {
+    int scale = 1; // 1, 2, 4, 8 or 16
+    armatools::heightpipe::ResampleMethod resample = armatools::heightpipe::ResampleMethod::Bicubic;
+    armatools::heightpipe::CorrectionPreset correction = armatools::heightpipe::CorrectionPreset::None;
+};
+
 // ProjectInfo holds all parameters needed by the generator functions.
 struct ProjectInfo {
     std::string name;
@@ -56,6 +65,11 @@ struct ProjectInfo {
     bool empty_layers = false;   // generate TV4L layers without objects (for txt import)
     ReplacementMap* replace_map = nullptr;
 
+    // Interned models of world->objects, shared by the object-based
+    // generators. Built on first use by models(); reset it after renaming
+    // objects.
+    std::optional<armatools::wrp::ModelTable> model_table;
+
     // Effective heightmap (after optional upscale)
     int hm_width = 0;
     int hm_height = 0;
@@ -78,12 +92,15 @@ struct ProjectInfo {
 
     // P:-drive relative directory for this project.
     std::string p_drive_dir() const;
+
+    // Model table of world->objects, built on first use.
+    const armatools::wrp::ModelTable& models();
 };
 
 // --- Generator function declarations ---
 
 // heightmap
-void init_heightmap(ProjectInfo& p, int scale);
+void init_heightmap(ProjectInfo& p, const HeightmapOptions& opts);
 void write_heightmap_asc(ProjectInfo& p);
 
 // config generation
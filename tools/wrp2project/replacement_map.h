@@ -1,5 +1,7 @@
 #pragma once
 
+#include <armatools/wrp.h>
+
 #include <algorithm>
 #include <cctype>
 #include <format>
@@ -69,6 +71,17 @@ struct ReplacementMap {
         return {"", false};
     }
 
+    // resolve looks up every model of a table once. The result is indexed by
+    // model id and holds the replacement, or "" when the model has none.
+    std::vector<std::string> resolve(const armatools::wrp::ModelTable& models) const {
+        std::vector<std::string> out(models.size());
+        for (uint32_t id = 0; id < models.size(); id++) {
+            auto [new_name, found] = lookup(models[id].name);
+            if (found && rmap_to_lower(new_name) != "unmatched") out[id] = std::move(new_name);
+        }
+        return out;
+    }
+
     bool is_matched(const std::string& model_name) const {
         auto [n, found] = lookup(model_name);
         return found && rmap_to_lower(n) != "unmatched";
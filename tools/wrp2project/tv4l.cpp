@@ -1,5 +1,7 @@
 #include "project.h"
 
+#include "armatools/parallel.h"
+
 #include <algorithm>
 #include <array>
 #include <cmath>
@@ -121,32 +123,6 @@ struct LeafObj {
     float yaw, pitch, roll, scale;
     uint32_t id;
 };
-struct LeafObjGroup { uint32_t template_hash; std::vector<LeafObj> objects; };
-struct ObjEntry { LeafObj obj; uint32_t hash; };
-
-static void buf_write_f64(std::vector<uint8_t>& buf, double v) {
-    uint64_t u; std::memcpy(&u, &v, 8);
-    auto p = reinterpret_cast<const uint8_t*>(&u); buf.insert(buf.end(), p, p + 8);
-}
-static void buf_write_f32(std::vector<uint8_t>& buf, float v) {
-    uint32_t u; std::memcpy(&u, &v, 4);
-    auto p = reinterpret_cast<const uint8_t*>(&u); buf.insert(buf.end(), p, p + 4);
-}
-static void buf_write_i32(std::vector<uint8_t>& buf, int32_t v) {
-    uint32_t u = static_cast<uint32_t>(v);
-    auto p = reinterpret_cast<const uint8_t*>(&u); buf.insert(buf.end(), p, p + 4);
-}
-static void buf_write_u32(std::vector<uint8_t>& buf, uint32_t v) {
-    auto p = reinterpret_cast<const uint8_t*>(&v); buf.insert(buf.end(), p, p + 4);
-}
-
-static void buf_write_bbox(std::vector<uint8_t>& buf, const TreeBBox& bb) {
-    buf_write_f64(buf, bb.min_y);
-    buf_write_f64(buf, bb.min_x);
-    buf_write_f64(buf, bb.max_y);
-    buf_write_f64(buf, bb.max_x);
-}
-
 static int child_index_for(double x, double y, const TreeBBox& bb) {
     double mid_x = (bb.min_x + bb.max_x) / 2;
     double mid_y = (bb.min_y + bb.max_y) / 2;
@@ -167,93 +143,182 @@ static float normalize_angle_deg(double angle) {
     return static_cast<float>(a);
 }
 
-static void write_leaf(std::vector<uint8_t>& buf, const TreeBBox& bbox, int depth,
-                       const std::vector<ObjEntry>& entries) {
-    std::unordered_map<uint32_t, std::vector<LeafObj>> by_hash;
-    for (const auto& e : entries) by_hash[e.hash].push_back(e.obj);
-
-    std::vector<uint32_t> hashes;
-    hashes.reserve(by_hash.size());
-    for (const auto& [h, _] : by_hash) hashes.push_back(h);
-    std::sort(hashes.begin(), hashes.end());
-
-    buf_write_bbox(buf, bbox);
-    buf_write_i32(buf, depth);
-    buf_write_i32(buf, hashes.empty() ? 0 : static_cast<int32_t>(hashes.front()));
-    buf_write_i32(buf, static_cast<int32_t>(hashes.size()));
-
-    for (uint32_t h : hashes) {
-        const auto& objs = by_hash[h];
-        buf_write_i32(buf, static_cast<int32_t>(objs.size()));
-        buf_write_u32(buf, h);
-        for (const auto& obj : objs) {
-            // Object payload used by TB layer serializer in this stream (40 bytes).
-            buf_write_f64(buf, obj.x);
-            buf_write_f64(buf, obj.y);
-            buf_write_f32(buf, obj.yaw);
-            // TB stores pitch/roll in these legacy serializer slots.
-            buf_write_f32(buf, obj.pitch);
-            buf_write_f32(buf, obj.roll);
-            buf_write_f32(buf, obj.scale);
-            buf_write_f32(buf, obj.z);
-            buf_write_u32(buf, obj.id);
+// TreeWriter serializes a layer's objects as a TB quadtree without copying
+// them per node. Every object gets its quadrant path below the root (two
+// bits per level in TB child order, most significant level first); sorting
+// by path makes each node a contiguous range of positions, and children are
+// found by binary search. A sizing pass computes the exact blob size and
+// groups each leaf by template hash in place, then the write pass fills a
+// buffer allocated once.
+class TreeWriter {
+public:
+    TreeWriter(const std::vector<LeafObj>& objs, const std::vector<uint32_t>& hashes, const TreeBBox& root)
+        : objs_(objs), hashes_(hashes), root_(root) {
+        constexpr int levels = TB_QTREE_MAX_DEPTH;
+        std::vector<uint64_t> keys(objs.size());
+        for (size_t i = 0; i < objs.size(); i++) {
+            TreeBBox bb = root;
+            uint32_t path = 0;
+            for (int d = 0; d < levels; d++) {
+                int c = child_index_for(objs[i].x, objs[i].y, bb);
+                path |= static_cast<uint32_t>(c) << (2 * (levels - 1 - d));
+                bb = bb.child(c);
+            }
+            keys[i] = (static_cast<uint64_t>(path) << 32) | i; // ties keep input order
+        }
+        std::sort(keys.begin(), keys.end());
+        paths_.resize(keys.size());
+        order_.resize(keys.size());
+        for (size_t i = 0; i < keys.size(); i++) {
+            paths_[i] = static_cast<uint32_t>(keys[i] >> 32);
+            order_[i] = static_cast<uint32_t>(keys[i]);
         }
     }
-}
 
-static void write_inner(std::vector<uint8_t>& buf, const TreeBBox& bbox, int depth,
-                        const std::vector<ObjEntry>& entries, int max_depth,
-                        int leaf_target) {
-    std::array<std::vector<ObjEntry>, 4> child_entries;
-    for (const auto& e : entries) {
-        int ci = child_index_for(e.obj.x, e.obj.y, bbox);
-        if (ci < 0 || ci >= static_cast<int>(child_entries.size())) continue;
-        child_entries[static_cast<size_t>(ci)].push_back(e);
+    // serialize returns the tree blob: u32 payload size, then the nodes.
+    std::vector<uint8_t> serialize() {
+        out_ = nullptr;
+        size_ = 0;
+        write_inner(root_, 0, 0, order_.size());
+
+        std::vector<uint8_t> buf(4 + size_);
+        auto payload_size = static_cast<uint32_t>(size_);
+        std::memcpy(buf.data(), &payload_size, 4);
+        out_ = buf.data() + 4;
+        size_ = 0;
+        write_inner(root_, 0, 0, order_.size());
+        return buf;
+    }
+
+private:
+    const std::vector<LeafObj>& objs_;
+    const std::vector<uint32_t>& hashes_;
+    TreeBBox root_;
+    std::vector<uint32_t> paths_; // quadrant path by sorted position
+    std::vector<uint32_t> order_; // object index by sorted position; leaves regrouped by hash
+    uint8_t* out_ = nullptr;      // nullptr during the sizing pass
+    size_t size_ = 0;
+
+    void put(const void* p, size_t n) {
+        if (out_) std::memcpy(out_ + size_, p, n);
+        size_ += n;
+    }
+    void put_u8(uint8_t v) { put(&v, 1); }
+    void put_i32(int32_t v) { put(&v, 4); }
+    void put_u32(uint32_t v) { put(&v, 4); }
+    void put_f32(float v) { put(&v, 4); }
+    void put_f64(double v) { put(&v, 8); }
+    void put_bbox(const TreeBBox& bb) {
+        put_f64(bb.min_y);
+        put_f64(bb.min_x);
+        put_f64(bb.max_y);
+        put_f64(bb.max_x);
     }
 
-    const bool force_full_inner = (depth < TB_QTREE_FULL_INNER_DEPTH);
-    const bool force_depth8_inner = (depth == TB_QTREE_FULL_INNER_DEPTH);
-
-    uint8_t children_type = 0x01;
-    uint8_t child_mask = 0;
-
-    if (force_full_inner) {
-        // Match TB dense topology in upper levels.
-        children_type = 0x01;
-        child_mask = 0x0F;
-    } else if (force_depth8_inner && entries.empty()) {
-        // TB uses explicit empty inner nodes at this level.
-        children_type = 0xFF;
-        child_mask = 0x00;
-    } else {
-        for (size_t c = 0; c < child_entries.size(); c++) {
-            if (!child_entries[c].empty()) {
-                child_mask |= static_cast<uint8_t>(1u << static_cast<unsigned>(c));
+    // child_end returns the end of the positions in [begin, end) whose
+    // quadrant at depth is at most c.
+    size_t child_end(size_t begin, size_t end, int depth, int c) const {
+        const int shift = 2 * (TB_QTREE_MAX_DEPTH - 1 - depth);
+        auto it = std::partition_point(paths_.begin() + static_cast<std::ptrdiff_t>(begin),
+                                       paths_.begin() + static_cast<std::ptrdiff_t>(end),
+                                       [&](uint32_t path) { return static_cast<int>((path >> shift) & 3u) <= c; });
+        return static_cast<size_t>(it - paths_.begin());
+    }
+
+    void write_leaf(const TreeBBox& bbox, int depth, size_t begin, size_t end) {
+        auto first = order_.begin() + static_cast<std::ptrdiff_t>(begin);
+        auto last = order_.begin() + static_cast<std::ptrdiff_t>(end);
+        if (!out_) {
+            std::sort(first, last, [&](uint32_t a, uint32_t b) {
+                return hashes_[a] != hashes_[b] ? hashes_[a] < hashes_[b] : a < b;
+            });
+        }
+
+        int32_t groups = 0;
+        for (auto it = first; it != last; ++it) {
+            if (it == first || hashes_[*it] != hashes_[*(it - 1)]) groups++;
+        }
+
+        put_bbox(bbox);
+        put_i32(depth);
+        put_i32(static_cast<int32_t>(hashes_[*first]));
+        put_i32(groups);
+
+        for (auto it = first; it != last;) {
+            uint32_t h = hashes_[*it];
+            auto group_end = std::find_if(it, last, [&](uint32_t i) { return hashes_[i] != h; });
+            put_i32(static_cast<int32_t>(group_end - it));
+            put_u32(h);
+            if (!out_) {
+                size_ += static_cast<size_t>(group_end - it) * 40;
+                it = group_end;
+                continue;
+            }
+            for (; it != group_end; ++it) {
+                const LeafObj& obj = objs_[*it];
+                // Object payload used by TB layer serializer in this stream (40 bytes).
+                put_f64(obj.x);
+                put_f64(obj.y);
+                put_f32(obj.yaw);
+                // TB stores pitch/roll in these legacy serializer slots.
+                put_f32(obj.pitch);
+                put_f32(obj.roll);
+                put_f32(obj.scale);
+                put_f32(obj.z);
+                put_u32(obj.id);
             }
         }
-        bool children_are_leaves =
-            (depth + 1 >= max_depth) || (entries.size() <= static_cast<size_t>(leaf_target));
-        children_type = children_are_leaves ? 0x10 : 0x01;
     }
 
-    buf.push_back(children_type);
-    buf_write_bbox(buf, bbox);
-    buf_write_i32(buf, depth);
-    // TB-native TV4L stores 0 in this slot for inner nodes.
-    buf_write_i32(buf, 0);
-    buf.push_back(child_mask);
-
-    for (size_t c = 0; c < child_entries.size(); c++) {
-        uint8_t bit = static_cast<uint8_t>(1u << static_cast<unsigned>(c));
-        if ((child_mask & bit) == 0) continue;
-
-        TreeBBox cb = bbox.child(static_cast<int>(c));
-        if (children_type == 0x10)
-            write_leaf(buf, cb, depth + 1, child_entries[c]);
-        else
-            write_inner(buf, cb, depth + 1, child_entries[c], max_depth, leaf_target);
+    void write_inner(const TreeBBox& bbox, int depth, size_t begin, size_t end) {
+        std::array<size_t, 5> bounds{begin, 0, 0, 0, end};
+        for (int c = 0; c < 3; c++) bounds[static_cast<size_t>(c + 1)] = child_end(bounds[static_cast<size_t>(c)], end, depth, c);
+        const size_t count = end - begin;
+
+        const bool force_full_inner = (depth < TB_QTREE_FULL_INNER_DEPTH);
+        const bool force_depth8_inner = (depth == TB_QTREE_FULL_INNER_DEPTH);
+
+        uint8_t children_type = 0x01;
+        uint8_t child_mask = 0;
+
+        if (force_full_inner) {
+            // Match TB dense topology in upper levels.
+            children_type = 0x01;
+            child_mask = 0x0F;
+        } else if (force_depth8_inner && count == 0) {
+            // TB uses explicit empty inner nodes at this level.
+            children_type = 0xFF;
+            child_mask = 0x00;
+        } else {
+            for (size_t c = 0; c < 4; c++) {
+                if (bounds[c + 1] > bounds[c]) {
+                    child_mask |= static_cast<uint8_t>(1u << static_cast<unsigned>(c));
+                }
+            }
+            bool children_are_leaves =
+                (depth + 1 >= TB_QTREE_MAX_DEPTH) || (count <= static_cast<size_t>(TB_QTREE_LEAF_TARGET));
+            children_type = children_are_leaves ? 0x10 : 0x01;
+        }
+
+        put_u8(children_type);
+        put_bbox(bbox);
+        put_i32(depth);
+        // TB-native TV4L stores 0 in this slot for inner nodes.
+        put_i32(0);
+        put_u8(child_mask);
+
+        for (size_t c = 0; c < 4; c++) {
+            uint8_t bit = static_cast<uint8_t>(1u << static_cast<unsigned>(c));
+            if ((child_mask & bit) == 0) continue;
+
+            TreeBBox cb = bbox.child(static_cast<int>(c));
+            if (children_type == 0x10)
+                write_leaf(cb, depth + 1, bounds[c], bounds[c + 1]);
+            else
+                write_inner(cb, depth + 1, bounds[c], bounds[c + 1]);
+        }
     }
-}
+};
 
 static bool utm_easting_from_lon_lat(double lon_deg, double lat_deg, int zone, double& easting_out) {
     if (zone < 1 || zone > 60) return false;
@@ -380,8 +445,10 @@ static std::vector<uint8_t> build_layer_tree(const std::vector<LayerObject>& obj
         if (!model_name_ci.count(low)) model_name_ci[low] = name;
     }
 
-    std::vector<ObjEntry> entries;
+    std::vector<LeafObj> entries;
+    std::vector<uint32_t> hashes;
     entries.reserve(objects.size());
+    hashes.reserve(objects.size());
     // TB object IDs in TV4L start from 10000 (mobjectIDcounter keeps additional headroom).
     uint32_t next_id = 10000;
 
@@ -401,7 +468,7 @@ static std::vector<uint8_t> build_layer_tree(const std::vector<LayerObject>& obj
             }
         }
 
-        entries.push_back({{
+        entries.push_back({
             obj.x,
             obj.y,
             static_cast<float>(obj.z),
@@ -410,21 +477,14 @@ static std::vector<uint8_t> build_layer_tree(const std::vector<LayerObject>& obj
             normalize_angle_deg(obj.roll),
             static_cast<float>(obj.scale),
             next_id++
-        }, h});
+        });
+        hashes.push_back(h);
     }
 
     serialized_count_out = static_cast<uint32_t>(entries.size());
 
-    std::vector<uint8_t> buf;
-    buf.reserve(4 + entries.size() * 64);
-    buf.resize(4, 0);
-
     // Root must be an inner node; for empty layers write a valid empty root.
-    write_inner(buf, root, 0, entries, TB_QTREE_MAX_DEPTH, TB_QTREE_LEAF_TARGET);
-
-    uint32_t payload_size = static_cast<uint32_t>(buf.size() - 4);
-    std::memcpy(buf.data(), &payload_size, 4);
-    return buf;
+    return TreeWriter(entries, hashes, root).serialize();
 }
 
 static std::string cat_file_name_l(const std::string& cat) {
@@ -443,6 +503,8 @@ static char utm_zone_letter(double latitude) {
     return letters[band];
 }
 
+// write_layer_tv4l writes one layer file. layer_ptr must already be
+// allocated so that layers can be written concurrently.
 static void write_layer_tv4l(const std::string& layers_dir, const std::string& file_name,
                                const std::string& layer_name, const std::vector<LayerObject>& objects,
                                const std::vector<Tv4lLibEntry>& libs,
@@ -454,8 +516,8 @@ static void write_layer_tv4l(const std::string& layers_dir, const std::string& f
     auto tree_blob = build_layer_tree(objects, models, root_bbox, serialized_count);
 
     Tv4lBuf root;
-    if (layer_ptr != 0) root.class_preamble_ptr("CLayer", layer_ptr);
-    else root.class_preamble("CLayer");
+    root.data.reserve(tree_blob.size() + 64 * models.size() + 512);
+    root.class_preamble_ptr("CLayer", layer_ptr);
     root.str("mname", layer_name);
     root.u32_val("mlayerVersion", 4);
     root.u32_alt("mnPriority", 0);
@@ -513,36 +575,55 @@ void write_tv4l(ProjectInfo& p) {
     // Write an empty default layer first
     write_layer_tv4l(layers_dir, "default", "default", {}, {}, {}, {}, 1, default_layer_ptr, default_bbox, utm_letter, utm_number);
 
-    // Write one layer per category with its objects
+    // Layers are prepared in category order so pointers are allocated as
+    // before, then the trees are built and written on worker threads.
+    struct LayerJob {
+        std::string safe;
+        const std::vector<LayerObject>* objs = nullptr;
+        std::vector<Tv4lLibEntry> libs;
+        std::unordered_map<std::string, uint32_t> model_lib_id;
+        std::vector<std::string> models;
+        TreeBBox root_bbox;
+        uint32_t layer_id = 0;
+        uint32_t layer_ptr = 0;
+    };
+    static const std::vector<LayerObject> no_objects;
+
+    std::vector<LayerJob> jobs;
+    jobs.reserve(p.categories.size());
     uint32_t layer_id = 2;
     bool active_layer_bound = false;
     for (const auto& cat : p.categories) {
         const auto& objs = p.cat_objects[cat];
-        std::string lib_name = p.cat_lib_names[cat];
+        const std::string& lib_name = p.cat_lib_names[cat];
 
+        LayerJob& job = jobs.emplace_back();
         // Build lib entry for this category
-        std::vector<Tv4lLibEntry> libs;
-        std::unordered_map<std::string, uint32_t> model_lib_id;
         if (!lib_name.empty()) {
             uint32_t id = armatools::tb::sdbm_hash(lib_name);
-            libs.push_back({lib_name, id});
+            job.libs.push_back({lib_name, id});
             for (const auto& obj : objs)
-                model_lib_id[obj.model_name] = id;
+                job.model_lib_id.try_emplace(obj.model_name, id);
         }
 
-        auto models = unique_model_names(objs);
-        auto root_bbox = compute_layer_tree_bbox(p, objs);
-        std::string safe = cat_file_name_l(cat);
+        job.models = unique_model_names(objs);
+        job.root_bbox = compute_layer_tree_bbox(p, objs);
+        job.safe = cat_file_name_l(cat);
         // When empty_layers is set, create the layer structure (libs, models)
         // but without objects — user will import from txt files.
-        const auto& layer_objs = p.empty_layers ? std::vector<LayerObject>{} : objs;
-        uint32_t layer_ptr = 0;
+        job.objs = p.empty_layers ? &no_objects : &objs;
+        job.layer_id = layer_id++;
         if (!active_layer_bound) {
-            layer_ptr = p.active_layer_ptr;
+            job.layer_ptr = p.active_layer_ptr;
             active_layer_bound = true;
+        } else {
+            job.layer_ptr = p.alloc_ptr();
         }
-        write_layer_tv4l(layers_dir, safe, safe, layer_objs, libs, model_lib_id,
-                          models, layer_id, layer_ptr, root_bbox, utm_letter, utm_number);
-        layer_id++;
     }
+
+    armatools::binutil::parallel_for(jobs.size(), armatools::binutil::worker_count(0), [&](size_t i) {
+        const LayerJob& job = jobs[i];
+        write_layer_tv4l(layers_dir, job.safe, job.safe, *job.objs, job.libs, job.model_lib_id,
+                         job.models, job.layer_id, job.layer_ptr, job.root_bbox, utm_letter, utm_number);
+    });
 }
@@ -604,9 +604,10 @@ void write_alb1_file(const std::string& path, const std::vector<uint8_t>& payloa
     write_string_table(file, tag_ids().at("tags"), tag_ids());
     write_string_table(file, tag_ids().at("classes"), class_ids());
 
-    file.insert(file.end(), payload.begin(), payload.end());
-
+    // The payload can be large (TV4L object trees); write it after the
+    // header instead of copying it into the header buffer.
     std::ofstream out(path, std::ios::binary);
     if (!out) throw std::runtime_error("cannot create " + path);
     out.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+    out.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
 }
@@ -185,35 +185,53 @@ static double width_from_id(int id) {
     }
 }
 
-static std::vector<armatools::roadnet::Polyline> polylines_from_shp(const std::string& shp_path,
-                                                                      double offset_x, double offset_z) {
-    auto src = armatools::shp::open(shp_path);
+// polylines_from_shp imports the roads of a shapefile that touch the map
+// area, shifted back to world coordinates.
+static std::vector<armatools::roadnet::Polyline> polylines_from_shp(const ProjectInfo& p) {
+    auto src = armatools::shp::Reader::open(p.roads_shp);
+    double offset_x = p.offset_x, offset_z = p.offset_z;
+    std::vector<size_t> records;
+    if (p.world->bounds.world_size_x > 0 && p.world->bounds.world_size_y > 0) {
+        records = src->query({offset_x, offset_z, offset_x + p.world->bounds.world_size_x,
+                              offset_z + p.world->bounds.world_size_y});
+    } else {
+        records.resize(src->size());
+        for (size_t i = 0; i < records.size(); i++) records[i] = i;
+    }
+
+    int id_col = src->field_index("ID"), width_col = src->field_index("WIDTH");
+    int order_col = src->field_index("ORDER"), segments_col = src->field_index("SEGMENTS");
+    int road_type_col = src->field_index("ROADTYPE"), map_col = src->field_index("MAP");
+    int terrain_col = src->field_index("TERRAIN");
+
     std::vector<armatools::roadnet::Polyline> polylines;
-    for (const auto& rec : src.records) {
-        for (const auto& part : rec.parts) {
+    for (size_t r : records) {
+        auto rec = src->record(r);
+        for (size_t pi = 0; pi < rec.part_count(); pi++) {
+            auto part = rec.part(pi);
             if (part.size() < 2) continue;
             std::vector<std::array<double, 2>> points;
+            points.reserve(part.size());
             double length = 0;
-            for (size_t i = 0; i < part.size(); i++) {
-                points.push_back({part[i].x - offset_x, part[i].y - offset_z});
-                if (i > 0) {
-                    double dx = points[i][0] - points[i - 1][0];
-                    double dy = points[i][1] - points[i - 1][1];
+            for (auto pt : part) {
+                points.push_back({pt.x - offset_x, pt.y - offset_z});
+                if (points.size() > 1) {
+                    double dx = points.back()[0] - points[points.size() - 2][0];
+                    double dy = points.back()[1] - points[points.size() - 2][1];
                     length += std::sqrt(dx * dx + dy * dy);
                 }
             }
 
-            int id = armatools::shp::attr_int(rec.attrs, "ID");
-            double width = armatools::shp::attr_float64(rec.attrs, "WIDTH");
-            int order = armatools::shp::attr_int(rec.attrs, "ORDER");
-            int segments = armatools::shp::attr_int(rec.attrs, "SEGMENTS");
-            std::string road_type, map_type;
-            auto rt = rec.attrs.find("ROADTYPE"); if (rt != rec.attrs.end()) road_type = rt->second;
-            auto mt = rec.attrs.find("MAP"); if (mt != rec.attrs.end()) map_type = mt->second;
+            int id = static_cast<int>(src->integer(r, id_col));
+            double width = src->number(r, width_col);
+            int order = static_cast<int>(src->integer(r, order_col));
+            int segments = static_cast<int>(src->integer(r, segments_col));
+            std::string road_type(src->text(r, road_type_col));
+            std::string map_type(src->text(r, map_col));
             if (road_type.empty()) road_type = road_type_from_id(id);
             if (map_type.empty()) map_type = map_type_from_id(id);
             if (width == 0) width = width_from_id(id);
-            double terrain = armatools::shp::attr_float64(rec.attrs, "TERRAIN");
+            double terrain = src->number(r, terrain_col);
             if (terrain == 0) terrain = width + 2;
 
             polylines.push_back({points, road_type,
@@ -246,12 +264,12 @@ static void write_road_tv4s(ProjectInfo& p, const std::string& shapes_dir) {
     std::vector<armatools::roadnet::Polyline> polylines;
 
     if (!p.roads_shp.empty()) {
-        polylines = polylines_from_shp(p.roads_shp, p.offset_x, p.offset_z);
+        polylines = polylines_from_shp(p);
     } else {
         if (!p.world->road_links.empty())
             polylines = armatools::roadnet::extract_from_road_links(p.world->road_links);
         if (polylines.empty() && !p.world->objects.empty())
-            polylines = armatools::roadnet::extract_from_objects(p.world->objects);
+            polylines = armatools::roadnet::extract_from_objects(p.world->objects, p.models());
     }
 
     if (polylines.empty()) {
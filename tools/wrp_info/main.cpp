@@ -267,12 +267,9 @@ static std::string to_lower(std::string s) {
 }
 
 static std::string parse_new_roads_shape(const std::string& config_path) {
-    // The text parser is a stub, so this won't work yet.
-    // Keep it for when the text parser is implemented.
-    std::ifstream f(config_path);
-    if (!f) return "";
+    if (!std::filesystem::exists(config_path)) return "";
     try {
-        auto cfg = armatools::config::parse_text(f);
+        auto cfg = armatools::config::parse_text_file(config_path);
         // Search for CfgWorlds -> concrete class -> newRoadsShape
         for (const auto& ne : cfg.root.entries) {
             if (to_lower(ne.name) != "cfgworlds") continue;
@@ -2,6 +2,7 @@
 #include "armatools/roadobj.h"
 #include "armatools/tb.h"
 #include "../wrp2project/replacement_map.h"
+#include "wrp_patch.h"
 
 #include <nlohmann/json.hpp>
 
@@ -43,21 +44,32 @@ struct ReplacementStats {
     std::vector<UnmappedEntry> unmapped;
 };
 
-static ReplacementStats compute_stats(const std::vector<armatools::wrp::ObjectRecord>& objects,
-                                       const ReplacementMap& rmap) {
+// Replacement target per model id of a ModelTable, "" where the model keeps its name.
+using ModelTargets = std::vector<std::string>;
+
+static const std::string& output_name(const armatools::wrp::ModelTable& models,
+                                      const ModelTargets& targets, uint32_t id) {
+    return targets[id].empty() ? models[id].name : targets[id];
+}
+
+static ReplacementStats compute_stats(const armatools::wrp::ModelTable& models,
+                                       const ModelTargets& targets, const ReplacementMap& rmap) {
     struct MK { std::string from, to; bool operator==(const MK& o) const { return from == o.from && to == o.to; } };
     struct MKHash { size_t operator()(const MK& k) const { return std::hash<std::string>()(k.from) ^ std::hash<std::string>()(k.to); }};
     std::unordered_map<MK, int, MKHash> mapping_counts;
     std::unordered_map<std::string, int> unmapped_counts;
 
+    int total = 0;
     int replaced = 0;
-    for (const auto& obj : objects) {
-        auto [new_name, found] = rmap.lookup(obj.model_name);
-        if (found && to_lower(new_name) != "unmatched") {
-            replaced++;
-            mapping_counts[{obj.model_name, new_name}]++;
+    for (uint32_t id = 0; id < models.size(); id++) {
+        const auto& e = models[id];
+        int n = static_cast<int>(e.object_count);
+        total += n;
+        if (!targets[id].empty()) {
+            replaced += n;
+            mapping_counts[{e.name, targets[id]}] += n;
         } else {
-            unmapped_counts[obj.model_name]++;
+            unmapped_counts[e.name] += n;
         }
     }
 
@@ -79,18 +91,17 @@ static ReplacementStats compute_stats(const std::vector<armatools::wrp::ObjectRe
         return a.source_class < b.source_class;
     });
 
-    return {static_cast<int>(objects.size()), 0, replaced,
-            static_cast<int>(objects.size()) - replaced, rmap.len(), mappings, unmapped};
+    return {total, 0, replaced, total - replaced, rmap.len(), mappings, unmapped};
 }
 
 // --- Output writers ---
 
 static void write_objects_tb(std::ostream& w, const std::vector<armatools::wrp::ObjectRecord>& objects,
-                              const ReplacementMap& rmap, double offset_x, double offset_z) {
-    for (const auto& obj : objects) {
-        std::string name = obj.model_name;
-        auto [new_name, found] = rmap.lookup(name);
-        if (found && to_lower(new_name) != "unmatched") name = new_name;
+                              const armatools::wrp::ModelTable& models, const ModelTargets& targets,
+                              double offset_x, double offset_z) {
+    for (size_t i = 0; i < objects.size(); i++) {
+        const auto& obj = objects[i];
+        const auto& name = output_name(models, targets, models.id(i));
 
         double x = obj.position[0] + offset_x;
         double y = obj.position[2] + offset_z;
@@ -102,14 +113,17 @@ static void write_objects_tb(std::ostream& w, const std::vector<armatools::wrp::
 }
 
 static void write_classes_json(std::ostream& w, const std::vector<armatools::wrp::ObjectRecord>& objects,
-                                const ReplacementMap& rmap, bool pretty) {
+                                const armatools::wrp::ModelTable& models, const ModelTargets& targets,
+                                bool pretty) {
     struct Acc { int count = 0; double sum[3] = {}; };
     std::unordered_map<std::string, Acc> classes;
-    for (const auto& obj : objects) {
-        std::string name = obj.model_name;
-        auto [new_name, found] = rmap.lookup(name);
-        if (found && to_lower(new_name) != "unmatched") name = new_name;
-        auto& acc = classes[name];
+    std::vector<Acc*> model_acc(models.size());
+    for (uint32_t id = 0; id < models.size(); id++) {
+        model_acc[id] = &classes[output_name(models, targets, id)];
+    }
+    for (size_t i = 0; i < objects.size(); i++) {
+        const auto& obj = objects[i];
+        auto& acc = *model_acc[models.id(i)];
         acc.count++;
         acc.sum[0] += obj.position[0];
         acc.sum[1] += obj.position[1];
@@ -161,12 +175,12 @@ static void write_stats_json(std::ostream& w, const ReplacementStats& stats, boo
 
 // --- Unique models ---
 
-static std::vector<std::string> unique_models(const std::vector<armatools::wrp::ObjectRecord>& objects) {
+static std::vector<std::string> unique_models(const armatools::wrp::ModelTable& table) {
     std::set<std::string> seen;
     std::vector<std::string> models;
-    for (const auto& obj : objects) {
-        auto lower = to_lower(obj.model_name);
-        if (seen.insert(lower).second) models.push_back(obj.model_name);
+    for (const auto& e : table.entries()) {
+        auto lower = to_lower(e.name);
+        if (seen.insert(lower).second) models.push_back(e.name);
     }
     std::sort(models.begin(), models.end(), [](const auto& a, const auto& b) {
         return to_lower(a) < to_lower(b);
@@ -188,9 +202,104 @@ static void append_unmatched_to_file(const std::string& path, const ReplacementM
     }
 }
 
+// --- Binary patch ---
+
+// to_wrp_model_path turns a replacement target into the form stored in WRP
+// model tables: first candidate of a ";" list, backslashes, .p3d extension.
+static std::string to_wrp_model_path(std::string name) {
+    auto semi = name.find(';');
+    if (semi != std::string::npos) name.resize(semi);
+    name = rmap_trim(std::move(name));
+    std::replace(name.begin(), name.end(), '/', '\\');
+    if (!name.empty() && name[0] == '\\') name.erase(0, 1);
+    if (to_lower(fs::path(name).extension().string()) != ".p3d") name += ".p3d";
+    return name;
+}
+
+static ModelTablePatch build_model_patch(const std::vector<std::string>& models,
+                                          const ReplacementMap& rmap,
+                                          const armatools::roadobj::RoadMap& roads, bool keep_roads) {
+    ModelTablePatch patch;
+    std::unordered_map<std::string, uint32_t> index; // lowercased name -> new table index
+    patch.remap.reserve(models.size());
+    for (const auto& model : models) {
+        std::string name = model;
+        if (keep_roads || !roads.is_road(model)) {
+            auto [new_name, found] = rmap.lookup(model);
+            if (found && to_lower(new_name) != "unmatched") name = to_wrp_model_path(new_name);
+        }
+        auto [it, inserted] = index.try_emplace(to_lower(name), static_cast<uint32_t>(patch.names.size()));
+        if (inserted) patch.names.push_back(name);
+        patch.remap.push_back(it->second);
+    }
+    return patch;
+}
+
+static int run_patch(const std::string& replacements_path, const std::string& input_path,
+                     const std::string& output_path, ReplacementMap& rmap,
+                     const armatools::roadobj::RoadMap& roads, bool keep_roads) {
+    std::ifstream f(input_path, std::ios::binary);
+    if (!f) {
+        std::cerr << "Error: cannot open " << input_path << '\n';
+        return 1;
+    }
+
+    armatools::wrp::WorldData world;
+    try {
+        world = armatools::wrp::read(f, {.no_objects = true, .no_mapinfo = true});
+    } catch (const std::exception& e) {
+        std::cerr << "Error: parsing " << input_path << ": " << e.what() << '\n';
+        return 1;
+    }
+    f.close();
+
+    int append_count = 0;
+    for (const auto& m : world.models) {
+        if (m.empty() || (!keep_roads && roads.is_road(m))) continue;
+        auto [_, found] = rmap.lookup(m);
+        if (!found) {
+            rmap.add_entry(m, "unmatched");
+            append_count++;
+        }
+    }
+    if (append_count > 0) {
+        append_unmatched_to_file(replacements_path, rmap, append_count);
+        std::cerr << "Appended " << append_count << " unmatched models to " << replacements_path << '\n';
+    }
+
+    auto patch = build_model_patch(world.models, rmap, roads, keep_roads);
+
+    PatchResult result;
+    try {
+        result = patch_wrp(input_path, output_path, world.layout, patch);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+
+    uint64_t replaced_objects = 0;
+    size_t replaced_models = 0;
+    for (size_t i = 0; i < world.models.size(); i++) {
+        if (patch.names[patch.remap[i]] == world.models[i]) continue;
+        replaced_models++;
+        replaced_objects += result.objects_per_model[i];
+    }
+
+    std::cerr << "Parsed: " << input_path << " (" << world.format.signature << " v" << world.format.version << ")\n";
+    std::cerr << std::format("Models: {} in WRP, {} replaced, {} after merging duplicates\n",
+                              world.models.size(), replaced_models, patch.names.size());
+    std::cerr << std::format("Objects: {} total, {} replaced, {} kept original\n",
+                              result.objects, replaced_objects, result.objects - replaced_objects);
+    std::cerr << "Output: " << output_path << " (" << result.bytes_written << " bytes)\n";
+    return 0;
+}
+
 static void print_usage() {
-    std::cerr << "Usage: wrp_objreplace [flags] <replacements.txt> <input.wrp> <output_dir>\n\n"
-              << "Applies model name replacements to WRP objects and writes Terrain Builder files.\n\n"
+    std::cerr << "Usage: wrp_objreplace [flags] <replacements.txt> <input.wrp> <output_dir>\n"
+              << "       wrp_objreplace [flags] -patch <output.wrp> <replacements.txt> <input.wrp>\n"
+              << "       wrp_objreplace [flags] --in-place <replacements.txt> <input.wrp>\n\n"
+              << "Applies model name replacements to WRP objects and writes Terrain Builder files,\n"
+              << "or patches the WRP model table directly (OPRW only).\n\n"
               << "Output files:\n"
               << "  objects.txt           Terrain Builder text import format\n"
               << "  objects.tml           Terrain Builder template library\n"
@@ -201,7 +310,9 @@ static void print_usage() {
               << "  --keep-roads          Keep road objects (skipped by default)\n"
               << "  -offset-x <n>        X coordinate offset (default: 200000)\n"
               << "  -offset-z <n>        Z coordinate offset (default: 0)\n"
-              << "  -roads <file>        Road type mapping file (TSV)\n";
+              << "  -roads <file>        Road type mapping file (TSV)\n"
+              << "  -patch <file>        Write a patched copy of the WRP instead of TB files\n"
+              << "  --in-place            Patch the input WRP itself\n";
 }
 
 int main(int argc, char* argv[]) {
@@ -210,6 +321,8 @@ int main(int argc, char* argv[]) {
     double offset_x = 200000;
     double offset_z = 0;
     std::string roads_file;
+    std::string patch_path;
+    bool in_place = false;
     std::vector<std::string> positional;
 
     for (int i = 1; i < argc; i++) {
@@ -218,6 +331,8 @@ int main(int argc, char* argv[]) {
         else if (std::strcmp(argv[i], "-offset-x") == 0 && i + 1 < argc) offset_x = std::stod(argv[++i]);
         else if (std::strcmp(argv[i], "-offset-z") == 0 && i + 1 < argc) offset_z = std::stod(argv[++i]);
         else if (std::strcmp(argv[i], "-roads") == 0 && i + 1 < argc) roads_file = argv[++i];
+        else if (std::strcmp(argv[i], "-patch") == 0 && i + 1 < argc) patch_path = argv[++i];
+        else if (std::strcmp(argv[i], "--in-place") == 0) in_place = true;
         else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
             print_usage();
             return 0;
@@ -226,14 +341,16 @@ int main(int argc, char* argv[]) {
         }
     }
 
-    if (positional.size() < 3) {
+    bool patch_mode = in_place || !patch_path.empty();
+    if (positional.size() < (patch_mode ? 2u : 3u)) {
         print_usage();
         return 1;
     }
 
     std::string replacements_path = positional[0];
     std::string input_path = positional[1];
-    std::string output_dir = positional[2];
+    std::string output_dir = patch_mode ? std::string() : positional[2];
+    if (in_place) patch_path = input_path;
 
     // Load road map
     armatools::roadobj::RoadMap roads;
@@ -259,6 +376,10 @@ int main(int argc, char* argv[]) {
     }
     std::cerr << "Loaded " << rmap.len() << " replacement rules from " << replacements_path << '\n';
 
+    if (patch_mode) {
+        return run_patch(replacements_path, input_path, patch_path, rmap, roads, keep_roads);
+    }
+
     // Parse WRP
     std::ifstream f(input_path, std::ios::binary);
     if (!f) {
@@ -280,24 +401,31 @@ int main(int argc, char* argv[]) {
     }
 
     // Filter road objects
-    auto objects = world.objects;
+    const size_t wrp_objects = world.objects.size();
+    auto objects = std::move(world.objects);
+    auto models = armatools::wrp::ModelTable::build(objects);
     int skipped_roads = 0;
     if (!keep_roads) {
+        std::vector<bool> model_is_road(models.size());
+        for (uint32_t id = 0; id < models.size(); id++) {
+            model_is_road[id] = roads.classify_base(models[id].base_name).has_value();
+        }
         std::vector<armatools::wrp::ObjectRecord> filtered;
         filtered.reserve(objects.size());
-        for (const auto& obj : objects) {
-            if (roads.is_road(obj.model_name)) {
+        for (size_t i = 0; i < objects.size(); i++) {
+            if (model_is_road[models.id(i)]) {
                 skipped_roads++;
             } else {
-                filtered.push_back(obj);
+                filtered.push_back(std::move(objects[i]));
             }
         }
         objects = std::move(filtered);
+        models = armatools::wrp::ModelTable::build(objects);
     }
 
     // Auto-append unmatched
     int append_count = 0;
-    for (const auto& u : unique_models(objects)) {
+    for (const auto& u : unique_models(models)) {
         auto [_, found] = rmap.lookup(u);
         if (!found) {
             rmap.add_entry(u, "unmatched");
@@ -310,7 +438,8 @@ int main(int argc, char* argv[]) {
     }
 
     // Stats
-    auto stats = compute_stats(objects, rmap);
+    auto targets = rmap.resolve(models);
+    auto stats = compute_stats(models, targets, rmap);
     stats.skipped_roads = skipped_roads;
 
     // Create output dir
@@ -320,31 +449,29 @@ int main(int argc, char* argv[]) {
     {
         std::ofstream out(fs::path(output_dir) / "objects.txt");
         if (!out) { std::cerr << "Error: creating objects.txt\n"; return 1; }
-        write_objects_tb(out, objects, rmap, offset_x, offset_z);
+        write_objects_tb(out, objects, models, targets, offset_x, offset_z);
     }
 
     // Write objects.tml
     {
         std::set<std::string> seen;
-        std::vector<std::string> models;
-        for (const auto& obj : objects) {
-            std::string name = obj.model_name;
-            auto [new_name, found] = rmap.lookup(name);
-            if (found && to_lower(new_name) != "unmatched") name = new_name;
-            if (seen.insert(to_lower(name)).second) models.push_back(name);
+        std::vector<std::string> names;
+        for (uint32_t id = 0; id < models.size(); id++) {
+            const auto& name = output_name(models, targets, id);
+            if (seen.insert(to_lower(name)).second) names.push_back(name);
         }
-        std::sort(models.begin(), models.end());
+        std::sort(names.begin(), names.end());
 
         std::ofstream out(fs::path(output_dir) / "objects.tml");
         if (!out) { std::cerr << "Error: creating objects.tml\n"; return 1; }
-        armatools::tb::write_tml(out, "WRP_Objects", models, nullptr, armatools::tb::default_style());
+        armatools::tb::write_tml(out, "WRP_Objects", names, nullptr, armatools::tb::default_style());
     }
 
     // Write classes.json
     {
         std::ofstream out(fs::path(output_dir) / "classes.json");
         if (!out) { std::cerr << "Error: creating classes.json\n"; return 1; }
-        write_classes_json(out, objects, rmap, pretty);
+        write_classes_json(out, objects, models, targets, pretty);
     }
 
     // Write replacement_stats.json
@@ -358,7 +485,7 @@ int main(int argc, char* argv[]) {
     std::cerr << "Parsed: " << input_path << " (" << world.format.signature << " v" << world.format.version << ")\n";
     if (skipped_roads > 0) {
         std::cerr << std::format("Objects: {} in WRP, {} roads skipped, {} remaining\n",
-                                  world.objects.size(), skipped_roads, objects.size());
+                                  wrp_objects, skipped_roads, objects.size());
     }
     std::cerr << std::format("Objects: {} total, {} replaced, {} kept original\n",
                               stats.total_objects, stats.replaced_objects, stats.kept_objects);
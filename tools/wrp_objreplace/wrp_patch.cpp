@@ -0,0 +1,111 @@
+#include "wrp_patch.h"
+
+#include "armatools/binutil.h"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t kCopyBufferSize = 4 * 1024 * 1024;
+
+void copy_range(std::istream& in, std::ostream& out, uint64_t n, std::vector<char>& buf) {
+    while (n > 0) {
+        auto chunk = static_cast<std::streamsize>(std::min<uint64_t>(n, buf.size()));
+        if (!in.read(buf.data(), chunk))
+            throw std::runtime_error("patch: unexpected end of input");
+        if (!out.write(buf.data(), chunk))
+            throw std::runtime_error("patch: write failed");
+        n -= static_cast<uint64_t>(chunk);
+    }
+}
+
+void copy_rest(std::istream& in, std::ostream& out, std::vector<char>& buf) {
+    while (in) {
+        in.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+        auto got = in.gcount();
+        if (got > 0 && !out.write(buf.data(), got))
+            throw std::runtime_error("patch: write failed");
+    }
+}
+
+} // namespace
+
+PatchResult patch_wrp(const fs::path& input, const fs::path& output,
+                      const armatools::wrp::LayoutInfo& layout, const ModelTablePatch& patch) {
+    if (layout.models_offset < 0 || layout.models_end < layout.models_offset ||
+        layout.objects_offset < layout.models_end || layout.object_record_size <= 0) {
+        throw std::runtime_error("patch: WRP layout unknown (binary patching supports OPRW only)");
+    }
+
+    std::ifstream in(input, std::ios::binary);
+    if (!in) throw std::runtime_error(std::format("patch: cannot open {}", input.string()));
+
+    fs::path tmp = output;
+    tmp += ".tmp";
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error(std::format("patch: cannot create {}", tmp.string()));
+
+    PatchResult result;
+    result.objects_per_model.assign(patch.remap.size(), 0);
+    std::vector<char> buf(kCopyBufferSize);
+
+    try {
+        // Header and terrain sections up to the model table.
+        copy_range(in, out, static_cast<uint64_t>(layout.models_offset), buf);
+
+        // New model table. The count field is 4 bytes in both OPRW variants.
+        armatools::binutil::write_u32(out, static_cast<uint32_t>(patch.names.size()));
+        for (const auto& name : patch.names) armatools::binutil::write_asciiz(out, name);
+        in.seekg(layout.models_end);
+
+        // Sections between the model table and the object records
+        // (classed models, offset quadtrees, road net, ...).
+        copy_range(in, out, static_cast<uint64_t>(layout.objects_offset - layout.models_end), buf);
+
+        // Object records, patched a buffer at a time.
+        const size_t rec = static_cast<size_t>(layout.object_record_size);
+        const size_t recs_per_chunk = buf.size() / rec;
+        uint64_t remaining = static_cast<uint64_t>(layout.objects_size) / rec;
+        result.objects = remaining;
+        while (remaining > 0) {
+            size_t n = static_cast<size_t>(std::min<uint64_t>(remaining, recs_per_chunk));
+            auto bytes = static_cast<std::streamsize>(n * rec);
+            if (!in.read(buf.data(), bytes))
+                throw std::runtime_error("patch: unexpected end of object records");
+            for (size_t i = 0; i < n; i++) {
+                char* field = buf.data() + i * rec + 4;
+                int32_t idx;
+                std::memcpy(&idx, field, 4);
+                if (idx < 0 || static_cast<size_t>(idx) >= patch.remap.size()) continue;
+                result.objects_per_model[static_cast<size_t>(idx)]++;
+                auto new_idx = static_cast<int32_t>(patch.remap[static_cast<size_t>(idx)]);
+                std::memcpy(field, &new_idx, 4);
+            }
+            if (!out.write(buf.data(), bytes)) throw std::runtime_error("patch: write failed");
+            remaining -= n;
+        }
+
+        // Sentinel (legacy), map infos and anything else after the objects.
+        copy_rest(in, out, buf);
+
+        out.flush();
+        if (!out) throw std::runtime_error(std::format("patch: write failed: {}", tmp.string()));
+        result.bytes_written = static_cast<uint64_t>(out.tellp());
+        out.close();
+        in.close();
+        fs::rename(tmp, output);
+    } catch (...) {
+        out.close();
+        std::error_code ec;
+        fs::remove(tmp, ec);
+        throw;
+    }
+
+    return result;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "armatools/wrp.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// New model table for a binary patch: names[] is written in place of the
+// original table and remap[old_index] gives each old model's new index.
+struct ModelTablePatch {
+    std::vector<std::string> names;
+    std::vector<uint32_t> remap;
+};
+
+struct PatchResult {
+    uint64_t objects = 0;
+    uint64_t bytes_written = 0;
+    std::vector<uint64_t> objects_per_model; // indexed by old model index
+};
+
+// patch_wrp copies input to output, replacing the model table and rewriting
+// the model index of every object record. All other sections are streamed
+// through unchanged. output may equal input; the result is written to a
+// temporary file next to output and renamed over it.
+PatchResult patch_wrp(const std::filesystem::path& input, const std::filesystem::path& output,
+                      const armatools::wrp::LayoutInfo& layout, const ModelTablePatch& patch);
@@ -1,13 +1,12 @@
 #include "asset_provider.h"
 #include "mapinfo_tiles.h"
 #include "mosaic.h"
+#include "tile_loader.h"
 
 #include <armatools/wrp.h>
 #include <armatools/pboindex.h>
 #include <armatools/rvmat.h>
 
-#include "png_stream_writer.h"
-
 #include <algorithm>
 #include <cmath>
 #include <cctype>
@@ -26,44 +25,71 @@
 #include <chrono>
 #include <limits>
 #include <new>
-
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include <stb_image_write.h>
+#include <optional>
 
 namespace fs = std::filesystem;
 
 struct TileLoadReport {
-    std::vector<RasterTile> tiles;
     std::vector<std::string> missing_paths;
     std::vector<std::string> decode_failures;
 };
 
-static TileLoadReport load_tiles(const std::vector<TileRef>& refs, const AssetProvider& provider) {
-    TileLoadReport report;
+// write_tile_mosaic streams the MapInfo tiles with grid coordinates into a PNG.
+// Returns nullopt if no tile has coordinates; throws if none can be decoded.
+static std::optional<MosaicResult> write_tile_mosaic(const std::vector<TileRef>& refs,
+                                                     const AssetProvider& provider,
+                                                     const fs::path& path,
+                                                     const MosaicOptions& opts,
+                                                     TileLoadReport& report) {
+    std::optional<int> min_x, min_y, max_x, max_y;
     for (const auto& ref : refs) {
-        auto bytes = provider.read(ref.path);
-        if (!bytes) {
-            report.missing_paths.push_back(ref.path);
-            continue;
-        }
+        if (ref.x < 0 || ref.y < 0) continue;
+        min_x = min_x ? std::min(*min_x, ref.x) : ref.x;
+        max_x = max_x ? std::max(*max_x, ref.x) : ref.x;
+        min_y = min_y ? std::min(*min_y, ref.y) : ref.y;
+        max_y = max_y ? std::max(*max_y, ref.y) : ref.y;
+    }
+    if (!min_x || !min_y || !max_x || !max_y) return std::nullopt;
+
+    CellMosaic mosaic;
+    mosaic.columns = *max_x - *min_x + 1;
+    mosaic.rows = *max_y - *min_y + 1;
+    mosaic.cell_tiles.assign(static_cast<size_t>(mosaic.columns) * static_cast<size_t>(mosaic.rows), -1);
+    mosaic.tile_count = refs.size();
+    mosaic.read = [&](size_t i) { return provider.read(refs[i].path); };
+    for (size_t i = 0; i < refs.size(); ++i) {
+        if (refs[i].x < 0 || refs[i].y < 0) continue;
+        size_t cell = static_cast<size_t>(refs[i].y - *min_y) * static_cast<size_t>(mosaic.columns)
+                      + static_cast<size_t>(refs[i].x - *min_x);
+        mosaic.cell_tiles[cell] = static_cast<int>(i);
+    }
+
+    auto result = write_mosaic(mosaic, path, opts);
+    for (size_t i = 0; i < refs.size(); ++i) {
+        if (result.tiles[i] == TileOutcome::Missing) report.missing_paths.push_back(refs[i].path);
+        if (result.tiles[i] == TileOutcome::DecodeFailed) report.decode_failures.push_back(refs[i].path);
+    }
+    return result;
+}
 
-        std::string data(reinterpret_cast<const char*>(bytes->data()), bytes->size());
-        std::istringstream stream(data, std::ios::binary);
-        try {
-            auto [image, header] = armatools::paa::decode(stream);
-            (void)header;
-            report.tiles.push_back({ref, std::move(image)});
-        } catch (const std::exception& e) {
-            report.decode_failures.push_back(ref.path);
-        }
-    }
-    return report;
+// output_path returns the PNG file or tile pyramid location for a layer.
+static fs::path output_path(const fs::path& out_root, const std::string& stem, const MosaicOptions& opts) {
+    if (opts.pyramid) return pyramid_path(out_root, stem, opts.pyramid->format);
+    return out_root / (stem + ".png");
 }
 
-static bool write_png(const fs::path& path, const MosaicResult& mosaic) {
-    if (mosaic.pixels.empty() || mosaic.width <= 0 || mosaic.height <= 0) return false;
-    return stbi_write_png(path.string().c_str(), mosaic.width, mosaic.height, 4,
-                          mosaic.pixels.data(), mosaic.width * 4);
+static void print_pyramid_summary(const char* label, const MosaicResult& result) {
+    if (result.max_zoom < 0) return;
+    std::cout << std::format("{} pyramid: zoom 0-{}, {} tiles written\n", label, result.max_zoom,
+                             result.pyramid_tiles);
+}
+
+static void print_output_size(const MosaicResult& layout, int max_resolution) {
+    std::cerr << "Output size: " << layout.width << "x" << layout.height << '\n';
+    if (layout.width != layout.canvas_width || layout.height != layout.canvas_height) {
+        std::cerr << "Max resolution cap: " << max_resolution << " -> scaled to "
+                  << layout.width << "x" << layout.height << '\n';
+    }
 }
 
 struct LegacyTextureState {
@@ -72,7 +98,6 @@ struct LegacyTextureState {
     bool blank_name = false;
     bool decode_failed = false;
     bool pac = false;
-    armatools::paa::Image image;
 };
 
 static std::string to_lower_ascii(std::string_view input) {
@@ -210,15 +235,14 @@ struct ModernTextureState {
     bool blank_name = false;
     bool decode_failed = false;
     bool pac = false;
-    std::shared_ptr<armatools::paa::Image> image;
 };
 
 static bool write_modern_sat_from_rvmat(const armatools::wrp::WorldData& world,
                                         const AssetProvider& provider,
                                         const fs::path& base,
                                         const fs::path& out_root,
-                                        bool verbose,
-                                        int max_resolution) {
+                                        const MosaicOptions& output) {
+    const bool verbose = output.verbose;
     auto log_verbose = [&](const std::string& msg) {
         if (verbose) std::cerr << msg << '\n';
     };
@@ -239,10 +263,18 @@ static bool write_modern_sat_from_rvmat(const armatools::wrp::WorldData& world,
     std::vector<ModernTextureState> states(world.textures.size());
     std::unordered_map<std::string, RvmatTextureInfo> rvmat_cache;
     std::unordered_map<std::string, bool> exists_cache;
-    std::unordered_map<std::string, std::shared_ptr<armatools::paa::Image>> texture_cache;
 
-    int tile_width = 0;
-    int tile_height = 0;
+    // Texture decode jobs, keyed by texture path and the RVMAT-relative
+    // fallback path; each job is read and decoded once for all its indices.
+    struct TextureJob {
+        std::string path;
+        std::string alt_path;
+        bool pac = false;
+        std::vector<int> indices;
+    };
+    std::vector<TextureJob> jobs;
+    std::unordered_map<std::string, size_t> job_by_key;
+
     int decoded_indices = 0;
     int failed_decode_indices = 0;
     int empty_name_indices = 0;
@@ -376,165 +408,67 @@ static bool write_modern_sat_from_rvmat(const armatools::wrp::WorldData& world,
 
         fs::path tex_fs(tex_path);
         auto ext = to_lower_ascii(tex_fs.extension().string());
-        bool is_pac = ext == ".pac";
-
-        auto cache_it = texture_cache.find(tex_path);
-        if (cache_it == texture_cache.end()) {
-            auto bytes = provider.read(tex_path);
-            if (!bytes && !rvmat_used.empty()) {
-                fs::path base_dir = fs::path(rvmat_used).parent_path();
-                auto alt_path = (base_dir / tex_path).string();
-                if (alt_path != tex_path) {
-                    bytes = provider.read(alt_path);
-                    if (bytes) tex_path = std::move(alt_path);
-                }
-            }
-            if (!bytes) {
-                state.decode_failed = true;
-                ++failed_decode_indices;
-                continue;
-            }
-
-            std::string data(reinterpret_cast<const char*>(bytes->data()), bytes->size());
-            std::istringstream stream(data, std::ios::binary);
-            try {
-                auto [image, header] = armatools::paa::decode(stream);
-                (void)header;
 
-                if (tile_width == 0) {
-                    tile_width = image.width;
-                    tile_height = image.height;
-                }
-                if (image.width != tile_width || image.height != tile_height) {
-                    state.decode_failed = true;
-                    ++failed_decode_indices;
-                    continue;
-                }
-
-                auto shared = std::make_shared<armatools::paa::Image>(std::move(image));
-                cache_it = texture_cache.emplace(tex_path, shared).first;
-                ++decoded_indices;
-            } catch (const std::exception&) {
-                state.decode_failed = true;
-                ++failed_decode_indices;
-                continue;
-            }
+        std::string alt_path;
+        if (!rvmat_used.empty()) {
+            alt_path = (fs::path(rvmat_used).parent_path() / tex_path).string();
+            if (alt_path == tex_path) alt_path.clear();
         }
-
-        state.decoded = true;
-        state.pac = is_pac;
-        state.image = cache_it->second;
-
-    }
-
-    if (tile_width == 0 || tile_height == 0) {
-        std::cerr << "Error: no tile could be decoded from RVMAT\n";
-        return false;
+        auto [job_it, inserted] = job_by_key.try_emplace(tex_path + '\n' + alt_path, jobs.size());
+        if (inserted) jobs.push_back({tex_path, alt_path, ext == ".pac", {}});
+        jobs[job_it->second].indices.push_back(idx);
     }
-    log_verbose(std::format("Tile dimensions: {}x{}", tile_width, tile_height));
 
-    uint64_t canvas_width64 = static_cast<uint64_t>(width) * static_cast<uint64_t>(tile_width);
-    uint64_t canvas_height64 = static_cast<uint64_t>(height) * static_cast<uint64_t>(tile_height);
-    if (canvas_width64 == 0 || canvas_height64 == 0) {
-        std::cerr << "Error: invalid canvas dimensions\n";
-        return false;
+    std::vector<int> job_of_index(states.size(), -1);
+    for (size_t j = 0; j < jobs.size(); ++j) {
+        for (int idx : jobs[j].indices) job_of_index[static_cast<size_t>(idx)] = static_cast<int>(j);
     }
-    log_verbose(std::format("Canvas size: {}x{}", canvas_width64, canvas_height64));
-
-    uint64_t pixel_count64 = canvas_width64 * canvas_height64;
-    const uint64_t pixels_limit = std::numeric_limits<size_t>::max() / 4;
-    if (pixel_count64 > pixels_limit) {
-        std::cerr << "Error: canvas too large to allocate (" << pixel_count64 * 4 << " bytes)\n";
-        return false;
-    }
-
-    size_t canvas_width = static_cast<size_t>(canvas_width64);
-    size_t canvas_height = static_cast<size_t>(canvas_height64);
 
-    int out_width = static_cast<int>(canvas_width);
-    int out_height = static_cast<int>(canvas_height);
-    double scale = 1.0;
-    if (max_resolution > 0) {
-        int max_dim = std::max(out_width, out_height);
-        if (max_dim > max_resolution) {
-            scale = static_cast<double>(max_resolution) / static_cast<double>(max_dim);
-            out_width = std::max(1, static_cast<int>(std::floor(static_cast<double>(canvas_width) * scale)));
-            out_height = std::max(1, static_cast<int>(std::floor(static_cast<double>(canvas_height) * scale)));
+    CellMosaic mosaic;
+    mosaic.columns = width;
+    mosaic.rows = height;
+    mosaic.flip_y = true;
+    mosaic.tile_count = jobs.size();
+    mosaic.cell_tiles.assign(expected, -1);
+    for (size_t i = 0; i < expected; ++i) {
+        int idx = static_cast<int>(world.cell_texture_indexes[i]);
+        if (idx > 0 && idx < static_cast<int>(states.size())) {
+            mosaic.cell_tiles[i] = job_of_index[static_cast<size_t>(idx)];
         }
     }
+    mosaic.read = [&](size_t j) {
+        auto bytes = provider.read(jobs[j].path);
+        if (!bytes && !jobs[j].alt_path.empty()) bytes = provider.read(jobs[j].alt_path);
+        return bytes;
+    };
 
-    log_verbose("Streaming PNG: enabled");
-    std::cerr << "Output size: " << out_width << "x" << out_height << '\n';
-    if (scale < 1.0) {
-        std::cerr << "Max resolution cap: " << max_resolution << " -> scaled to "
-                  << out_width << "x" << out_height << '\n';
-    }
+    MosaicOptions opts = output;
+    opts.on_layout = [&](const MosaicResult& layout) { print_output_size(layout, opts.max_resolution); };
 
-    fs::path sat_path = out_root / (base.string() + "_sat_lco.png");
+    fs::path sat_path = output_path(out_root, base.string() + "_sat_lco", opts);
+    MosaicResult result;
     try {
-        PngStreamWriter png_writer(sat_path, out_width, out_height, 4);
-        const size_t out_width_u = static_cast<size_t>(out_width);
-        std::vector<uint8_t> row(canvas_width * 4ull);
-        std::vector<uint8_t> scaled_row(out_width_u * 4ull);
-
-        for (int out_y = 0; out_y < out_height; ++out_y) {
-            std::fill(row.begin(), row.end(), 0);
-            size_t src_y = static_cast<size_t>(static_cast<uint64_t>(out_y) * canvas_height
-                                               / static_cast<uint64_t>(out_height));
-            src_y = (canvas_height - 1) - src_y;
-            size_t cell_y = src_y / static_cast<size_t>(tile_height);
-            size_t in_tile_y = src_y % static_cast<size_t>(tile_height);
-
-            size_t row_base = cell_y * static_cast<size_t>(width);
-
-            for (int cell_x = 0; cell_x < width; ++cell_x) {
-                size_t cell_idx = row_base + static_cast<size_t>(cell_x);
-                if (cell_idx >= world.cell_texture_indexes.size()) continue;
-                int tex_idx = static_cast<int>(world.cell_texture_indexes[cell_idx]);
-                if (tex_idx <= 0 || tex_idx >= static_cast<int>(states.size())) continue;
-                const auto& state = states[static_cast<size_t>(tex_idx)];
-                if (!state.decoded) continue;
-
-                const auto& image = *state.image;
-                const uint8_t* tile_row = image.pixels.data()
-                    + static_cast<size_t>(in_tile_y) * static_cast<size_t>(tile_width) * 4ull;
-                size_t dst_offset = static_cast<size_t>(cell_x) * static_cast<size_t>(tile_width) * 4ull;
-                size_t copy_bytes = static_cast<size_t>(tile_width) * 4u;
-                std::copy_n(tile_row, static_cast<std::vector<uint8_t>::difference_type>(copy_bytes),
-                            row.begin() + static_cast<std::vector<uint8_t>::difference_type>(dst_offset));
-            }
-
-            if (scale == 1.0) {
-                png_writer.write_row({row.data(), row.size()});
-            } else {
-                for (int out_x = 0; out_x < out_width; ++out_x) {
-                    size_t src_x = static_cast<size_t>(static_cast<uint64_t>(out_x) * canvas_width
-                                                       / static_cast<uint64_t>(out_width));
-                    size_t src_offset = src_x * 4ull;
-                    size_t dst_offset = static_cast<size_t>(out_x) * 4u;
-                    std::copy_n(row.begin() + static_cast<std::vector<uint8_t>::difference_type>(src_offset),
-                                4, scaled_row.begin() + static_cast<std::vector<uint8_t>::difference_type>(dst_offset));
-                }
-                png_writer.write_row({scaled_row.data(), scaled_row.size()});
-            }
-
-            if (verbose && (out_y % 256 == 0 || out_y == out_height - 1)) {
-                int pct = static_cast<int>((static_cast<int64_t>(out_y + 1) * 100) / out_height);
-                std::cerr << "["
-                          << std::setw(3) << pct
-                          << "%] "
-                          << (out_y + 1)
-                          << "/"
-                          << out_height
-                          << " rows\n";
-            }
-        }
-
-        png_writer.finish();
+        log_verbose(std::format("Decoding up to {} textures", jobs.size()));
+        result = write_mosaic(mosaic, sat_path, opts);
     } catch (const std::exception& e) {
-        std::cerr << "Error: streaming PNG failed: " << e.what() << '\n';
+        std::cerr << "Error: RVMAT SAT: " << e.what() << '\n';
         return false;
     }
+    print_pyramid_summary("Sat", result);
+
+    for (size_t j = 0; j < jobs.size(); ++j) {
+        auto outcome = result.tiles[j];
+        if (outcome == TileOutcome::Unused) continue;
+        bool ok = outcome == TileOutcome::Decoded;
+        if (ok) ++decoded_indices;
+        else failed_decode_indices += static_cast<int>(jobs[j].indices.size());
+        for (int idx : jobs[j].indices) {
+            auto& state = states[static_cast<size_t>(idx)];
+            state.decoded = ok;
+            state.decode_failed = !ok;
+            state.pac = jobs[j].pac;
+        }
+    }
 
     std::cerr << "Tile cache entries decoded: " << decoded_indices << '\n';
     std::cerr << "Blank index0 cells: " << blank_index0_cells << '\n';
@@ -548,8 +482,8 @@ static bool write_legacy_sat(const armatools::wrp::WorldData& world,
                              const AssetProvider& provider,
                              const fs::path& base,
                              const fs::path& out_root,
-                             bool verbose,
-                             int max_resolution) {
+                             const MosaicOptions& output) {
+    const bool verbose = output.verbose;
     auto log_verbose = [&](const std::string& msg) {
         if (verbose) std::cerr << msg << '\n';
     };
@@ -570,14 +504,14 @@ static bool write_legacy_sat(const armatools::wrp::WorldData& world,
     log_verbose(std::format("Legacy texture entries: {}", world.textures.size()));
 
     std::vector<LegacyTextureState> states(world.textures.size());
-    int tile_width = 0;
-    int tile_height = 0;
     int decoded_paa_indices = 0;
     int decoded_pac_indices = 0;
     int failed_decode_indices = 0;
     int empty_name_indices = 0;
     int blank_index0_cells = 0;
 
+    // Texture indexes to decode, in first-use order.
+    std::vector<size_t> pending;
     for (size_t i = 0; i < expected; ++i) {
         int idx = static_cast<int>(world.cell_texture_indexes[i]);
         if (idx == 0) {
@@ -596,153 +530,54 @@ static bool write_legacy_sat(const armatools::wrp::WorldData& world,
             ++empty_name_indices;
             continue;
         }
-
-        fs::path tex_path(tex_name);
-        auto ext = to_lower_ascii(tex_path.extension().string());
-        bool is_pac = ext == ".pac";
-
-        auto bytes = provider.read(tex_name);
-        if (!bytes) {
-            state.decode_failed = true;
-            ++failed_decode_indices;
-            continue;
-        }
-
-        std::string data(reinterpret_cast<const char*>(bytes->data()), bytes->size());
-        std::istringstream stream(data, std::ios::binary);
-        try {
-            auto [image, header] = armatools::paa::decode(stream);
-            (void)header;
-
-            if (tile_width == 0) {
-                tile_width = image.width;
-                tile_height = image.height;
-            }
-            if (image.width != tile_width || image.height != tile_height) {
-                state.decode_failed = true;
-                ++failed_decode_indices;
-                continue;
-            }
-
-            state.decoded = true;
-            state.pac = is_pac;
-            state.image = std::move(image);
-            if (is_pac) ++decoded_pac_indices;
-            else ++decoded_paa_indices;
-        } catch (const std::exception& e) {
-            state.decode_failed = true;
-            ++failed_decode_indices;
-        }
+        pending.push_back(static_cast<size_t>(idx));
     }
 
-    if (tile_width == 0 || tile_height == 0) {
-        std::cerr << "Error: no legacy tile could be decoded\n";
-        return false;
-    }
-    log_verbose(std::format("Legacy tile dimensions: {}x{}", tile_width, tile_height));
-
-    uint64_t canvas_width64 = static_cast<uint64_t>(width) * static_cast<uint64_t>(tile_width);
-    uint64_t canvas_height64 = static_cast<uint64_t>(height) * static_cast<uint64_t>(tile_height);
-    if (canvas_width64 == 0 || canvas_height64 == 0) {
-        std::cerr << "Error: invalid legacy canvas dimensions\n";
-        return false;
-    }
-    log_verbose(std::format("Legacy canvas size: {}x{}", canvas_width64, canvas_height64));
+    std::vector<int> job_of_index(states.size(), -1);
+    for (size_t j = 0; j < pending.size(); ++j) job_of_index[pending[j]] = static_cast<int>(j);
 
-    uint64_t pixel_count64 = canvas_width64 * canvas_height64;
-    const uint64_t pixels_limit = std::numeric_limits<size_t>::max() / 4;
-    if (pixel_count64 > pixels_limit) {
-        std::cerr << "Error: legacy canvas too large to allocate (" << pixel_count64 * 4 << " bytes)\n";
-        return false;
-    }
-
-    size_t canvas_width = static_cast<size_t>(canvas_width64);
-    size_t canvas_height = static_cast<size_t>(canvas_height64);
-
-    int out_width = static_cast<int>(canvas_width);
-    int out_height = static_cast<int>(canvas_height);
-    double scale = 1.0;
-    if (max_resolution > 0) {
-        int max_dim = std::max(out_width, out_height);
-        if (max_dim > max_resolution) {
-            scale = static_cast<double>(max_resolution) / static_cast<double>(max_dim);
-            out_width = std::max(1, static_cast<int>(std::floor(static_cast<double>(canvas_width) * scale)));
-            out_height = std::max(1, static_cast<int>(std::floor(static_cast<double>(canvas_height) * scale)));
+    CellMosaic mosaic;
+    mosaic.columns = width;
+    mosaic.rows = height;
+    mosaic.flip_y = true;
+    mosaic.tile_count = pending.size();
+    mosaic.cell_tiles.assign(expected, -1);
+    for (size_t i = 0; i < expected; ++i) {
+        int idx = static_cast<int>(world.cell_texture_indexes[i]);
+        if (idx > 0 && idx < static_cast<int>(states.size())) {
+            mosaic.cell_tiles[i] = job_of_index[static_cast<size_t>(idx)];
         }
     }
+    mosaic.read = [&](size_t j) { return provider.read(world.textures[pending[j]].filename); };
 
-    log_verbose("Streaming PNG: enabled");
-    std::cerr << "Output size: " << out_width << "x" << out_height << '\n';
-    if (scale < 1.0) {
-        std::cerr << "Max resolution cap: " << max_resolution << " -> scaled to "
-                  << out_width << "x" << out_height << '\n';
-    }
+    MosaicOptions opts = output;
+    opts.on_layout = [&](const MosaicResult& layout) { print_output_size(layout, opts.max_resolution); };
 
-    fs::path sat_path = out_root / (base.string() + "_sat_lco.png");
+    fs::path sat_path = output_path(out_root, base.string() + "_sat_lco", opts);
+    MosaicResult result;
     try {
-        PngStreamWriter png_writer(sat_path, out_width, out_height, 4);
-        const size_t out_width_u = static_cast<size_t>(out_width);
-        std::vector<uint8_t> row(canvas_width * 4ull);
-        std::vector<uint8_t> scaled_row(out_width_u * 4ull);
-
-        for (int out_y = 0; out_y < out_height; ++out_y) {
-            std::fill(row.begin(), row.end(), 0);
-            size_t src_y = static_cast<size_t>(static_cast<uint64_t>(out_y) * canvas_height
-                                               / static_cast<uint64_t>(out_height));
-            src_y = (canvas_height - 1) - src_y;
-            size_t cell_y = src_y / static_cast<size_t>(tile_height);
-            size_t in_tile_y = src_y % static_cast<size_t>(tile_height);
-
-            size_t row_base = cell_y * static_cast<size_t>(width);
-
-            for (int cell_x = 0; cell_x < width; ++cell_x) {
-                size_t cell_idx = row_base + static_cast<size_t>(cell_x);
-                if (cell_idx >= world.cell_texture_indexes.size()) continue;
-                int tex_idx = static_cast<int>(world.cell_texture_indexes[cell_idx]);
-                if (tex_idx <= 0 || tex_idx >= static_cast<int>(states.size())) continue;
-                const auto& state = states[static_cast<size_t>(tex_idx)];
-                if (!state.decoded) continue;
-
-                const auto& image = state.image;
-                const uint8_t* tile_row = image.pixels.data()
-                    + static_cast<size_t>(in_tile_y) * static_cast<size_t>(tile_width) * 4ull;
-                size_t dst_offset = static_cast<size_t>(cell_x) * static_cast<size_t>(tile_width) * 4ull;
-                size_t copy_bytes = static_cast<size_t>(tile_width) * 4u;
-                std::copy_n(tile_row, static_cast<std::vector<uint8_t>::difference_type>(copy_bytes),
-                            row.begin() + static_cast<std::vector<uint8_t>::difference_type>(dst_offset));
-            }
-
-            if (scale == 1.0) {
-                png_writer.write_row({row.data(), row.size()});
-            } else {
-                for (int out_x = 0; out_x < out_width; ++out_x) {
-                    size_t src_x = static_cast<size_t>(static_cast<uint64_t>(out_x) * canvas_width
-                                                       / static_cast<uint64_t>(out_width));
-                    size_t src_offset = src_x * 4ull;
-                    size_t dst_offset = static_cast<size_t>(out_x) * 4u;
-                    std::copy_n(row.begin() + static_cast<std::vector<uint8_t>::difference_type>(src_offset),
-                                4, scaled_row.begin() + static_cast<std::vector<uint8_t>::difference_type>(dst_offset));
-                }
-                png_writer.write_row({scaled_row.data(), scaled_row.size()});
-            }
-
-            if (verbose && (out_y % 256 == 0 || out_y == out_height - 1)) {
-                int pct = static_cast<int>((static_cast<int64_t>(out_y + 1) * 100) / out_height);
-                std::cerr << "["
-                          << std::setw(3) << pct
-                          << "%] "
-                          << (out_y + 1)
-                          << "/"
-                          << out_height
-                          << " rows\n";
-            }
-        }
-
-        png_writer.finish();
+        result = write_mosaic(mosaic, sat_path, opts);
     } catch (const std::exception& e) {
-        std::cerr << "Error: streaming PNG failed: " << e.what() << '\n';
+        std::cerr << "Error: legacy SAT: " << e.what() << '\n';
         return false;
     }
+    print_pyramid_summary("Sat", result);
+
+    for (size_t j = 0; j < pending.size(); ++j) {
+        auto outcome = result.tiles[j];
+        if (outcome == TileOutcome::Unused) continue;
+        auto& state = states[pending[j]];
+        if (outcome != TileOutcome::Decoded) {
+            state.decode_failed = true;
+            ++failed_decode_indices;
+            continue;
+        }
+        fs::path tex_path(world.textures[pending[j]].filename);
+        state.decoded = true;
+        state.pac = to_lower_ascii(tex_path.extension().string()) == ".pac";
+        if (state.pac) ++decoded_pac_indices;
+        else ++decoded_paa_indices;
+    }
 
     std::cerr << "Tile cache entries decoded: "
               << (decoded_paa_indices + decoded_pac_indices)
@@ -762,6 +597,12 @@ static void print_usage() {
               << "  --dump-tiles     Print extracted tile paths/coords\n"
               << "  -v               Enable verbose logging\n"
               << "  --max-resolution N  Cap largest dimension to N (default: 0 for no cap)\n"
+              << "  --threads N      Tile decode and PNG encode threads (default: 0 for all cores)\n"
+              << "  --parallel-png   Encode PNGs with the multithreaded deflate backend\n"
+              << "  --png-level N    zlib compression level 0-9 (default: 6)\n"
+              << "  --png-filter F   none, sub, up, average, paeth or adaptive (default: adaptive)\n"
+              << "  --pyramid FMT    Write a tile pyramid instead of one PNG: xyz (directory) or mbtiles\n"
+              << "  --tile-size N    Pyramid tile size, 256 or 512 (default: 256)\n"
               << "  -h, --help       Show this help message\n";
 }
 
@@ -771,6 +612,10 @@ int main(int argc, char* argv[]) {
     bool dump_tiles = false;
     bool verbose = false;
     int max_resolution = 0;
+    int threads = 0;
+    PngStreamOptions png;
+    std::optional<PyramidOptions> pyramid;
+    int tile_size = 256;
     std::vector<std::string> positional;
 
     for (int i = 1; i < argc; ++i) {
@@ -789,6 +634,51 @@ int main(int argc, char* argv[]) {
                 std::cerr << "Error: invalid value for --max-resolution\n";
                 return 1;
             }
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            try {
+                threads = std::max(0, std::stoi(argv[++i]));
+            } catch (...) {
+                std::cerr << "Error: invalid value for --threads\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--parallel-png") == 0) {
+            png.parallel = true;
+        } else if (std::strcmp(argv[i], "--png-level") == 0 && i + 1 < argc) {
+            try {
+                png.encode.level = std::stoi(argv[++i]);
+            } catch (...) {
+                png.encode.level = -1;
+            }
+            if (png.encode.level < 0 || png.encode.level > 9) {
+                std::cerr << "Error: invalid value for --png-level\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--png-filter") == 0 && i + 1 < argc) {
+            try {
+                png.encode.filter = armatools::png::parse_filter(argv[++i]);
+            } catch (...) {
+                std::cerr << "Error: invalid value for --png-filter\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--pyramid") == 0 && i + 1 < argc) {
+            std::string format = argv[++i];
+            pyramid.emplace();
+            if (format == "mbtiles") {
+                pyramid->format = PyramidFormat::MBTiles;
+            } else if (format != "xyz") {
+                std::cerr << "Error: invalid value for --pyramid (want xyz or mbtiles)\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--tile-size") == 0 && i + 1 < argc) {
+            try {
+                tile_size = std::stoi(argv[++i]);
+            } catch (...) {
+                tile_size = 0;
+            }
+            if (tile_size != 256 && tile_size != 512) {
+                std::cerr << "Error: invalid value for --tile-size (want 256 or 512)\n";
+                return 1;
+            }
         } else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
             print_usage();
             return 0;
@@ -857,10 +747,25 @@ int main(int argc, char* argv[]) {
     }
 
     AssetProvider provider(index, db);
+    threads = resolve_thread_count(threads);
+    log_verbose(std::format("Decode threads: {}", threads));
+    png.encode.threads = threads;
+
+    MosaicOptions opts;
+    opts.max_resolution = max_resolution;
+    opts.threads = threads;
+    opts.verbose = verbose;
+    opts.png = png;
+    if (pyramid) {
+        pyramid->tile_size = tile_size;
+        pyramid->threads = threads;
+        pyramid->encode = png.encode;
+        opts.pyramid = pyramid;
+    }
 
     if (legacy_format) {
         log_verbose("Processing legacy WRP path");
-        if (!write_legacy_sat(world, provider, base, out_root, verbose, max_resolution)) {
+        if (!write_legacy_sat(world, provider, base, out_root, opts)) {
             return 1;
         }
         return 0;
@@ -876,7 +781,7 @@ int main(int argc, char* argv[]) {
     }
     if (tiles.sat_tiles.empty()) {
         std::cerr << "Warning: no sat tiles found in MapInfo; falling back to RVMAT-based SAT.\n";
-        if (!write_modern_sat_from_rvmat(world, provider, base, out_root, verbose, max_resolution)) {
+        if (!write_modern_sat_from_rvmat(world, provider, base, out_root, opts)) {
             return 1;
         }
         return 0;
@@ -893,33 +798,28 @@ int main(int argc, char* argv[]) {
         dump("Mask", tiles.mask_tiles);
     }
 
-    auto sat_report = load_tiles(tiles.sat_tiles, provider);
-
-    log_verbose(std::format("Sat tiles decoded: {}; missing {}; decode failures: {}",
-                             sat_report.tiles.size(),
-                             sat_report.missing_paths.size(),
-                             sat_report.decode_failures.size()));
-    if (sat_report.tiles.empty()) {
-        std::cerr << "Error: no sat tiles could be decoded\n";
+    fs::path sat_path = output_path(out_root, base.string() + "_sat_lco", opts);
+    TileLoadReport sat_report;
+    std::optional<MosaicResult> sat_mosaic;
+    try {
+        sat_mosaic = write_tile_mosaic(tiles.sat_tiles, provider, sat_path, opts, sat_report);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: sat mosaic: " << e.what() << '\n';
         return 1;
     }
-
-    auto sat_mosaic = build_mosaic(sat_report.tiles);
     if (!sat_mosaic) {
         std::cerr << "Error: failed to build sat mosaic\n";
         return 1;
     }
 
-    fs::path sat_path = out_root / (base.string() + "_sat_lco.png");
-
-    if (!write_png(sat_path, *sat_mosaic)) {
-        std::cerr << "Error: could not write " << sat_path << '\n';
-        return 1;
-    }
-
+    log_verbose(std::format("Sat tiles decoded: {}; missing {}; decode failures: {}",
+                             sat_mosaic->placed_tiles,
+                             sat_report.missing_paths.size(),
+                             sat_report.decode_failures.size()));
     std::cout << std::format("Sat mosaic: {}x{} pixels (tile {}x{})\n",
                               sat_mosaic->width, sat_mosaic->height,
                               sat_mosaic->tile_width, sat_mosaic->tile_height);
+    print_pyramid_summary("Sat", *sat_mosaic);
 
     if (!sat_report.missing_paths.empty()) {
         std::cerr << "Missing sat tiles (" << sat_report.missing_paths.size() << "):\n";
@@ -935,17 +835,19 @@ int main(int argc, char* argv[]) {
     }
 
     if (!legacy_format && !tiles.mask_tiles.empty()) {
-        auto mask_report = load_tiles(tiles.mask_tiles, provider);
-        auto mask_mosaic = build_mosaic(mask_report.tiles);
+        fs::path mask_path = output_path(out_root, base.string() + "_mask_lco", opts);
+        TileLoadReport mask_report;
+        std::optional<MosaicResult> mask_mosaic;
+        try {
+            mask_mosaic = write_tile_mosaic(tiles.mask_tiles, provider, mask_path, opts, mask_report);
+        } catch (const std::exception& e) {
+            log_verbose(std::format("Mask mosaic: {}", e.what()));
+        }
         if (mask_mosaic && mask_mosaic->placed_tiles > 0) {
-            fs::path mask_path = out_root / (base.string() + "_mask_lco.png");
-            if (!write_png(mask_path, *mask_mosaic)) {
-                std::cerr << "Error: could not write " << mask_path << '\n';
-                return 1;
-            }
             std::cout << std::format("Mask mosaic: {}x{} pixels (tile {}x{})\n",
                                       mask_mosaic->width, mask_mosaic->height,
                                       mask_mosaic->tile_width, mask_mosaic->tile_height);
+            print_pyramid_summary("Mask", *mask_mosaic);
             log_verbose(std::format("Mask mosaic tiles placed: {}", mask_mosaic->placed_tiles));
         } else {
             std::cerr << "Warning: mask tiles could not be assembled\n";
@@ -1,64 +1,219 @@
 #include "mosaic.h"
 
+#include "png_stream_writer.h"
+
 #include <algorithm>
+#include <cmath>
+#include <format>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+
+MosaicResult write_mosaic(const CellMosaic& mosaic, const std::filesystem::path& path,
+                          const MosaicOptions& opts) {
+    auto log_verbose = [&](const std::string& msg) {
+        if (opts.verbose) std::cerr << msg << '\n';
+    };
+
+    const size_t columns = static_cast<size_t>(std::max(0, mosaic.columns));
+    const size_t rows = static_cast<size_t>(std::max(0, mosaic.rows));
+    if (columns == 0 || rows == 0 || mosaic.cell_tiles.size() != columns * rows) {
+        throw std::runtime_error("invalid mosaic grid");
+    }
+
+    MosaicResult result;
+    result.tiles.assign(mosaic.tile_count, TileOutcome::Unused);
+    std::vector<armatools::paa::Image> images(mosaic.tile_count);
+
+    auto tile_at = [&](size_t cell_x, size_t cell_y) -> int {
+        int id = mosaic.cell_tiles[cell_y * columns + cell_x];
+        return (id >= 0 && static_cast<size_t>(id) < mosaic.tile_count) ? id : -1;
+    };
+
+    auto accept = [&](size_t id, LoadedTile&& tile) {
+        switch (tile.status) {
+        case LoadedTile::Status::Missing:
+            result.tiles[id] = TileOutcome::Missing;
+            return;
+        case LoadedTile::Status::DecodeFailed:
+            result.tiles[id] = TileOutcome::DecodeFailed;
+            return;
+        case LoadedTile::Status::Ok:
+            break;
+        }
+        if (result.tile_width == 0) {
+            result.tile_width = tile.image.width;
+            result.tile_height = tile.image.height;
+        }
+        if (tile.image.width != result.tile_width || tile.image.height != result.tile_height ||
+            tile.image.width <= 0 || tile.image.height <= 0) {
+            result.tiles[id] = TileOutcome::SizeMismatch;
+            return;
+        }
+        result.tiles[id] = TileOutcome::Decoded;
+        images[id] = std::move(tile.image);
+    };
+
+    // Decodes the given tile ids in parallel and stores them.
+    auto decode = [&](const std::vector<size_t>& ids) {
+        load_tiles_ordered(
+            ids.size(), [&](size_t i) { return mosaic.read(ids[i]); }, opts.threads,
+            [&](size_t i, LoadedTile&& tile) { accept(ids[i], std::move(tile)); });
+    };
 
-std::optional<MosaicResult> build_mosaic(const std::vector<RasterTile>& tiles) {
-    if (tiles.empty()) return std::nullopt;
-
-    std::optional<int> min_x;
-    std::optional<int> min_y;
-    std::optional<int> max_x;
-    std::optional<int> max_y;
-    int tile_width = 0;
-    int tile_height = 0;
-
-    for (const auto& tile : tiles) {
-        if (tile.ref.x < 0 || tile.ref.y < 0) continue;
-        if (tile.image.width <= 0 || tile.image.height <= 0) continue;
-        if (tile_width == 0) {
-            tile_width = tile.image.width;
-            tile_height = tile.image.height;
+    // The tile size comes from the first tile id (in id order) that decodes.
+    std::vector<uint8_t> used(mosaic.tile_count, 0);
+    for (size_t y = 0; y < rows; ++y) {
+        for (size_t x = 0; x < columns; ++x) {
+            if (int id = tile_at(x, y); id >= 0) used[static_cast<size_t>(id)] = 1;
         }
-        if (tile.image.width != tile_width || tile.image.height != tile_height) continue;
+    }
+    for (size_t id = 0; id < mosaic.tile_count && result.tile_width == 0; ++id) {
+        if (used[id]) decode({id});
+    }
+    if (result.tile_width == 0) {
+        throw std::runtime_error("no tile could be decoded");
+    }
+    log_verbose(std::format("Tile dimensions: {}x{}", result.tile_width, result.tile_height));
 
-        min_x = min_x ? std::min(*min_x, tile.ref.x) : tile.ref.x;
-        max_x = max_x ? std::max(*max_x, tile.ref.x) : tile.ref.x;
-        min_y = min_y ? std::min(*min_y, tile.ref.y) : tile.ref.y;
-        max_y = max_y ? std::max(*max_y, tile.ref.y) : tile.ref.y;
+    const uint64_t canvas_width64 = static_cast<uint64_t>(columns) * static_cast<uint64_t>(result.tile_width);
+    const uint64_t canvas_height64 = static_cast<uint64_t>(rows) * static_cast<uint64_t>(result.tile_height);
+    constexpr uint64_t max_dim = static_cast<uint64_t>(std::numeric_limits<int>::max());
+    if (canvas_width64 > max_dim || canvas_height64 > max_dim) {
+        throw std::runtime_error(std::format("canvas too large ({}x{})", canvas_width64, canvas_height64));
     }
+    log_verbose(std::format("Canvas size: {}x{}", canvas_width64, canvas_height64));
 
-    if (!min_x || !min_y || !max_x || !max_y || tile_width == 0 || tile_height == 0) {
-        return std::nullopt;
+    const size_t canvas_width = static_cast<size_t>(canvas_width64);
+    const size_t canvas_height = static_cast<size_t>(canvas_height64);
+    result.canvas_width = static_cast<int>(canvas_width);
+    result.canvas_height = static_cast<int>(canvas_height);
+    result.width = result.canvas_width;
+    result.height = result.canvas_height;
+    double scale = 1.0;
+    if (opts.max_resolution > 0) {
+        int max_side = std::max(result.width, result.height);
+        if (max_side > opts.max_resolution) {
+            scale = static_cast<double>(opts.max_resolution) / static_cast<double>(max_side);
+            result.width = std::max(1, static_cast<int>(std::floor(static_cast<double>(canvas_width) * scale)));
+            result.height = std::max(1, static_cast<int>(std::floor(static_cast<double>(canvas_height) * scale)));
+        }
     }
+    if (opts.on_layout) opts.on_layout(result);
 
-    MosaicResult result;
-    result.tile_width = tile_width;
-    result.tile_height = tile_height;
-    result.width = (static_cast<int>(*max_x - *min_x + 1)) * tile_width;
-    result.height = (static_cast<int>(*max_y - *min_y + 1)) * tile_height;
-    result.pixels.assign(static_cast<size_t>(result.width) * static_cast<size_t>(result.height) * 4, 0);
-
-    for (const auto& tile : tiles) {
-        if (tile.ref.x < 0 || tile.ref.y < 0) continue;
-        if (tile.image.width != tile_width || tile.image.height != tile_height) continue;
-
-        int offset_x = (tile.ref.x - *min_x) * tile_width;
-        int offset_y = (tile.ref.y - *min_y) * tile_height;
-
-        if (offset_x < 0 || offset_y < 0) continue;
-        if (offset_x + tile_width > result.width || offset_y + tile_height > result.height) continue;
-
-        for (int row = 0; row < tile_height; ++row) {
-            auto row_offset = static_cast<size_t>(offset_y + row) * static_cast<size_t>(result.width);
-            auto dst_index = (row_offset + static_cast<size_t>(offset_x)) * 4;
-            size_t src_index = static_cast<size_t>(row) * static_cast<size_t>(tile_width) * 4;
-            using Diff = std::vector<uint8_t>::difference_type;
-            Diff copy_count = static_cast<Diff>(static_cast<size_t>(tile_width) * 4);
-            auto dst = result.pixels.begin() + static_cast<Diff>(dst_index);
-            std::copy_n(&tile.image.pixels[src_index], copy_count, dst);
+    const size_t tile_width = static_cast<size_t>(result.tile_width);
+    const size_t tile_height = static_cast<size_t>(result.tile_height);
+    const size_t out_height = static_cast<size_t>(result.height);
+
+    auto source_row = [&](size_t out_y) {
+        size_t src_y = static_cast<size_t>(static_cast<uint64_t>(out_y) * canvas_height / out_height);
+        return mosaic.flip_y ? (canvas_height - 1) - src_y : src_y;
+    };
+
+    // Band order and the last band each tile appears in, so tiles can be
+    // dropped as soon as the output has moved past them.
+    constexpr size_t never = std::numeric_limits<size_t>::max();
+    std::vector<size_t> bands;
+    for (size_t out_y = 0; out_y < out_height; ++out_y) {
+        size_t cell_y = source_row(out_y) / tile_height;
+        if (bands.empty() || bands.back() != cell_y) bands.push_back(cell_y);
+    }
+    std::vector<size_t> last_band(mosaic.tile_count, never);
+    for (size_t b = 0; b < bands.size(); ++b) {
+        for (size_t x = 0; x < columns; ++x) {
+            if (int id = tile_at(x, bands[b]); id >= 0) last_band[static_cast<size_t>(id)] = b;
+        }
+    }
+    for (size_t id = 0; id < mosaic.tile_count; ++id) {
+        if (last_band[id] == never) images[id] = {};
+    }
+
+    std::optional<PngStreamWriter> png_writer;
+    std::optional<PyramidWriter> pyramid_writer;
+    if (opts.pyramid) {
+        pyramid_writer.emplace(path, result.width, result.height, *opts.pyramid);
+        result.max_zoom = pyramid_writer->max_zoom();
+        log_verbose(std::format("Streaming tile pyramid: zoom 0-{}, {} px tiles", result.max_zoom,
+                                opts.pyramid->tile_size));
+    } else {
+        png_writer.emplace(path, result.width, result.height, 4, opts.png);
+        log_verbose(std::format("Streaming PNG: {} encoder", opts.png.parallel ? "parallel" : "libpng"));
+    }
+    auto write_row = [&](std::span<const uint8_t> out_row) {
+        if (pyramid_writer) pyramid_writer->write_row(out_row);
+        else png_writer->write_row(out_row);
+    };
+    std::vector<uint8_t> row(canvas_width * 4);
+    std::vector<uint8_t> scaled_row(static_cast<size_t>(result.width) * 4);
+    std::vector<size_t> band_tiles;
+    std::vector<size_t> band_seen(mosaic.tile_count, never);
+    size_t band = never;
+
+    for (size_t out_y = 0; out_y < out_height; ++out_y) {
+        size_t src_y = source_row(out_y);
+        size_t cell_y = src_y / tile_height;
+        size_t in_tile_y = src_y % tile_height;
+
+        if (band == never || bands[band] != cell_y) {
+            if (band != never) {
+                for (size_t id : band_tiles) {
+                    if (last_band[id] == band) images[id] = {};
+                }
+            }
+            band = (band == never) ? 0 : band + 1;
+
+            band_tiles.clear();
+            std::vector<size_t> pending;
+            for (size_t x = 0; x < columns; ++x) {
+                int id = tile_at(x, cell_y);
+                if (id < 0) continue;
+                auto uid = static_cast<size_t>(id);
+                if (band_seen[uid] == band) continue;
+                band_seen[uid] = band;
+                band_tiles.push_back(uid);
+                if (result.tiles[uid] == TileOutcome::Unused) pending.push_back(uid);
+            }
+            decode(pending);
+        }
+
+        std::fill(row.begin(), row.end(), 0);
+        for (size_t cell_x = 0; cell_x < columns; ++cell_x) {
+            int id = tile_at(cell_x, cell_y);
+            if (id < 0) continue;
+            const auto& image = images[static_cast<size_t>(id)];
+            if (image.pixels.empty()) continue;
+            const uint8_t* tile_row = image.pixels.data() + in_tile_y * tile_width * 4;
+            std::copy_n(tile_row, tile_width * 4, row.data() + cell_x * tile_width * 4);
+        }
+
+        if (scale == 1.0) {
+            write_row({row.data(), row.size()});
+        } else {
+            for (size_t out_x = 0; out_x < static_cast<size_t>(result.width); ++out_x) {
+                size_t src_x = static_cast<size_t>(static_cast<uint64_t>(out_x) * canvas_width
+                                                   / static_cast<uint64_t>(result.width));
+                std::copy_n(row.data() + src_x * 4, 4, scaled_row.data() + out_x * 4);
+            }
+            write_row({scaled_row.data(), scaled_row.size()});
+        }
+
+        if (opts.verbose && (out_y % 256 == 0 || out_y + 1 == out_height)) {
+            auto pct = ((out_y + 1) * 100) / out_height;
+            std::cerr << "[" << std::setw(3) << pct << "%] " << (out_y + 1) << "/" << out_height
+                      << " rows\n";
         }
-        ++result.placed_tiles;
+    }
+    if (pyramid_writer) {
+        pyramid_writer->finish();
+        result.pyramid_tiles = pyramid_writer->tiles_written();
+    } else {
+        png_writer->finish();
     }
 
+    for (auto outcome : result.tiles) {
+        if (outcome == TileOutcome::Decoded) ++result.placed_tiles;
+    }
     return result;
 }
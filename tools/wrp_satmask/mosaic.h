@@ -1,24 +1,57 @@
 #pragma once
 
-#include "mapinfo_tiles.h"
-
-#include <armatools/paa.h>
+#include "png_stream_writer.h"
+#include "pyramid_writer.h"
+#include "tile_loader.h"
 
+#include <cstdint>
+#include <filesystem>
+#include <functional>
 #include <optional>
 #include <vector>
 
-struct RasterTile {
-    TileRef ref;
-    armatools::paa::Image image;
+// CellMosaic is a grid of cells, each showing one tile image. Tiles are
+// identified by id (0..tile_count-1) and may repeat across cells.
+struct CellMosaic {
+    int columns = 0;
+    int rows = 0;
+    std::vector<int> cell_tiles; // tile id per cell, row-major; -1 for an empty cell
+    size_t tile_count = 0;
+    TileReader read;             // reads the bytes of a tile id
+    bool flip_y = false;         // flip the whole canvas vertically (WRP cell order)
 };
 
+enum class TileOutcome : uint8_t { Unused, Decoded, Missing, DecodeFailed, SizeMismatch };
+
 struct MosaicResult {
-    int width = 0;
+    int width = 0;  // output size, after any --max-resolution cap
     int height = 0;
+    int canvas_width = 0;
+    int canvas_height = 0;
     int tile_width = 0;
     int tile_height = 0;
     int placed_tiles = 0;
-    std::vector<uint8_t> pixels;
+    std::vector<TileOutcome> tiles; // per tile id
+    int max_zoom = -1;              // pyramid output only
+    size_t pyramid_tiles = 0;
+};
+
+struct MosaicOptions {
+    int max_resolution = 0;
+    int threads = 1;
+    bool verbose = false;
+    PngStreamOptions png;
+    std::optional<PyramidOptions> pyramid; // write a tile pyramid instead of one PNG
+    // Called once the output layout is known, before any row is written.
+    std::function<void(const MosaicResult&)> on_layout;
 };
 
-std::optional<MosaicResult> build_mosaic(const std::vector<RasterTile>& tiles);
+// write_mosaic streams a mosaic one cell row (band) at a time to a PNG file,
+// or to a tile pyramid at path when opts.pyramid is set. Only the tiles of
+// the current band, and tiles that a later band uses again, are resident;
+// each tile is decoded once. The tile size is taken from the first tile id
+// that decodes, and tiles of another size are skipped.
+// Throws std::runtime_error if no tile decodes or the output cannot be
+// written.
+MosaicResult write_mosaic(const CellMosaic& mosaic, const std::filesystem::path& path,
+                          const MosaicOptions& opts);
@@ -1,16 +1,44 @@
 #include "png_stream_writer.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <stdexcept>
 
 namespace fs = std::filesystem;
 
-PngStreamWriter::PngStreamWriter(const fs::path& path, int width, int height, int channels)
+namespace {
+
+int libpng_filters(armatools::png::Filter filter) {
+    using armatools::png::Filter;
+    switch (filter) {
+    case Filter::None: return PNG_FILTER_NONE;
+    case Filter::Sub: return PNG_FILTER_SUB;
+    case Filter::Up: return PNG_FILTER_UP;
+    case Filter::Average: return PNG_FILTER_AVG;
+    case Filter::Paeth: return PNG_FILTER_PAETH;
+    case Filter::Adaptive: break;
+    }
+    return PNG_ALL_FILTERS;
+}
+
+} // namespace
+
+PngStreamWriter::PngStreamWriter(const fs::path& path, int width, int height, int channels,
+                                 const PngStreamOptions& opts)
     : width_(width), height_(height), channels_(channels) {
     if (width <= 0 || height <= 0 || (channels != 3 && channels != 4)) {
         throw std::invalid_argument("invalid PNG dimensions or channels");
     }
 
+    if (opts.parallel) {
+        out_.open(path, std::ios::binary);
+        if (!out_) {
+            throw std::runtime_error("png: cannot open output file");
+        }
+        parallel_ = std::make_unique<armatools::png::Writer>(out_, width, height, channels, opts.encode);
+        return;
+    }
+
     file_ = std::fopen(path.string().c_str(), "wb");
     if (!file_) {
         throw std::runtime_error("png: cannot open output file");
@@ -34,6 +62,8 @@ PngStreamWriter::PngStreamWriter(const fs::path& path, int width, int height, in
     }
 
     png_init_io(png_ptr_, file_);
+    png_set_compression_level(png_ptr_, std::clamp(opts.encode.level, 0, 9));
+    png_set_filter(png_ptr_, PNG_FILTER_TYPE_BASE, libpng_filters(opts.encode.filter));
     png_set_IHDR(png_ptr_, info_ptr_, width_, height_, 8,
                  channels_ == 3 ? PNG_COLOR_TYPE_RGB : PNG_COLOR_TYPE_RGBA,
                  PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
@@ -60,6 +90,10 @@ void PngStreamWriter::write_row(std::span<const uint8_t> row) {
     if (row.size() != static_cast<size_t>(width_) * static_cast<size_t>(channels_)) {
         throw std::runtime_error("png: row size mismatch");
     }
+    if (parallel_) {
+        parallel_->write_row(row);
+        return;
+    }
     ensure_initialized();
     if (setjmp(png_jmpbuf(png_ptr_))) {
         throw std::runtime_error("png: write row failed");
@@ -68,6 +102,12 @@ void PngStreamWriter::write_row(std::span<const uint8_t> row) {
 }
 
 void PngStreamWriter::finish() {
+    if (parallel_ && !finished_) {
+        parallel_->finish();
+        out_.close();
+        if (!out_) throw std::runtime_error("png: write end failed");
+        finished_ = true;
+    }
     if (finished_ || !png_ptr_) return;
     if (setjmp(png_jmpbuf(png_ptr_))) {
         throw std::runtime_error("png: write end failed");
@@ -1,12 +1,24 @@
 #pragma once
 
+#include <armatools/png.h>
+
 #include <filesystem>
+#include <fstream>
+#include <memory>
 #include <span>
 #include <png.h>
 
+struct PngStreamOptions {
+    // Encode with armatools::png (chunked deflate on encode.threads threads)
+    // instead of single-threaded libpng.
+    bool parallel = false;
+    armatools::png::Options encode; // level and filter apply to both encoders
+};
+
 class PngStreamWriter {
 public:
-    PngStreamWriter(const std::filesystem::path& path, int width, int height, int channels);
+    PngStreamWriter(const std::filesystem::path& path, int width, int height, int channels,
+                    const PngStreamOptions& opts = {});
     ~PngStreamWriter();
 
     void write_row(std::span<const uint8_t> row);
@@ -22,4 +34,7 @@ private:
     int height_ = 0;
     int channels_ = 0;
     bool finished_ = false;
+
+    std::ofstream out_;
+    std::unique_ptr<armatools::png::Writer> parallel_;
 };
@@ -0,0 +1,295 @@
+#include "pyramid_writer.h"
+
+#include "armatools/parallel.h"
+
+#include <sqlite3.h>
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string json_escape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        if (static_cast<unsigned char>(c) < 0x20) continue;
+        out += c;
+    }
+    return out;
+}
+
+// downsample_rows halves a pair of RGBA rows (b may be null for the last
+// row of an odd-height level) with a box filter. Samples past the right
+// edge are left out rather than treated as transparent.
+void downsample_rows(const uint8_t* a, const uint8_t* b, size_t width, uint8_t* out) {
+    size_t out_width = (width + 1) / 2;
+    for (size_t x = 0; x < out_width; ++x) {
+        size_t x0 = x * 2;
+        bool right = x0 + 1 < width;
+        unsigned count = (right ? 2u : 1u) * (b ? 2u : 1u);
+        for (size_t c = 0; c < 4; ++c) {
+            unsigned sum = a[x0 * 4 + c];
+            if (right) sum += a[(x0 + 1) * 4 + c];
+            if (b) {
+                sum += b[x0 * 4 + c];
+                if (right) sum += b[(x0 + 1) * 4 + c];
+            }
+            out[x * 4 + c] = static_cast<uint8_t>((sum + count / 2) / count);
+        }
+    }
+}
+
+} // namespace
+
+struct PyramidWriter::Impl {
+    struct Level {
+        size_t width = 0;
+        size_t height = 0;
+        size_t rows_in = 0;
+        std::vector<uint8_t> band;    // tile_size rows
+        std::vector<uint8_t> pending; // first row of the next 2x2 pair
+        bool has_pending = false;
+        std::vector<uint8_t> half;    // downsampled row for the level below
+    };
+
+    fs::path path;
+    PyramidOptions opts;
+    size_t tile;
+    int zmax = 0;
+    std::vector<Level> levels; // indexed by zoom
+    size_t written = 0;
+    bool finished = false;
+
+    sqlite3* db = nullptr;
+    sqlite3_stmt* insert = nullptr;
+
+    Impl(const fs::path& p, int width, int height, const PyramidOptions& o)
+        : path(p), opts(o), tile(static_cast<size_t>(o.tile_size)) {
+        opts.encode.threads = 1;
+        if (opts.name.empty()) opts.name = path.stem().string();
+        size_t side = static_cast<size_t>(std::max(width, height));
+        while ((tile << zmax) < side) ++zmax;
+
+        levels.resize(static_cast<size_t>(zmax) + 1);
+        size_t w = static_cast<size_t>(width);
+        size_t h = static_cast<size_t>(height);
+        for (int z = zmax; z >= 0; --z) {
+            auto& level = levels[static_cast<size_t>(z)];
+            level.width = w;
+            level.height = h;
+            level.band.resize(tile * w * 4);
+            if (z > 0) {
+                level.pending.resize(w * 4);
+                level.half.resize((w + 1) / 2 * 4);
+            }
+            w = (w + 1) / 2;
+            h = (h + 1) / 2;
+        }
+
+        if (opts.format == PyramidFormat::MBTiles) {
+            open_mbtiles();
+        } else {
+            fs::create_directories(path);
+        }
+    }
+
+    ~Impl() {
+        if (insert) sqlite3_finalize(insert);
+        if (db) sqlite3_close(db);
+    }
+
+    void exec(const char* sql) {
+        char* err = nullptr;
+        if (sqlite3_exec(db, sql, nullptr, nullptr, &err) != SQLITE_OK) {
+            std::string msg = err ? err : "unknown error";
+            sqlite3_free(err);
+            throw std::runtime_error(std::format("pyramid: sqlite3_exec: {}", msg));
+        }
+    }
+
+    void open_mbtiles() {
+        std::error_code ec;
+        fs::remove(path, ec);
+        if (sqlite3_open_v2(path.string().c_str(), &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE,
+                            nullptr) != SQLITE_OK) {
+            std::string msg = db ? sqlite3_errmsg(db) : "out of memory";
+            throw std::runtime_error(std::format("pyramid: cannot create {}: {}", path.string(), msg));
+        }
+        exec("PRAGMA journal_mode=OFF;"
+             "PRAGMA synchronous=OFF;"
+             "CREATE TABLE metadata (name TEXT, value TEXT);"
+             "CREATE TABLE tiles (zoom_level INTEGER, tile_column INTEGER, tile_row INTEGER, tile_data BLOB);"
+             "CREATE UNIQUE INDEX tile_index ON tiles (zoom_level, tile_column, tile_row);"
+             "BEGIN;");
+        if (sqlite3_prepare_v2(db, "INSERT INTO tiles VALUES (?, ?, ?, ?)", -1, &insert, nullptr) != SQLITE_OK) {
+            throw std::runtime_error(std::format("pyramid: prepare: {}", sqlite3_errmsg(db)));
+        }
+    }
+
+    void store(int z, size_t x, size_t y, const std::string& data) {
+        if (db) {
+            sqlite3_bind_int(insert, 1, z);
+            sqlite3_bind_int64(insert, 2, static_cast<sqlite3_int64>(x));
+            // MBTiles rows count from the bottom (TMS).
+            sqlite3_bind_int64(insert, 3, static_cast<sqlite3_int64>(((size_t{1} << z) - 1) - y));
+            sqlite3_bind_blob(insert, 4, data.data(), static_cast<int>(data.size()), SQLITE_STATIC);
+            int rc = sqlite3_step(insert);
+            sqlite3_reset(insert);
+            if (rc != SQLITE_DONE) {
+                throw std::runtime_error(std::format("pyramid: insert tile: {}", sqlite3_errmsg(db)));
+            }
+        } else {
+            fs::path dir = path / std::to_string(z) / std::to_string(x);
+            fs::create_directories(dir);
+            fs::path file = dir / (std::to_string(y) + ".png");
+            std::ofstream out(file, std::ios::binary);
+            out.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (!out) throw std::runtime_error("pyramid: cannot write " + file.string());
+        }
+        ++written;
+    }
+
+    // Encodes a tile; returns an empty string if it is fully transparent.
+    std::string encode_tile(const Level& level, size_t tx, size_t rows) const {
+        size_t x0 = tx * tile;
+        size_t cols = std::min(tile, level.width - x0);
+        std::vector<uint8_t> pixels(tile * tile * 4, 0);
+        bool opaque = false;
+        for (size_t y = 0; y < rows; ++y) {
+            const uint8_t* src = level.band.data() + (y * level.width + x0) * 4;
+            for (size_t x = 0; x < cols && !opaque; ++x) opaque = src[x * 4 + 3] != 0;
+            std::memcpy(pixels.data() + y * tile * 4, src, cols * 4);
+        }
+        if (!opaque) return {};
+        std::ostringstream out;
+        armatools::png::write(out, pixels.data(), static_cast<int>(tile), static_cast<int>(tile), 4,
+                              opts.encode);
+        return std::move(out).str();
+    }
+
+    void flush_band(int z, size_t rows) {
+        auto& level = levels[static_cast<size_t>(z)];
+        size_t ty = (level.rows_in - 1) / tile;
+        size_t tiles_x = (level.width + tile - 1) / tile;
+        std::vector<std::string> encoded(tiles_x);
+
+        armatools::binutil::parallel_for(tiles_x, static_cast<size_t>(std::max(1, opts.threads)),
+                                         [&](size_t tx) { encoded[tx] = encode_tile(level, tx, rows); });
+
+        for (size_t tx = 0; tx < tiles_x; ++tx) {
+            if (!encoded[tx].empty()) store(z, tx, ty, encoded[tx]);
+        }
+        std::fill(level.band.begin(), level.band.end(), 0);
+    }
+
+    void push(int z, const uint8_t* row) {
+        auto& level = levels[static_cast<size_t>(z)];
+        size_t stride = level.width * 4;
+        std::memcpy(level.band.data() + (level.rows_in % tile) * stride, row, stride);
+        ++level.rows_in;
+
+        if (z > 0) {
+            if (!level.has_pending) {
+                std::memcpy(level.pending.data(), row, stride);
+                level.has_pending = true;
+            } else {
+                downsample_rows(level.pending.data(), row, level.width, level.half.data());
+                level.has_pending = false;
+                push(z - 1, level.half.data());
+            }
+        }
+        if (level.rows_in % tile == 0) flush_band(z, tile);
+    }
+
+    void write_row(std::span<const uint8_t> row) {
+        auto& top = levels.back();
+        if (row.size() != top.width * 4) throw std::runtime_error("pyramid: row size mismatch");
+        if (top.rows_in >= top.height) throw std::runtime_error("pyramid: too many rows");
+        push(zmax, row.data());
+    }
+
+    void finish() {
+        if (finished) return;
+        if (levels.back().rows_in != levels.back().height) throw std::runtime_error("pyramid: missing rows");
+        for (int z = zmax; z >= 0; --z) {
+            auto& level = levels[static_cast<size_t>(z)];
+            if (level.has_pending) {
+                downsample_rows(level.pending.data(), nullptr, level.width, level.half.data());
+                level.has_pending = false;
+                push(z - 1, level.half.data());
+            }
+            if (size_t rows = level.rows_in % tile; rows != 0) flush_band(z, rows);
+        }
+
+        const auto& top = levels.back();
+        if (db) {
+            sqlite3_stmt* meta = nullptr;
+            sqlite3_prepare_v2(db, "INSERT INTO metadata VALUES (?, ?)", -1, &meta, nullptr);
+            auto put = [&](const char* key, const std::string& value) {
+                sqlite3_bind_text(meta, 1, key, -1, SQLITE_STATIC);
+                sqlite3_bind_text(meta, 2, value.c_str(), -1, SQLITE_TRANSIENT);
+                sqlite3_step(meta);
+                sqlite3_reset(meta);
+            };
+            put("name", opts.name);
+            put("format", "png");
+            put("type", "baselayer");
+            put("version", "1");
+            put("minzoom", "0");
+            put("maxzoom", std::to_string(zmax));
+            put("tile_size", std::to_string(tile));
+            put("width", std::to_string(top.width));
+            put("height", std::to_string(top.height));
+            sqlite3_finalize(meta);
+            exec("COMMIT;");
+        } else {
+            std::ofstream out(path / "metadata.json");
+            out << std::format("{{\"name\":\"{}\",\"format\":\"png\",\"scheme\":\"xyz\",\"tile_size\":{},"
+                               "\"minzoom\":0,\"maxzoom\":{},\"width\":{},\"height\":{}}}\n",
+                               json_escape(opts.name), tile, zmax, top.width, top.height);
+            if (!out) throw std::runtime_error("pyramid: cannot write metadata.json");
+        }
+        finished = true;
+    }
+};
+
+PyramidWriter::PyramidWriter(const fs::path& path, int width, int height, const PyramidOptions& opts) {
+    if (width <= 0 || height <= 0) {
+        throw std::invalid_argument("invalid pyramid dimensions");
+    }
+    if (opts.tile_size != 256 && opts.tile_size != 512) {
+        throw std::invalid_argument("pyramid: tile size must be 256 or 512");
+    }
+    impl_ = std::make_unique<Impl>(path, width, height, opts);
+}
+
+PyramidWriter::~PyramidWriter() = default;
+
+void PyramidWriter::write_row(std::span<const uint8_t> row) {
+    impl_->write_row(row);
+}
+
+void PyramidWriter::finish() {
+    impl_->finish();
+}
+
+int PyramidWriter::max_zoom() const {
+    return impl_->zmax;
+}
+
+size_t PyramidWriter::tiles_written() const {
+    return impl_->written;
+}
+
+fs::path pyramid_path(const fs::path& dir, const std::string& stem, PyramidFormat format) {
+    if (format == PyramidFormat::MBTiles) return dir / (stem + ".mbtiles");
+    return dir / stem;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <armatools/png.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+
+enum class PyramidFormat { Xyz, MBTiles };
+
+struct PyramidOptions {
+    PyramidFormat format = PyramidFormat::Xyz;
+    int tile_size = 256;
+    int threads = 1;                // tiles encoded in parallel per band
+    armatools::png::Options encode; // per-tile PNG settings; threads is ignored
+    std::string name;               // metadata name; defaults to the path stem
+};
+
+// PyramidWriter turns an RGBA image streamed top to bottom into a tile
+// pyramid. The image sits at the top-left of the deepest zoom level, which
+// is the first level where it fits into 2^z x 2^z tiles at full resolution;
+// each lower level halves it with a 2x2 box filter as rows arrive. Only one
+// band of tile_size rows per level is buffered. Fully transparent tiles are
+// not written.
+//
+// Xyz writes <path>/<z>/<x>/<y>.png plus <path>/metadata.json; MBTiles
+// writes a single SQLite file (TMS row order, replacing any existing file).
+class PyramidWriter {
+public:
+    PyramidWriter(const std::filesystem::path& path, int width, int height, const PyramidOptions& opts);
+    ~PyramidWriter();
+
+    PyramidWriter(const PyramidWriter&) = delete;
+    PyramidWriter& operator=(const PyramidWriter&) = delete;
+
+    void write_row(std::span<const uint8_t> row);
+    void finish();
+
+    int max_zoom() const;
+    size_t tiles_written() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// pyramid_path returns where a pyramid for a layer named stem is written:
+// a directory for Xyz and a .mbtiles file for MBTiles.
+std::filesystem::path pyramid_path(const std::filesystem::path& dir, const std::string& stem,
+                                   PyramidFormat format);
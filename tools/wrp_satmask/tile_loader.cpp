@@ -0,0 +1,101 @@
+#include "tile_loader.h"
+
+#include "armatools/parallel.h"
+
+#include <algorithm>
+#include <istream>
+#include <semaphore>
+#include <streambuf>
+
+namespace {
+
+// ByteViewBuf exposes a byte buffer to std::istream without copying it.
+class ByteViewBuf : public std::streambuf {
+public:
+    explicit ByteViewBuf(std::span<const uint8_t> bytes) {
+        char* begin = const_cast<char*>(reinterpret_cast<const char*>(bytes.data()));
+        setg(begin, begin, begin + bytes.size());
+    }
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+        if (!(which & std::ios_base::in)) return pos_type(off_type(-1));
+        off_type base = 0;
+        if (dir == std::ios_base::cur) base = gptr() - eback();
+        else if (dir == std::ios_base::end) base = egptr() - eback();
+        return seekpos(pos_type(base + off), which);
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+        off_type off = pos;
+        if (!(which & std::ios_base::in) || off < 0 || off > egptr() - eback()) {
+            return pos_type(off_type(-1));
+        }
+        setg(eback(), eback() + off, egptr());
+        return pos;
+    }
+};
+
+LoadedTile decode_tile(std::optional<std::vector<uint8_t>> bytes) {
+    LoadedTile tile;
+    if (!bytes) {
+        tile.status = LoadedTile::Status::Missing;
+        return tile;
+    }
+    try {
+        tile.image = decode_paa(*bytes).first;
+    } catch (const std::exception&) {
+        tile.status = LoadedTile::Status::DecodeFailed;
+    }
+    return tile;
+}
+
+std::optional<std::vector<uint8_t>> read_tile(const TileReader& read, size_t index) {
+    try {
+        return read(index);
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+} // namespace
+
+std::pair<armatools::paa::Image, armatools::paa::Header> decode_paa(std::span<const uint8_t> bytes) {
+    ByteViewBuf buf(bytes);
+    std::istream stream(&buf);
+    return armatools::paa::decode(stream);
+}
+
+int resolve_thread_count(int requested) {
+    return static_cast<int>(armatools::binutil::worker_count(requested));
+}
+
+void load_tiles_ordered(size_t count, const TileReader& read, int threads, const TileSink& sink) {
+    if (threads <= 1 || count <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            sink(i, decode_tile(read_tile(read, i)));
+        }
+        return;
+    }
+
+    // Decoding dominates; a few concurrent reads are enough to keep the
+    // decoders fed without thrashing the disk with many concurrent PBO reads.
+    const auto workers = static_cast<size_t>(threads);
+    std::counting_semaphore<> io(static_cast<std::ptrdiff_t>(std::clamp<size_t>(workers / 4, 1, 4)));
+
+    armatools::binutil::ordered_for<LoadedTile>(
+        count, workers,
+        [&](size_t i, LoadedTile& tile) {
+            std::optional<std::vector<uint8_t>> bytes;
+            io.acquire();
+            try {
+                bytes = read_tile(read, i);
+            } catch (...) {
+                io.release();
+                throw;
+            }
+            io.release();
+            tile = decode_tile(std::move(bytes));
+        },
+        [&](size_t i, LoadedTile& tile) { sink(i, std::move(tile)); });
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <armatools/paa.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+// LoadedTile is the outcome of reading and decoding one tile asset.
+struct LoadedTile {
+    enum class Status { Ok, Missing, DecodeFailed };
+
+    Status status = Status::Ok;
+    armatools::paa::Image image;
+};
+
+// TileReader returns the raw bytes of item i, or nullopt if it cannot be found.
+// It is called concurrently from the worker threads.
+using TileReader = std::function<std::optional<std::vector<uint8_t>>(size_t)>;
+
+// TileSink receives item i; it is called on the caller's thread in index order.
+using TileSink = std::function<void(size_t, LoadedTile&&)>;
+
+// decode_paa decodes a PAA/PAC image directly from an in-memory buffer.
+std::pair<armatools::paa::Image, armatools::paa::Header> decode_paa(std::span<const uint8_t> bytes);
+
+// resolve_thread_count maps a --threads value to a worker count (0 = all cores).
+int resolve_thread_count(int requested);
+
+// load_tiles_ordered reads and decodes count tiles on up to threads workers,
+// with at most a few reads in flight at once, and hands the results to sink
+// in index order. Only a couple of tiles per worker are held at any time, so
+// memory stays bounded however many tiles there are. An exception from sink
+// stops the workers and is rethrown. With threads <= 1 everything runs on the
+// calling thread.
+void load_tiles_ordered(size_t count, const TileReader& read, int threads, const TileSink& sink);